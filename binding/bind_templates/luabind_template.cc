@@ -147,6 +147,21 @@ int lua_is$$ClassName$$(lua_State *L, int index){
 
 void lua_push$$ClassName$$(lua_State *L, $$ClassName$$ *obj){
         int lua_ref = obj->getLuaRef();
+        if (lua_ref != LUA_NOREF) {
+          pushOrCreateTable(L, LUA_REGISTRYINDEX, "luabind_refs");
+          // pila = refs
+          lua_rawgeti(L, -1, lua_ref);
+          // pila = refs ptr
+          lua_remove(L, -2);
+          // pila = ptr
+          // A userdata which is unreachable but not finalized yet has been
+          // removed from the weak refs table, and its slot could be reused by
+          // another object, so a new userdata is needed in this case.
+          if (lua_rawget$$ClassName$$_$$FILENAME2$$(L, -1) != obj) {
+            lua_pop(L, 1);
+            lua_ref = LUA_NOREF;
+          }
+        }
         if (lua_ref == LUA_NOREF) {
           // We do IncRef as soon as possible avoiding GARBAGE COLLECTOR to removes
           // our instance
@@ -190,11 +205,6 @@ void lua_push$$ClassName$$(lua_State *L, $$ClassName$$ *obj){
           // pila = ptr
         }
         else {
-          pushOrCreateTable(L, LUA_REGISTRYINDEX, "luabind_refs");
-          // pila = refs
-          lua_rawgeti(L, -1, lua_ref);
-          // pila = refs ptr
-          lua_remove(L, -2);
           // pila = ptr
           lua_getmetatable(L, -1);
           // pila = ptr metatable
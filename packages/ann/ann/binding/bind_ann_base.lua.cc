@@ -28,12 +28,63 @@
 #include "bind_mtrand.h"
 #include "bind_tokens.h"
 #include "bind_util.h"
+#include "qsort.h"
 #include "table_of_token_codes.h"
 
 using namespace AprilUtils;
 using namespace Basics;
 
 namespace ANN {
+  /// Reads the matrices of a weights dictionary at the given stack position,
+  /// sorted by name
+  static void readWeightsDict(lua_State *L, int n,
+                              AprilUtils::vector<AprilUtils::string> &names,
+                              AprilUtils::vector<MatrixFloat*> &weights) {
+    n = lua_absindex(L, n);
+    lua_pushnil(L);
+    while(lua_next(L, n) != 0) {
+      if (lua_type(L, -2) != LUA_TSTRING) {
+        luaL_error(L, "Expected a dictionary of weights indexed by strings");
+      }
+      names.push_back(AprilUtils::string(lua_tostring(L, -2)));
+      lua_pop(L, 1);
+    }
+    AprilUtils::Sort(names.begin(), static_cast<int>(names.size()));
+    for (unsigned int i=0; i<names.size(); ++i) {
+      lua_getfield(L, n, names[i].c_str());
+      if (!lua_isMatrixFloat(L, -1)) {
+        luaL_error(L, "Expected a matrix at weights %s", names[i].c_str());
+      }
+      weights.push_back(lua_toMatrixFloat(L, -1));
+      lua_pop(L, 1);
+    }
+  }
+
+  /// Puts the given matrices into the table at the given stack position
+  static void writeWeightsDict(lua_State *L, int n,
+                               const AprilUtils::vector<AprilUtils::string> &names,
+                               const AprilUtils::vector<MatrixFloat*> &weights) {
+    n = lua_absindex(L, n);
+    for (unsigned int i=0; i<names.size(); ++i) {
+      lua_pushMatrixFloat(L, weights[i]);
+      lua_setfield(L, n, names[i].c_str());
+    }
+  }
+
+  /// Moves the weights of the table at the given stack position to views of
+  /// one flat matrix, unless they are already in this layout. Returns true if
+  /// the weights have been modified.
+  static bool flattenWeightsDict(lua_State *L, int n) {
+    AprilUtils::vector<AprilUtils::string> names;
+    AprilUtils::vector<MatrixFloat*> weights, views;
+    readWeightsDict(L, n, names, weights);
+    AprilUtils::SharedPtr<MatrixFloat> flat(Connections::getFlat(weights));
+    if (!flat.empty() || weights.empty()) return false;
+    flat = Connections::buildFlat(weights, views, true);
+    writeWeightsDict(L, n, names, views);
+    return true;
+  }
+
   static bool rewrapToAtLeastDim2(AprilUtils::SharedPtr<Token> &tk) {
     if (tk->getTokenCode() == table_of_token_codes::token_matrix) {
       Basics::TokenMatrixFloat *tk_mat = tk->convertTo<Basics::TokenMatrixFloat*>();
@@ -75,6 +126,9 @@ void lua_pushAuxANNComponent(lua_State *L, ANNComponent *value) {
   else if (dynamic_cast<ConvolutionANNComponent*>(value)) {
     lua_pushConvolutionANNComponent(L, (ConvolutionANNComponent*)value);
   }
+  else if (dynamic_cast<DotProductANNComponent*>(value)) {
+    lua_pushDotProductANNComponent(L, (DotProductANNComponent*)value);
+  }
   else if (dynamic_cast<RewrapANNComponent*>(value)) {
     lua_pushRewrapANNComponent(L, (RewrapANNComponent*)value);
   }
@@ -306,6 +360,55 @@ void lua_pushAuxANNComponent(lua_State *L, ANNComponent *value);
 }
 //BIND_END
 
+//BIND_FUNCTION ann.connections.flatten
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  flattenWeightsDict(L, 1);
+  AprilUtils::vector<AprilUtils::string> names;
+  AprilUtils::vector<MatrixFloat*> weights;
+  readWeightsDict(L, 1, names, weights);
+  MatrixFloat *flat = Connections::getFlat(weights);
+  LUABIND_RETURN_FROM_STACK(1);
+  if (flat != 0) {
+    LUABIND_RETURN(MatrixFloat, flat);
+  }
+}
+//BIND_END
+
+//BIND_FUNCTION ann.connections.flat_like
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  AprilUtils::vector<AprilUtils::string> names;
+  AprilUtils::vector<MatrixFloat*> weights, views;
+  readWeightsDict(L, 1, names, weights);
+  if (weights.empty()) LUABIND_ERROR("Expected a non empty weights table");
+  MatrixFloat *flat = Connections::buildFlat(weights, views, false);
+  lua_newtable(L);
+  writeWeightsDict(L, -1, names, views);
+  LUABIND_INCREASE_NUM_RETURNS(1);
+  LUABIND_RETURN(MatrixFloat, flat);
+}
+//BIND_END
+
+//BIND_FUNCTION ann.connections.get_flat
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  AprilUtils::vector<AprilUtils::string> names;
+  AprilUtils::vector<MatrixFloat*> weights;
+  readWeightsDict(L, 1, names, weights);
+  MatrixFloat *flat = Connections::getFlat(weights);
+  if (flat != 0) {
+    LUABIND_RETURN(MatrixFloat, flat);
+  }
+  else {
+    LUABIND_RETURN_NIL();
+  }
+}
+//BIND_END
+
 /////////////////////////////////////////////////////
 //                  ANNComponent                   //
 /////////////////////////////////////////////////////
@@ -539,18 +642,30 @@ void lua_pushAuxANNComponent(lua_State *L, ANNComponent *value);
   LUABIND_CHECK_ARGN(<=, 1);
   int argn = lua_gettop(L);
   unsigned int input_size=0, output_size=0;
+  bool flat=false;
   AprilUtils::LuaTable weights_dict(L), components_dict(L);
   if (argn == 1) {
     LUABIND_CHECK_PARAMETER(1, table);
-    check_table_fields(L, 1, "input", "output", "weights", (const char *)0);
+    check_table_fields(L, 1, "input", "output", "weights", "flat",
+                       (const char *)0);
     LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, input, uint, input_size, 0);
     LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, output, uint, output_size, 0);
+    LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, flat, bool, flat, false);
     lua_getfield(L, 1, "weights");
     if (!lua_isnil(L, -1)) weights_dict = lua_toLuaTable(L,-1);
     lua_pop(L, 1);
   }
   //
   obj->build(input_size, output_size, weights_dict, components_dict);
+  if (flat) {
+    // weights are moved to views of a flat matrix, and the component is
+    // rebuilt to use them
+    AprilUtils::LuaTable::pushInto(L, weights_dict);
+    if (flattenWeightsDict(L, -1)) {
+      obj->build(input_size, output_size, weights_dict, components_dict);
+    }
+    lua_pop(L, 1);
+  }
   //
   LUABIND_RETURN(AuxANNComponent, obj);
   LUABIND_RETURN(LuaTable, weights_dict);
@@ -643,6 +758,39 @@ void lua_pushAuxANNComponent(lua_State *L, ANNComponent *value);
 }
 //BIND_END
 
+//BIND_METHOD DotProductANNComponent quantize
+//DOC_BEGIN
+// quantize(keep_float_weights=true)
+/// Takes an int8 snapshot of the weights, releasing the float ones when keep_float_weights=false.
+//DOC_END
+{
+  bool keep_float_weights;
+  LUABIND_GET_OPTIONAL_PARAMETER(1, bool, keep_float_weights, true);
+  obj->quantize(keep_float_weights);
+  LUABIND_RETURN(DotProductANNComponent, obj);
+}
+//BIND_END
+
+//BIND_METHOD DotProductANNComponent dequantize
+{
+  obj->dequantize();
+  LUABIND_RETURN(DotProductANNComponent, obj);
+}
+//BIND_END
+
+//BIND_METHOD DotProductANNComponent is_quantized
+{
+  LUABIND_RETURN(bool, obj->isQuantized());
+}
+//BIND_END
+
+//BIND_METHOD DotProductANNComponent get_quantized_memory_size
+{
+  QuantizedWeights *qw = obj->getQuantizedWeights();
+  LUABIND_RETURN(uint, (qw != 0) ? static_cast<unsigned int>(qw->getMemorySize()) : 0u);
+}
+//BIND_END
+
 /////////////////////////////////////////////////////
 //         ProbabilisticMatrixANNComponent         //
 /////////////////////////////////////////////////////
@@ -1259,6 +1407,39 @@ void lua_pushAuxANNComponent(lua_State *L, ANNComponent *value);
 }
 //BIND_END
 
+//BIND_METHOD ConvolutionANNComponent quantize
+//DOC_BEGIN
+// quantize(keep_float_weights=true)
+/// Takes an int8 snapshot of the weights, releasing the float ones when keep_float_weights=false.
+//DOC_END
+{
+  bool keep_float_weights;
+  LUABIND_GET_OPTIONAL_PARAMETER(1, bool, keep_float_weights, true);
+  obj->quantize(keep_float_weights);
+  LUABIND_RETURN(ConvolutionANNComponent, obj);
+}
+//BIND_END
+
+//BIND_METHOD ConvolutionANNComponent dequantize
+{
+  obj->dequantize();
+  LUABIND_RETURN(ConvolutionANNComponent, obj);
+}
+//BIND_END
+
+//BIND_METHOD ConvolutionANNComponent is_quantized
+{
+  LUABIND_RETURN(bool, obj->isQuantized());
+}
+//BIND_END
+
+//BIND_METHOD ConvolutionANNComponent get_quantized_memory_size
+{
+  QuantizedWeights *qw = obj->getQuantizedWeights();
+  LUABIND_RETURN(uint, (qw != 0) ? static_cast<unsigned int>(qw->getMemorySize()) : 0u);
+}
+//BIND_END
+
 /////////////////////////////////////////////////////
 //           ConvolutionBiasANNComponent           //
 /////////////////////////////////////////////////////
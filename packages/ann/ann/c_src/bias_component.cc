@@ -62,8 +62,10 @@ namespace ANN {
     else {
       // addition of bias vector at output
       doAxpyLoop(output_size, 1.0f,
-		 bias_ptr->getRawDataAccess(), bias_ptr->getStrideSize(0), 0,
-		 output->getRawDataAccess(), output->getStrideSize(1), 0,
+		 bias_ptr->getRawDataAccess(), bias_ptr->getStrideSize(0),
+		 bias_ptr->getOffset(),
+		 output->getRawDataAccess(), output->getStrideSize(1),
+		 output->getOffset(),
 		 bunch_size,
 		 0, output->getStrideSize(0),
 		 use_cuda);
@@ -111,10 +113,10 @@ namespace ANN {
                  1.0f,
                  error_input_mat->getRawDataAccess(),
                  error_input_mat->getStrideSize(1),
-                 0,
+                 error_input_mat->getOffset(),
                  grads_mat->getRawDataAccess(),
                  grads_mat->getStrideSize(0),
-                 0,
+                 grads_mat->getOffset(),
                  bunch_size,
                  error_input_mat->getStrideSize(0), 0,
                  use_cuda);
@@ -24,11 +24,14 @@
 #include "check_floats.h"
 #include "smart_ptr.h"
 #include "c_string.h"
+#include "matrix_ext.h"
 #include "swap.h"
 #include "utilMatrixFloat.h"
 
 using namespace AprilIO;
 using namespace AprilMath;
+using namespace AprilMath::MatrixExt::BLAS;
+using namespace AprilMath::MatrixExt::Initializers;
 using namespace AprilUtils;
 using namespace Basics;
 
@@ -166,6 +169,48 @@ namespace ANN {
     return current_w_pos;
   }
   
+  MatrixFloat *Connections::buildFlat(const vector<MatrixFloat*> &weights,
+                                      vector<MatrixFloat*> &views,
+                                      bool copy) {
+    int total_size = 0;
+    for (unsigned int i=0; i<weights.size(); ++i) {
+      total_size += weights[i]->size();
+    }
+    MatrixFloat *flat = new MatrixFloat(1, &total_size);
+    if (!copy) matZeros(flat);
+    views.clear();
+    int offset = 0;
+    for (unsigned int i=0; i<weights.size(); ++i) {
+      MatrixFloat *w = weights[i];
+      MatrixFloat *view = new MatrixFloat(w->getNumDim(), w->getDimPtr(),
+                                          flat->getRawDataAccess(), offset);
+#ifdef USE_CUDA
+      view->setUseCuda(w->getCudaFlag());
+#endif
+      if (copy) matCopy(view, w);
+      views.push_back(view);
+      offset += w->size();
+    }
+    return flat;
+  }
+
+  MatrixFloat *Connections::getFlat(const vector<MatrixFloat*> &weights) {
+    if (weights.empty()) return 0;
+    const GPUMirroredMemoryBlock<float> *block =
+      weights[0]->getRawDataAccess();
+    const int first_offset = weights[0]->getOffset();
+    int offset = first_offset;
+    for (unsigned int i=0; i<weights.size(); ++i) {
+      const MatrixFloat *w = weights[i];
+      if (w->getRawDataAccess() != block || w->getOffset() != offset ||
+          !w->getIsContiguous()) return 0;
+      offset += w->size();
+    }
+    int total_size = offset - first_offset;
+    return new MatrixFloat(1, &total_size,
+                           weights[0]->getRawDataAccess(), first_offset);
+  }
+  
   char *Connections::toLuaString(MatrixFloat *weights) {
     SharedPtr<CStringStream> stream(new CStringStream());
     stream->put("matrix.fromString[[");
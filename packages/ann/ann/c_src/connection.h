@@ -30,6 +30,7 @@
 #include "matrixFloat.h"
 #include "error_print.h"
 #include "maxmin.h"
+#include "vector.h"
 
 namespace ANN {
 
@@ -79,6 +80,31 @@ namespace ANN {
 				      unsigned int column_size);
     
     static char *toLuaString(Basics::MatrixFloat *weights);
+
+    /**
+     * @brief Allocates one flat matrix with the size of all the given
+     * weights, and fills @c views with matrices of the same shapes which are
+     * consecutive views of it.
+     *
+     * @param weights - The weight matrices, in the order of the flat buffer.
+     * @param[out] views - New matrices sharing memory with the flat buffer.
+     * @param copy - Indicates if the content of weights is copied into the
+     * views, otherwise the flat buffer is initialized with zeros.
+     *
+     * @return The flat matrix, a one dimensional matrix.
+     */
+    static Basics::MatrixFloat *
+    buildFlat(const AprilUtils::vector<Basics::MatrixFloat*> &weights,
+              AprilUtils::vector<Basics::MatrixFloat*> &views,
+              bool copy);
+
+    /**
+     * @brief Returns a one dimensional matrix over the memory of the given
+     * weights when they are contiguous and consecutive views of the same
+     * memory block, otherwise NULL.
+     */
+    static Basics::MatrixFloat *
+    getFlat(const AprilUtils::vector<Basics::MatrixFloat*> &weights);
   };
 }
 #endif
@@ -209,7 +209,7 @@ namespace ANN {
 		 error_w->getOffset(),
 		 grads_mat->getRawDataAccess(),
 		 grads_mat->getStrideSize(0),
-		 0,
+		 grads_mat->getOffset(),
 		 bunch_size,
 		 error_w->getStrideSize(0), 0,
 		 use_cuda);
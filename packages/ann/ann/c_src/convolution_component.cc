@@ -132,8 +132,9 @@ namespace ANN {
   MatrixFloat *ConvolutionANNComponent::
   privateDoForward(MatrixFloat *input_mat, bool during_training) {
     UNUSED_VARIABLE(during_training);
-    if (weights_matrix == 0) ERROR_EXIT1(129, "Not built component %s\n",
-					 name.c_str());
+    if (weights_matrix == 0 && quantized_weights.empty()) {
+      ERROR_EXIT1(129, "Not built component %s\n", name.c_str());
+    }
     MatrixFloat *weights_mat = weights_matrix;
     // error checking
     if (input_mat->getNumDim() != input_num_dims+1)
@@ -182,11 +183,16 @@ namespace ANN {
       IncRef(output_flattened);
       
       // COMPUTE MATRIX MULTIPLICATION
-      matGemm(output_flattened,
-              CblasNoTrans, CblasTrans,
-              1.0f, input_flattened,
-              weights_mat,
-              0.0f);
+      if (!quantized_weights.empty()) {
+        quantized_weights->forward(input_flattened, output_flattened);
+      }
+      else {
+        matGemm(output_flattened,
+                CblasNoTrans, CblasTrans,
+                1.0f, input_flattened,
+                weights_mat,
+                0.0f);
+      }
       // COPY TO DESTINATION IF NEEDED
       if (output_w->getRawDataAccess()!=output_flattened->getRawDataAccess()) {
 	// if output_w and output_flattened are pointing to different data
@@ -217,6 +223,10 @@ namespace ANN {
   
   MatrixFloat *ConvolutionANNComponent::
   privateDoBackprop(MatrixFloat *error_input_mat) {
+    if (!quantized_weights.empty()) {
+      ERROR_EXIT1(128, "Quantized components are inference only [%s]\n",
+                  name.c_str());
+    }
     MatrixFloat *weights_mat = weights_matrix;
     MatrixFloat *output_mat  = getOutputMatrix();
     MatrixFloat *input_mat   = getInputMatrix();
@@ -297,6 +307,10 @@ namespace ANN {
   
   void ConvolutionANNComponent::computeGradients(const char *name,
                                                  AprilUtils::LuaTable &grads_mat_dict) {
+    if (!quantized_weights.empty()) {
+      ERROR_EXIT1(128, "Quantized components are inference only [%s]\n",
+                  this->name.c_str());
+    }
     weights_matrix->addToSharedCount(number_input_windows);
     MatrixFloat *grads_mat = grads_mat_dict.opt<MatrixFloat*>(name, 0);
     if (grads_mat == 0) {
@@ -356,7 +370,7 @@ namespace ANN {
 
   void ConvolutionANNComponent::privateReset(unsigned int it) {
     UNUSED_VARIABLE(it);
-    weights_matrix->resetSharedCount();
+    if (weights_matrix != 0) weights_matrix->resetSharedCount();
   }
   
   ANNComponent *ConvolutionANNComponent::clone() {
@@ -382,6 +396,7 @@ namespace ANN {
     // printf("%s :: %p %p\n", weights_name.c_str(), w, weights_matrix);
     if (w != 0) {
       // printf("COPY OF WEIGHTS FROM HASH %s\n", weights_name.c_str());
+      if (w != weights_matrix) quantized_weights.reset();
       AssignRef(weights_matrix, w);
       if (!Connections::checkInputOutputSizes(weights_matrix,
 					      weights_input_size,
@@ -391,6 +406,14 @@ namespace ANN {
 		    weights_input_size, weights_output_size,
 		    name.c_str());
     }
+    else if (weights_matrix == 0 && !quantized_weights.empty()) {
+      // quantized without float weights, nothing to be built
+      if (quantized_weights->getInputSize()  != static_cast<int>(weights_input_size) ||
+          quantized_weights->getOutputSize() != static_cast<int>(weights_output_size)) {
+        ERROR_EXIT1(256, "The quantized weights sizes are not correct [%s]\n",
+                    name.c_str());
+      }
+    }
     else {
       if (weights_matrix == 0) {
 	// printf("NEW OF WEIGHTS %s\n", weights_name.c_str());
@@ -403,7 +426,30 @@ namespace ANN {
     }
   }
 
+  void ConvolutionANNComponent::quantize(bool keep_float_weights) {
+    if (weights_matrix == 0) {
+      ERROR_EXIT1(128, "Component not built, impossible to quantize [%s]\n",
+                  name.c_str());
+    }
+    // weights are hidden_size x kernel_size, as a not transposed dot product
+    quantized_weights.reset( new QuantizedWeights(weights_matrix, false) );
+    if (!keep_float_weights) {
+      DecRef(weights_matrix);
+      weights_matrix = 0;
+    }
+  }
+
+  void ConvolutionANNComponent::dequantize() {
+    if (weights_matrix == 0 && !quantized_weights.empty()) {
+      ERROR_EXIT1(128, "Float weights were released, impossible to "
+                  "dequantize [%s]\n", name.c_str());
+    }
+    quantized_weights.reset();
+  }
+
   void ConvolutionANNComponent::copyWeights(AprilUtils::LuaTable &weights_dict) {
+    // quantized components without float weights have nothing to copy
+    if (weights_matrix == 0 && !quantized_weights.empty()) return;
     if (weights_matrix == 0)
       ERROR_EXIT1(100, "Component not built, impossible execute copyWeights [%s]\n",
 		  name.c_str());
@@ -25,6 +25,8 @@
 #include "cblas_headers.h"
 #include "matrix_component.h"
 #include "connection.h"
+#include "quantized_weights.h"
+#include "smart_ptr.h"
 
 namespace ANN {
 
@@ -34,6 +36,8 @@ namespace ANN {
     APRIL_DISALLOW_COPY_AND_ASSIGN(ConvolutionANNComponent);
     
     Basics::MatrixFloat *weights_matrix;
+    /// Int8 snapshot of weights_matrix, used by forward when not NULL
+    AprilUtils::SharedPtr<QuantizedWeights> quantized_weights;
     
     // parameters of the convolution
     
@@ -124,6 +128,17 @@ namespace ANN {
       n = input_num_dims;
       return kernel_dims + 1;
     }
+
+    /**
+     * @brief Switches the component to int8 quantized inference.
+     *
+     * @see DotProductANNComponent::quantize
+     */
+    void quantize(bool keep_float_weights = true);
+    /// Returns to float inference, releasing the int8 snapshot.
+    void dequantize();
+    bool isQuantized() const { return !quantized_weights.empty(); }
+    QuantizedWeights *getQuantizedWeights() { return quantized_weights.get(); }
     
   };
 }
@@ -63,8 +63,9 @@ namespace ANN {
     if (input_mat->getNumDim() < 2)
       ERROR_EXIT2(128, "At 2-dimensional matrix is expected, found %d. "
 		  "[%s]", input_mat->getNumDim(), name.c_str());
-    if (weights_matrix == 0) ERROR_EXIT1(129, "Not built component %s\n",
-                                         getName().c_str());
+    if (weights_matrix == 0 && quantized_weights.empty()) {
+      ERROR_EXIT1(129, "Not built component %s\n", getName().c_str());
+    }
     MatrixFloat *weights_mat = weights_matrix;
     unsigned int bunch_size  = input_mat->getDimSize(0);
     // new output to fit the bunch
@@ -75,7 +76,11 @@ namespace ANN {
 #ifdef USE_CUDA
     output_mat->setUseCuda(use_cuda);
 #endif
-    if (bunch_size == 1) {
+    if (!quantized_weights.empty()) {
+      // int8 inference, input is quantized on-the-fly
+      quantized_weights->forward(input_mat, output_mat);
+    }
+    else if (bunch_size == 1) {
       // vector x matrix product
       matGemv(output_mat,
               transpose_weights,
@@ -109,16 +114,27 @@ namespace ANN {
 #ifdef USE_CUDA
     output_mat->setUseCuda(use_cuda);
 #endif
-    matSparseMM(output_mat,
-                CblasNoTrans,
-                NEGATE_CBLAS_TRANSPOSE(transpose_weights),
-                1.0f, input_mat, weights_mat,
-                0.0f);
+    if (!quantized_weights.empty()) {
+      quantized_weights->sparseForward(input_mat, output_mat);
+    }
+    else {
+      if (weights_mat == 0) ERROR_EXIT1(129, "Not built component %s\n",
+                                        getName().c_str());
+      matSparseMM(output_mat,
+                  CblasNoTrans,
+                  NEGATE_CBLAS_TRANSPOSE(transpose_weights),
+                  1.0f, input_mat, weights_mat,
+                  0.0f);
+    }
     return output_mat;
   }
   
   MatrixFloat *DotProductANNComponent::
   privateDoDenseBackprop(MatrixFloat *error_input_mat) {
+    if (!quantized_weights.empty()) {
+      ERROR_EXIT1(128, "Quantized components are inference only [%s]\n",
+                  getName().c_str());
+    }
     // new error output to fit the bunch
     unsigned int bunch_size = error_input_mat->getDimSize(0);
     // new output to fit the bunch
@@ -161,17 +177,21 @@ namespace ANN {
   
   void DotProductANNComponent::privateDenseReset(unsigned int it) {
     UNUSED_VARIABLE(it);
-    weights_matrix->resetSharedCount();
+    if (weights_matrix != 0) weights_matrix->resetSharedCount();
   }
 
   void DotProductANNComponent::privateSparseReset(unsigned int it) {
     UNUSED_VARIABLE(it);
-    weights_matrix->resetSharedCount();
+    if (weights_matrix != 0) weights_matrix->resetSharedCount();
   }
 
   MatrixFloat *DotProductANNComponent::
   initializeComputeGradients(const char *name,
                              AprilUtils::LuaTable &grads_mat_dict) {
+    if (!quantized_weights.empty()) {
+      ERROR_EXIT1(128, "Quantized components are inference only [%s]\n",
+                  getName().c_str());
+    }
     weights_matrix->addToSharedCount();
     MatrixFloat *grads_mat = grads_mat_dict.opt<MatrixFloat*>(name, 0);
     if (grads_mat == 0) {
@@ -270,6 +290,7 @@ namespace ANN {
     // printf("%s :: %p %p\n", weights_name.c_str(), w, weights_matrix);
     if (w != 0) {
       // printf("COPY OF WEIGHTS FROM HASH %s\n", weights_name.c_str());
+      if (w != weights_matrix) quantized_weights.reset();
       AssignRef(weights_matrix, w);
       if (!Connections::checkInputOutputSizes(weights_matrix,
 					      weights_input_size,
@@ -281,6 +302,14 @@ namespace ANN {
 		    Connections::getOutputSize(weights_matrix),
                     getName().c_str());
     }
+    else if (weights_matrix == 0 && !quantized_weights.empty()) {
+      // quantized without float weights, nothing to be built
+      if (quantized_weights->getInputSize()  != static_cast<int>(getInputSize()) ||
+          quantized_weights->getOutputSize() != static_cast<int>(getOutputSize())) {
+        ERROR_EXIT1(256, "The quantized weights sizes are not correct [%s]\n",
+                    getName().c_str());
+      }
+    }
     else {
       if (weights_matrix == 0) {
 	// printf("NEW OF WEIGHTS %s\n", weights_name.c_str());
@@ -293,7 +322,30 @@ namespace ANN {
     }
   }
 
+  void DotProductANNComponent::quantize(bool keep_float_weights) {
+    if (weights_matrix == 0) {
+      ERROR_EXIT1(128, "Component not built, impossible to quantize [%s]\n",
+                  getName().c_str());
+    }
+    quantized_weights.reset( new QuantizedWeights(weights_matrix,
+                                                  transpose_weights == CblasTrans) );
+    if (!keep_float_weights) {
+      DecRef(weights_matrix);
+      weights_matrix = 0;
+    }
+  }
+
+  void DotProductANNComponent::dequantize() {
+    if (weights_matrix == 0 && !quantized_weights.empty()) {
+      ERROR_EXIT1(128, "Float weights were released, impossible to "
+                  "dequantize [%s]\n", getName().c_str());
+    }
+    quantized_weights.reset();
+  }
+
   void DotProductANNComponent::copyWeights(AprilUtils::LuaTable &weights_dict) {
+    // quantized components without float weights have nothing to copy
+    if (weights_matrix == 0 && !quantized_weights.empty()) return;
     if (weights_matrix == 0) {
       ERROR_EXIT1(100, "Component not built, impossible execute copyWeights [%s]\n",
 		  getName().c_str());
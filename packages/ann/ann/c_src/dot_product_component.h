@@ -26,6 +26,8 @@
 #include "cblas_headers.h"
 #include "matrix_input_switch_component.h"
 #include "connection.h"
+#include "quantized_weights.h"
+#include "smart_ptr.h"
 
 namespace ANN {
   
@@ -38,6 +40,9 @@ namespace ANN {
     
     /// learning parameters
     CBLAS_TRANSPOSE transpose_weights;
+
+    /// Int8 snapshot of weights_matrix, used by forward when not NULL
+    AprilUtils::SharedPtr<QuantizedWeights> quantized_weights;
     
   protected:
     
@@ -77,6 +82,23 @@ namespace ANN {
     virtual char *toLuaString();
     
     bool transposed() { return transpose_weights == CblasTrans; }
+
+    /**
+     * @brief Switches the component to int8 quantized inference.
+     *
+     * Takes an int8 snapshot of the current weights which is used by dense
+     * and sparse forward computations. Backprop and gradients computation are
+     * forbidden while the component is quantized.
+     *
+     * @param keep_float_weights - When false, the reference to the float
+     * weights is released, so the component only holds the int8 snapshot and
+     * it cannot be dequantized.
+     */
+    void quantize(bool keep_float_weights = true);
+    /// Returns to float inference, releasing the int8 snapshot.
+    void dequantize();
+    bool isQuantized() const { return !quantized_weights.empty(); }
+    QuantizedWeights *getQuantizedWeights() { return quantized_weights.get(); }
   };
 }
 
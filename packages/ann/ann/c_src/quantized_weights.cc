@@ -0,0 +1,112 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include "error_print.h"
+#include "int8_gemm.h"
+#include "quantized_weights.h"
+
+using namespace AprilMath;
+using namespace Basics;
+
+namespace ANN {
+  
+  QuantizedWeights::QuantizedWeights(const MatrixFloat *w, bool transposed) :
+    Referenced(),
+    output_size(w->getDimSize(transposed ? 1 : 0)),
+    input_size(w->getDimSize(transposed ? 0 : 1)),
+    weights(new int8_t[static_cast<size_t>(output_size)*input_size]),
+    scales(new float[output_size]) {
+    if (w->getNumDim() != 2) {
+      ERROR_EXIT(128, "Needs a 2-dimensional weights matrix\n");
+    }
+    const float *w_ptr = w->getRawDataAccess()->getPPALForRead() + w->getOffset();
+    // every output neuron is a row of the quantized matrix
+    const int row_stride = w->getStrideSize(transposed ? 1 : 0);
+    const int col_stride = w->getStrideSize(transposed ? 0 : 1);
+    int8QuantizeRows(output_size, input_size,
+                     w_ptr, row_stride, col_stride,
+                     weights.get(), input_size,
+                     scales.get());
+  }
+
+  void QuantizedWeights::forward(const MatrixFloat *input,
+                                 MatrixFloat *output) const {
+    if (input->getNumDim() != 2 || output->getNumDim() != 2) {
+      ERROR_EXIT(128, "Needs 2-dimensional input and output matrices\n");
+    }
+    const int bunch_size = input->getDimSize(0);
+    if (input->getDimSize(1) != input_size ||
+        output->getDimSize(0) != bunch_size ||
+        output->getDimSize(1) != output_size) {
+      ERROR_EXIT(128, "Incorrect input/output matrix sizes\n");
+    }
+    AprilUtils::UniquePtr<int8_t []> q_input(new int8_t[static_cast<size_t>(bunch_size)*input_size]);
+    AprilUtils::UniquePtr<float []> input_scales(new float[bunch_size]);
+    const float *input_ptr =
+      input->getRawDataAccess()->getPPALForRead() + input->getOffset();
+    int8QuantizeRows(bunch_size, input_size,
+                     input_ptr, input->getStrideSize(0), input->getStrideSize(1),
+                     q_input.get(), input_size,
+                     input_scales.get());
+    float *output_ptr =
+      output->getRawDataAccess()->getPPALForReadAndWrite() + output->getOffset();
+    int8Gemm(bunch_size, output_size, input_size,
+             1.0f,
+             q_input.get(), input_size, input_scales.get(),
+             weights.get(), input_size, scales.get(),
+             0.0f,
+             output_ptr, output->getStrideSize(0), output->getStrideSize(1));
+  }
+
+  void QuantizedWeights::sparseForward(const SparseMatrixFloat *input,
+                                       MatrixFloat *output) const {
+    if (output->getNumDim() != 2) {
+      ERROR_EXIT(128, "Needs a 2-dimensional output matrix\n");
+    }
+    const int bunch_size = input->getDimSize(0);
+    if (input->getDimSize(1) != input_size ||
+        output->getDimSize(0) != bunch_size ||
+        output->getDimSize(1) != output_size) {
+      ERROR_EXIT(128, "Incorrect input/output matrix sizes\n");
+    }
+    const int out_stride0 = output->getStrideSize(0);
+    const int out_stride1 = output->getStrideSize(1);
+    float *output_ptr =
+      output->getRawDataAccess()->getPPALForReadAndWrite() + output->getOffset();
+    for (int b=0; b<bunch_size; ++b) {
+      for (int o=0; o<output_size; ++o) output_ptr[b*out_stride0 + o*out_stride1] = 0.0f;
+    }
+    for (SparseMatrixFloat::const_iterator it(input->begin());
+         it != input->end(); ++it) {
+      int b, i;
+      it.getCoords(b, i);
+      const float v = *it;
+      const int8_t *w_col = weights.get() + i;
+      float *out_row = output_ptr + b*out_stride0;
+      for (int o=0; o<output_size; ++o) {
+        out_row[o*out_stride1] += v * w_col[static_cast<size_t>(o)*input_size];
+      }
+    }
+    for (int b=0; b<bunch_size; ++b) {
+      for (int o=0; o<output_size; ++o) output_ptr[b*out_stride0 + o*out_stride1] *= scales[o];
+    }
+  }
+  
+} // namespace ANN
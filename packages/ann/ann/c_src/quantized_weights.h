@@ -0,0 +1,92 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef QUANTIZED_WEIGHTS_H
+#define QUANTIZED_WEIGHTS_H
+
+#include <stdint.h>
+#include "disallow_class_methods.h"
+#include "matrixFloat.h"
+#include "sparse_matrixFloat.h"
+#include "referenced.h"
+#include "unique_ptr.h"
+
+namespace ANN {
+
+  /**
+   * @brief Int8 snapshot of a weights matrix for quantized inference.
+   *
+   * Weights are stored as an output x input row-major int8 matrix with one
+   * symmetric scale per output neuron (per-channel quantization), using 4 times
+   * less memory than the float weights. Inputs are quantized on-the-fly with
+   * one scale per bunch row and the product is computed by AprilMath::int8Gemm.
+   *
+   * @note The snapshot is not updated when the float weights change, it is
+   * intended for inference with already trained components.
+   */
+  class QuantizedWeights : public Referenced {
+    APRIL_DISALLOW_COPY_AND_ASSIGN(QuantizedWeights);
+
+    const int output_size, input_size;
+    AprilUtils::UniquePtr<int8_t []> weights;
+    AprilUtils::UniquePtr<float []> scales;
+    
+  public:
+    /**
+     * @param w - A weights matrix, output x input when not transposed, input x
+     * output otherwise.
+     * @param transposed - Indicates the layout of the given matrix.
+     */
+    QuantizedWeights(const Basics::MatrixFloat *w, bool transposed);
+    
+    /**
+     * @brief Computes \f$ Y = X W^T \f$ using int8 arithmetic.
+     *
+     * @param input - A bunch x input matrix, any strides are allowed.
+     * @param output - A bunch x output matrix where the result is stored.
+     */
+    void forward(const Basics::MatrixFloat *input,
+                 Basics::MatrixFloat *output) const;
+
+    /**
+     * @brief Computes \f$ Y = X W^T \f$ for a sparse input.
+     *
+     * The non-zero input values are kept in float precision and multiplied by
+     * the int8 weights, the per-neuron scales are applied at the end.
+     *
+     * @param input - A bunch x input sparse matrix.
+     * @param output - A bunch x output matrix where the result is stored.
+     */
+    void sparseForward(const Basics::SparseMatrixFloat *input,
+                       Basics::MatrixFloat *output) const;
+
+    int getInputSize() const { return input_size; }
+    int getOutputSize() const { return output_size; }
+    
+    /// Memory used by quantized weights and scales, in bytes.
+    size_t getMemorySize() const {
+      return ( static_cast<size_t>(output_size)*input_size*sizeof(int8_t) +
+               static_cast<size_t>(output_size)*sizeof(float) );
+    }
+  };
+  
+} // namespace ANN
+
+#endif // QUANTIZED_WEIGHTS_H
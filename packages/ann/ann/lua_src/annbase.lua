@@ -467,6 +467,69 @@ ann.load = april_doc{
     local c,_,_ = dofile(filename)
     return c
   end
+
+----------------------------------------------------------------------
+
+ann.components.quantized_clone = april_doc{
+  class="function",
+  summary="Clones a built component and quantizes it for int8 inference",
+  description={
+    "All dot_product and convolution components found in the clone",
+    "receive an int8 snapshot of its weights. By default the clone",
+    "releases its references to their float weights, so only the int8",
+    "weights (and the float ones of other components, as biases) are",
+    "kept once the given component is dropped. The clone is inference",
+    "only, any backprop or gradient computation will produce an error.",
+  },
+  params={
+    "A built ANN component",
+    "A boolean, keep_float_weights [optional], by default it is false",
+  },
+  outputs = { "A quantized clone in built-state" },
+} ..
+  function(c, keep_float_weights)
+    assert(c:get_is_built(), "Needs a built component")
+    local q = c:clone()
+    q:build{ weights = c:copy_weights(),
+             input = c:get_input_size(),
+             output = c:get_output_size() }
+    for _,comp in pairs(q:copy_components()) do
+      if comp.quantize then comp:quantize(keep_float_weights or false) end
+    end
+    return q
+  end
+
+ann.components.quantization_report = april_doc{
+  class="function",
+  summary="Compares the outputs of a float component and its quantized clone",
+  params={
+    "The float ANN component",
+    "The quantized ANN component",
+    "An input matrix (bunch_size x input_size)",
+  },
+  outputs = {
+    "A table with max_abs_diff, mean_abs_diff and argmax_agreement fields",
+  },
+} ..
+  function(c, q, input)
+    local out_f = c:forward(input):clone()
+    local out_q = q:forward(input):clone()
+    local diff  = out_f:clone():axpy(-1.0, out_q):abs()
+    local bunch_size = out_f:dim(1)
+    local out_f2 = out_f:rewrap(bunch_size, out_f:size()/bunch_size)
+    local out_q2 = out_q:rewrap(bunch_size, out_q:size()/bunch_size)
+    local _,arg_f = out_f2:max(2)
+    local _,arg_q = out_q2:max(2)
+    local agree = 0
+    for i=1,bunch_size do
+      if arg_f:get(i,1) == arg_q:get(i,1) then agree = agree + 1 end
+    end
+    return {
+      max_abs_diff     = diff:max(),
+      mean_abs_diff    = diff:sum() / diff:size(),
+      argmax_agreement = agree / bunch_size,
+    }
+  end
 ----------------------------------------------------------------------
 
 april_set_doc(ann.mlp,
@@ -765,6 +828,58 @@ april_set_doc(ann.connections.randomize_weights,
 		},
 	      })
 
+-------------------------------------------------------------------
+
+april_set_doc(ann.connections.flatten,
+	      {
+		class="function",
+		summary="Moves all weights of a dictionary to one flat matrix",
+		description=
+		  {
+		    "Weights are copied, sorted by name, into a flat matrix,",
+		    "and the dictionary is modified to contain views of it.",
+		    "Components built with the old matrices need to be rebuilt.",
+		  },
+		params={
+		  "A table weights_name=>matrix",
+		},
+		outputs={
+		  "The given table",
+		  "The flat matrix, nil if the table is empty",
+		},
+	      })
+
+april_set_doc(ann.connections.flat_like,
+	      {
+		class="function",
+		summary="Builds a dictionary of zeroed views of a flat matrix",
+		description=
+		  {
+		    "The returned dictionary has the same names and shapes as",
+		    "the given one, useful to allocate gradients.",
+		  },
+		params={
+		  "A table weights_name=>matrix",
+		},
+		outputs={
+		  "A new table weights_name=>matrix",
+		  "The flat matrix",
+		},
+	      })
+
+april_set_doc(ann.connections.get_flat,
+	      {
+		class="function",
+		summary="Returns the flat matrix of a flattened dictionary",
+		params={
+		  "A table weights_name=>matrix",
+		},
+		outputs={
+		  "The flat matrix, or nil if the weights are not consecutive",
+		  "views of the same memory block",
+		},
+	      })
+
 -------------------------------------------------------------------
 -------------------------------------------------------------------
 -------------------------------------------------------------------
@@ -1042,6 +1157,9 @@ april_set_doc(ann.components.base.."build",
 				 "the connections property of the",
 				 "component is assigned to table value.",
 				 "Otherwise, connections property is new reserved", },
+		  ["flat"] = {"A boolean [optional], if true all the weights",
+			      "are moved to views of one flat matrix, see",
+			      "ann.connections.flatten. By default it is false.", },
 		  
 		},
 		outputs= {
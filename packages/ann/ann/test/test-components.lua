@@ -744,6 +744,69 @@ T("DOTPRODUCT TEST",
 end
 )
 
+-------------------------
+-- QUANTIZED INFERENCE --
+-------------------------
+T("QUANTIZED DOTPRODUCT TEST",
+  function()
+    local net = ann.components.stack():
+      push( ann.components.dot_product{ input=20, output=10 } ):
+      push( ann.components.actf.relu() ):
+      push( ann.components.dot_product{ input=10, output=4 } )
+    net:build()
+    for _,w in pairs(net:copy_weights()) do w:uniformf(-0.5,0.5,rnd) end
+    local q = ann.components.quantized_clone(net)
+    local input = matrix(16, 20):uniformf(-1,1,rnd)
+    local report = ann.components.quantization_report(net, q, input)
+    check.lt(report.max_abs_diff, 0.05)
+    check.lt(report.mean_abs_diff, 0.02)
+    for _,comp in pairs(q:copy_components()) do
+      if comp.is_quantized then
+        check.TRUE(comp:is_quantized())
+        check.gt(comp:get_quantized_memory_size(), 0)
+      end
+    end
+    check.errored(function()
+        q:backprop(matrix(16, 4):zeros())
+    end)
+    -- the clone doesn't keep float weights
+    check.TRUE(next(q:copy_weights()) == nil)
+    -- original component keeps working in float mode
+    net:forward(input)
+    net:backprop(matrix(16, 4):zeros())
+    -- sparse inputs use the int8 weights too
+    local q2 = ann.components.quantized_clone(net, true)
+    check.TRUE(next(q2:copy_weights()) ~= nil)
+    local dense = matrix(4, 20):zeros()
+    dense:set(1,3, 0.5):set(2,7,-1.0):set(3,20,0.25):set(4,1,1.0)
+    local sparse = matrix.sparse(dense)
+    local dot = ann.components.dot_product{ input=20, output=10, weights="w" }
+    dot:build{ weights = { w = matrix(10, 20):uniformf(-0.5,0.5,rnd) } }
+    local out_f = dot:forward(dense):clone()
+    dot:quantize(false)
+    local out_s = dot:forward(sparse):clone()
+    check.lt(out_s:clone():axpy(-1.0, out_f):abs():max(), 0.01)
+    check.lt(out_s:clone():axpy(-1.0, dot:forward(dense)):abs():max(), 0.02)
+    check.errored(function() dot:dequantize() end)
+end)
+
+T("QUANTIZED CONVOLUTION TEST",
+  function()
+    local net = ann.components.stack():
+      push( ann.components.rewrap{ size={1,8,8} } ):
+      push( ann.components.convolution{ kernel={1,3,3}, n=4 } ):
+      push( ann.components.flatten() )
+    net:build{ input=64 }
+    for _,w in pairs(net:copy_weights()) do w:uniformf(-0.5,0.5,rnd) end
+    local q = ann.components.quantized_clone(net)
+    local input = matrix(8, 64):uniformf(-1,1,rnd)
+    local report = ann.components.quantization_report(net, q, input)
+    check.lt(report.max_abs_diff, 0.05)
+    check.errored(function()
+        q:backprop(matrix(8, 4*6*6):zeros())
+    end)
+end)
+
 -----------------------
 -- PROBMAT COMPONENT --
 -----------------------
@@ -11,3 +11,60 @@ T("AllAllGenerate", function()
     local net = generate("10 inputs 4 sparse_logistic{sparsity=0.1,penalty=3} 3 softmax")
     check.TRUE(net)
 end)
+
+T("FlatWeightsTest", function()
+    local w = { b = matrix(4):linspace(), a = matrix(2,3):linspace() }
+    local a,b = w.a,w.b
+    check.FALSE(ann.connections.get_flat(w))
+    local _,flat = ann.connections.flatten(w)
+    check.eq(flat:size(), 10)
+    -- weights are sorted by name
+    check.eq(flat, matrix.join(1, a:rewrap(6), b))
+    check.eq(w.a, a)
+    check.eq(w.b, b)
+    check.TRUE(w.a:data() == flat:data())
+    check.eq(w.b:offset(), 6)
+    check.eq(ann.connections.get_flat(w), flat)
+    -- views share the flat matrix memory
+    flat:fill(2)
+    check.eq(w.b, matrix(4):fill(2))
+    local g,gflat = ann.connections.flat_like(w)
+    check.eq(gflat, matrix(10):zeros())
+    check.TRUE(g.b:data() == gflat:data())
+    check.eq(g.a:dim(1), 2)
+    check.eq(g.a:dim(2), 3)
+    check.errored(function() ann.connections.flat_like({}) end)
+    -- components use the views after build
+    local net = ann.mlp.all_all.generate("4 inputs 3 tanh 2 linear")
+    local net2 = net:clone()
+    local _,weights = net:build{ flat = true }
+    local _,weights2 = net2:build()
+    local flat = ann.connections.get_flat(weights)
+    check.TRUE(flat)
+    check.eq(flat:size(), 4*3 + 3 + 3*2 + 2)
+    flat:linspace(-1,1)
+    for name,w in pairs(weights) do weights2[name]:copy(w) end
+    local x = matrix(2,4):linspace()
+    check.eq(net:forward(x), net2:forward(x))
+  end)
+
+T("BiasOffsetGradientsTest", function()
+    local rnd = random(1234)
+    local net = ann.mlp.all_all.generate("4 inputs 3 tanh 2 linear")
+    local net2 = net:clone()
+    local _,w = net:build()
+    for _,m in pairs(w) do m:uniformf(-1, 1, rnd) end
+    local _,w2 = net2:build{ flat = true,
+                             weights = matrix.dict.clone(w) }
+    local x = matrix(5,4):uniformf(-1,1,rnd)
+    local e = matrix(5,2):uniformf(-1,1,rnd)
+    local g = ann.connections.flat_like(w2)
+    for i,n in ipairs{ net, net2 } do
+      n:forward(x, true)
+      n:backprop(e)
+    end
+    local ga = net:compute_gradients()
+    local gb = net2:compute_gradients(g)
+    check.eq(net:forward(x), net2:forward(x))
+    for name,m in pairs(ga) do check.eq(gb[name], m) end
+  end)
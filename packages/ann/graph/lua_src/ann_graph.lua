@@ -528,6 +528,13 @@ ann_graph_methods.build = function(self, tbl, bptt_data)
                                 { weights = weights,
                                   input = input_sizes[nodes[input_name].out_edges[1]],
                                   output = sum_sizes(nodes[output_name].in_edges, output_sizes) })
+  if tbl.flat and next(weights) and not ann.connections.get_flat(weights) then
+    -- weights are moved to views of a flat matrix, and the graph is rebuilt
+    -- to use them
+    ann.connections.flatten(weights)
+    return self:build({ input = tbl.input, output = tbl.output,
+                        weights = weights }, bptt_data)
+  end
   return self,weights,components
 end
 
@@ -68,7 +68,8 @@ function AD.ann.logistic(a)
 				      ":div(1.0)" }
 			dest:write_expr_assign(self.var_name,
 					       table.concat(tbl, ""))
-		      end)
+		      end,
+		      { "logistic" })
   return s
 end
 
@@ -95,7 +96,8 @@ function AD.ann.tanh(a)
                                       "scalar_add(-1.0)", }
 			dest:write_expr_assign(self.var_name,
 					       table.concat(tbl, ""))
-		      end)
+		      end,
+		      { "logistic", "const", 2, "mul", "const", -1, "add" })
   return s  
 end
 
@@ -122,7 +124,8 @@ function AD.ann.log_logistic(a)
 				      ":log():scal(-1)" }
 			dest:write_expr_assign(self.var_name,
 					       table.concat(tbl, ""))
-		      end)
+		      end,
+		      { "log_logistic" })
   return s
 end
 
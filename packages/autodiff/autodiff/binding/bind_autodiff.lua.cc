@@ -0,0 +1,101 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+//BIND_HEADER_C
+#include "bind_matrix.h"
+//BIND_END
+
+//BIND_HEADER_H
+#include "fused_kernel.h"
+
+using namespace AutoDiff;
+//BIND_END
+
+//BIND_LUACLASSNAME FusedKernel autodiff.fused_kernel
+//BIND_CPP_CLASS    FusedKernel
+
+//BIND_CONSTRUCTOR FusedKernel
+{
+  LUABIND_CHECK_ARGN(>=,1);
+  LUABIND_CHECK_ARGN(<=,2);
+  LUABIND_CHECK_PARAMETER(1, table);
+  bool reuse_buffer;
+  LUABIND_GET_OPTIONAL_PARAMETER(2, bool, reuse_buffer, false);
+  int len;
+  LUABIND_TABLE_GETN(1, len);
+  AprilUtils::vector<FusedKernel::Instruction> code;
+  for (int i=1; i<=len; ++i) {
+    lua_rawgeti(L, 1, i);
+    if (!lua_isstring(L, -1)) {
+      LUABIND_FERROR1("Expected an opcode string at position %d", i);
+    }
+    const char *name = lua_tostring(L, -1);
+    FusedKernel::OpCode op = FusedKernel::getOpCode(name);
+    lua_pop(L, 1);
+    if (op == FusedKernel::NUM_OPCODES) {
+      LUABIND_FERROR2("Unknown opcode %s at position %d", name, i);
+    }
+    FusedKernel::Instruction inst(op);
+    if (op == FusedKernel::INPUT || op == FusedKernel::CONST) {
+      lua_rawgeti(L, 1, ++i);
+      if (!lua_isnumber(L, -1)) {
+        LUABIND_FERROR1("Expected a number at position %d", i);
+      }
+      if (op == FusedKernel::INPUT) inst.input = lua_toint(L, -1) - 1;
+      else inst.value = lua_tofloat(L, -1);
+      lua_pop(L, 1);
+    }
+    code.push_back(inst);
+  }
+  obj = new FusedKernel(code, reuse_buffer);
+  LUABIND_RETURN(FusedKernel, obj);
+}
+//BIND_END
+
+//BIND_METHOD FusedKernel run
+{
+  int argn = lua_gettop(L);
+  AprilUtils::vector<FusedKernel::Input> inputs(argn);
+  for (int i=1; i<=argn; ++i) {
+    if (lua_isMatrixFloat(L, i)) {
+      inputs[i-1].m = lua_toMatrixFloat(L, i);
+    }
+    else if (lua_isnumber(L, i)) {
+      inputs[i-1].value = lua_tofloat(L, i);
+    }
+    else {
+      LUABIND_FERROR1("Expected a matrix or a number at argument %d", i);
+    }
+  }
+  LUABIND_RETURN(MatrixFloat, obj->run(inputs));
+}
+//BIND_END
+
+//BIND_METHOD FusedKernel num_inputs
+{
+  LUABIND_RETURN(int, obj->getNumInputs());
+}
+//BIND_END
+
+//BIND_METHOD FusedKernel size
+{
+  LUABIND_RETURN(uint, obj->getNumInstructions());
+}
+//BIND_END
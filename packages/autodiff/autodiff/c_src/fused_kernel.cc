@@ -0,0 +1,255 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cstring>
+
+#include "cmath_overloads.h"
+#include "error_print.h"
+#include "fused_kernel.h"
+
+using Basics::MatrixFloat;
+using AprilUtils::SharedPtr;
+using AprilUtils::vector;
+
+namespace AutoDiff {
+
+  namespace {
+
+    const char *OPCODE_NAMES[FusedKernel::NUM_OPCODES] = {
+      "input", "const",
+      "neg", "exp", "log", "cos", "sin", "tanh", "abs", "sign", "logistic",
+      "log_logistic",
+      "add", "sub", "mul", "div", "pow", "lt", "gt",
+      "clamp",
+    };
+
+    /// Number of stack positions consumed by every opcode.
+    int getArity(FusedKernel::OpCode op) {
+      if (op < FusedKernel::NEG) return 0;
+      if (op < FusedKernel::ADD) return 1;
+      if (op < FusedKernel::CLAMP) return 2;
+      return 3;
+    }
+
+  } // anonymous namespace
+
+  FusedKernel::OpCode FusedKernel::getOpCode(const char *name) {
+    for (int i=0; i<NUM_OPCODES; ++i) {
+      if (strcmp(name, OPCODE_NAMES[i]) == 0) return static_cast<OpCode>(i);
+    }
+    return NUM_OPCODES;
+  }
+
+  FusedKernel::FusedKernel(const vector<Instruction> &code,
+                           bool reuse_buffer) :
+    Referenced(), code(code), num_inputs(0), max_depth(0),
+    reuse_buffer(reuse_buffer) {
+    int depth = 0;
+    for (unsigned int i=0; i<code.size(); ++i) {
+      const Instruction &inst = code[i];
+      if (inst.op < 0 || inst.op >= NUM_OPCODES) {
+        ERROR_EXIT1(128, "Incorrect opcode at instruction %u\n", i+1);
+      }
+      int arity = getArity(inst.op);
+      if (depth < arity) {
+        ERROR_EXIT1(128, "Stack underflow at instruction %u\n", i+1);
+      }
+      if (arity == 0) {
+        ++depth;
+        if (inst.op == INPUT) {
+          if (inst.input < 0) {
+            ERROR_EXIT1(128, "Incorrect input index at instruction %u\n", i+1);
+          }
+          if (inst.input >= num_inputs) num_inputs = inst.input + 1;
+        }
+      }
+      else depth -= arity - 1;
+      if (depth > max_depth) max_depth = depth;
+    }
+    if (depth != 1) {
+      ERROR_EXIT1(128, "The kernel leaves %d values in the stack, "
+                  "expected 1\n", depth);
+    }
+  }
+
+  FusedKernel::~FusedKernel() {
+  }
+
+  void FusedKernel::evalBlock(const float * const *in_ptrs,
+                              const vector<Input> &inputs,
+                              float *regs, int first, int n,
+                              float *dest) const {
+    float *top = regs - BLOCK_SIZE;
+    for (unsigned int pc=0; pc<code.size(); ++pc) {
+      const Instruction &inst = code[pc];
+      switch(inst.op) {
+      case INPUT:
+        top += BLOCK_SIZE;
+        if (in_ptrs[inst.input] != 0) {
+          memcpy(top, in_ptrs[inst.input] + first, n*sizeof(float));
+        }
+        else {
+          for (int i=0; i<n; ++i) top[i] = inputs[inst.input].value;
+        }
+        break;
+      case CONST:
+        top += BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] = inst.value;
+        break;
+      case NEG:
+        for (int i=0; i<n; ++i) top[i] = -top[i];
+        break;
+      case EXP:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_exp(top[i]);
+        break;
+      case LOG:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_log(top[i]);
+        break;
+      case COS:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_cos(top[i]);
+        break;
+      case SIN:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_sin(top[i]);
+        break;
+      case TANH:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_tanh(top[i]);
+        break;
+      case ABS:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_abs(top[i]);
+        break;
+      case SIGN:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_sign(top[i]);
+        break;
+      case LOGISTIC:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_logistic(top[i]);
+        break;
+      case LOG_LOGISTIC:
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_log_logistic(top[i]);
+        break;
+      case ADD: {
+        const float *b = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] += b[i];
+        break;
+      }
+      case SUB: {
+        const float *b = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] -= b[i];
+        break;
+      }
+      case MUL: {
+        const float *b = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] *= b[i];
+        break;
+      }
+      case DIV: {
+        const float *b = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] /= b[i];
+        break;
+      }
+      case POW: {
+        const float *b = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] = AprilMath::m_pow(top[i], b[i]);
+        break;
+      }
+      case LT: {
+        const float *b = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] = (top[i] < b[i]) ? 1.0f : 0.0f;
+        break;
+      }
+      case GT: {
+        const float *b = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) top[i] = (top[i] > b[i]) ? 1.0f : 0.0f;
+        break;
+      }
+      case CLAMP: {
+        const float *upper = top; top -= BLOCK_SIZE;
+        const float *lower = top; top -= BLOCK_SIZE;
+        for (int i=0; i<n; ++i) {
+          top[i] = AprilMath::m_clamp(top[i], lower[i], upper[i]);
+        }
+        break;
+      }
+      default:
+        ; // never happens, checked at the constructor
+      }
+    }
+    memcpy(dest + first, regs, n*sizeof(float));
+  }
+
+  MatrixFloat *FusedKernel::run(const vector<Input> &inputs) {
+    if (static_cast<int>(inputs.size()) < num_inputs) {
+      ERROR_EXIT2(128, "Incorrect number of inputs, expected %d, found %lu\n",
+                  num_inputs, static_cast<unsigned long>(inputs.size()));
+    }
+    // the first matrix gives the shape of the result
+    const MatrixFloat *shape = 0;
+    for (unsigned int i=0; i<inputs.size() && shape == 0; ++i) {
+      shape = inputs[i].m;
+    }
+    if (shape == 0) ERROR_EXIT(128, "Needs at least one matrix input\n");
+    const int size = shape->size();
+    // not contiguous inputs are copied, so every input is read linearly
+    vector< SharedPtr<MatrixFloat> > contiguous(inputs.size());
+    vector<const float*> in_ptrs(inputs.size(), 0);
+    for (unsigned int i=0; i<inputs.size(); ++i) {
+      MatrixFloat *m = inputs[i].m;
+      if (m == 0) continue;
+      // the result keeps the shape of the first input, all of them must agree
+      if (!m->sameDim(shape)) {
+        ERROR_EXIT1(128, "Incorrect shape at input %u, all the input "
+                    "matrices must have the same shape\n", i+1);
+      }
+      if (!m->getIsContiguous()) {
+        contiguous[i] = m->clone();
+        m = contiguous[i].get();
+      }
+      in_ptrs[i] = m->getRawDataAccess()->getPPALForRead() + m->getOffset();
+    }
+    MatrixFloat *result;
+    if (reuse_buffer && !buffer.empty() &&
+        buffer->sameDim(shape->getDimPtr(), shape->getNumDim())) {
+      result = buffer.get();
+    }
+    else {
+      result = new MatrixFloat(shape->getNumDim(), shape->getDimPtr());
+      if (reuse_buffer) buffer = result;
+    }
+    float *dest = result->getRawDataAccess()->getPPALForWrite() +
+      result->getOffset();
+    const int num_blocks = (size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    const float * const *in_ptrs_ptr = in_ptrs.begin();
+#ifndef NO_OMP
+#pragma omp parallel if(num_blocks > 16)
+#endif
+    {
+      vector<float> regs(max_depth * BLOCK_SIZE);
+#ifndef NO_OMP
+#pragma omp for schedule(static)
+#endif
+      for (int b=0; b<num_blocks; ++b) {
+        const int first = b*BLOCK_SIZE;
+        const int n = (first + BLOCK_SIZE <= size) ? BLOCK_SIZE : size - first;
+        evalBlock(in_ptrs_ptr, inputs, regs.begin(), first, n, dest);
+      }
+    }
+    return result;
+  }
+
+} // namespace AutoDiff
@@ -0,0 +1,105 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef FUSED_KERNEL_H
+#define FUSED_KERNEL_H
+
+#include "matrixFloat.h"
+#include "referenced.h"
+#include "smart_ptr.h"
+#include "vector.h"
+
+namespace AutoDiff {
+
+  /**
+   * @brief A chain of elementwise operations evaluated in one pass over its
+   * inputs.
+   *
+   * The kernel is a postfix program over a stack of registers. Every
+   * register holds a block of consecutive elements, so the interpretation
+   * cost is paid once per block and the intermediate results never leave
+   * the cache. Blocks are evaluated in parallel.
+   *
+   * Inputs are float matrices with the same number of elements, or numbers
+   * which are broadcasted to all the elements. The result has the shape of
+   * the first matrix input. When the kernel reuses its buffer, the result
+   * matrix is kept between calls and overwritten by the next one which has
+   * the same shape.
+   */
+  class FusedKernel : public Referenced {
+  public:
+    enum OpCode {
+      INPUT=0, CONST,
+      // unary operations
+      NEG, EXP, LOG, COS, SIN, TANH, ABS, SIGN, LOGISTIC, LOG_LOGISTIC,
+      // binary operations
+      ADD, SUB, MUL, DIV, POW, LT, GT,
+      // ternary operations
+      CLAMP,
+      NUM_OPCODES
+    };
+
+    struct Instruction {
+      OpCode op;
+      int input;   ///< 0-based input index for INPUT
+      float value; ///< Constant value for CONST
+      Instruction(OpCode op=CONST, int input=0, float value=0.0f) :
+        op(op), input(input), value(value) { }
+    };
+
+    /// An input value, a matrix or a number when the matrix is NULL.
+    struct Input {
+      Basics::MatrixFloat *m;
+      float value;
+      Input(Basics::MatrixFloat *m=0, float value=0.0f) :
+        m(m), value(value) { }
+    };
+
+    FusedKernel(const AprilUtils::vector<Instruction> &code,
+                bool reuse_buffer);
+    virtual ~FusedKernel();
+
+    /// Evaluates the kernel over the given inputs.
+    Basics::MatrixFloat *run(const AprilUtils::vector<Input> &inputs);
+
+    int getNumInputs() const { return num_inputs; }
+    int getStackDepth() const { return max_depth; }
+    unsigned int getNumInstructions() const { return code.size(); }
+
+    /// Returns the opcode of the given name, or NUM_OPCODES if unknown.
+    static OpCode getOpCode(const char *name);
+
+  private:
+    /// Number of elements in every register.
+    static const int BLOCK_SIZE = 256;
+
+    AprilUtils::vector<Instruction> code;
+    int num_inputs, max_depth;
+    bool reuse_buffer;
+    AprilUtils::SharedPtr<Basics::MatrixFloat> buffer;
+
+    void evalBlock(const float * const *in_ptrs,
+                   const AprilUtils::vector<Input> &inputs,
+                   float *regs, int first, int n, float *dest) const;
+  };
+
+} // namespace AutoDiff
+
+#endif // FUSED_KERNEL_H
@@ -29,7 +29,8 @@ autodiff.gen_var_name = gen_var_name
 ------------------------------------------------------------------------------
 
 -- COMPILER OUT: Lua CLASS, developed from scratch, not using APRIL-ANN
--- class. Allows to write the compilation output to a file
+-- class. Allows to write the compilation output to a file. The produced chunk
+-- receives as argument the table of fused kernels used by the program.
 
 local compiler_out = {}
 local compiler_out_mt = {}
@@ -40,8 +41,10 @@ setmetatable(compiler_out,
 	       __call = function(self,filename)
 		 local f = io.open(filename, "w") or error("Impossible to open: ".. filename)
 		 local obj = { f=f, indent=1, active_vars={}, cache_counts={},
-			       declared_expressions = {} }
+			       declared_expressions = {}, kernels = {},
+			       kernel_ids = {} }
 		 setmetatable(obj,compiler_out_mt)
+		 obj.f:write("local __kernels__ = ...\n")
 		 obj.f:write("return function(arg,cache)\n")
                  obj.f:write("  _ENV=setmetatable(cache,{__index=_G})\n")
 		 return obj
@@ -139,6 +142,19 @@ compiler_out_mt.__index = {
     self.f:write(string.format("%s = (%s)\n", var_name, expression))
     self.active_vars[var_name] = true
   end,
+  -- writes the call to a fused kernel, see plan_fusion() function
+  write_fused = function(self, var_name, fused)
+    if not self.kernel_ids[fused.kernel] then
+      table.insert(self.kernels, fused.kernel)
+      self.kernel_ids[fused.kernel] = #self.kernels
+    end
+    local inputs = iterator(ipairs(fused.inputs)):select(2):
+    map(function(v) return v.var_name end):concat(",")
+    self:write_expr_assign(var_name,
+                           string.format("__kernels__[%d]:run(%s)",
+                                         self.kernel_ids[fused.kernel],
+                                         inputs))
+  end,
   end_expression = function(self, var_name, parent_count, childs)
     assert(self.active_vars[var_name],
 	   "Declare expression vars before writing them")
@@ -415,9 +431,12 @@ end
 
 autodiff.coercion = coercion
 
--- this functions returns a new operation with the given data
+-- this functions returns a new operation with the given data. The optional
+-- elementwise argument is a table with the opcodes of autodiff.fused_kernel
+-- which compute the operation given its arguments in the kernel stack, it
+-- allows to fuse the operation with its elementwise neighbors at compilation
 function autodiff.gen_op(name, dtype, args,
-			 eval_func, diff_func, compile)
+			 eval_func, diff_func, compile, elementwise)
   local compile = compile or function() error("COMPILATION NOT IMPLEMENTED") end
   -- an operation is a symbol with the given type, and with a name which is a
   -- concatenation of its arguments
@@ -429,6 +448,8 @@ function autodiff.gen_op(name, dtype, args,
   s.isop = name
   -- the arguments of the operation
   s.args = args
+  -- kernel opcodes when the operation is elementwise
+  s.elementwise = elementwise
   --
   s.unmark = function(self)
     if self.visited then
@@ -472,11 +493,15 @@ function autodiff.gen_op(name, dtype, args,
     end
     if not dest:declared_expression(self.var_name) then
       dest:begin_expression(self.var_name, parent_count)
-      -- compiles the arguments list
-      iterator(self:arg_ipairs()):select(2):
-      call('compile',dest,dest:get_cache_count(self.var_name)):apply()
+      local fused = self.fused
+      -- compiles the arguments list, or the inputs of the fused kernel
+      local it = (fused and iterator(ipairs(fused.inputs))) or
+        iterator(self:arg_ipairs())
+      it:select(2):call('compile',dest,dest:get_cache_count(self.var_name)):apply()
       -- compiles the operation expression itself
-      compile(self, dest)
+      if fused then dest:write_fused(self.var_name, fused)
+      else compile(self, dest)
+      end
       dest:end_expression(self.var_name, parent_count, self.args)
     end
   end
@@ -531,14 +556,106 @@ function autodiff.symbol(names,dtype)
   return table.unpack(result)
 end
 
+-- Operations which can return a view of their first argument, so the values of
+-- their arguments can reach the user through the outputs of a compiled function
+local ALIAS_OPS = { ['T']=true, ['slice']=true, ['select']=true }
+
+-- Plans the fusion of elementwise operations for the compilation of the given
+-- list of output symbols. Every group of connected elementwise operations with
+-- at least two operations becomes an autodiff.fused_kernel, stored at the
+-- field fused of the group root, which is the only symbol of the group
+-- computed by the program. An operation is fused with its parent when it is
+-- not an output and it is only used by its parent, so fusion never repeats
+-- computations. Kernels keep their result matrix between evaluations, unless
+-- the result can reach the caller through the outputs. With fuse=false it only
+-- removes the plan of previous compilations.
+local function plan_fusion(outputs, fuse)
+  local consumers = {} -- number of uses of every symbol
+  local parents   = {} -- the parent of symbols with only one use
+  local exposed   = {} -- symbols whose value can be returned to the caller
+  local nodes     = {} -- all the symbols in post-order
+  local visited   = {}
+  local function traverse(v)
+    if not visited[v] then
+      visited[v] = true
+      v.fused = nil
+      for _,child in v:arg_ipairs() do
+        consumers[child] = (consumers[child] or 0) + 1
+        parents[child] = v
+        traverse(child)
+      end
+      table.insert(nodes, v)
+    end
+  end
+  local function expose(v)
+    if not exposed[v] then
+      exposed[v] = true
+      if ALIAS_OPS[v.isop] then
+        for _,child in v:arg_ipairs() do expose(child) end
+      end
+    end
+  end
+  for _,v in ipairs(outputs) do traverse(v) expose(v) end
+  if not fuse then return end
+  --
+  local function fusable(v)
+    if not v.isop or not v.elementwise or v.dtype ~= MATRIX then return false end
+    for _,child in v:arg_ipairs() do
+      local dtype = child.dtype
+      if dtype ~= MATRIX and dtype ~= SCALAR and dtype ~= CONSTANT then
+        return false
+      end
+    end
+    return true
+  end
+  local function absorbed(v)
+    return fusable(v) and consumers[v] == 1 and not exposed[v] and
+      fusable(parents[v])
+  end
+  -- builds the kernels from the roots of fusion groups
+  for i=#nodes,1,-1 do
+    local root = nodes[i]
+    if fusable(root) and not absorbed(root) then
+      local code,inputs,input_idx,num_ops = {},{},{},0
+      local function emit(v)
+        if v == root or absorbed(v) then
+          for _,child in v:arg_ipairs() do emit(child) end
+          for _,opcode in ipairs(v.elementwise) do table.insert(code, opcode) end
+          num_ops = num_ops + 1
+        elseif v.dtype == CONSTANT then
+          table.insert(code, "const")
+          table.insert(code, v:eval())
+        else
+          if not input_idx[v] then
+            table.insert(inputs, v)
+            input_idx[v] = #inputs
+          end
+          table.insert(code, "input")
+          table.insert(code, input_idx[v])
+        end
+      end
+      emit(root)
+      if num_ops > 1 then
+        root.fused = {
+          code   = code,
+          inputs = inputs,
+          kernel = autodiff.fused_kernel(code, not exposed[root]),
+        }
+      end
+    end
+  end
+end
+
 -- Function which compiles any number of symbols (in a table) into a
 -- multi-evaluated function. It receives an args table where the function
 -- arguments are stored in the expected order. The shared_values table stores
 -- pairs name,value which are shared between symbolic expressions and your Lua
 -- program. The resulting function will return as many values as the number of
--- symbols are given in s table.
-function autodiff.func(s, args, shared_values, optimize)
+-- symbols are given in s table. Elementwise operations are fused into native
+-- kernels unless fuse=false.
+function autodiff.func(s, args, shared_values, optimize, fuse)
   local optimize = (optimize==nil and true) or optimize
+  local fuse = (fuse==nil and true) or fuse
   assert(type(s) == "table")
   if s.issymbol then s = { s } end
   -- optimize all the given symbols
@@ -564,6 +681,7 @@ function autodiff.func(s, args, shared_values, optimize)
     symbols_dict[name] = true
   end
   -- COMPILATION PROCEDURE
+  plan_fusion(s, fuse)
   local filename = os.tmpname()
   local dest = compiler_out(filename)
   -- FIRST, traverse the symbols to acquire cache counts, which will be used to
@@ -601,7 +719,7 @@ function autodiff.func(s, args, shared_values, optimize)
   end
   dest:close()
   -- loading of the compiled program
-  local funcs = table.pack(dofile(filename))
+  local funcs = table.pack(assert(loadfile(filename))(dest.kernels))
   local f = io.open(filename, "r")
   local program = f:read("*a")
   f:close()
@@ -615,6 +733,7 @@ function autodiff.func(s, args, shared_values, optimize)
     outputs       = s,
     shared_values = shared_values,
     funcs         = funcs,
+    kernels       = dest.kernels,
     get_shared    = function(self) return self.shared_values end,
     set_shared    = function(self,new_shared_values)
       for name,w in pairs(new_shared_values) do
@@ -225,7 +225,8 @@ autodiff.op[MATRIX] = {
 		   local str_tbl = { a.var_name, '+', b.var_name }
 		   dest:write_expr_assign(self.var_name,
 					  table.concat(str_tbl, " "))
-		 end)
+		 end,
+		 { "add" })
     end
     if a.dims or b.dims then
       local a_dims,b_dims,dims = a.dims or {}, b.dims or {}, {}
@@ -352,7 +353,8 @@ autodiff.op[MATRIX] = {
 					 ':clone():pow(', b.var_name, ')' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "pow" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -380,7 +382,8 @@ autodiff.op[MATRIX] = {
 		       local str_tbl = { a.var_name, ':clone():log()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "log" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -403,7 +406,8 @@ autodiff.op[MATRIX] = {
 		       local str_tbl = { a.var_name, ':clone():exp()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "exp" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -425,7 +429,8 @@ autodiff.op[MATRIX] = {
 		       local str_tbl = { a.var_name, ':clone():cos()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "cos" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -447,7 +452,8 @@ autodiff.op[MATRIX] = {
 		       local str_tbl = { a.var_name, ':clone():sin()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "sin" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -469,7 +475,8 @@ autodiff.op[MATRIX] = {
 		       local str_tbl = { a.var_name, ':clone():tanh()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "tanh" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -506,11 +513,16 @@ autodiff.op[MATRIX] = {
 
   cmul = function(a,b)
     local a,b = coercion(a),coercion(b)
+    -- canonical order, so equivalent products share the same symbol
+    if b<a then a,b=b,a end
     -- simplification
-    if a.isop and a.isop=='fill' then
-      if     a.args[2] == autodiff[CONSTANT]( 1) then return  b
-      elseif a.args[2] == autodiff[CONSTANT](-1) then return -b
-      elseif a.args[2] == autodiff[CONSTANT]( 0) then return  a
+    for _,pair in ipairs{ {a,b}, {b,a} } do
+      local f,other = pair[1],pair[2]
+      if f.isop and f.isop=='fill' then
+        if     f.args[2] == autodiff[CONSTANT]( 1) then return  other
+        elseif f.args[2] == autodiff[CONSTANT](-1) then return -other
+        elseif f.args[2] == autodiff[CONSTANT]( 0) then return  f
+        end
       end
     end
     if a == autodiff[CONSTANT](0) or b == autodiff[CONSTANT](0) then
@@ -549,7 +561,8 @@ autodiff.op[MATRIX] = {
 		       end
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "mul" })
     if a.dims or b.dims then
       assert( check_dims(a.dims, b.dims),
 	      "Incorrect dimensions" )
@@ -576,7 +589,8 @@ autodiff.op[MATRIX] = {
 					 ':clone():lt(', b.var_name, '):to_float()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "lt" })
     if a.dims or b.dims then
       assert( check_dims(a.dims, b.dims),
 	      "Incorrect dimensions" )
@@ -603,7 +617,8 @@ autodiff.op[MATRIX] = {
 					 ':clone():gt(', b.var_name, '):to_float()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "gt" })
     if a.dims or b.dims then
       assert( check_dims(a.dims, b.dims),
 	      "Incorrect dimensions" )
@@ -881,7 +896,8 @@ end
 		       local str_tbl = { a.var_name, ':clone():sign()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "sign" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -904,7 +920,8 @@ end
 		       local str_tbl = { a.var_name, ':clone():abs()' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "abs" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,
@@ -1028,7 +1045,8 @@ end
                                          upper.var_name, ')' }
 		       dest:write_expr_assign(self.var_name,
 					      table.concat(str_tbl, ""))
-		     end)
+		     end,
+		     { "clamp" })
     if a.dims then s:set_dims(a.dims) end
     return s
   end,  
@@ -17,31 +17,31 @@ package{ name = "autodiff",
    target{
      name = "provide",
      depends = "init",
-   --   copy{ file= "c_src/*.h", dest_dir = "include" },
-   --   provide_bind{ file = "binding/bind_util.lua.cc" , dest_dir = "include" },
+     copy{ file= "c_src/*.h", dest_dir = "include" },
+     provide_bind{ file = "binding/bind_autodiff.lua.cc" , dest_dir = "include" },
+   },
+   target{
+     name = "test",
+     lua_unit_test{
+       file={
+	 "test/test-fusion.lua",
+       },
+     },
    },
-   -- target{
-   --   name = "test",
-   --   lua_unit_test{
-   --     file={
-   -- 	 "test/test-functional-programming.lua",
-   --     },
-   --   },
-   -- },
    target{
      name = "build",
      depends = "provide",
      use_timestamp = true,
-     -- object{ 
-     --   file = "c_src/*.cc",
-     --   dest_dir = "build",
-     --   --       flags = "-std=c99",
-     -- },
+     object{ 
+       file = "c_src/*.cc",
+       include_dirs = "${include_dirs}",
+       dest_dir = "build",
+     },
      luac{
        orig_dir = "lua_src",
        dest_dir = "build",
      },
-     -- build_bind{ file = "binding/bind_util.lua.cc", dest_dir = "build" },
+     build_bind{ file = "binding/bind_autodiff.lua.cc", dest_dir = "build" },
    },
    target{
      name = "document",
@@ -0,0 +1,58 @@
+-- Benchmark of fused versus not fused compilation of autodiff graphs. It
+-- evaluates the loss and gradients of a MLP with logistic and tanh hidden
+-- layers and cross-entropy loss, and a deep elementwise chain.
+local AD   = autodiff
+local op   = AD.op
+local M    = matrix
+local rnd  = random(1234)
+local reps = tonumber(arg[1] or 50)
+
+local function bench(name, f, ...)
+  f(...) -- warm up
+  local clock = util.stopwatch()
+  clock:go()
+  for i=1,reps do f(...) end
+  clock:stop()
+  local cpu,wall = clock:read()
+  printf("%-40s %10.3f ms/eval\n", name, wall/reps*1000)
+  return wall
+end
+
+local function compare(name, outputs, inputs, shared, ...)
+  local fused     = AD.func(outputs, inputs, shared)
+  local not_fused = AD.func(outputs, inputs, shared, true, false)
+  local t1 = bench(name .. " (not fused)", not_fused, ...)
+  local t2 = bench(string.format("%s (fused, %d kernels)",
+                                 name, #fused.kernels), fused, ...)
+  printf("%-40s %10.2fx\n", "speedup", t1/t2)
+end
+
+-- MLP 256 x 512 x 256 x 10, bunch of 128 samples
+AD.clear()
+do
+  local x,y,w1,b1,w2,b2,w3,b3 = AD.matrix('x y w1 b1 w2 b2 w3 b3')
+  local shared = {
+    w1 = M(512,256):uniformf(-0.1,0.1,rnd), b1 = M(512,1):zeros(),
+    w2 = M(256,512):uniformf(-0.1,0.1,rnd), b2 = M(256,1):zeros(),
+    w3 = M(10,256):uniformf(-0.1,0.1,rnd),  b3 = M(10,1):zeros(),
+  }
+  for _,b in ipairs{b1,b2,b3} do b:set_broadcast(false, true) end
+  local function logistic(s) return 1/(1 + op.exp(-s)) end
+  local h1 = logistic(b1 + w1 * x)
+  local h2 = op.tanh(b2 + w2 * h1)
+  local o  = logistic(b3 + w3 * h2)
+  local L  = -op.sum(op.cmul(y,op.log(o)) + op.cmul((1-y),op.log(1-o)))
+  L = L + 0.5 * 1e-04 * (op.sum(w1^2) + op.sum(w2^2) + op.sum(w3^2))
+  local tbl = table.pack( L, AD.diff(L, {w1, b1, w2, b2, w3, b3}) )
+  compare("MLP loss+gradients", tbl, {x,y}, shared,
+          M(256,128):uniformf(-1,1,rnd), M(10,128):uniformf(0,1,rnd))
+end
+
+-- elementwise chain over a 1000x1000 matrix
+AD.clear()
+do
+  local a,b = AD.matrix('a b')
+  local e = op.log(1 + op.exp(op.cmul(a,b) * 0.5)) + op.tanh(a)^2
+  compare("Elementwise chain", { e }, {a,b}, {},
+          M(1000,1000):uniformf(-1,1,rnd), M(1000,1000):uniformf(-1,1,rnd))
+end
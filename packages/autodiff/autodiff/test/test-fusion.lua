@@ -0,0 +1,75 @@
+local T = utest.test
+local check = utest.check
+--
+local AD   = autodiff
+local op   = AD.op
+local func = AD.func
+local M    = matrix
+
+T("FusedKernelTest", function()
+    local rnd = random(1234)
+    local a = M(50,30):uniformf(0.1,1,rnd)
+    local b = M(50,30):uniformf(0.1,1,rnd)
+    -- log(a .* b + 1)
+    local k = AD.fused_kernel{ "input", 1, "input", 2, "mul",
+                               "const", 1, "add", "log" }
+    check.eq(k:num_inputs(), 2)
+    check.eq(k:run(a, b), a:clone():cmul(b):scalar_add(1):log())
+    -- transposed (not contiguous) inputs and numbers are broadcasted
+    local k = AD.fused_kernel{ "input", 1, "input", 2, "add",
+                               "input", 3, "pow", "tanh" }
+    local bt = M(30,50):uniformf(0.1,1,rnd)
+    check.eq(k:run(a, bt:t(), 2),
+             (a + bt:t():clone()):pow(2):tanh())
+    check.eq(AD.fused_kernel{ "input", 1, "const", 0.5, "gt" }:run(a),
+             a:gt(0.5):to_float())
+    -- wrong programs and sizes
+    check.errored(function() return AD.fused_kernel{ "input", 1, "add" } end)
+    check.errored(function() return AD.fused_kernel{ "foo" } end)
+    check.errored(function() return k:run(a, M(3,3), 2) end)
+    check.errored(function() return k:run(a, bt, 2) end) -- same size
+    -- reused buffer
+    local k = AD.fused_kernel({ "input", 1, "exp", "const", 2, "mul" }, true)
+    local r1 = k:run(a)
+    local r2 = k:run(b)
+    check.eq(r2, b:clone():exp():scal(2))
+    check.eq(r1, r2) -- r1 was overwritten
+end)
+
+T("FusionTest", function()
+    AD.clear()
+    local rnd = random(4567)
+    local x,y,w1,b1,w2,b2 = AD.matrix('x y w1 b1 w2 b2')
+    local weights = {
+      w1 = M(10,8):uniformf(-0.5,0.5,rnd),
+      b1 = M(10,1):uniformf(-0.5,0.5,rnd),
+      w2 = M(3,10):uniformf(-0.5,0.5,rnd),
+      b2 = M(3,1):uniformf(-0.5,0.5,rnd),
+    }
+    b1:set_broadcast(false, true)
+    b2:set_broadcast(false, true)
+    local function logistic(s) return 1/(1 + op.exp(-s)) end
+    local h = op.tanh(b1 + w1 * x)
+    local o = logistic(b2 + w2 * h)
+    local L = -op.sum(op.cmul(y,op.log(o)) + op.cmul((1-y),op.log(1-o)))
+    L = L + 0.5 * 1e-03 * (op.sum(w1^2) + op.sum(w2^2))
+    local tbl = table.pack( L, o, AD.diff(L, {w1, b1, w2, b2}) )
+    local fused     = func(tbl, {x,y}, weights)
+    local not_fused = func(tbl, {x,y}, weights, true, false)
+    check.TRUE(#fused.kernels > 0)
+    check.eq(#not_fused.kernels, 0)
+    local input  = M(8,16):uniformf(-1,1,rnd)
+    local output = M(3,16):uniformf(0,1,rnd)
+    local r1 = table.pack( fused(input, output) )
+    local r2 = table.pack( not_fused(input, output) )
+    check.number_eq(r1[1], r2[1])
+    for i=2,#r2 do check.eq(r1[i], r2[i]) end
+    -- outputs are never overwritten by later evaluations
+    local o1 = r1[2]:clone()
+    local r3 = table.pack( fused(input:clone():scal(2), output) )
+    check.eq(r1[2], o1)
+    check.TRUE(not r3[2]:equals(o1))
+    -- the same product with its operands swapped is the same symbol
+    check.TRUE(op.cmul(x,y) == op.cmul(y,x))
+    AD.clear()
+end)
@@ -22,6 +22,7 @@
 //BIND_HEADER_C
 #include <cmath>
 #include "bind_function_interface.h"
+#include "bind_matrix_int32.h"
 #include "bind_mtrand.h"
 #include "bind_referenced_vector.h"
 #include "bind_tokens.h"
@@ -146,6 +147,7 @@ DataSetToken *lua_toAuxDataSetToken(lua_State *L, int n) {
 #include <cmath> // para sqrt en mean_deviation
 #include "bind_mtrand.h"
 #include "MersenneTwister.h"
+#include "chunked_dataset.h"
 #include "datasetToken.h"
 
 using namespace Basics;
@@ -1202,6 +1204,100 @@ LUABIND_ERROR("use constructor methods: matrix, etc.");
 
 //////////////////////////////////////////
 
+//BIND_LUACLASSNAME ChunkedFileDataSet dataset.chunked_file
+//BIND_CPP_CLASS    ChunkedFileDataSet
+//BIND_SUBCLASS_OF  ChunkedFileDataSet DataSetFloat
+
+//BIND_CONSTRUCTOR ChunkedFileDataSet
+//DOC_BEGIN
+// Opens a file written by dataset.chunked_file.write. Receives a table with
+// the path, and optionally the number of chunks kept in memory (cache_size)
+// and the number of chunks announced in advance to the kernel (readahead).
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  check_table_fields(L, 1, "path", "cache_size", "readahead",
+                     (const char *)0);
+  const char *path;
+  int cache_size, readahead;
+  LUABIND_GET_TABLE_PARAMETER(1, path, string, path);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, cache_size, int, cache_size,
+                                       ChunkedFileDataSet::DEFAULT_CACHE_CHUNKS);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, readahead, int, readahead,
+                                       ChunkedFileDataSet::DEFAULT_READAHEAD);
+  obj = new ChunkedFileDataSet(path, cache_size, readahead);
+  LUABIND_RETURN(ChunkedFileDataSet, obj);
+}
+//BIND_END
+
+//BIND_CLASS_METHOD ChunkedFileDataSet write
+//DOC_BEGIN
+// Writes a dataset into a chunked file. Receives a table with the path, the
+// dataset, and optionally the number of patterns by chunk (chunk_size) and
+// a compress flag which enables zlib compression of every chunk.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  check_table_fields(L, 1, "path", "dataset", "chunk_size", "compress",
+                     (const char *)0);
+  const char *path;
+  DataSetFloat *ds;
+  int chunk_size;
+  bool compress;
+  LUABIND_GET_TABLE_PARAMETER(1, path, string, path);
+  LUABIND_GET_TABLE_PARAMETER(1, dataset, DataSetFloat, ds);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, chunk_size, int, chunk_size,
+                                       ChunkedFileDataSet::DEFAULT_CHUNK_SIZE);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, compress, bool, compress, false);
+  ChunkedFileDataSet::write(path, ds, chunk_size, compress);
+}
+//BIND_END
+
+//BIND_METHOD ChunkedFileDataSet chunk_shuffle
+//DOC_BEGIN
+// Returns a MatrixInt32 with a permutation of the pattern indices (starting
+// at 1), where chunks are shuffled and patterns are shuffled inside windows
+// of consecutive chunks. The window size can not be larger than the cache.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(>=, 1);
+  LUABIND_CHECK_ARGN(<=, 2);
+  MTRand *random;
+  int window;
+  LUABIND_GET_PARAMETER(1, MTRand, random);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, int, window, 1);
+  int dims[1] = { obj->numPatterns() };
+  MatrixInt32 *perm = new MatrixInt32(1, dims);
+  int32_t *data = perm->getRawDataAccess()->getPPALForWrite();
+  obj->chunkShuffle(random, window, data);
+  for (int i=0; i<dims[0]; ++i) ++data[i];
+  LUABIND_RETURN(MatrixInt32, perm);
+}
+//BIND_END
+
+//BIND_METHOD ChunkedFileDataSet num_chunks
+{
+  LUABIND_RETURN(int, obj->getNumChunks());
+}
+//BIND_END
+
+//BIND_METHOD ChunkedFileDataSet chunk_size
+{
+  LUABIND_RETURN(int, obj->getChunkSize());
+}
+//BIND_END
+
+//BIND_METHOD ChunkedFileDataSet cache_stats
+{
+  LUABIND_RETURN(uint, obj->getCacheHits());
+  LUABIND_RETURN(uint, obj->getCacheMisses());
+}
+//BIND_END
+
+//////////////////////////////////////////
+
 //BIND_LUACLASSNAME DataSetToken dataset.token
 //BIND_CPP_CLASS    DataSetToken
 
@@ -1240,12 +1336,19 @@ LUABIND_ERROR("use constructor methods: matrix, etc.");
 {
   unsigned int bunch_size;
   int *indexes;
-  LUABIND_CHECK_ARGN(==,1);
+  // the optional second argument is a buffer which is filled and returned
+  // when it fits the bunch
+  AprilUtils::SharedPtr<Token> buffer;
+  LUABIND_CHECK_ARGN(>=,1);
+  LUABIND_CHECK_ARGN(<=,2);
   LUABIND_CHECK_PARAMETER(1, table);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, AuxToken, buffer, 0);
   LUABIND_TABLE_GETN(1,bunch_size);
   indexes = new int[bunch_size];
   LUABIND_TABLE_TO_VECTOR_SUB1(1,uint,indexes,bunch_size);
-  AprilUtils::SharedPtr<Token> token( obj->getPatternBunch(indexes,bunch_size) );
+  AprilUtils::SharedPtr<Token> token;
+  if (buffer.empty()) token = obj->getPatternBunch(indexes,bunch_size);
+  else token = obj->getPatternBunchInto(indexes,bunch_size,buffer.get());
   delete[] indexes;
   LUABIND_RETURN(AuxToken, token);
 }
@@ -1404,12 +1507,21 @@ LUABIND_ERROR("use constructor methods: matrix, etc.");
 
 //BIND_CONSTRUCTOR SparseMatrixDataSetToken
 {
-  LUABIND_CHECK_ARGN(==,1);
+  LUABIND_CHECK_ARGN(>=,1);
+  LUABIND_CHECK_ARGN(<=,2);
   LUABIND_CHECK_PARAMETER(1, SparseMatrixFloat);
   SparseMatrixFloat *sparse_matrix;
+  bool compress_indices;
   LUABIND_GET_PARAMETER(1, SparseMatrixFloat, sparse_matrix);
-  obj = new SparseMatrixDataSetToken(sparse_matrix);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, bool, compress_indices, false);
+  obj = new SparseMatrixDataSetToken(sparse_matrix, compress_indices);
   LUABIND_RETURN(SparseMatrixDataSetToken, obj);
 }
 //BIND_END
 
+//BIND_METHOD SparseMatrixDataSetToken are_indices_compressed
+{
+  LUABIND_RETURN(bool, obj->areIndicesCompressed());
+}
+//BIND_END
+
@@ -0,0 +1,276 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <zlib.h>
+}
+#include <cstdio>
+#include <cstring>
+#include "chunked_dataset.h"
+#include "error_print.h"
+#include "unused_variable.h"
+
+namespace Basics {
+
+  namespace {
+    const char CHUNKED_MAGIC[8] = { 'A','P','R','I','L','C','D','S' };
+    const uint32_t CHUNKED_VERSION = 1;
+    const uint32_t CHUNKED_ZLIB_FLAG = 1;
+
+    struct ChunkedFileHeader {
+      char magic[8];
+      uint32_t version, flags, pattern_size, chunk_size;
+      uint64_t num_patterns, index_offset;
+    };
+
+    void writeOrDie(FILE *f, const void *data, size_t sz, const char *path) {
+      if (sz > 0 && fwrite(data, 1, sz, f) != sz) {
+        ERROR_EXIT1(256, "Unable to write chunked dataset %s\n", path);
+      }
+    }
+
+    void preadOrDie(int fd, void *data, size_t sz, uint64_t offset) {
+      char *ptr = static_cast<char*>(data);
+      while (sz > 0) {
+        ssize_t n = pread(fd, ptr, sz, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) ERROR_EXIT(256, "Unable to read chunked dataset\n");
+        ptr += n;
+        sz -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+      }
+    }
+  }
+
+  void ChunkedFileDataSet::write(const char *path, DataSetFloat *ds,
+                                 int chunk_size, bool compress) {
+    if (chunk_size <= 0) ERROR_EXIT(128, "Chunk size must be > 0\n");
+    FILE *f = fopen(path, "wb");
+    if (f == 0) ERROR_EXIT1(256, "Unable to open %s\n", path);
+    const int num_patterns = ds->numPatterns();
+    const int pattern_size = ds->patternSize();
+    const int num_chunks = (num_patterns + chunk_size - 1) / chunk_size;
+    ChunkedFileHeader header;
+    memcpy(header.magic, CHUNKED_MAGIC, sizeof(CHUNKED_MAGIC));
+    header.version = CHUNKED_VERSION;
+    header.flags = compress ? CHUNKED_ZLIB_FLAG : 0;
+    header.pattern_size = static_cast<uint32_t>(pattern_size);
+    header.chunk_size = static_cast<uint32_t>(chunk_size);
+    header.num_patterns = static_cast<uint64_t>(num_patterns);
+    header.index_offset = 0;
+    // the header is written again when the index offset is known
+    writeOrDie(f, &header, sizeof(header), path);
+    AprilUtils::vector<uint64_t> offsets;
+    offsets.reserve(num_chunks + 1);
+    AprilUtils::vector<float> chunk(static_cast<size_t>(chunk_size)*pattern_size);
+    AprilUtils::vector<Bytef> zbuffer;
+    uint64_t offset = sizeof(header);
+    for (int c=0; c<num_chunks; ++c) {
+      const int first = c*chunk_size;
+      const int n = (num_patterns - first < chunk_size) ? num_patterns - first : chunk_size;
+      for (int i=0; i<n; ++i) {
+        ds->getPattern(first + i, chunk.begin() + static_cast<size_t>(i)*pattern_size);
+      }
+      const size_t raw_size = sizeof(float)*static_cast<size_t>(n)*pattern_size;
+      offsets.push_back(offset);
+      if (compress) {
+        uLongf zsize = compressBound(raw_size);
+        zbuffer.resize(zsize);
+        if (compress2(zbuffer.begin(), &zsize,
+                      reinterpret_cast<const Bytef*>(chunk.begin()),
+                      raw_size, Z_DEFAULT_COMPRESSION) != Z_OK) {
+          ERROR_EXIT1(256, "Unable to compress chunk %d\n", c);
+        }
+        writeOrDie(f, zbuffer.begin(), zsize, path);
+        offset += zsize;
+      }
+      else {
+        writeOrDie(f, chunk.begin(), raw_size, path);
+        offset += raw_size;
+      }
+    }
+    offsets.push_back(offset);
+    header.index_offset = offset;
+    writeOrDie(f, offsets.begin(), sizeof(uint64_t)*offsets.size(), path);
+    if (fseek(f, 0, SEEK_SET) != 0) {
+      ERROR_EXIT1(256, "Unable to write chunked dataset %s\n", path);
+    }
+    writeOrDie(f, &header, sizeof(header), path);
+    if (fclose(f) != 0) {
+      ERROR_EXIT1(256, "Unable to write chunked dataset %s\n", path);
+    }
+  }
+
+  ChunkedFileDataSet::ChunkedFileDataSet(const char *path, int cache_chunks,
+                                         int readahead) :
+    DataSetFloat(),
+    cache_chunks(cache_chunks), readahead(readahead),
+    tick(0), cache_hits(0), cache_misses(0) {
+    if (cache_chunks <= 0) ERROR_EXIT(128, "Cache size must be > 0\n");
+    if (readahead < 0) ERROR_EXIT(128, "Readahead must be >= 0\n");
+    fd = open(path, O_RDONLY);
+    if (fd < 0) ERROR_EXIT1(256, "Unable to open %s\n", path);
+    ChunkedFileHeader header;
+    preadOrDie(fd, &header, sizeof(header), 0);
+    if (memcmp(header.magic, CHUNKED_MAGIC, sizeof(CHUNKED_MAGIC)) != 0 ||
+        header.version != CHUNKED_VERSION) {
+      ERROR_EXIT1(256, "Incorrect chunked dataset file %s\n", path);
+    }
+    compressed   = (header.flags & CHUNKED_ZLIB_FLAG) != 0;
+    pattern_size = static_cast<int>(header.pattern_size);
+    chunk_size   = static_cast<int>(header.chunk_size);
+    num_patterns = static_cast<int>(header.num_patterns);
+    num_chunks   = (num_patterns + chunk_size - 1) / chunk_size;
+    chunk_offset.resize(num_chunks + 1);
+    preadOrDie(fd, chunk_offset.begin(), sizeof(uint64_t)*(num_chunks + 1),
+               header.index_offset);
+    if (this->cache_chunks > num_chunks) this->cache_chunks = num_chunks;
+    if (this->cache_chunks == 0) this->cache_chunks = 1;
+    cache_data.resize(static_cast<size_t>(this->cache_chunks) *
+                      chunk_size * pattern_size);
+    slot_chunk.resize(this->cache_chunks);
+    slot_tick.resize(this->cache_chunks);
+    for (int i=0; i<this->cache_chunks; ++i) {
+      slot_chunk[i] = -1;
+      slot_tick[i]  = 0;
+    }
+    chunk_slot.resize(num_chunks);
+    for (int c=0; c<num_chunks; ++c) chunk_slot[c] = -1;
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  }
+
+  ChunkedFileDataSet::~ChunkedFileDataSet() {
+    close(fd);
+  }
+
+  void ChunkedFileDataSet::readChunk(int chunk, float *dest) {
+    const uint64_t offset = chunk_offset[chunk];
+    const size_t stored_size =
+      static_cast<size_t>(chunk_offset[chunk + 1] - offset);
+    const size_t raw_size =
+      sizeof(float)*static_cast<size_t>(patternsAtChunk(chunk))*pattern_size;
+    if (compressed) {
+      io_buffer.resize(stored_size);
+      preadOrDie(fd, io_buffer.begin(), stored_size, offset);
+      uLongf dest_size = raw_size;
+      if (uncompress(reinterpret_cast<Bytef*>(dest), &dest_size,
+                     reinterpret_cast<const Bytef*>(io_buffer.begin()),
+                     stored_size) != Z_OK || dest_size != raw_size) {
+        ERROR_EXIT1(256, "Unable to uncompress chunk %d\n", chunk);
+      }
+    }
+    else {
+      if (stored_size != raw_size) {
+        ERROR_EXIT1(256, "Incorrect size of chunk %d\n", chunk);
+      }
+      preadOrDie(fd, dest, raw_size, offset);
+    }
+  }
+
+  void ChunkedFileDataSet::prefetch(int chunk) {
+#ifdef POSIX_FADV_WILLNEED
+    int pos = chunk_order.empty() ? chunk : chunk_order_pos[chunk];
+    for (int i=1; i<=readahead && pos+i<num_chunks; ++i) {
+      const int next = chunk_order.empty() ? pos+i : chunk_order[pos+i];
+      if (chunk_slot[next] < 0) {
+        posix_fadvise(fd, static_cast<off_t>(chunk_offset[next]),
+                      static_cast<off_t>(chunk_offset[next+1] - chunk_offset[next]),
+                      POSIX_FADV_WILLNEED);
+      }
+    }
+#else
+    UNUSED_VARIABLE(chunk);
+#endif
+  }
+
+  const float *ChunkedFileDataSet::getChunk(int chunk) {
+    int slot = chunk_slot[chunk];
+    if (slot >= 0) {
+      ++cache_hits;
+    }
+    else {
+      ++cache_misses;
+      // least recently used slot, empty slots have tick 0
+      slot = 0;
+      for (int i=1; i<cache_chunks; ++i) {
+        if (slot_tick[i] < slot_tick[slot]) slot = i;
+      }
+      if (slot_chunk[slot] >= 0) chunk_slot[slot_chunk[slot]] = -1;
+      slot_chunk[slot] = chunk;
+      chunk_slot[chunk] = slot;
+      readChunk(chunk, cache_data.begin() +
+                static_cast<size_t>(slot)*chunk_size*pattern_size);
+      prefetch(chunk);
+    }
+    slot_tick[slot] = ++tick;
+    return cache_data.begin() + static_cast<size_t>(slot)*chunk_size*pattern_size;
+  }
+
+  int ChunkedFileDataSet::getPattern(int index, float *pat) {
+    if (index < 0 || index >= num_patterns) {
+      ERROR_EXIT2(128, "Index %d out of bounds [0,%d)\n", index, num_patterns);
+    }
+    const int chunk = index / chunk_size;
+    const float *src = getChunk(chunk) +
+      static_cast<size_t>(index - chunk*chunk_size)*pattern_size;
+    memcpy(pat, src, sizeof(float)*pattern_size);
+    return pattern_size;
+  }
+
+  int ChunkedFileDataSet::putPattern(int index, const float *pat) {
+    UNUSED_VARIABLE(index);
+    UNUSED_VARIABLE(pat);
+    ERROR_EXIT(1,"Method putPattern forbidden for ChunkedFileDataSet!!!\n");
+    return 0;
+  }
+
+  void ChunkedFileDataSet::chunkShuffle(MTRand *random, int window, int *dest) {
+    if (window <= 0 || window > cache_chunks) {
+      ERROR_EXIT1(128, "Window size must be in range [1,%d]\n", cache_chunks);
+    }
+    chunk_order.resize(num_chunks);
+    chunk_order_pos.resize(num_chunks);
+    random->shuffle(num_chunks, chunk_order.begin());
+    for (int i=0; i<num_chunks; ++i) chunk_order_pos[chunk_order[i]] = i;
+    int k = 0;
+    for (int w=0; w<num_chunks; w+=window) {
+      const int begin = k;
+      for (int i=w; i<w+window && i<num_chunks; ++i) {
+        const int first = chunk_order[i]*chunk_size;
+        const int n = patternsAtChunk(chunk_order[i]);
+        for (int j=0; j<n; ++j) dest[k++] = first + j;
+      }
+      for (int i=k-1; i>begin; --i) {
+        const int j = begin + static_cast<int>(random->randInt(i - begin));
+        const int swap = dest[i];
+        dest[i] = dest[j];
+        dest[j] = swap;
+      }
+    }
+  }
+
+} // namespace Basics
@@ -0,0 +1,120 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef CHUNKED_DATASET_H
+#define CHUNKED_DATASET_H
+
+#include <stdint.h>
+#include "datasetFloat.h"
+#include "disallow_class_methods.h"
+#include "MersenneTwister.h"
+#include "vector.h"
+
+namespace Basics {
+
+  /**
+   * @brief A DataSetFloat which reads its patterns from a chunked file.
+   *
+   * The file stores consecutive groups of chunk_size patterns (chunks),
+   * every one of them optionally compressed with zlib, followed by an index
+   * with the file offset of every chunk. Chunks are read with pread() into
+   * an LRU cache of a given number of chunks, so memory usage is bounded
+   * independently of the dataset size.
+   *
+   * Every time a chunk is loaded, the next ones in the expected access order
+   * are announced to the kernel with posix_fadvise(), so their reads overlap
+   * with the computation. The expected order is sequential, unless it has
+   * been changed by chunkShuffle(), which produces a chunk-aware permutation
+   * of the patterns: chunks are shuffled, and patterns are shuffled inside
+   * windows of consecutive chunks of that order, keeping I/O sequential.
+   *
+   * Numbers are stored with the native byte order. The class is not
+   * thread-safe, as the rest of DataSet implementations.
+   */
+  class ChunkedFileDataSet : public DataSetFloat {
+    APRIL_DISALLOW_COPY_AND_ASSIGN(ChunkedFileDataSet);
+  public:
+    static const int DEFAULT_CHUNK_SIZE   = 1024;
+    static const int DEFAULT_CACHE_CHUNKS = 16;
+    static const int DEFAULT_READAHEAD    = 2;
+
+    /// Writes all the patterns of ds into a new chunked file.
+    static void write(const char *path, DataSetFloat *ds,
+                      int chunk_size=DEFAULT_CHUNK_SIZE, bool compress=false);
+
+    ChunkedFileDataSet(const char *path,
+                       int cache_chunks=DEFAULT_CACHE_CHUNKS,
+                       int readahead=DEFAULT_READAHEAD);
+    virtual ~ChunkedFileDataSet();
+    int numPatterns() { return num_patterns; }
+    int patternSize() { return pattern_size; }
+    int getPattern(int index, float *pat);
+    int putPattern(int index, const float *pat);
+
+    int getNumChunks() const { return num_chunks; }
+    int getChunkSize() const { return chunk_size; }
+    bool isCompressed() const { return compressed; }
+    unsigned int getCacheHits() const { return cache_hits; }
+    unsigned int getCacheMisses() const { return cache_misses; }
+
+    /**
+     * @brief Chunk-aware shuffle of the pattern indices.
+     *
+     * Writes into dest a permutation of [0,numPatterns()). The window size
+     * (in chunks) must not be larger than the cache, so every chunk is read
+     * once when the patterns are traversed in the given order. The chunk
+     * order becomes the readahead order.
+     */
+    void chunkShuffle(MTRand *random, int window, int *dest);
+
+  private:
+    int fd;
+    int num_patterns, pattern_size, chunk_size, num_chunks;
+    bool compressed;
+    /// File offset of every chunk, plus the offset of the index.
+    AprilUtils::vector<uint64_t> chunk_offset;
+    int cache_chunks, readahead;
+    /// Cached chunks, cache_chunks*chunk_size*pattern_size values.
+    AprilUtils::vector<float> cache_data;
+    /// Chunk stored at every cache slot, or -1.
+    AprilUtils::vector<int> slot_chunk;
+    /// Last access time of every cache slot.
+    AprilUtils::vector<uint64_t> slot_tick;
+    /// Cache slot of every chunk, or -1.
+    AprilUtils::vector<int> chunk_slot;
+    uint64_t tick;
+    unsigned int cache_hits, cache_misses;
+    /// Raw bytes of a compressed chunk.
+    AprilUtils::vector<char> io_buffer;
+    /// Readahead order of chunks and position of every chunk in it.
+    AprilUtils::vector<int> chunk_order, chunk_order_pos;
+
+    int patternsAtChunk(int chunk) const {
+      const int first = chunk*chunk_size;
+      return (num_patterns - first < chunk_size) ? num_patterns - first : chunk_size;
+    }
+    const float *getChunk(int chunk);
+    void readChunk(int chunk, float *dest);
+    void prefetch(int chunk);
+  };
+
+} // namespace Basics
+
+#endif // CHUNKED_DATASET_H
@@ -223,6 +223,23 @@ namespace Basics {
     return patternSize();
   }
 
+  template <typename T>
+  Matrix<T> *MatrixDataSet<T>::getContiguousBunch(int first,
+                                                  unsigned int bunch_size) {
+    const int last = first + static_cast<int>(bunch_size);
+    if (first < 0 || last > numPatternsv ||
+        last > matrix->getDimSize(0)) return 0;
+    if (offset[0] != 0 || step[0] != 1 || subMatrixSize[0] != 1) return 0;
+    for (int i=1; i<matrix->getNumDim(); ++i) {
+      if (offset[i] != 0 || numSteps[i] != 1 ||
+          subMatrixSize[i] != matrix->getDimSize(i)) return 0;
+    }
+    // the matrix is simple, so rows [first,last) are consecutive in memory
+    int dims[2] = { static_cast<int>(bunch_size), patternSizev };
+    return new Matrix<T>(2, dims, matrix->getRawDataAccess(),
+                         matrix->getOffset() + first*patternSizev);
+  }
+
   template <typename T>
   MatrixDataSet<T>::~MatrixDataSet(){
     delete[] offset;
@@ -58,6 +58,24 @@ namespace Basics {
     /// Put the given vector pat at pattern index. The function returns the
     /// patternSize().
     virtual int putPattern(int index, const T *pat)=0;
+    /// Get the patterns at the given indexes, storing them consecutively in
+    /// dest, which must have room for bunch_size*patternSize() values.
+    /// Subclasses could overwrite it to compute the bunch in parallel.
+    virtual void getPatternBunch(const int *indexes, unsigned int bunch_size,
+                                 T *dest) {
+      const int pattern_size = patternSize();
+      for (unsigned int i=0; i<bunch_size; ++i) {
+        getPattern(indexes[i], dest + i*pattern_size);
+      }
+    }
+    /// Returns a new bunch_size x patternSize() Matrix which shares memory
+    /// with the DataSet and contains patterns [first, first+bunch_size), or 0
+    /// when the DataSet cannot expose them without copying.
+    virtual Matrix<T> *getContiguousBunch(int first, unsigned int bunch_size) {
+      UNUSED_VARIABLE(first);
+      UNUSED_VARIABLE(bunch_size);
+      return 0;
+    }
   };
 
   /// DataSet specialization to put or get patterns from a Matrix object.
@@ -118,6 +136,9 @@ namespace Basics {
     int patternSize() { return patternSizev; }
     int getPattern(int index, T *pat);
     int putPattern(int index, const T *pat);
+    /// A view is only possible when every pattern is a whole row of the
+    /// underlying matrix (default configuration).
+    Matrix<T> *getContiguousBunch(int first, unsigned int bunch_size);
   };
 
   /// DataSet specialization to put or get patterns from a union of DataSets.
@@ -20,12 +20,15 @@
  *
  */
 
+#include <cstring>
+
 #include "dataset.h"
 #include "datasetFloat.h"
 #include "datasetToken.h"
 #include "function_interface.h"
 #include "matrixFloat.h"
 #include "matrix_ext.h"
+#include "maxmin.h"
 #include "smart_ptr.h"
 #include "token_base.h"
 #include "token_matrix.h"
@@ -172,12 +175,104 @@ namespace Basics {
     return result.weakRelease();
   }
   
-  Token *SparseMatrixDataSetToken::getPatternBunch(const int *indexes,
-                                                   unsigned int bunch_size) {
-    unsigned int nnz = 0;
-    const FloatGPUMirroredMemoryBlock *data_values = data->getRawValuesAccess();
-    const Int32GPUMirroredMemoryBlock *data_indices = data->getRawIndicesAccess();
-    const Int32GPUMirroredMemoryBlock *data_first_index = data->getRawFirstIndexAccess();
+  namespace {
+    /// A block which points to the first positions of a bigger buffer block,
+    /// keeping the buffer alive while the slice is referenced.
+    template<typename T>
+    class BufferSlice : public AprilMath::GPUMirroredMemoryBlock<T> {
+      SharedPtr< AprilMath::GPUMirroredMemoryBlock<T> > buffer;
+    public:
+      BufferSlice(AprilMath::GPUMirroredMemoryBlock<T> *buffer,
+                  unsigned int sz) :
+        AprilMath::GPUMirroredMemoryBlock<T>(sz, buffer->getPPALForWrite()),
+        buffer(buffer) { }
+    };
+
+    /// Returns a slice of sz positions of the given buffer. The buffer is
+    /// replaced by a new one when it is too small or when it cannot be
+    /// reused; in the latter case the old one remains alive thanks to the
+    /// slices which point to it.
+    template<typename T>
+    AprilMath::GPUMirroredMemoryBlock<T> *
+    getBufferSlice(SharedPtr< AprilMath::GPUMirroredMemoryBlock<T> > &buffer,
+                   unsigned int sz, bool reuse) {
+      if (!reuse || buffer.empty() || buffer->getSize() < sz) {
+        unsigned int capacity = sz;
+        if (reuse && !buffer.empty()) {
+          capacity = AprilUtils::max(sz, buffer->getSize()+buffer->getSize()/2);
+        }
+        buffer = new AprilMath::GPUMirroredMemoryBlock<T>(AprilUtils::max(capacity,
+                                                                          1u));
+      }
+      return new BufferSlice<T>(buffer.get(), sz);
+    }
+
+    /// Appends the given value as a varint, 7 bits per byte.
+    void pushVarint(vector<unsigned char> &dest, unsigned int v) {
+      while (v >= 0x80u) {
+        dest.push_back(static_cast<unsigned char>((v & 0x7Fu) | 0x80u));
+        v >>= 7;
+      }
+      dest.push_back(static_cast<unsigned char>(v));
+    }
+  }
+
+  SparseMatrixDataSetToken::SparseMatrixDataSetToken(SparseMatrixFloat *data,
+                                                     bool compress_indices) {
+    if (data->getSparseFormat() != CSR_FORMAT) {
+      ERROR_EXIT(128, "Only valid for CSR matrices\n");
+    }
+    num_rows    = data->getDimSize(0);
+    num_cols    = data->getDimSize(1);
+    values      = data->getRawValuesAccess();
+    indices     = data->getRawIndicesAccess();
+    first_index = data->getRawFirstIndexAccess();
+    if (compress_indices) compressIndices();
+  }
+
+  void SparseMatrixDataSetToken::compressIndices() {
+    const int *first_index_ptr = first_index->getPPALForRead();
+    const int *indices_ptr = indices->getPPALForRead();
+    packed_indices.reserve(indices->getSize());
+    packed_first.resize(num_rows + 1);
+    packed_first[0] = 0;
+    for (int i=0; i<num_rows; ++i) {
+      // CSR indices are sorted, so deltas are never negative
+      int prev = 0;
+      for (int j=first_index_ptr[i]; j<first_index_ptr[i+1]; ++j) {
+        pushVarint(packed_indices, static_cast<unsigned int>(indices_ptr[j]-prev));
+        prev = indices_ptr[j];
+      }
+      packed_first[i+1] = packed_indices.size();
+    }
+    indices.reset();
+  }
+
+  bool SparseMatrixDataSetToken::canReuseBuffers(Token *buffer) const {
+    if (last_values.empty()) return true;
+    if (last_values->getRef() == 1 && last_indices->getRef() == 1 &&
+        last_first_index->getRef() == 1) return true;
+    // the last bunch is alive, but the caller gives it back
+    if (buffer != 0 &&
+        buffer->getTokenCode() == table_of_token_codes::token_sparse_matrix) {
+      SparseMatrixFloat *mat =
+        buffer->convertTo<TokenSparseMatrixFloat*>()->getMatrix();
+      return ( mat->getRawValuesAccess() == last_values.get() &&
+               mat->getRawIndicesAccess() == last_indices.get() &&
+               mat->getRawFirstIndexAccess() == last_first_index.get() );
+    }
+    return false;
+  }
+
+  Token *SparseMatrixDataSetToken::getPatternBunchInto(const int *indexes,
+                                                       unsigned int bunch_size,
+                                                       Token *buffer) {
+    const int *data_first_index = first_index->getPPALForRead();
+    bool reuse = canReuseBuffers(buffer);
+    last_first_index = getBufferSlice(first_index_buffer, bunch_size + 1, reuse);
+    // prefix-sum of row sizes
+    int *bunch_first_index = last_first_index->getPPALForWrite();
+    bunch_first_index[0] = 0;
     for (unsigned int i=0; i<bunch_size; ++i) {
       const int p = indexes[i];
       if (p < 0 || p >= numPatterns()) {
@@ -185,31 +280,53 @@ namespace Basics {
                     "range [0,%d], found %d\n", numPatterns(), p);
         
       }
-      nnz += (*data_first_index)[p+1] - (*data_first_index)[p];
+      bunch_first_index[i+1] = bunch_first_index[i] +
+        data_first_index[p+1] - data_first_index[p];
     }
-    int dims[2] = { static_cast<int>(bunch_size), patternSize() };
-    // build a sparse matrix with nnz values in CSR format
-    SharedPtr< FloatGPUMirroredMemoryBlock >
-      values(new FloatGPUMirroredMemoryBlock(nnz));
-    SharedPtr< Int32GPUMirroredMemoryBlock >
-      indices(new Int32GPUMirroredMemoryBlock(nnz));
-    SharedPtr< Int32GPUMirroredMemoryBlock >
-      first_index(new Int32GPUMirroredMemoryBlock(bunch_size + 1));
-    (*first_index)[0] = 0;
-    size_t pos=0;
-    for (unsigned int i=0; i<bunch_size; ++i) {
-      int p = indexes[i];
-      unsigned int from = (*data_first_index)[p];
-      unsigned int sz = (*data_first_index)[p+1] - (*data_first_index)[p];
-      values->copyFromBlock(pos, data_values, from, sz);
-      indices->copyFromBlock(pos, data_indices, from, sz);
-      pos += sz;
-      (*first_index)[i+1] = pos;
+    const unsigned int nnz = static_cast<unsigned int>(bunch_first_index[bunch_size]);
+    last_values  = getBufferSlice(values_buffer, nnz, reuse);
+    last_indices = getBufferSlice(indices_buffer, nnz, reuse);
+    // concurrent copy of rows, every one to its own position
+    const float *data_values = values->getPPALForRead();
+    const int *data_indices = (indices.empty()) ? 0 : indices->getPPALForRead();
+    const size_t *packed_first_ptr = packed_first.begin();
+    float *bunch_values = last_values->getPPALForWrite();
+    int *bunch_indices = last_indices->getPPALForWrite();
+    const int n = static_cast<int>(bunch_size);
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(n > 1 && nnz > 65536u)
+#endif
+    for (int i=0; i<n; ++i) {
+      const int p    = indexes[i];
+      const int from = data_first_index[p];
+      const int sz   = data_first_index[p+1] - from;
+      const int pos  = bunch_first_index[i];
+      memcpy(bunch_values + pos, data_values + from, sz*sizeof(float));
+      if (data_indices != 0) {
+        memcpy(bunch_indices + pos, data_indices + from, sz*sizeof(int));
+      }
+      else {
+        // decoding of delta+varint indices
+        const unsigned char *it = packed_indices.begin() + packed_first_ptr[p];
+        int prev = 0;
+        for (int j=0; j<sz; ++j) {
+          unsigned int v = 0;
+          int shift = 0;
+          unsigned char c;
+          do {
+            c = *it++;
+            v |= static_cast<unsigned int>(c & 0x7Fu) << shift;
+            shift += 7;
+          } while (c & 0x80u);
+          prev += static_cast<int>(v);
+          bunch_indices[pos + j] = prev;
+        }
+      }
     }
-    SparseMatrixFloat *result = new SparseMatrixFloat(dims[0], dims[1],
-                                                      values.get(),
-                                                      indices.get(),
-                                                      first_index.get());
+    SparseMatrixFloat *result = new SparseMatrixFloat(n, patternSize(),
+                                                      last_values.get(),
+                                                      last_indices.get(),
+                                                      last_first_index.get());
     return new TokenSparseMatrixFloat(result);
   }
   
@@ -49,6 +49,16 @@ namespace Basics {
     virtual Token *getPattern(int index)=0;
     /// Get the pattern index to the vector pat
     virtual Token *getPatternBunch(const int *indexes,unsigned int bunch_size);
+    /// Get the pattern bunch reusing the given buffer token when possible.
+    /// The returned token could be the buffer itself, a new token, or a view
+    /// which shares memory with the dataset, so it must be taken as
+    /// read-only. By default the buffer is ignored.
+    virtual Token *getPatternBunchInto(const int *indexes,
+                                       unsigned int bunch_size,
+                                       Token *buffer) {
+      UNUSED_VARIABLE(buffer);
+      return getPatternBunch(indexes, bunch_size);
+    }
     /// Put the given vector pat at pattern index
     virtual void putPattern(int index, Token *pat)=0;
     /// Put the pattern bunch
@@ -158,6 +168,13 @@ namespace Basics {
   class DataSetFloat2TokenWrapper : public DataSetToken {
     AprilUtils::SharedPtr<MatrixFloat> aux_mat;
     AprilUtils::SharedPtr<DataSetFloat> ds;
+
+    static bool areContiguous(const int *indexes, unsigned int bunch_size) {
+      for (unsigned int i=1; i<bunch_size; ++i) {
+        if (indexes[i] != indexes[0] + static_cast<int>(i)) return false;
+      }
+      return bunch_size > 0;
+    }
   public:
     DataSetFloat2TokenWrapper(DataSetFloat *ds) :
       ds(ds) {
@@ -179,29 +196,52 @@ namespace Basics {
       ds->getPattern(index, mem_ptr);
       return token;
     }
+    /// Contiguous indexes over a matrix-backed dataset are returned as a
+    /// view of the underlying matrix, without copying.
     Token *getPatternBunch(const int *indexes, unsigned int bunch_size) {
-      int dims[2], major_dim=0;
-      dims[0] = static_cast<int>(bunch_size); dims[1] = patternSize();
-      MatrixFloat *mat = new MatrixFloat(2, dims);
-#ifdef USE_CUDA
-      bool old_use_cuda = mat->getCudaFlag();
-      mat->setUseCuda(false);
-#endif
-      // The TokenMatrixFloat takes increases reference counter of Matrix.
-      TokenMatrixFloat *token = new TokenMatrixFloat(mat);
-      // The memory block given to ds->getPattern(...).
-      AprilMath::FloatGPUMirroredMemoryBlock *aux_mem_block = aux_mat->getRawDataAccess();
-      float *aux_mem = aux_mem_block->getPPALForWrite();
-      // int pattern_size = patternSize();
+      return getPatternBunchInto(indexes, bunch_size, 0);
+    }
+    /// The buffer is filled when it is a contiguous bunch_size x
+    /// patternSize() matrix, otherwise a new matrix is allocated.
+    Token *getPatternBunchInto(const int *indexes, unsigned int bunch_size,
+                               Token *buffer) {
       int num_patterns = numPatterns();
-      dims[major_dim] = 1;
-      AprilUtils::SharedPtr<MatrixFloat> submat;
       for (unsigned int i=0; i<bunch_size; ++i) {
         april_assert(0 <= indexes[i] && indexes[i] < num_patterns);
-        ds->getPattern(indexes[i], aux_mem);
-        submat = mat->select(0, i, submat.get());
-        AprilMath::MatrixExt::BLAS::matCopy(submat.get(),aux_mat.get());
       }
+      UNUSED_VARIABLE(num_patterns);
+      if (areContiguous(indexes, bunch_size)) {
+        MatrixFloat *view = ds->getContiguousBunch(indexes[0], bunch_size);
+        if (view != 0) return new TokenMatrixFloat(view);
+      }
+      MatrixFloat *mat = 0;
+      Token *token = 0;
+      if (buffer != 0 &&
+          buffer->getTokenCode() == table_of_token_codes::token_matrix) {
+        MatrixFloat *buffer_mat =
+          buffer->convertTo<TokenMatrixFloat*>()->getMatrix();
+        if (buffer_mat->getNumDim() == 2 && buffer_mat->isSimple() &&
+            buffer_mat->getDimSize(0) == static_cast<int>(bunch_size) &&
+            buffer_mat->getDimSize(1) == patternSize()) {
+          mat = buffer_mat;
+          token = buffer;
+        }
+      }
+      if (mat == 0) {
+        int dims[2];
+        dims[0] = static_cast<int>(bunch_size); dims[1] = patternSize();
+        mat = new MatrixFloat(2, dims);
+        // The TokenMatrixFloat takes increases reference counter of Matrix.
+        token = new TokenMatrixFloat(mat);
+      }
+#ifdef USE_CUDA
+      bool old_use_cuda = mat->getCudaFlag();
+      mat->setUseCuda(false);
+#endif
+      // The matrix is contiguous, so patterns are written in place.
+      AprilMath::FloatGPUMirroredMemoryBlock *mem_block = mat->getRawDataAccess();
+      ds->getPatternBunch(indexes, bunch_size,
+                          mem_block->getPPALForWrite() + mat->getOffset());
 #ifdef USE_CUDA
       mat->setUseCuda(old_use_cuda);
 #endif
@@ -282,6 +322,13 @@ namespace Basics {
     virtual Token *getPatternBunch(const int *indexes,unsigned int bunch_size) {
       return filter->calculate(ds->getPatternBunch(indexes,bunch_size));
     }
+    /// The buffer is given to the underlying dataset.
+    virtual Token *getPatternBunchInto(const int *indexes,
+                                       unsigned int bunch_size,
+                                       Token *buffer) {
+      return filter->calculate(ds->getPatternBunchInto(indexes,bunch_size,
+                                                       buffer));
+    }
     /// Put the given vector pat at pattern index
     virtual void putPattern(int index, Token *pat) {
       UNUSED_VARIABLE(index);
@@ -298,29 +345,55 @@ namespace Basics {
     }
   };
 
+  /// DataSetToken which traverses the rows of a CSR SparseMatrixFloat.
+  /**
+     Bunches are assembled by a prefix-sum of row sizes followed by a parallel
+     copy of every row. The CSR blocks of the result are slices of internal
+     buffers, which are reused when the previous bunch is not referenced
+     anymore or when it is given back as buffer to getPatternBunchInto(). With
+     compress_indices=true the column indices are stored as delta+varint
+     bytes, and they are decoded while the bunch is assembled.
+  */
   class SparseMatrixDataSetToken : public DataSetToken {
-    AprilUtils::SharedPtr< SparseMatrixFloat > data;
+    int num_rows, num_cols;
+    AprilUtils::SharedPtr<AprilMath::FloatGPUMirroredMemoryBlock> values;
+    AprilUtils::SharedPtr<AprilMath::Int32GPUMirroredMemoryBlock> first_index;
+    /// Column indices, empty when they are compressed.
+    AprilUtils::SharedPtr<AprilMath::Int32GPUMirroredMemoryBlock> indices;
+    /// Delta+varint compressed column indices.
+    AprilUtils::vector<unsigned char> packed_indices;
+    /// Byte offset of every row in packed_indices, num_rows+1 values.
+    AprilUtils::vector<size_t> packed_first;
+    // buffers where bunches are assembled
+    AprilUtils::SharedPtr<AprilMath::FloatGPUMirroredMemoryBlock> values_buffer;
+    AprilUtils::SharedPtr<AprilMath::Int32GPUMirroredMemoryBlock> indices_buffer;
+    AprilUtils::SharedPtr<AprilMath::Int32GPUMirroredMemoryBlock> first_index_buffer;
+    // slices of the buffers used by the last returned bunch
+    AprilUtils::SharedPtr<AprilMath::FloatGPUMirroredMemoryBlock> last_values;
+    AprilUtils::SharedPtr<AprilMath::Int32GPUMirroredMemoryBlock> last_indices;
+    AprilUtils::SharedPtr<AprilMath::Int32GPUMirroredMemoryBlock> last_first_index;
+
+    void compressIndices();
+    bool canReuseBuffers(Token *buffer) const;
   public:
-    SparseMatrixDataSetToken(SparseMatrixFloat *data) : data(data) {
-      if (data->getSparseFormat() != CSR_FORMAT) {
-        ERROR_EXIT(128, "Only valid for CSR matrices\n");
-      }
-    }
+    SparseMatrixDataSetToken(SparseMatrixFloat *data,
+                             bool compress_indices=false);
     virtual ~SparseMatrixDataSetToken() { }
     virtual int numPatterns() {
-      return data->getDimSize(0);
+      return num_rows;
     }
     virtual int patternSize() {
-      return data->getDimSize(1);
+      return num_cols;
     }
     virtual Token *getPattern(int index) {
-      int coords[2] = { index, 0 };
-      int sizes[2] = {1, patternSize() };
-      SparseMatrixFloat *sparse_matrix;
-      sparse_matrix = new SparseMatrixFloat(data.get(), coords, sizes);
-      return new TokenSparseMatrixFloat(sparse_matrix);
+      return getPatternBunchInto(&index, 1, 0);
+    }
+    virtual Token *getPatternBunch(const int *indexes, unsigned int bunch_size) {
+      return getPatternBunchInto(indexes, bunch_size, 0);
     }
-    virtual Token *getPatternBunch(const int *indexes, unsigned int bunch_size);
+    virtual Token *getPatternBunchInto(const int *indexes,
+                                       unsigned int bunch_size,
+                                       Token *buffer);
     virtual void putPattern(int index, Token *pat) {
       UNUSED_VARIABLE(index);
       UNUSED_VARIABLE(pat);
@@ -333,6 +406,7 @@ namespace Basics {
       UNUSED_VARIABLE(pat);
       ERROR_EXIT(128, "Not implemented!!!\n");    
     }
+    bool areIndicesCompressed() const { return indices.empty(); }
   };
 
   namespace DataSetTokenUtils {
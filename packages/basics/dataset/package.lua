@@ -1,6 +1,7 @@
  package{ name = "dataset",
    version = "1.0",
    depends = { "util", "matrix", "random", "tokens", "functions" },
+   link_libraries = { "z" },
    keywords = { "dataset" },
    description = "no description available",
    -- targets como en ant
@@ -18,6 +19,8 @@
      lua_unit_test{
        file={
          "test/test.lua",
+         "test/test_chunked_dataset.lua",
+         "test/test_token_bunch.lua",
        },
      },
    },
@@ -0,0 +1,59 @@
+local check = utest.check
+local T = utest.test
+
+-- number of misses of an LRU cache of size chunks for the given sequence
+-- of 1-based pattern accesses
+local function lru_misses(accesses, chunk_size, size)
+  local last_use, misses = {}, 0
+  for t,i in ipairs(accesses) do
+    local c = math.floor((i-1) / chunk_size)
+    if not last_use[c] then
+      misses = misses + 1
+      local cached, lru = 0
+      for k,u in pairs(last_use) do
+        cached = cached + 1
+        if not lru or u < last_use[lru] then lru = k end
+      end
+      if cached == size then last_use[lru] = nil end
+    end
+    last_use[c] = t
+  end
+  return misses
+end
+
+T("ChunkedFileDataSet",
+  function()
+    local m = matrix(1003, 7):linspace()
+    local ds = dataset.matrix(m)
+    for _,compress in ipairs{ false, true } do
+      local path = os.tmpname()
+      dataset.chunked_file.write{ path=path, dataset=ds,
+                                  chunk_size=100, compress=compress }
+      local cds = dataset.chunked_file{ path=path, cache_size=4 }
+      check.eq( cds:numPatterns(), 1003 )
+      check.eq( cds:patternSize(), 7 )
+      check.eq( cds:num_chunks(), 11 )
+      local idx = { 1, 1003, 500, 999, 2 }
+      check.eq( dataset.token.wrapper(cds):getPatternBunch(idx),
+                m:index(1, matrixInt32(idx)) )
+      -- a shuffled pass reads every chunk once
+      local perm = cds:chunk_shuffle(random(5), 4)
+      local seen = {}
+      local accesses = iterator(ipairs(idx)):select(2):table()
+      for i=1,perm:size() do
+        local k = perm:get(i)
+        accesses[#accesses+1] = k
+        check.TRUE( not seen[k] )
+        seen[k] = true
+        check.eq( matrix(1, 7, cds:getPattern(k)), m:select(1, k):rewrap(1, 7) )
+      end
+      check.eq( perm:size(), 1003 )
+      local hits, misses = cds:cache_stats()
+      check.eq( hits + misses, #accesses )
+      check.eq( misses, lru_misses(accesses, 100, 4) )
+      -- the window fits in the cache, so every chunk is read at most once
+      -- by the shuffled pass
+      check.TRUE( misses <= #idx + 11 )
+      os.remove(path)
+    end
+end)
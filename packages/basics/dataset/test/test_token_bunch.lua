@@ -0,0 +1,80 @@
+local check = utest.check
+local T = utest.test
+
+T("DataSetTokenContiguousBunch",
+  function()
+    local m = matrix(20, 6):linspace()
+    local ds = dataset.token.wrapper(dataset.matrix(m))
+    local b = ds:getPatternBunch{ 5, 6, 7, 8 }
+    check.eq( b, m[{'5:8',':'}] )
+    -- contiguous bunches are views of the underlying matrix
+    m:set(6, 2, -1)
+    check.eq( b:get(2, 2), -1 )
+    -- sliding windows cannot be views, but the result is the same
+    local ds2 = dataset.token.wrapper(dataset.matrix(m, {
+                                                       patternSize = { 1, 3 },
+                                                       stepSize    = { 1, 3 },
+                                                       numSteps    = { 20, 2 },
+    }))
+    local b2 = ds2:getPatternBunch{ 1, 2, 3 }
+    check.eq( b2[{1,':'}], m[{1,'1:3'}] )
+    check.eq( b2[{2,':'}], m[{1,'4:6'}] )
+    check.eq( b2[{3,':'}], m[{2,'1:3'}] )
+end)
+
+T("DataSetTokenBunchBuffer",
+  function()
+    local m = matrix(20, 6):linspace()
+    local ds = dataset.token.wrapper(dataset.matrix(m))
+    local buffer = matrix(3, 6):zeros()
+    local idx = { 9, 2, 17 }
+    local b = ds:getPatternBunch(idx, buffer)
+    check.eq( b, m:index(1, matrixInt32(idx)) )
+    check.eq( buffer, b )
+    -- the buffer is overwritten by the next call
+    ds:getPatternBunch({ 1, 3, 5 }, buffer)
+    check.eq( buffer, m:index(1, matrixInt32{ 1, 3, 5 }) )
+    -- a buffer with a different shape is not used
+    local b2 = ds:getPatternBunch({ 4, 1 }, buffer)
+    check.eq( b2, m:index(1, matrixInt32{ 4, 1 }) )
+    check.eq( buffer, m:index(1, matrixInt32{ 1, 3, 5 }) )
+    -- iterators with reusable buffers produce the same bunches
+    local rnd1, rnd2 = random(1234), random(1234)
+    local it1 = trainable.dataset_multiple_iterator{
+      datasets = { dataset.matrix(m) }, bunch_size = 6, shuffle = rnd1,
+    }
+    local it2 = trainable.dataset_multiple_iterator{
+      datasets = { dataset.matrix(m) }, bunch_size = 6, shuffle = rnd2,
+      reuse_buffers = true,
+    }
+    for b1,idx1 in it1 do
+      local b2,idx2 = it2()
+      check.eq( b1, b2 )
+    end
+end)
+
+T("SparseMatrixDataSetTokenBunch",
+  function()
+    local rnd = random(4321)
+    local m = matrix(40, 300):uniformf(0, 1, rnd)
+    m:map(function(x) return x < 0.9 and 0 or x end)
+    local sm = matrix.sparse(m)
+    local ds  = dataset.token.sparse_matrix(sm)
+    local cds = dataset.token.sparse_matrix(sm, true)
+    check.FALSE( ds:are_indices_compressed() )
+    check.TRUE( cds:are_indices_compressed() )
+    local idx = { 7, 40, 1, 13, 13, 22 }
+    local expected = m:index(1, matrixInt32(idx))
+    check.eq( ds:getPatternBunch(idx):to_dense(), expected )
+    check.eq( cds:getPatternBunch(idx):to_dense(), expected )
+    check.eq( cds:getPattern(40):to_dense(), m[{40,':'}]:rewrap(1, 300) )
+    -- a living bunch is never overwritten
+    local b1 = cds:getPatternBunch{ 1, 2, 3 }
+    local b2 = cds:getPatternBunch{ 4, 5 }
+    check.eq( b1:to_dense(), m[{'1:3',':'}] )
+    check.eq( b2:to_dense(), m[{'4:5',':'}] )
+    -- a bunch given back as buffer is recycled
+    local b3 = cds:getPatternBunch({ 30, 31, 32, 33 }, b2)
+    check.eq( b3:to_dense(), m[{'30:33',':'}] )
+    check.eq( b1:to_dense(), m[{'1:3',':'}] )
+end)
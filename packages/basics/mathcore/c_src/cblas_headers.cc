@@ -19,6 +19,8 @@
  *
  */
 
+#include "maxmin.h"
+#include "omp_utils.h"
 #include "swap.h"
 #include "april_assert.h"
 #include "unused_variable.h"
@@ -152,6 +154,164 @@ void generic_cblas_axpyi(int NNZ, T alpha,
   }
 }
 
+// Minimum amount of work (number of non-zero values multiplied by the number
+// of dense columns) which makes worth to execute generic sparse kernels using
+// OMP.
+#define SPARSE_OMP_WORK_TH 16384
+// Width of the dense panels processed together with every sparse row or
+// column, it keeps the destination panel in cache while traversing the
+// non-zero values.
+#define SPARSE_PANEL_SIZE 256
+// Minimum width of dense panels when they are used to distribute the work
+// between threads.
+#define SPARSE_MIN_PANEL_SIZE 16
+
+// c = beta*c for a vector of size n
+template<typename T>
+inline void generic_sparse_scal(int n, T beta, T *c, int c_inc) {
+  if (beta == T()) {
+    for (int j=0; j<n; ++j, c+=c_inc) *c = T();
+  }
+  else {
+    for (int j=0; j<n; ++j, c+=c_inc) *c = (*c) * beta;
+  }
+}
+
+// c = c + alpha*b for vectors of size n, contiguous vectors are traversed in a
+// loop which allows compiler vectorization
+template<typename T>
+inline void generic_sparse_axpy(int n, T alpha,
+                                const T *b, int b_inc,
+                                T *c, int c_inc) {
+  if (b_inc == 1 && c_inc == 1) {
+    for (int j=0; j<n; ++j) c[j] = c[j] + alpha * b[j];
+  }
+  else {
+    for (int j=0; j<n; ++j, b+=b_inc, c+=c_inc) *c = *c + alpha * (*b);
+  }
+}
+
+// C = beta C + alpha A*B, where rows of A are compressed (CSR); every
+// destination row is independent, so rows are distributed between threads.
+template<typename T>
+void generic_cblas_sparse_mm_rows(int m, int n, int k,
+                                  T alpha,
+                                  const T *a_values_mem,
+                                  const int *a_indices_mem,
+                                  const int *a_first_index_mem,
+                                  const T *b_mem, const int *b_stride,
+                                  T beta, T *c_mem, const int *c_stride) {
+  UNUSED_VARIABLE(k);
+#ifndef NO_OMP
+  const int NNZ = a_first_index_mem[m] - a_first_index_mem[0];
+  const bool use_omp = ( OMPUtils::get_num_threads() > 1 &&
+                         m > 1 &&
+                         static_cast<long>(NNZ)*n > SPARSE_OMP_WORK_TH );
+#endif
+  if (b_stride[1] == 1 || b_stride[0] != 1) {
+    // B rows are contiguous: every non-zero value of A is multiplied by a
+    // dense panel of one B row and accumulated into a panel of C row
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic,16) if(use_omp)
+#endif
+    for (int dest_row=0; dest_row<m; ++dest_row) {
+      // dest_row are also A rows
+      const int first  = a_first_index_mem[dest_row];
+      const int lastp1 = a_first_index_mem[dest_row+1]; // last plus 1
+      for (int col=0; col<n; col+=SPARSE_PANEL_SIZE) {
+        const int panel = AprilUtils::min(n - col, SPARSE_PANEL_SIZE);
+        T *c_panel = c_mem + dest_row*c_stride[0] + col*c_stride[1];
+        generic_sparse_scal(panel, beta, c_panel, c_stride[1]);
+        // traverse one A row and accumulate the B rows panels
+        for (int x=first; x<lastp1; ++x) {
+          const int A_col = a_indices_mem[x];
+          april_assert(0 <= A_col && A_col < k);
+          generic_sparse_axpy(panel, alpha * a_values_mem[x],
+                              b_mem + A_col*b_stride[0] + col*b_stride[1],
+                              b_stride[1],
+                              c_panel, c_stride[1]);
+        }
+      }
+    } // for every destination row
+  }
+  else {
+    // B columns are contiguous: every destination value is a sparse dot
+    // product between one A row and one B column
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic,16) if(use_omp)
+#endif
+    for (int dest_row=0; dest_row<m; ++dest_row) {
+      const int first  = a_first_index_mem[dest_row];
+      const int lastp1 = a_first_index_mem[dest_row+1]; // last plus 1
+      int c_pos = dest_row*c_stride[0];
+      for (int dest_col=0; dest_col<n; ++dest_col, c_pos += c_stride[1]) {
+        const T *b_col = b_mem + dest_col*b_stride[1];
+        T aux = T();
+        for (int x=first; x<lastp1; ++x) {
+          const int A_col = a_indices_mem[x];
+          april_assert(0 <= A_col && A_col < k);
+          aux = aux + a_values_mem[x] * b_col[A_col];
+        }
+        if (beta == T()) c_mem[c_pos] = alpha * aux;
+        else c_mem[c_pos] = beta*c_mem[c_pos] + alpha*aux;
+      }
+    } // for every destination row
+  }
+}
+
+// C = beta C + alpha A*B, where columns of A are compressed (CSC); every
+// non-zero value updates one C row, so the work is distributed between
+// threads by C column panels, avoiding write conflicts.
+template<typename T>
+void generic_cblas_sparse_mm_cols(int m, int n, int k,
+                                  T alpha,
+                                  const T *a_values_mem,
+                                  const int *a_indices_mem,
+                                  const int *a_first_index_mem,
+                                  const T *b_mem, const int *b_stride,
+                                  T beta, T *c_mem, const int *c_stride) {
+  int panel_size = SPARSE_PANEL_SIZE;
+#ifndef NO_OMP
+  const int NNZ = a_first_index_mem[k] - a_first_index_mem[0];
+  const int num_threads = OMPUtils::get_num_threads();
+  const bool use_omp = ( num_threads > 1 &&
+                         n > SPARSE_MIN_PANEL_SIZE &&
+                         static_cast<long>(NNZ)*n > SPARSE_OMP_WORK_TH );
+  if (use_omp) {
+    panel_size = AprilUtils::max(SPARSE_MIN_PANEL_SIZE,
+                                 AprilUtils::min(SPARSE_PANEL_SIZE,
+                                                 (n + num_threads - 1)/num_threads));
+  }
+#endif
+  const int num_panels = (n + panel_size - 1) / panel_size;
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(use_omp)
+#endif
+  for (int p=0; p<num_panels; ++p) {
+    const int col   = p*panel_size;
+    const int panel = AprilUtils::min(n - col, panel_size);
+    // first C panel needs to be initialized
+    for (int i=0; i<m; ++i) {
+      generic_sparse_scal(panel, beta, c_mem + i*c_stride[0] + col*c_stride[1],
+                          c_stride[1]);
+    }
+    for (int A_col=0; A_col<k; ++A_col) {
+      const int first  = a_first_index_mem[A_col];
+      const int lastp1 = a_first_index_mem[A_col+1]; // last plus 1
+      const T *b_panel = b_mem + A_col*b_stride[0] + col*b_stride[1];
+      // for each destination row (sparse)
+      for (int x=first; x<lastp1; ++x) {
+        const int dest_row = a_indices_mem[x];
+        april_assert(0 <= dest_row && dest_row < m);
+        generic_sparse_axpy(panel, alpha * a_values_mem[x],
+                            b_panel, b_stride[1],
+                            c_mem + dest_row*c_stride[0] + col*c_stride[1],
+                            c_stride[1]);
+      }
+    }
+  } // for every C panel
+}
+
 // only works with row-major dense matrices
 template<typename T>
 void generic_cblas_sparse_mm(CBLAS_ORDER major_order,
@@ -166,7 +326,7 @@ void generic_cblas_sparse_mm(CBLAS_ORDER major_order,
                              const int *a_first_index_mem,
                              const T *b_mem, int b_inc,
                              T beta, T *c_mem, int c_inc) {
-  UNUSED_VARIABLE(k);
+  // transposition of A is equivalent to swap its sparse format
   if (a_transpose == CblasTrans) {
     if (sparse_format == CSR_FORMAT) sparse_format = CSC_FORMAT;
     else sparse_format = CSR_FORMAT;
@@ -180,59 +340,14 @@ void generic_cblas_sparse_mm(CBLAS_ORDER major_order,
        (c_transpose == CblasNoTrans && major_order == CblasColMajor) )
     swap(c_stride[0], c_stride[1]);
   if (sparse_format == CSR_FORMAT) {
-    // C = beta C + alpha A*B
-    for (int dest_row=0; dest_row<m; ++dest_row) {
-      // dest_row are also A rows
-      int first  = a_first_index_mem[dest_row];
-      int lastp1 = a_first_index_mem[dest_row+1]; // last plus 1
-      // position of the first column at dest_row
-      int c_pos  = dest_row*c_stride[0];
-      for (int dest_col=0; dest_col<n; ++dest_col, c_pos += c_stride[1]) {
-        T aux = T();
-        // traverse one A row and one B column
-        for (int x=first; x<lastp1; ++x) {
-          int A_col = a_indices_mem[x];
-          int b_pos = A_col*b_stride[0] + dest_col*b_stride[1];
-          april_assert(0 <= A_col && A_col < k);
-          aux = aux + a_values_mem[x] * b_mem[b_pos];
-        }
-        if (beta == T()) c_mem[c_pos] = alpha * aux;
-        else c_mem[c_pos] = beta*c_mem[c_pos] + alpha*aux;
-      }
-    }
+    generic_cblas_sparse_mm_rows(m, n, k, alpha,
+                                 a_values_mem, a_indices_mem, a_first_index_mem,
+                                 b_mem, b_stride, beta, c_mem, c_stride);
   }
   else if (sparse_format == CSC_FORMAT) {
-    // first C matrix needs to be initialized
-    if (beta == T()) {
-      for (int i=0; i<m; ++i) {
-        int c_pos  = i*c_stride[0];
-        for (int j=0; j<n; ++j, c_pos += c_stride[1]) {
-          c_mem[c_pos] = T();
-        }
-      }
-    }
-    else {
-      for (int i=0; i<m; ++i) {
-        int c_pos  = i*c_stride[0];
-        for (int j=0; j<n; ++j, c_pos += c_stride[1]) {
-          c_mem[c_pos] = c_mem[c_pos] * beta;
-        }
-      }
-    }
-    // C = beta C + alpha A*B
-    for (int dest_col=0; dest_col<n; ++dest_col) {
-      for (int A_col=0; A_col<k; ++A_col) {
-        int first  = a_first_index_mem[A_col];
-        int lastp1 = a_first_index_mem[A_col+1]; // last plus 1
-        // for each destination row (sparse)
-        for (int x=first; x<lastp1; ++x) {
-          int dest_row = a_indices_mem[x];
-          int b_pos = A_col*b_stride[0] + dest_col*b_stride[1];
-          int c_pos = dest_row*c_stride[0] + dest_col*c_stride[1];
-          c_mem[c_pos] = c_mem[c_pos] + alpha * a_values_mem[x] * b_mem[b_pos];
-        }
-      }
-    }
+    generic_cblas_sparse_mm_cols(m, n, k, alpha,
+                                 a_values_mem, a_indices_mem, a_first_index_mem,
+                                 b_mem, b_stride, beta, c_mem, c_stride);
   }
 }
 
@@ -252,7 +367,16 @@ void generic_cblas_sparse_mv(SPARSE_FORMAT sparse_format,
   }
   int y_size = (a_transpose==CblasNoTrans)?(m):(n);
   int x_size = (a_transpose==CblasNoTrans)?(n):(m);
+#ifndef NO_OMP
+  const int num_threads = OMPUtils::get_num_threads();
+#endif
   if (sparse_format == CSR_FORMAT) {
+#ifndef NO_OMP
+    const int NNZ = a_first_index_mem[y_size] - a_first_index_mem[0];
+    const bool use_omp = ( num_threads > 1 && y_size > 1 &&
+                           NNZ > SPARSE_OMP_WORK_TH );
+#pragma omp parallel for schedule(dynamic,64) if(use_omp)
+#endif
     for (int dest=0; dest<y_size; ++dest) {
       int first  = a_first_index_mem[dest];
       int lastp1 = a_first_index_mem[dest+1]; // last plus 1
@@ -269,19 +393,49 @@ void generic_cblas_sparse_mv(SPARSE_FORMAT sparse_format,
     }
   }
   else if (sparse_format == CSC_FORMAT) {
-    // first Y vector needs to be initialized
-    if (beta == T()) {
-      int y_pos=0;
-      for (int i=0; i<y_size; ++i, y_pos+=y_inc) {
-        y_mem[y_pos] = T();
-      }
-    }
-    else {
-      int y_pos=0;
-      for (int i=0; i<y_size; ++i, y_pos+=y_inc) {
-        y_mem[y_pos] = y_mem[y_pos] * beta;
+#ifndef NO_OMP
+    const int NNZ = a_first_index_mem[x_size] - a_first_index_mem[0];
+    if (num_threads > 1 && x_size > 1 && NNZ > SPARSE_OMP_WORK_TH) {
+      // every thread accumulates a subset of A columns into its own partial
+      // result, which are combined afterwards in thread order, so the result
+      // is deterministic for a given number of threads
+      T *partials = new T[static_cast<size_t>(num_threads)*y_size];
+      // the team can be smaller than requested, only its slices are summed
+      int num_partials = num_threads;
+#pragma omp parallel num_threads(num_threads)
+      {
+#pragma omp single
+        num_partials = omp_get_num_threads();
+        T *partial = partials + static_cast<size_t>(omp_get_thread_num())*y_size;
+        for (int i=0; i<y_size; ++i) partial[i] = T();
+#pragma omp for schedule(static)
+        for (int A_col=0; A_col<x_size; ++A_col) {
+          int first  = a_first_index_mem[A_col];
+          int lastp1 = a_first_index_mem[A_col+1]; // last plus 1
+          T x_value = alpha * x_mem[A_col*x_inc];
+          for (int x=first; x<lastp1; ++x) {
+            int dest  = a_indices_mem[x];
+            april_assert(0 <= dest && dest < y_size);
+            partial[dest] = partial[dest] + a_values_mem[x] * x_value;
+          }
+        }
+      } // omp parallel
+#pragma omp parallel for schedule(static)
+      for (int i=0; i<y_size; ++i) {
+        T aux = T();
+        for (int t=0; t<num_partials; ++t) {
+          aux = aux + partials[static_cast<size_t>(t)*y_size + i];
+        }
+        int y_pos = i*y_inc;
+        if (beta == T()) y_mem[y_pos] = aux;
+        else y_mem[y_pos] = beta*y_mem[y_pos] + aux;
       }
+      delete[] partials;
+      return;
     }
+#endif
+    // first Y vector needs to be initialized
+    generic_sparse_scal(y_size, beta, y_mem, y_inc);
     for (int A_col=0; A_col<x_size; ++A_col) {
       int first  = a_first_index_mem[A_col];
       int lastp1 = a_first_index_mem[A_col+1]; // last plus 1
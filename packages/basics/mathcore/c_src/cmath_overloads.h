@@ -724,6 +724,15 @@ namespace AprilMath {
       }
     };
 
+    /// Substraction map operation.
+    template<typename T>
+    struct m_sub {
+      /// Returns \f$ a-b \f$
+      APRIL_CUDA_EXPORT T operator()(const T &a, const T &b) const {
+        return a-b;
+      }
+    };
+
     /// Division map operation.
     template<typename T>
     struct m_div {
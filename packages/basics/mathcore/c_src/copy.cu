@@ -189,6 +189,14 @@ namespace AprilMath {
                              unsigned int,
                              bool);
 
+  template void doCopy<Half>(int, const GPUMirroredMemoryBlock<Half>*,
+                             unsigned int,
+                             unsigned int,
+                             GPUMirroredMemoryBlock<Half>*,
+                             unsigned int,
+                             unsigned int,
+                             bool);
+
   template void doCopy<float>(int, const GPUMirroredMemoryBlock<float>*,
                               unsigned int,
                               unsigned int,
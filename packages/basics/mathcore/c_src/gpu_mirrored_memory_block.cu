@@ -39,4 +39,5 @@ namespace AprilMath {
   template class GPUMirroredMemoryBlock<double>;
   template class GPUMirroredMemoryBlock<int32_t>;
   template class GPUMirroredMemoryBlock<ComplexF>;
+  template class GPUMirroredMemoryBlock<Half>;
 } // namespace AprilMath
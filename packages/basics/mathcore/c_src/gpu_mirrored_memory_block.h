@@ -39,6 +39,7 @@ extern "C" {
 #include "cmath_overloads.h"
 #include "referenced.h"
 #include "complex_number.h"
+#include "half_float.h"
 #include "unused_variable.h"
 #include <new>
 
@@ -809,6 +810,7 @@ namespace AprilMath {
   typedef GPUMirroredMemoryBlock<double>   DoubleGPUMirroredMemoryBlock;
   typedef GPUMirroredMemoryBlock<int32_t>  Int32GPUMirroredMemoryBlock;
   typedef GPUMirroredMemoryBlock<ComplexF> ComplexFGPUMirroredMemoryBlock;
+  typedef GPUMirroredMemoryBlock<Half>     HalfGPUMirroredMemoryBlock;
 
 } // namespace AprilMath
 
@@ -0,0 +1,63 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#include "half_float.h"
+
+namespace AprilMath {
+
+  void halfFromFloat(int N, const float *src, int src_stride,
+                     Half *dst, int dst_stride) {
+    int i = 0;
+#if defined(__F16C__)
+    if (src_stride == 1 && dst_stride == 1) {
+      for (; i+8<=N; i+=8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i),
+                                          _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+      }
+    }
+#endif
+    for (; i<N; ++i) {
+      dst[i*dst_stride].bits = floatToHalfBits(src[i*src_stride]);
+    }
+  }
+
+  void halfToFloat(int N, const Half *src, int src_stride,
+                   float *dst, int dst_stride) {
+    int i = 0;
+#if defined(__F16C__)
+    if (src_stride == 1 && dst_stride == 1) {
+      for (; i+8<=N; i+=8) {
+        const __m128i h =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+      }
+    }
+#endif
+    for (; i<N; ++i) {
+      dst[i*dst_stride] = halfBitsToFloat(src[i*src_stride].bits);
+    }
+  }
+  
+} // namespace AprilMath
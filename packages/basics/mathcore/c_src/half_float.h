@@ -0,0 +1,143 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef HALF_FLOAT_H
+#define HALF_FLOAT_H
+
+#include <cstring>
+#include <stdint.h>
+
+#ifndef __host__
+#define __host__
+#define UNDEF_HOST
+#endif
+#ifndef __device__
+#define __device__
+#define UNDEF_DEVICE
+#endif
+
+namespace AprilMath {
+
+  /// Converts a float into IEEE 754 binary16 bits, rounding to nearest even.
+  __host__ __device__ static inline uint16_t floatToHalfBits(float v) {
+    uint32_t x;
+    memcpy(&x, &v, sizeof(uint32_t));
+    const uint32_t sign = (x >> 16) & 0x8000u;
+    const uint32_t abs  = x & 0x7fffffffu;
+    if (abs >= 0x7f800000u) { // Inf or NaN (keeps NaN as quiet NaN)
+      return static_cast<uint16_t>(sign | 0x7c00u |
+                                   ((abs > 0x7f800000u) ? 0x200u : 0u));
+    }
+    if (abs >= 0x477ff000u) { // overflow, rounds to Inf
+      return static_cast<uint16_t>(sign | 0x7c00u);
+    }
+    if (abs < 0x38800000u) { // zero or subnormal half
+      if (abs < 0x33000000u) return static_cast<uint16_t>(sign);
+      const uint32_t e = abs >> 23;
+      const uint32_t m = (abs & 0x7fffffu) | 0x800000u;
+      const uint32_t shift = 126u - e;
+      uint32_t r = m >> shift;
+      const uint32_t rem  = m & ((1u << shift) - 1u);
+      const uint32_t half = 1u << (shift - 1u);
+      if (rem > half || (rem == half && (r & 1u))) ++r;
+      return static_cast<uint16_t>(sign | r);
+    }
+    // normal number, rebias exponent from 127 to 15 and round mantissa
+    uint32_t r = abs - 0x38000000u;
+    r = (r + 0xfffu + ((r >> 13) & 1u)) >> 13;
+    return static_cast<uint16_t>(sign | r);
+  }
+
+  /// Converts IEEE 754 binary16 bits into a float, the conversion is exact.
+  __host__ __device__ static inline float halfBitsToFloat(uint16_t h) {
+    const uint32_t sign = (static_cast<uint32_t>(h) & 0x8000u) << 16;
+    const uint32_t exp  = (h >> 10) & 0x1fu;
+    uint32_t mant = h & 0x3ffu;
+    uint32_t x;
+    if (exp == 0u) {
+      if (mant == 0u) x = sign;
+      else { // subnormal half, normalize it
+        uint32_t e = 113u;
+        while (!(mant & 0x400u)) { mant <<= 1; --e; }
+        x = sign | (e << 23) | ((mant & 0x3ffu) << 13);
+      }
+    }
+    else if (exp == 0x1fu) x = sign | 0x7f800000u | (mant << 13);
+    else x = sign | ((exp + 112u) << 23) | (mant << 13);
+    float v;
+    memcpy(&v, &x, sizeof(float));
+    return v;
+  }
+  
+  /**
+   * @brief A 16 bits floating point number (IEEE 754 binary16).
+   *
+   * This class is a storage type, it is intended to be used as template
+   * parameter of Basics::Matrix class to keep large weight matrices in half of
+   * the memory. Arithmetic is not defined for this type, values are implicitly
+   * promoted to float, operated in float precision and rounded back to half
+   * precision when stored.
+   *
+   * @note Half precision represents integers exactly up to 2048 and its
+   * largest finite value is 65504.
+   */
+  struct Half {
+    /// The binary16 representation.
+    uint16_t bits;
+    /// Default constructor, declares a +0 value.
+    __host__ __device__ Half() : bits(0) { }
+    /// Rounds the given float to the nearest half precision number.
+    __host__ __device__ Half(float v) : bits(floatToHalfBits(v)) { }
+    /// Returns a Half with the given binary16 representation.
+    __host__ __device__ static Half fromBits(uint16_t b) {
+      Half h; h.bits = b; return h;
+    }
+    /// Promotion to float, it is exact.
+    __host__ __device__ operator float() const {
+      return halfBitsToFloat(bits);
+    }
+  };
+
+  /**
+   * @brief Converts a float vector into half precision.
+   *
+   * Uses F16C instructions when the compiler enables them and both vectors are
+   * contiguous, otherwise it uses the portable scalar conversion.
+   */
+  void halfFromFloat(int N, const float *src, int src_stride,
+                     Half *dst, int dst_stride);
+  
+  /// Converts a half precision vector into float, it is the inverse of
+  /// halfFromFloat.
+  void halfToFloat(int N, const Half *src, int src_stride,
+                   float *dst, int dst_stride);
+  
+} // namespace AprilMath
+
+#ifdef UNDEF_HOST
+#undef __host__
+#undef UNDEF_HOST
+#endif
+#ifdef UNDEF_DEVICE
+#undef __device__
+#undef UNDEF_DEVICE
+#endif
+
+#endif // HALF_FLOAT_H
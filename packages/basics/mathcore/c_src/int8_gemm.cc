@@ -0,0 +1,189 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "clamp.h"
+#include "error_print.h"
+#include "int8_gemm.h"
+#include "maxmin.h"
+#include "omp_utils.h"
+
+// rows of A reduced against every tile of B rows
+#define INT8_GEMM_M_TILE 16
+// rows of B kept in cache while traversing a tile of A rows
+#define INT8_GEMM_N_TILE 64
+// minimum number of multiply-add operations to use OMP
+#define INT8_GEMM_OMP_TH 65536
+
+namespace AprilMath {
+
+  void int8QuantizeRows(int rows, int cols,
+                        const float *src, int src_row_stride, int src_col_stride,
+                        int8_t *dst, int dst_stride,
+                        float *scales) {
+#ifndef NO_OMP
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1 && rows*cols > INT8_GEMM_OMP_TH)
+#endif
+    for (int i=0; i<rows; ++i) {
+      const float *row = src + i*src_row_stride;
+      int8_t *q = dst + i*dst_stride;
+      float max_abs = 0.0f;
+      for (int j=0; j<cols; ++j) {
+        max_abs = AprilUtils::max(max_abs, fabsf(row[j*src_col_stride]));
+      }
+      if (max_abs > 0.0f) {
+        const float inv_scale = 127.0f / max_abs;
+        for (int j=0; j<cols; ++j) {
+          float v = roundf(row[j*src_col_stride] * inv_scale);
+          q[j] = static_cast<int8_t>(AprilUtils::clamp(v, -127.0f, 127.0f));
+        }
+        scales[i] = max_abs / 127.0f;
+      }
+      else {
+        for (int j=0; j<cols; ++j) q[j] = 0;
+        scales[i] = 0.0f;
+      }
+    }
+  }
+
+  /// int8 dot product with int32 accumulation.
+  static inline int32_t int8Dot(const int8_t *a, const int8_t *b, int K) {
+    int32_t acc = 0;
+    for (int k=0; k<K; ++k) {
+      acc += static_cast<int32_t>(a[k]) * static_cast<int32_t>(b[k]);
+    }
+    return acc;
+  }
+
+#if defined(__AVX2__)
+  /// Multiplies 32 int8 pairs and adds them in groups of four into eight
+  /// int32 lanes. maddubs needs an unsigned operand, so the sign of a is
+  /// moved into b; since values are clamped to [-127,127] the int16 pair
+  /// sums never saturate.
+  static inline __m256i int8MulAdd(__m256i acc, __m256i a, __m256i b,
+                                   __m256i ones) {
+    const __m256i abs_a = _mm256_sign_epi8(a, a);
+    const __m256i sgn_b = _mm256_sign_epi8(b, a);
+    const __m256i pairs = _mm256_maddubs_epi16(abs_a, sgn_b);
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+  }
+
+  static inline int32_t int8HorizontalSum(__m256i v) {
+    __m128i x = _mm_add_epi32(_mm256_castsi256_si128(v),
+                              _mm256_extracti128_si256(v, 1));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1,0,3,2)));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2,3,0,1)));
+    return _mm_cvtsi128_si32(x);
+  }
+#endif
+
+  /// Four int8 dot products sharing the same row of A, every load of A is
+  /// reused four times.
+  static inline void int8Dot4(const int8_t *a,
+                              const int8_t *b0, const int8_t *b1,
+                              const int8_t *b2, const int8_t *b3,
+                              int K, int32_t *acc) {
+    int32_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+    int k = 0;
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i v0 = _mm256_setzero_si256(), v1 = _mm256_setzero_si256();
+    __m256i v2 = _mm256_setzero_si256(), v3 = _mm256_setzero_si256();
+    for (; k+32<=K; k+=32) {
+      const __m256i ak = _mm256_loadu_si256((const __m256i*)(a + k));
+      v0 = int8MulAdd(v0, ak, _mm256_loadu_si256((const __m256i*)(b0 + k)), ones);
+      v1 = int8MulAdd(v1, ak, _mm256_loadu_si256((const __m256i*)(b1 + k)), ones);
+      v2 = int8MulAdd(v2, ak, _mm256_loadu_si256((const __m256i*)(b2 + k)), ones);
+      v3 = int8MulAdd(v3, ak, _mm256_loadu_si256((const __m256i*)(b3 + k)), ones);
+    }
+    acc0 = int8HorizontalSum(v0);
+    acc1 = int8HorizontalSum(v1);
+    acc2 = int8HorizontalSum(v2);
+    acc3 = int8HorizontalSum(v3);
+#endif
+    for (; k<K; ++k) {
+      const int32_t ak = static_cast<int32_t>(a[k]);
+      acc0 += ak * static_cast<int32_t>(b0[k]);
+      acc1 += ak * static_cast<int32_t>(b1[k]);
+      acc2 += ak * static_cast<int32_t>(b2[k]);
+      acc3 += ak * static_cast<int32_t>(b3[k]);
+    }
+    acc[0] = acc0; acc[1] = acc1; acc[2] = acc2; acc[3] = acc3;
+  }
+  
+  void int8Gemm(int M, int N, int K,
+                float alpha,
+                const int8_t *A, int lda, const float *a_scales,
+                const int8_t *B, int ldb, const float *b_scales,
+                float beta,
+                float *C, int c_row_stride, int c_col_stride) {
+    if (K >= (1<<17)) {
+      ERROR_EXIT1(128, "Too large K dimension for int8 GEMM, found %d\n", K);
+    }
+    const int num_m_tiles = (M + INT8_GEMM_M_TILE - 1) / INT8_GEMM_M_TILE;
+    const int num_n_tiles = (N + INT8_GEMM_N_TILE - 1) / INT8_GEMM_N_TILE;
+    const int num_tiles = num_m_tiles * num_n_tiles;
+#ifndef NO_OMP
+    const bool use_omp = ( OMPUtils::get_num_threads() > 1 && num_tiles > 1 &&
+                           static_cast<long>(M)*N*K > INT8_GEMM_OMP_TH );
+#pragma omp parallel for schedule(static) if(use_omp)
+#endif
+    for (int t=0; t<num_tiles; ++t) {
+      const int m0 = (t / num_n_tiles) * INT8_GEMM_M_TILE;
+      const int n0 = (t % num_n_tiles) * INT8_GEMM_N_TILE;
+      const int m1 = AprilUtils::min(M, m0 + INT8_GEMM_M_TILE);
+      const int n1 = AprilUtils::min(N, n0 + INT8_GEMM_N_TILE);
+      for (int i=m0; i<m1; ++i) {
+        const int8_t *a_row = A + i*lda;
+        const float a_scale = alpha * a_scales[i];
+        float *c_row = C + i*c_row_stride;
+        int j=n0;
+        for (; j+4<=n1; j+=4) {
+          int32_t acc[4];
+          int8Dot4(a_row, B + j*ldb, B + (j+1)*ldb, B + (j+2)*ldb,
+                   B + (j+3)*ldb, K, acc);
+          for (int jj=0; jj<4; ++jj) {
+            const float v = a_scale * b_scales[j+jj] *
+              static_cast<float>(acc[jj]);
+            float &c = c_row[(j+jj)*c_col_stride];
+            if (beta == 0.0f) c = v;
+            else c = beta*c + v;
+          }
+        }
+        for (; j<n1; ++j) {
+          const float v = a_scale * b_scales[j] *
+            static_cast<float>(int8Dot(a_row, B + j*ldb, K));
+          float &c = c_row[j*c_col_stride];
+          if (beta == 0.0f) c = v;
+          else c = beta*c + v;
+        }
+      }
+    }
+  }
+
+} // namespace AprilMath
+
+#undef INT8_GEMM_M_TILE
+#undef INT8_GEMM_N_TILE
+#undef INT8_GEMM_OMP_TH
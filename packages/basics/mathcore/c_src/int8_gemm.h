@@ -0,0 +1,75 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef INT8_GEMM_H
+#define INT8_GEMM_H
+
+#include <stdint.h>
+
+namespace AprilMath {
+
+  /**
+   * @brief Symmetric int8 quantization of the rows of a float matrix.
+   *
+   * Every row @c i is scaled by its own factor
+   * \f$ s_i = \max_j |x_{ij}| / 127 \f$ and rounded to the nearest integer in
+   * the range [-127,127], so \f$ x_{ij} \approx s_i q_{ij} \f$. Rows full of
+   * zeros receive a zero scale.
+   *
+   * @param rows - Number of rows.
+   * @param cols - Number of columns.
+   * @param src - Pointer to the first float element.
+   * @param src_row_stride - Distance between consecutive rows of @c src.
+   * @param src_col_stride - Distance between consecutive columns of @c src.
+   * @param dst - Row-major int8 destination with @c dst_stride between rows.
+   * @param dst_stride - Distance between consecutive rows of @c dst.
+   * @param scales - Destination for the @c rows scale factors.
+   */
+  void int8QuantizeRows(int rows, int cols,
+                        const float *src, int src_row_stride, int src_col_stride,
+                        int8_t *dst, int dst_stride,
+                        float *scales);
+
+  /**
+   * @brief Matrix product of two int8 row-quantized matrices.
+   *
+   * Computes \f$ C = \alpha (A B^T) + \beta C \f$ where
+   * \f$ A_{ik} = s^a_i q^a_{ik} \f$ is a MxK matrix and
+   * \f$ B_{jk} = s^b_j q^b_{jk} \f$ is a NxK matrix. Products are accumulated
+   * in int32 and the result is requantized to float using the outer product of
+   * both scale vectors, \f$ C_{ij} = s^a_i s^b_j \sum_k q^a_{ik} q^b_{jk} \f$.
+   *
+   * Operands are stored row-major with contiguous K dimension, this way every
+   * output is a contiguous int8 dot product which compilers vectorize. The
+   * computation is blocked in tiles of C and tiles are distributed between OMP
+   * threads.
+   *
+   * @note K should be less than 2^17 to avoid int32 overflow.
+   */
+  void int8Gemm(int M, int N, int K,
+                float alpha,
+                const int8_t *A, int lda, const float *a_scales,
+                const int8_t *B, int ldb, const float *b_scales,
+                float beta,
+                float *C, int c_row_stride, int c_col_stride);
+  
+} // namespace AprilMath
+
+#endif // INT8_GEMM_H
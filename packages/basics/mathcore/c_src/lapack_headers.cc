@@ -78,6 +78,38 @@ int clapack_spotrf(const int Order, const int Uplo, const int N, float *A,
   }
   return info;
 }
+int clapack_sgeqrf(const int Order, const int M, const int N, const int LDA,
+                   float *A, float *TAU) {
+  if (Order != CblasColMajor) {
+    ERROR_EXIT(256, "Only col_major order is allowed\n");
+  }
+  float workSize;
+  int lwork = -1;
+  int info = 0;
+  // call sgeqrf_ for workspace size computation
+  sgeqrf_(&M, &N, A, &LDA, TAU, &workSize, &lwork, &info);
+  lwork = (int)workSize;
+  float *work = new float[lwork];
+  sgeqrf_(&M, &N, A, &LDA, TAU, work, &lwork, &info);
+  delete[] work;
+  return info;
+}
+int clapack_sorgqr(const int Order, const int M, const int N, const int K,
+                   const int LDA, float *A, const float *TAU) {
+  if (Order != CblasColMajor) {
+    ERROR_EXIT(256, "Only col_major order is allowed\n");
+  }
+  float workSize;
+  int lwork = -1;
+  int info = 0;
+  // call sorgqr_ for workspace size computation
+  sorgqr_(&M, &N, &K, A, &LDA, TAU, &workSize, &lwork, &info);
+  lwork = (int)workSize;
+  float *work = new float[lwork];
+  sorgqr_(&M, &N, &K, A, &LDA, TAU, work, &lwork, &info);
+  delete[] work;
+  return info;
+}
 #elif defined(USE_XCODE)
 #include "cblas_headers.h"
 int clapack_sgetrf(int Order, int M, int N,
@@ -134,6 +166,37 @@ int clapack_spotrf(int Order, int Uplo, int N, float *A,
   }
   return info;
 }
+int clapack_sgeqrf(int Order, int M, int N, int LDA, float *A, float *TAU) {
+  if (Order != CblasColMajor)
+    ERROR_EXIT(256, "Only col_major order is allowed\n");
+  float workSize;
+  int lwork = -1;
+  int info = 0;
+  // call sgeqrf_ for workspace size computation
+  sgeqrf_(&M, &N, A, &LDA, TAU, &workSize, &lwork, &info);
+  lwork = (int)workSize;
+  float *work = new float[lwork];
+  sgeqrf_(&M, &N, A, &LDA, TAU, work, &lwork, &info);
+  delete[] work;
+  return info;
+}
+int clapack_sorgqr(int Order, int M, int N, int K, int LDA,
+                   float *A, const float *TAU) {
+  if (Order != CblasColMajor)
+    ERROR_EXIT(256, "Only col_major order is allowed\n");
+  // Accelerate declares TAU as non-const although it is only read
+  float *tau = const_cast<float*>(TAU);
+  float workSize;
+  int lwork = -1;
+  int info = 0;
+  // call sorgqr_ for workspace size computation
+  sorgqr_(&M, &N, &K, A, &LDA, tau, &workSize, &lwork, &info);
+  lwork = (int)workSize;
+  float *work = new float[lwork];
+  sorgqr_(&M, &N, &K, A, &LDA, tau, work, &lwork, &info);
+  delete[] work;
+  return info;
+}
 #else
 #include "lapacke.h"
 int clapack_sgesdd(const int Order, const int M, const int N, const int LDA,
@@ -144,6 +207,18 @@ int clapack_sgesdd(const int Order, const int M, const int N, const int LDA,
 			    M, N, A, LDA, S, U, M, VT, N);
   return info;
 }
+int clapack_sgeqrf(const int Order, const int M, const int N, const int LDA,
+                   float *A, float *TAU) {
+  if (Order != CblasColMajor)
+    ERROR_EXIT(256, "Only col_major order is allowed\n");
+  return LAPACKE_sgeqrf(LAPACK_COL_MAJOR, M, N, A, LDA, TAU);
+}
+int clapack_sorgqr(const int Order, const int M, const int N, const int K,
+                   const int LDA, float *A, const float *TAU) {
+  if (Order != CblasColMajor)
+    ERROR_EXIT(256, "Only col_major order is allowed\n");
+  return LAPACKE_sorgqr(LAPACK_COL_MAJOR, M, N, K, A, LDA, TAU);
+}
 #endif
 
 void checkLapackInfo(int info) {
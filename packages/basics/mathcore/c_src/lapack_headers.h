@@ -48,6 +48,10 @@ int clapack_sgesdd(const int Order, const int M, const int N, const int LDA,
 		   float *A, float *U, float *S, float *VT);
 int clapack_spotrf(const int Order, const int Uplo, const int N, float *A,
                    const int LDA);
+int clapack_sgeqrf(const int Order, const int M, const int N, const int LDA,
+                   float *A, float *TAU);
+int clapack_sorgqr(const int Order, const int M, const int N, const int K,
+                   const int LDA, float *A, const float *TAU);
 #elif defined(USE_XCODE)
 int clapack_sgetrf(int Order, int M, int N,
                    float *A, int lda, int *ipiv);
@@ -56,9 +60,16 @@ int clapack_sgetri(int Order, int N,
 int clapack_sgesdd(int Order, int M, int N, int LDA,
 		   float *A, float *U, float *S, float *VT);
 int clapack_spotrf(int Order, int Uplo, int N, float *A, int LDA);
+int clapack_sgeqrf(int Order, int M, int N, int LDA, float *A, float *TAU);
+int clapack_sorgqr(int Order, int M, int N, int K, int LDA,
+                   float *A, const float *TAU);
 #else
 int clapack_sgesdd(const int Order, const int M, const int N, const int LDA,
 		   float *A, float *U, float *S, float *VT);
+int clapack_sgeqrf(const int Order, const int M, const int N, const int LDA,
+                   float *A, float *TAU);
+int clapack_sorgqr(const int Order, const int M, const int N, const int K,
+                   const int LDA, float *A, const float *TAU);
 #endif
 
 void checkLapackInfo(int info);
@@ -24,11 +24,63 @@
 
 #include "cmath_overloads.h"
 #include "cuda_kernel_templates.h"
+#include "maxmin.h"
 #include "cuda_utils.h"
 #include "gpu_mirrored_memory_block.h"
 
 namespace AprilMath {
 
+  /// Number of consecutive elements reduced sequentially before their partial
+  /// result is combined pairwise with other partials.
+#define REDUCE_BLOCK_SIZE 128u
+  /// Maximum depth of the pairwise combination stack, enough for 2^32 blocks.
+#define REDUCE_STACK_SIZE 32
+
+  /**
+   * @brief Pairwise (tree) combination of an array of partial results.
+   *
+   * The partials are combined in-place following a fixed binary tree where
+   * left operands always precede right operands, so the result is
+   * deterministic and the rounding error grows logarithmically with @c N.
+   *
+   * @param partials - An array with N partial results, it is overwritten.
+   * @param N - The number of partials, it should be greater than zero.
+   * @param partials_reduce_op - Implements <tt>void operator()(O &acc, const O &other) const</tt>
+   *
+   * @return The reduction of all the given partials.
+   */
+  template<typename O, typename P>
+  O pairwiseReducePartials(O *partials, unsigned int N,
+                           const P &partials_reduce_op) {
+    for (unsigned int step=1; step<N; step<<=1) {
+      for (unsigned int i=0; i+step<N; i+=(step<<1)) {
+        partials_reduce_op(partials[i], partials[i+step]);
+      }
+    }
+    return partials[0];
+  }
+
+  /**
+   * @brief Pairwise (tree) combination of partial results of min/max
+   * reductions, together with its argmin/argmax.
+   *
+   * @see AprilMath::pairwiseReducePartials
+   *
+   * @note reduce_op implements <tt>void operator()(T &, const T &, int32_t &, const int32_t &) const</tt>
+   */
+  template<typename T, typename F>
+  T pairwiseReduceMinMaxPartials(T *partials, int32_t *which, unsigned int N,
+                                 int32_t &result_which,
+                                 const F &reduce_op) {
+    for (unsigned int step=1; step<N; step<<=1) {
+      for (unsigned int i=0; i+step<N; i+=(step<<1)) {
+        reduce_op(partials[i], partials[i+step], which[i], which[i+step]);
+      }
+    }
+    result_which = which[0];
+    return partials[0];
+  }
+
   /**
    * @brief Performs a reduce over a vector and stores its result at
    * another vector.
@@ -76,7 +128,6 @@ namespace AprilMath {
                           bool set_dest_to_zero) {
 #ifndef USE_CUDA
     UNUSED_VARIABLE(use_gpu);
-    UNUSED_VARIABLE(partials_reduce_op);
 #endif
 #ifdef USE_CUDA
     if (use_gpu) {
@@ -97,8 +148,39 @@ namespace AprilMath {
       else {
         dest_ptr = dest->getPPALForReadAndWrite() + dest_shift;
       }
-      for (unsigned int i=0; i<N; ++i, v_mem+=input_stride) {
-        reduce_op(*dest_ptr, *v_mem);
+      if (N <= REDUCE_BLOCK_SIZE) {
+        for (unsigned int i=0; i<N; ++i, v_mem+=input_stride) {
+          reduce_op(*dest_ptr, *v_mem);
+        }
+      }
+      else {
+        // blocks of consecutive elements are combined pairwise using a stack
+        // of partials, the level of every partial depends on the number of
+        // blocks reduced so far
+        O stack[REDUCE_STACK_SIZE];
+        int stack_size = 0;
+        unsigned int num_blocks = 0;
+        for (unsigned int i=0; i<N; i+=REDUCE_BLOCK_SIZE) {
+          const unsigned int last = AprilUtils::min(N, i+REDUCE_BLOCK_SIZE);
+          O acc = zero;
+          for (unsigned int j=i; j<last; ++j, v_mem+=input_stride) {
+            reduce_op(acc, *v_mem);
+          }
+          ++num_blocks;
+          for (unsigned int b=num_blocks; (b & 1u) == 0; b >>= 1) {
+            O &left = stack[--stack_size];
+            partials_reduce_op(left, acc);
+            acc = left;
+          }
+          stack[stack_size++] = acc;
+        }
+        O result = stack[--stack_size];
+        while(stack_size > 0) {
+          O &left = stack[--stack_size];
+          partials_reduce_op(left, result);
+          result = left;
+        }
+        partials_reduce_op(*dest_ptr, result);
       }
 #ifdef USE_CUDA
     }
@@ -159,7 +241,6 @@ namespace AprilMath {
                           bool set_dest_to_zero) {
 #ifndef USE_CUDA
     UNUSED_VARIABLE(use_gpu);
-    UNUSED_VARIABLE(partials_reduce_op);
 #endif
 #ifdef USE_CUDA
     if (use_gpu) {
@@ -182,9 +263,39 @@ namespace AprilMath {
       else {
         dest_ptr = dest->getPPALForReadAndWrite() + dest_shift;
       }
-      for (unsigned int i=0; i<N; ++i,
-             v1_mem+=input1_stride, v2_mem+=input2_stride) {
-        reduce_op(*dest_ptr, *v1_mem, *v2_mem);
+      if (N <= REDUCE_BLOCK_SIZE) {
+        for (unsigned int i=0; i<N; ++i,
+               v1_mem+=input1_stride, v2_mem+=input2_stride) {
+          reduce_op(*dest_ptr, *v1_mem, *v2_mem);
+        }
+      }
+      else {
+        // see genericReduce1Call
+        O stack[REDUCE_STACK_SIZE];
+        int stack_size = 0;
+        unsigned int num_blocks = 0;
+        for (unsigned int i=0; i<N; i+=REDUCE_BLOCK_SIZE) {
+          const unsigned int last = AprilUtils::min(N, i+REDUCE_BLOCK_SIZE);
+          O acc = zero;
+          for (unsigned int j=i; j<last; ++j,
+                 v1_mem+=input1_stride, v2_mem+=input2_stride) {
+            reduce_op(acc, *v1_mem, *v2_mem);
+          }
+          ++num_blocks;
+          for (unsigned int b=num_blocks; (b & 1u) == 0; b >>= 1) {
+            O &left = stack[--stack_size];
+            partials_reduce_op(left, acc);
+            acc = left;
+          }
+          stack[stack_size++] = acc;
+        }
+        O result = stack[--stack_size];
+        while(stack_size > 0) {
+          O &left = stack[--stack_size];
+          partials_reduce_op(left, result);
+          result = left;
+        }
+        partials_reduce_op(*dest_ptr, result);
       }
 #ifdef USE_CUDA
     }
@@ -236,7 +347,6 @@ namespace AprilMath {
                                bool set_dest_to_zero) {
 #ifndef USE_CUDA
     UNUSED_VARIABLE(use_gpu);
-    UNUSED_VARIABLE(zero);
 #endif
 #ifdef USE_CUDA
     if (use_gpu) {
@@ -262,9 +372,51 @@ namespace AprilMath {
         dest_ptr = dest->getPPALForReadAndWrite() + dest_shift;
         which_ptr = which->getPPALForReadAndWrite() + which_shift;
       }
-      for (unsigned int i=0; i<N; ++i, v_mem+=input_stride) {
-        // i+1 because Lua startas at 1.
-        reduce_op(*dest_ptr, *v_mem, *which_ptr, static_cast<int>(i+1));
+      if (N <= REDUCE_BLOCK_SIZE) {
+        for (unsigned int i=0; i<N; ++i, v_mem+=input_stride) {
+          // i+1 because Lua startas at 1.
+          reduce_op(*dest_ptr, *v_mem, *which_ptr, static_cast<int>(i+1));
+        }
+      }
+      else {
+        // see genericReduce1Call, left partials always precede right partials,
+        // so ties are resolved in favor of the first index as in a sequential
+        // traversal
+        T stack[REDUCE_STACK_SIZE];
+        int32_t which_stack[REDUCE_STACK_SIZE];
+        int stack_size = 0;
+        unsigned int num_blocks = 0;
+        for (unsigned int i=0; i<N; i+=REDUCE_BLOCK_SIZE) {
+          const unsigned int last = AprilUtils::min(N, i+REDUCE_BLOCK_SIZE);
+          T acc = zero;
+          int32_t which_acc = 0;
+          for (unsigned int j=i; j<last; ++j, v_mem+=input_stride) {
+            // j+1 because Lua startas at 1.
+            reduce_op(acc, *v_mem, which_acc, static_cast<int>(j+1));
+          }
+          ++num_blocks;
+          for (unsigned int b=num_blocks; (b & 1u) == 0; b >>= 1) {
+            --stack_size;
+            reduce_op(stack[stack_size], acc,
+                      which_stack[stack_size], which_acc);
+            acc = stack[stack_size];
+            which_acc = which_stack[stack_size];
+          }
+          stack[stack_size] = acc;
+          which_stack[stack_size] = which_acc;
+          ++stack_size;
+        }
+        --stack_size;
+        T result = stack[stack_size];
+        int32_t result_which = which_stack[stack_size];
+        while(stack_size > 0) {
+          --stack_size;
+          reduce_op(stack[stack_size], result,
+                    which_stack[stack_size], result_which);
+          result = stack[stack_size];
+          result_which = which_stack[stack_size];
+        }
+        reduce_op(*dest_ptr, result, *which_ptr, result_which);
       }
 #ifdef USE_CUDA
     }
@@ -434,4 +586,7 @@ namespace AprilMath {
   
 } // namespace AprilMath
 
+#undef REDUCE_BLOCK_SIZE
+#undef REDUCE_STACK_SIZE
+
 #endif // REDUCE_TEMPLATE_H
@@ -27,8 +27,10 @@ extern "C" {
 #include "bind_mathcore.h"
 #include "bind_mtrand.h"
 #include "bind_matrix_int32.h"
+#include "bind_matrix_half.h"
 #include "bind_matrix_bool.h"
 #include "bind_sparse_matrix.h"
+#include "bind_util.h"
 #include "luabindutil.h"
 #include "luabindmacros.h"
 #include "lua_string.h"
@@ -36,6 +38,7 @@ extern "C" {
 #include "mystring.h"
 #include "smart_ptr.h"
 #include "utilMatrixFloat.h"
+#include "utilMatrixHalf.h"
 
 using namespace AprilMath::MatrixExt::BLAS;
 using namespace AprilMath::MatrixExt::Boolean;
@@ -1381,6 +1384,12 @@ namespace Basics {
 }
 //BIND_END
 
+//BIND_METHOD MatrixFloat to_half
+{
+  LUABIND_RETURN(MatrixHalf, convertFromMatrixFloatToMatrixHalf(obj));
+}
+//BIND_END
+
 //BIND_METHOD MatrixFloat gemm
 {
   LUABIND_CHECK_ARGN(==, 1);
@@ -1411,6 +1420,32 @@ namespace Basics {
 }
 //BIND_END
 
+//BIND_METHOD MatrixFloat half_gemm
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  check_table_fields(L,1, "trans_A", "trans_B", "alpha", "A", "B", "beta",
+                     (const char *)0);
+  bool trans_A, trans_B;
+  float alpha;
+  float beta;
+  MatrixFloat *matA;
+  MatrixHalf *matB;
+  LUABIND_GET_TABLE_PARAMETER(1, A, MatrixFloat, matA);
+  LUABIND_GET_TABLE_PARAMETER(1, B, MatrixHalf, matB);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, trans_A, bool, trans_A, false);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, trans_B, bool, trans_B, false);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, alpha, float, alpha, 1.0f);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, beta, float, beta, 1.0f);
+  LUABIND_RETURN(MatrixFloat,
+                 matHalfGemm(obj,
+                             trans_A ? CblasTrans : CblasNoTrans,
+                             trans_B ? CblasTrans : CblasNoTrans,
+                             alpha, matA, matB,
+                             beta));
+}
+//BIND_END
+
 //BIND_METHOD MatrixFloat sparse_mm
 {
   LUABIND_CHECK_ARGN(==, 1);
@@ -1641,6 +1676,15 @@ namespace Basics {
 }
 //BIND_END
 
+//BIND_METHOD MatrixFloat qr
+{
+  MatrixFloat *Q,*R;
+  matQR(obj, &Q, &R);
+  LUABIND_RETURN(MatrixFloat, Q);
+  LUABIND_RETURN(MatrixFloat, R);
+}
+//BIND_END
+
 //BIND_METHOD MatrixFloat lt
 {
   if (lua_isMatrixFloat(L, 1)) {
@@ -1767,6 +1811,35 @@ namespace Basics {
 }
 //BIND_END
 
+//BIND_FUNCTION matrix.ext.broadcast_map
+{
+  const char *op;
+  MatrixFloat *a, *b, *result;
+  LUABIND_CHECK_ARGN(>=, 3);
+  LUABIND_CHECK_ARGN(<=, 4);
+  LUABIND_GET_PARAMETER(1, string, op);
+  LUABIND_GET_PARAMETER(2, MatrixFloat, a);
+  LUABIND_GET_PARAMETER(3, MatrixFloat, b);
+  LUABIND_GET_OPTIONAL_PARAMETER(4, MatrixFloat, result, 0);
+  if (!strcmp(op, "add")) {
+    result = matBroadcastAddition(a, b, result);
+  }
+  else if (!strcmp(op, "sub")) {
+    result = matBroadcastSubstraction(a, b, result);
+  }
+  else if (!strcmp(op, "cmul")) {
+    result = matBroadcastCmul(a, b, result);
+  }
+  else if (!strcmp(op, "div")) {
+    result = matBroadcastDiv(a, b, result);
+  }
+  else {
+    LUABIND_FERROR1("Unknown broadcast operation %s", op);
+  }
+  LUABIND_RETURN(MatrixFloat, result);
+}
+//BIND_END
+
 //// MATRIX SERIALIZATION ////
 
 //BIND_CLASS_METHOD MatrixFloat read
@@ -1776,18 +1849,65 @@ namespace Basics {
 }
 //BIND_END
 
+//BIND_CLASS_METHOD MatrixFloat readCSV
+{
+  LUABIND_CHECK_ARGN(>=, 1);
+  LUABIND_CHECK_ARGN(<=, 2);
+  const char *filename, *delim;
+  bool read_empty;
+  float default_value;
+  int skip;
+  AprilUtils::vector<int> columns;
+  LUABIND_GET_PARAMETER(1, string, filename);
+  if (lua_istable(L,2)) {
+    check_table_fields(L, 2, "delim", "read_empty", "default", "skip",
+                       "columns", (const char *)0);
+    LUABIND_GET_TABLE_OPTIONAL_PARAMETER(2, delim, string, delim, ",");
+    LUABIND_GET_TABLE_OPTIONAL_PARAMETER(2, read_empty, bool, read_empty, true);
+    LUABIND_GET_TABLE_OPTIONAL_PARAMETER(2, default, float, default_value,
+                                         0.0f);
+    LUABIND_GET_TABLE_OPTIONAL_PARAMETER(2, skip, int, skip, 0);
+    lua_getfield(L, 2, "columns");
+    if (!lua_isnil(L, -1)) {
+      int len;
+      LUABIND_TABLE_GETN(-1, len);
+      columns.resize(len);
+      LUABIND_TABLE_TO_VECTOR_SUB1(-1, int, columns, len);
+    }
+    lua_pop(L, 1);
+  }
+  else {
+    delim = ",";
+    read_empty = true;
+    default_value = 0.0f;
+    skip = 0;
+  }
+  LUABIND_RETURN(MatrixFloat, readMatrixFloatCSV(filename, delim, read_empty,
+                                                 default_value, skip,
+                                                 columns));
+}
+//BIND_END
+
 //BIND_CLASS_METHOD MatrixFloat fromMMap
 {
   LUABIND_CHECK_ARGN(>=, 1);
   LUABIND_CHECK_ARGN(<=, 3);
-  LUABIND_CHECK_PARAMETER(1, string);
-  const char *filename;
-  bool write, shared;
-  LUABIND_GET_PARAMETER(1,string,filename);
-  LUABIND_GET_OPTIONAL_PARAMETER(2,bool,write,true);
-  LUABIND_GET_OPTIONAL_PARAMETER(3,bool,shared,true);
   AprilUtils::MMappedDataReader *mmapped_data;
-  mmapped_data = new AprilUtils::MMappedDataReader(filename,write,shared);
+  if (lua_isMMappedDataReader(L,1)) {
+    // a reader shared by several objects, data is aligned by toMMap
+    LUABIND_CHECK_ARGN(==, 1);
+    LUABIND_GET_PARAMETER(1,MMappedDataReader,mmapped_data);
+    mmapped_data->align(64, sizeof(size_t));
+  }
+  else {
+    LUABIND_CHECK_PARAMETER(1, string);
+    const char *filename;
+    bool write, shared;
+    LUABIND_GET_PARAMETER(1,string,filename);
+    LUABIND_GET_OPTIONAL_PARAMETER(2,bool,write,true);
+    LUABIND_GET_OPTIONAL_PARAMETER(3,bool,shared,true);
+    mmapped_data = new AprilUtils::MMappedDataReader(filename,write,shared);
+  }
   IncRef(mmapped_data);
   MatrixFloat *obj = MatrixFloat::fromMMappedDataReader(mmapped_data);
   DecRef(mmapped_data);
@@ -1798,10 +1918,17 @@ namespace Basics {
 //BIND_METHOD MatrixFloat toMMap
 {
   LUABIND_CHECK_ARGN(==, 1);
-  const char *filename;
-  LUABIND_GET_PARAMETER(1, string, filename);
   AprilUtils::MMappedDataWriter *mmapped_data;
-  mmapped_data = new AprilUtils::MMappedDataWriter(filename);
+  if (lua_isMMappedDataWriter(L,1)) {
+    // a writer shared by several objects, data is aligned to 64 bytes
+    LUABIND_GET_PARAMETER(1, MMappedDataWriter, mmapped_data);
+    mmapped_data->align(64, sizeof(size_t));
+  }
+  else {
+    const char *filename;
+    LUABIND_GET_PARAMETER(1, string, filename);
+    mmapped_data = new AprilUtils::MMappedDataWriter(filename);
+  }
   IncRef(mmapped_data);
   obj->toMMappedDataWriter(mmapped_data);
   DecRef(mmapped_data);
@@ -0,0 +1,560 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+//BIND_HEADER_C
+#include "bind_mathcore.h"
+#include "bind_matrix.h"
+#include "utilMatrixHalf.h"
+#include "luabindutil.h"
+#include "luabindmacros.h"
+
+#include "matrix_ext.h"
+using namespace AprilMath::MatrixExt::BLAS;
+using namespace AprilMath::MatrixExt::Boolean;
+using namespace AprilMath::MatrixExt::Initializers;
+using namespace AprilMath::MatrixExt::Misc;
+using namespace AprilMath::MatrixExt::LAPACK;
+using namespace AprilMath::MatrixExt::Operations;
+using namespace AprilMath::MatrixExt::Reductions;
+
+namespace AprilUtils {
+  template<> AprilMath::Half LuaTable::
+  convertTo<AprilMath::Half>(lua_State *L, int idx) {
+    return AprilMath::Half(static_cast<float>(lua_tonumber(L, idx)));
+  }
+  
+  template<> void LuaTable::
+  pushInto<AprilMath::Half>(lua_State *L, AprilMath::Half value) {
+    lua_pushnumber(L, static_cast<float>(value));
+  }
+
+  template<> bool LuaTable::
+  checkType<AprilMath::Half>(lua_State *L, int idx) {
+    return lua_isnumber(L, idx);
+  }
+
+  template<> Basics::MatrixHalf *LuaTable::
+  convertTo<Basics::MatrixHalf *>(lua_State *L, int idx) {
+    return lua_toMatrixHalf(L, idx);
+  }
+  
+  template<> void LuaTable::
+  pushInto<Basics::MatrixHalf *>(lua_State *L, Basics::MatrixHalf *value) {
+    lua_pushMatrixHalf(L, value);
+  }
+
+  template<> bool LuaTable::
+  checkType<Basics::MatrixHalf *>(lua_State *L, int idx) {
+    return lua_isMatrixHalf(L, idx);
+  }
+}
+
+namespace Basics {
+#define FUNCTION_NAME "read_vector"
+  static int *read_vector(lua_State *L, const char *key, int num_dim, int add) {
+    int *v=0;
+    lua_getfield(L, 1, key);
+    if (!lua_isnil(L, -1)) {
+      LUABIND_CHECK_PARAMETER(-1, table);
+      int table_len;
+      LUABIND_TABLE_GETN(-1, table_len);
+      if (table_len != num_dim)
+        LUABIND_FERROR3("Table '%s' with incorrect size, expected %d, found %d",
+                        key, num_dim, table_len);
+      v = new int[num_dim];
+      for(int i=0; i < num_dim; i++) {
+        lua_rawgeti(L, -1, i+1);
+        v[i] = static_cast<int>(lua_tonumber(L, -1)) + add;
+        lua_pop(L,1);
+      }
+    }
+    lua_pop(L, 1);
+    return v;
+  }
+#undef FUNCTION_NAME
+
+#define FUNCTION_NAME "read_coords"
+  /// Reads the coordinates of a MatrixHalf element from the Lua stack,
+  /// returns them in C order.
+  static int *read_coords(lua_State *L, const MatrixHalf *obj) {
+    // all the coordinates are checked before allocating the buffer, so an
+    // error never leaves it behind
+    for (int i=0; i<obj->getNumDim(); ++i) {
+      int v;
+      LUABIND_GET_PARAMETER(i+1,int,v);
+      if (v<1 || v > obj->getDimSize(i)) {
+        LUABIND_FERROR2("wrong index parameter: 1 <= %d <= %d is incorrect",
+                        v, obj->getDimSize(i));
+      }
+    }
+    int *coords = new int[obj->getNumDim()];
+    for (int i=0; i<obj->getNumDim(); ++i) {
+      LUABIND_GET_PARAMETER(i+1,int,coords[i]);
+      coords[i]--;
+    }
+    return coords;
+  }
+#undef FUNCTION_NAME
+
+  int sliding_window_matrixHalf_iterator_function(lua_State *L) {
+    SlidingWindowMatrixHalf *obj = lua_toSlidingWindowMatrixHalf(L,1);
+    if (obj->isEnd()) {
+      lua_pushnil(L);
+      return 1;
+    }
+    MatrixHalf *mat = obj->getMatrix();
+    lua_pushMatrixHalf(L, mat);
+    obj->next();
+    return 1;
+  }
+}
+//BIND_END
+
+//BIND_HEADER_H
+#include "matrixHalf.h"
+using namespace Basics;
+typedef MatrixHalf::sliding_window SlidingWindowMatrixHalf;
+//BIND_END
+
+//BIND_LUACLASSNAME MatrixHalf matrixHalf
+//BIND_CPP_CLASS MatrixHalf
+//BIND_LUACLASSNAME Serializable aprilio.serializable
+//BIND_SUBCLASS_OF MatrixHalf Serializable
+
+//BIND_LUACLASSNAME SlidingWindowMatrixHalf matrixHalf.__sliding_window__
+//BIND_CPP_CLASS SlidingWindowMatrixHalf
+
+//BIND_CONSTRUCTOR SlidingWindowMatrixHalf
+{
+  LUABIND_ERROR("Use matrixHalf.sliding_window");
+}
+//BIND_END
+
+//BIND_METHOD SlidingWindowMatrixHalf get_matrix
+{
+  MatrixHalf *dest;
+  LUABIND_GET_OPTIONAL_PARAMETER(1, MatrixHalf, dest, 0);
+  LUABIND_RETURN(MatrixHalf, obj->getMatrix(dest));
+}
+//BIND_END
+
+//BIND_METHOD SlidingWindowMatrixHalf next
+{
+  LUABIND_RETURN(SlidingWindowMatrixHalf, obj->next());
+}
+//BIND_END
+
+//BIND_METHOD SlidingWindowMatrixHalf set_at_window
+{
+  int windex;
+  LUABIND_CHECK_ARGN(==,1);
+  LUABIND_GET_PARAMETER(1, int, windex);
+  if (windex < 1) LUABIND_ERROR("Index must be >= 1\n");
+  obj->setAtWindow(windex-1);
+  LUABIND_RETURN(SlidingWindowMatrixHalf, obj);
+}
+//BIND_END
+
+//BIND_METHOD SlidingWindowMatrixHalf num_windows
+{
+  LUABIND_RETURN(int, obj->numWindows());
+}
+//BIND_END
+
+//BIND_METHOD SlidingWindowMatrixHalf coords
+{
+  LUABIND_VECTOR_TO_NEW_TABLE(int, obj->getCoords(), obj->getNumDim());
+  LUABIND_RETURN_FROM_STACK(-1);
+}
+//BIND_END
+
+//BIND_METHOD SlidingWindowMatrixHalf is_end
+{
+  LUABIND_RETURN(bool, obj->isEnd());
+}
+//BIND_END
+
+//BIND_METHOD SlidingWindowMatrixHalf iterate
+{
+  LUABIND_CHECK_ARGN(==, 0);
+  LUABIND_RETURN(cfunction,sliding_window_matrixHalf_iterator_function);
+  LUABIND_RETURN(SlidingWindowMatrixHalf,obj);
+}
+//BIND_END
+
+//////////////////////////////////////////////////////////////////////
+
+//BIND_CONSTRUCTOR MatrixHalf
+{
+  int i,argn;
+  argn = lua_gettop(L); // number of arguments
+  LUABIND_CHECK_ARGN(>=, 1);
+  int ndims = (!lua_isnumber(L,argn)) ? argn-1 : argn;
+  int *dim;
+  if (ndims == 0) { // caso matrix{valores}
+    ndims = 1;
+    dim = new int[ndims];
+    LUABIND_TABLE_GETN(1, dim[0]);
+  } else {
+    dim = new int[ndims];
+    for (i=1; i <= ndims; i++) {
+      if (!lua_isnumber(L,i))
+	// TODO: Este mensaje de error parece que no es correcto... y no se todavia por que!!!
+	LUABIND_FERROR2("incorrect argument to matrix dimension (arg %d must"
+			" be a number and is a %s)",
+			i, lua_typename(L,i));
+      dim[i-1] = (int)lua_tonumber(L,i);
+      if (dim[i-1] <= 0)
+	LUABIND_FERROR1("incorrect argument to matrix dimension (arg %d must be >0)",i);
+    }
+  }
+  MatrixHalf* obj;
+  obj = new MatrixHalf(ndims,dim);
+  if (lua_istable(L,argn)) {
+    int i=1;
+    for (MatrixHalf::iterator it(obj->begin()); it != obj->end(); ++i, ++it) {
+      lua_rawgeti(L,argn,i);
+      *it = AprilMath::Half(static_cast<float>(luaL_checknumber(L,-1)));
+      lua_remove(L,-1);
+    }
+  }
+  delete[] dim;
+  LUABIND_RETURN(MatrixHalf,obj);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf size
+{
+  LUABIND_RETURN(int, obj->size());
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf rewrap
+{
+  LUABIND_CHECK_ARGN(>=, 1);
+  int ndims;
+  ndims = lua_gettop(L); // number of dimensions
+  int *dims = new int[ndims];
+  for (int i=1; i <= ndims; i++) {
+    LUABIND_GET_PARAMETER(i, int, dims[i-1]);
+    if (dims[i-1] <= 0)
+      LUABIND_FERROR1("incorrect argument to matrix dimension (arg %d must be >0)",i);
+  }
+  MatrixHalf *new_obj = obj->rewrap(dims, ndims);
+  delete[] dims;
+  LUABIND_RETURN(MatrixHalf,new_obj);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf squeeze
+{
+  LUABIND_RETURN(MatrixHalf,obj->squeeze());
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf get_reference_string
+{
+  char buff[128];
+  sprintf(buff,"%p data= %p",
+	  (void*)obj,
+	  (void*)obj->getRawDataAccess());
+  LUABIND_RETURN(string, buff);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf copy_from_table
+//DOC_BEGIN
+// void copy_from_table(table matrix_values)
+/// Permite dar valores a una matriz. Require una tabla con un numero
+/// de argumentos igual al numero de elementos de la matriz.
+///@param matrix_values Tabla con los elementos de la matriz.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  int veclen;
+  LUABIND_TABLE_GETN(1, veclen);
+  if (veclen != obj->size())
+    LUABIND_FERROR2("wrong size %d instead of %d",veclen,obj->size());
+  int i=1;
+  for (MatrixHalf::iterator it(obj->begin()); it != obj->end(); ++i, ++it) {
+    lua_rawgeti(L,1,i);
+    *it = AprilMath::Half(static_cast<float>(luaL_checknumber(L,-1)));
+    lua_remove(L,-1);
+  }
+  LUABIND_RETURN(MatrixHalf, obj);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf get
+{
+  int argn = lua_gettop(L); // number of arguments
+  if (argn != obj->getNumDim())
+    LUABIND_FERROR2("wrong size %d instead of %d",argn,obj->getNumDim());
+  int *coords = read_coords(L, obj);
+  float ret = (*obj)(coords, obj->getNumDim());
+  delete[] coords;
+  LUABIND_RETURN(float, ret);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf set
+{
+  int argn = lua_gettop(L); // number of arguments
+  if (argn != obj->getNumDim()+1)
+    LUABIND_FERROR2("wrong size %d instead of %d",argn,obj->getNumDim()+1);
+  float value;
+  LUABIND_GET_PARAMETER(obj->getNumDim()+1,float,value);
+  int *coords = read_coords(L, obj);
+  (*obj)(coords, obj->getNumDim()) = AprilMath::Half(value);
+  delete[] coords;
+  LUABIND_RETURN(MatrixHalf, obj);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf fill
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  float value;
+  LUABIND_GET_PARAMETER(1,float,value);
+  LUABIND_RETURN(MatrixHalf, 
+                 matFill(obj, AprilMath::Half(value)));
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf zeros
+{
+  LUABIND_RETURN(MatrixHalf, 
+                 matZeros(obj));
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf ones
+{
+  LUABIND_RETURN(MatrixHalf, 
+                 matOnes(obj));
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf offset
+{
+  LUABIND_RETURN(int, obj->getOffset());
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf dim
+{
+  LUABIND_CHECK_ARGN(>=, 0);
+  LUABIND_CHECK_ARGN(<=, 1);
+  int pos;
+  const int *d=obj->getDimPtr();
+  LUABIND_GET_OPTIONAL_PARAMETER(1, int, pos, -1);
+  if (pos < 1) {
+    LUABIND_VECTOR_TO_NEW_TABLE(int, d, obj->getNumDim());
+    LUABIND_RETURN_FROM_STACK(-1);
+  }
+  else LUABIND_RETURN(int, d[pos-1]);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf num_dim
+{
+  LUABIND_RETURN(int, obj->getNumDim());
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf stride
+{
+  LUABIND_CHECK_ARGN(>=, 0);
+  LUABIND_CHECK_ARGN(<=, 1);
+  int pos;
+  const int *s=obj->getStridePtr();
+  LUABIND_GET_OPTIONAL_PARAMETER(1, int, pos, -1);
+  if (pos < 1) {
+    LUABIND_VECTOR_TO_NEW_TABLE(int, s, obj->getNumDim());
+    LUABIND_RETURN_FROM_STACK(-1);
+  }
+  else LUABIND_RETURN(int, s[pos-1]);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf slice
+{
+  LUABIND_CHECK_ARGN(>=,2);
+  LUABIND_CHECK_ARGN(<=,3);
+  LUABIND_CHECK_PARAMETER(1, table);
+  LUABIND_CHECK_PARAMETER(2, table);
+  int *coords, *sizes, coords_len, sizes_len;
+  bool clone;
+  LUABIND_TABLE_GETN(1, coords_len);
+  LUABIND_TABLE_GETN(2, sizes_len);
+  if (coords_len != sizes_len || coords_len != obj->getNumDim())
+    LUABIND_FERROR3("Incorrect number of dimensions, expected %d, "
+		    "found %d and %d\n",
+		    obj->getNumDim(), coords_len, sizes_len);
+  coords = new int[coords_len];
+  sizes  = new int[sizes_len];
+  LUABIND_TABLE_TO_VECTOR_SUB1(1, int, coords, coords_len);
+  LUABIND_TABLE_TO_VECTOR(2, int, sizes,  sizes_len);
+  for (int i=0; i<sizes_len; ++i)
+    if (coords[i] < 0 || sizes[i] < 1 ||
+	sizes[i]+coords[i] > obj->getDimSize(i))
+      LUABIND_FERROR1("Incorrect size or coord at position %d\n", i+1);
+  LUABIND_GET_OPTIONAL_PARAMETER(3, bool, clone, false);
+  MatrixHalf *obj2 = new MatrixHalf(obj, coords, sizes, clone);
+  LUABIND_RETURN(MatrixHalf, obj2);
+  delete[] coords;
+  delete[] sizes;
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf select
+{
+  LUABIND_CHECK_ARGN(>=,2);
+  LUABIND_CHECK_ARGN(<=,3);
+  LUABIND_CHECK_PARAMETER(1, int);
+  LUABIND_CHECK_PARAMETER(2, int);
+  int dim, index;
+  MatrixHalf *dest;
+  LUABIND_GET_PARAMETER(1, int, dim);
+  LUABIND_GET_PARAMETER(2, int, index);
+  LUABIND_GET_OPTIONAL_PARAMETER(3, MatrixHalf, dest, 0);
+  MatrixHalf *obj2 = obj->select(dim-1, index-1, dest);
+  LUABIND_RETURN(MatrixHalf, obj2);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf clone
+//DOC_BEGIN
+// matrix *clone()
+/// Devuelve un <em>clon</em> de la matriz.
+//DOC_END
+{
+  MatrixHalf *obj2 = obj->clone();
+  LUABIND_RETURN(MatrixHalf,obj2);
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf transpose
+{
+  int argn;
+  argn = lua_gettop(L);
+  if (argn == 0) {
+    LUABIND_RETURN(MatrixHalf, obj->transpose());
+  }
+  else {
+    int d1,d2;
+    LUABIND_GET_PARAMETER(1, int, d1);
+    LUABIND_GET_PARAMETER(2, int, d2);
+    LUABIND_RETURN(MatrixHalf, obj->transpose(d1-1, d2-1));
+  }
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf toTable
+// Permite salvar una matriz en una tabla lua
+// TODO: Tener en cuenta las dimensiones de la matriz
+  {
+    LUABIND_CHECK_ARGN(==, 0);
+    lua_createtable(L, obj->size(), 0);
+    int index = 1;
+    for (MatrixHalf::iterator it(obj->begin()); it != obj->end(); ++it) {
+      lua_pushnumber(L, static_cast<float>(*it));
+      lua_rawseti(L, -2, index++);
+    }
+    LUABIND_RETURN_FROM_STACK(-1);
+  }
+//BIND_END
+
+//BIND_METHOD MatrixHalf sliding_window
+{
+  int *sub_matrix_size=0, *offset=0, *step=0, *num_steps=0, *order_step=0;
+  int argn = lua_gettop(L); // number of arguments
+  const int num_dim = obj->getNumDim();
+  if (argn > 1)
+    LUABIND_ERROR("incorrect number of arguments");
+  if (argn == 1) {
+    LUABIND_CHECK_PARAMETER(1, table);
+    check_table_fields(L, 1,
+		       "offset",
+		       "size",
+		       "step",
+		       "numSteps",
+		       "orderStep",
+		       (const char*)0);
+    
+    offset = read_vector(L, "offset", num_dim, 0);
+    sub_matrix_size = read_vector(L, "size", num_dim, 0);
+    step = read_vector(L, "step", num_dim, 0);
+    num_steps = read_vector(L, "numSteps", num_dim, 0);
+    order_step = read_vector(L, "orderStep", num_dim, -1);
+  }
+  SlidingWindowMatrixHalf *window = new SlidingWindowMatrixHalf(obj,
+								    sub_matrix_size,
+								    offset,
+								    step,
+								    num_steps,
+								    order_step);
+  LUABIND_RETURN(SlidingWindowMatrixHalf, window);
+  delete[] sub_matrix_size;
+  delete[] offset;
+  delete[] step;
+  delete[] num_steps;
+  delete[] order_step;
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf is_contiguous
+{
+  LUABIND_RETURN(bool, obj->getIsContiguous());
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf to_float
+{
+  MatrixFloat *dest;
+  LUABIND_GET_OPTIONAL_PARAMETER(1, MatrixFloat, dest, 0);
+  if (dest != 0 && !dest->sameDim(obj)) {
+    LUABIND_ERROR("Incompatible matrix sizes");
+  }
+  LUABIND_RETURN(MatrixFloat, convertFromMatrixHalfToMatrixFloat(obj, dest));
+}
+//BIND_END
+
+//BIND_METHOD MatrixHalf copy
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  MatrixHalf *mat;
+  LUABIND_GET_PARAMETER(1, MatrixHalf, mat);
+  LUABIND_RETURN(MatrixHalf, 
+                 matCopy(obj,mat));
+}
+//BIND_END
+
+//// MATRIX SERIALIZATION ////
+
+//BIND_CLASS_METHOD MatrixHalf read
+{
+  MAKE_READ_MATRIX_LUA_METHOD(MatrixHalf, AprilMath::Half);
+  LUABIND_INCREASE_NUM_RETURNS(1);
+}
+//BIND_END
+
+//////////////////////////////////////////////////////////////////////
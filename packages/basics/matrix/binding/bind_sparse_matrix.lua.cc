@@ -25,6 +25,7 @@
 #include "bind_matrix.h"
 #include "bind_matrix_int32.h"
 #include "bind_mathcore.h"
+#include "bind_util.h"
 #include "cmath_overloads.h"
 #include "luabindmacros.h" // for lua_pushfloat and lua_pushint
 #include "luabindutil.h"   // for lua_pushfloat and lua_pushint
@@ -252,14 +253,22 @@ using namespace Basics;
 {
   LUABIND_CHECK_ARGN(>=, 1);
   LUABIND_CHECK_ARGN(<=, 3);
-  LUABIND_CHECK_PARAMETER(1, string);
-  const char *filename;
-  bool write, shared;
-  LUABIND_GET_PARAMETER(1,string,filename);
-  LUABIND_GET_OPTIONAL_PARAMETER(2,bool,write,true);
-  LUABIND_GET_OPTIONAL_PARAMETER(3,bool,shared,true);
   AprilUtils::MMappedDataReader *mmapped_data;
-  mmapped_data = new AprilUtils::MMappedDataReader(filename,write,shared);
+  if (lua_isMMappedDataReader(L,1)) {
+    // a reader shared by several objects, data is aligned by toMMap
+    LUABIND_CHECK_ARGN(==, 1);
+    LUABIND_GET_PARAMETER(1,MMappedDataReader,mmapped_data);
+    mmapped_data->align(64, sizeof(size_t));
+  }
+  else {
+    LUABIND_CHECK_PARAMETER(1, string);
+    const char *filename;
+    bool write, shared;
+    LUABIND_GET_PARAMETER(1,string,filename);
+    LUABIND_GET_OPTIONAL_PARAMETER(2,bool,write,true);
+    LUABIND_GET_OPTIONAL_PARAMETER(3,bool,shared,true);
+    mmapped_data = new AprilUtils::MMappedDataReader(filename,write,shared);
+  }
   IncRef(mmapped_data);
   SparseMatrixFloat *obj = SparseMatrixFloat::fromMMappedDataReader(mmapped_data);
   DecRef(mmapped_data);
@@ -270,10 +279,17 @@ using namespace Basics;
 //BIND_METHOD SparseMatrixFloat toMMap
 {
   LUABIND_CHECK_ARGN(==, 1);
-  const char *filename;
-  LUABIND_GET_PARAMETER(1, string, filename);
   AprilUtils::MMappedDataWriter *mmapped_data;
-  mmapped_data = new AprilUtils::MMappedDataWriter(filename);
+  if (lua_isMMappedDataWriter(L,1)) {
+    // a writer shared by several objects, data is aligned to 64 bytes
+    LUABIND_GET_PARAMETER(1, MMappedDataWriter, mmapped_data);
+    mmapped_data->align(64, sizeof(size_t));
+  }
+  else {
+    const char *filename;
+    LUABIND_GET_PARAMETER(1, string, filename);
+    mmapped_data = new AprilUtils::MMappedDataWriter(filename);
+  }
   IncRef(mmapped_data);
   obj->toMMappedDataWriter(mmapped_data);
   DecRef(mmapped_data);
@@ -286,6 +286,58 @@ namespace AprilMath {
                                         const int N_th = DEFAULT_N_TH,
                                         const unsigned int SIZE_th = DEFAULT_SIZE_TH);
 
+    /**
+     * @brief Applies a span-based binary MAP operation broadcasting its inputs
+     * to the shape of @c dest.
+     *
+     * Input shapes are aligned at their trailing dimensions, as in SciPy
+     * broadcasting, and every input dimension has to be equal to the
+     * corresponding @c dest dimension or equal to 1. Broadcast dimensions are
+     * traversed using a zero stride, so inputs are never replicated and the
+     * whole result is computed in one traversal of @c dest.
+     *
+     * The MAP operation must be a functor with the same header as in
+     * MatrixSpanMap2, taking into account that input strides can be zero.
+     *
+     * @param input1 - The input1 Basics::Matrix, broadcast to @c dest shape.
+     *
+     * @param input2 - The input2 Basics::Matrix, broadcast to @c dest shape.
+     *
+     * @param functor - The functor which computes the MAP operation over a span.
+     *
+     * @param dest - The output Basics::Matrix.
+     *
+     * @note It is possible that @c input1=dest or @c input2=dest and the
+     * computation will be done in-place.
+     *
+     * @note Uses OMP, if available, to improve the performance.
+     */
+    template<typename T1, typename T2, typename O, typename OP>
+    Basics::Matrix<O> *MatrixBroadcastSpanMap2(const Basics::Matrix<T1> *input1,
+                                               const Basics::Matrix<T2> *input2,
+                                               const OP &functor,
+                                               Basics::Matrix<O> *dest,
+                                               const int N_th = DEFAULT_N_TH,
+                                               const unsigned int SIZE_th = DEFAULT_SIZE_TH);
+
+    /**
+     * @brief Applies a scalar-based binary MAP operation broadcasting its
+     * inputs to the shape of @c dest.
+     *
+     * @note This function is a wrapper over MatrixBroadcastSpanMap2 which
+     * converts a scalar functor into span functor using ScalarToSpanMap2
+     * struct.
+     *
+     * @see MatrixBroadcastSpanMap2
+     */
+    template<typename T1, typename T2, typename O, typename OP>
+    Basics::Matrix<O> *MatrixBroadcastScalarMap2(const Basics::Matrix<T1> *input1,
+                                                 const Basics::Matrix<T2> *input2,
+                                                 const OP &functor,
+                                                 Basics::Matrix<O> *dest,
+                                                 const int N_th = DEFAULT_N_TH,
+                                                 const unsigned int SIZE_th = DEFAULT_SIZE_TH);
+
   } // namespace MatrixExt
 
 } // namespace AprilMath
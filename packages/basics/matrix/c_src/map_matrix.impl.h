@@ -27,6 +27,7 @@
 #include "map_matrix.h"
 #include "map_template.h"
 #include "omp_utils.h"
+#include "unique_ptr.h"
 
 namespace AprilMath {
 
@@ -466,6 +467,143 @@ namespace AprilMath {
       return dest;
     } // MatrixMap2 function
 
+    /**
+     * @brief Computes the strides of the given matrix when it is broadcast to
+     * the given @c dest_dim shape, zero for every broadcast dimension.
+     */
+    template<typename T>
+    void computeBroadcastStrides(const Basics::Matrix<T> *m,
+                                 const int *dest_dim, const int D,
+                                 int *stride) {
+      const int shift = D - m->getNumDim();
+      if (shift < 0) {
+        ERROR_EXIT(128, "Incompatible number of dimensions\n");
+      }
+      for (int i=0; i<shift; ++i) stride[i] = 0;
+      for (int i=shift; i<D; ++i) {
+        const int sz = m->getDimSize(i - shift);
+        if (sz == dest_dim[i]) stride[i] = m->getStrideSize(i - shift);
+        else if (sz == 1) stride[i] = 0;
+        else ERROR_EXIT(128, "Not aligned matrix shapes\n");
+      }
+    }
+
+    template<typename T1, typename T2, typename O, typename OP>
+    Basics::Matrix<O> *MatrixBroadcastSpanMap2(const Basics::Matrix<T1> *input1,
+                                               const Basics::Matrix<T2> *input2,
+                                               const OP &functor,
+                                               Basics::Matrix<O> *dest,
+                                               const int N_th,
+                                               const unsigned int SIZE_th) {
+      april_assert(input1 != 0 && input2 != 0 && dest != 0);
+#ifdef NO_OMP
+      UNUSED_VARIABLE(N_th);
+      UNUSED_VARIABLE(SIZE_th);
+#endif
+      bool cuda_flag = input1->getCudaFlag() || input2->getCudaFlag() ||
+        dest->getCudaFlag();
+      const int D = dest->getNumDim();
+      const int *dest_dim = dest->getDimPtr();
+      AprilUtils::UniquePtr<int []> input1_bstride(new int[D]);
+      AprilUtils::UniquePtr<int []> input2_bstride(new int[D]);
+      computeBroadcastStrides(input1, dest_dim, D, input1_bstride.get());
+      computeBroadcastStrides(input2, dest_dim, D, input2_bstride.get());
+      // Collapse adjacent dimensions which are traversed with the same step in
+      // the three matrices, and ignore dimensions of size one.
+      AprilUtils::UniquePtr<int []> size(new int[D]);
+      AprilUtils::UniquePtr<int []> input1_stride(new int[D]);
+      AprilUtils::UniquePtr<int []> input2_stride(new int[D]);
+      AprilUtils::UniquePtr<int []> dest_stride(new int[D]);
+      int M = 0;
+      for (int i=0; i<D; ++i) {
+        const int n = dest_dim[i];
+        if (n == 1) continue;
+        const int s1 = input1_bstride[i];
+        const int s2 = input2_bstride[i];
+        const int sd = dest->getStrideSize(i);
+        if (M > 0 &&
+            input1_stride[M-1] == s1*n &&
+            input2_stride[M-1] == s2*n &&
+            dest_stride[M-1]   == sd*n) {
+          size[M-1] *= n;
+        }
+        else {
+          size[M] = n;
+          ++M;
+        }
+        input1_stride[M-1] = s1;
+        input2_stride[M-1] = s2;
+        dest_stride[M-1]   = sd;
+      }
+      if (M == 0) {
+        size[0] = 1;
+        input1_stride[0] = input2_stride[0] = dest_stride[0] = 0;
+        M = 1;
+      }
+      // The largest collapsed dimension is traversed by the span functor.
+      int span_dim = 0;
+      for (int i=1; i<M; ++i) {
+        if (size[i] > size[span_dim]) span_dim = i;
+      }
+      int N = 1;
+      for (int i=0; i<M; ++i) if (i != span_dim) N *= size[i];
+      const unsigned int span_size = static_cast<unsigned int>(size[span_dim]);
+      const int input1_offset = input1->getOffset();
+      const int input2_offset = input2->getOffset();
+      const int dest_offset   = dest->getOffset();
+#ifdef USE_CUDA
+      // Forces execution of memory copy from GPU to PPAL or viceversa (if
+      // needed), avoiding race conditions on the following.
+      input1->getRawDataAccess()->forceUpdate(cuda_flag);
+      input2->getRawDataAccess()->forceUpdate(cuda_flag);
+#endif
+#ifndef NO_OMP
+      // This if controls the execution using OMP only when the number of threads
+      // is more than 1 and the iterator size is large enough.
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1 && N > N_th && span_size > SIZE_th)
+#endif
+      for (int i=0; i<N; ++i) {
+        // coordinates of the span in row major order, every iteration computes
+        // them from scratch to allow its parallel execution
+        int rem = i;
+        int input1_pos = input1_offset;
+        int input2_pos = input2_offset;
+        int dest_pos   = dest_offset;
+        for (int j=M-1; j>=0; --j) {
+          if (j == span_dim) continue;
+          const int c = rem % size[j];
+          rem /= size[j];
+          input1_pos += c*input1_stride[j];
+          input2_pos += c*input2_stride[j];
+          dest_pos   += c*dest_stride[j];
+        }
+        functor(span_size,
+                input1->getRawDataAccess(),
+                static_cast<unsigned int>(input1_stride[span_dim]),
+                static_cast<unsigned int>(input1_pos),
+                input2->getRawDataAccess(),
+                static_cast<unsigned int>(input2_stride[span_dim]),
+                static_cast<unsigned int>(input2_pos),
+                dest->getRawDataAccess(),
+                static_cast<unsigned int>(dest_stride[span_dim]),
+                static_cast<unsigned int>(dest_pos),
+                cuda_flag);
+      }
+      return dest;
+    } // function MatrixBroadcastSpanMap2
+
+    template<typename T1, typename T2, typename O, typename OP>
+    Basics::Matrix<O> *MatrixBroadcastScalarMap2(const Basics::Matrix<T1> *input1,
+                                                 const Basics::Matrix<T2> *input2,
+                                                 const OP &functor,
+                                                 Basics::Matrix<O> *dest,
+                                                 const int N_th,
+                                                 const unsigned int SIZE_th) {
+      ScalarToSpanMap2<T1,T2,O,OP> span_functor(functor);
+      return MatrixBroadcastSpanMap2(input1, input2, span_functor, dest,
+                                     N_th, SIZE_th);
+    }
+
   } // namespace MatrixExt
 
 } // namespace AprilMath
@@ -0,0 +1,89 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include "binarizer.h"
+#include "constString.h"
+#include "matrixHalf.h"
+
+using AprilMath::Half;
+using AprilUtils::constString;
+
+namespace Basics {
+
+  namespace MatrixIO {
+  
+    /////////////////////////////////////////////////////////////////////////
+  
+    template<>
+    bool AsciiExtractor<Half>::operator()(constString &line,
+                                          Half &destination) {
+      float v;
+      if (!line.extract_float(&v)) return false;
+      destination = Half(v);
+      return true;
+    }
+  
+    template<>
+    bool BinaryExtractor<Half>::operator()(constString &line,
+                                           Half &destination) {
+      if (!line.extract_uint16_binary(&destination.bits)) return false;
+      return true;
+    }
+  
+    template<>
+    int AsciiSizer<Half>::operator()(const Matrix<Half> *mat) {
+      return mat->size()*12;
+    }
+
+    template<>
+    int BinarySizer<Half>::operator()(const Matrix<Half> *mat) {
+      return AprilUtils::binarizer::buffer_size_16(mat->size());
+    }
+
+    template<>
+    void AsciiCoder<Half>::operator()(const Half &value,
+                                      AprilIO::StreamInterface *stream) {
+      const float v = static_cast<float>(value);
+      if (v <= 2048.0f && v >= -2048.0f &&
+          static_cast<float>(static_cast<int>(v)) == v) {
+        stream->printf("%d", static_cast<int>(v));
+      }
+      else {
+        stream->printf("%.5g", v);
+      }
+    }
+  
+    template<>
+    void BinaryCoder<Half>::operator()(const Half &value,
+                                       AprilIO::StreamInterface *stream) {
+      char b[3];
+      AprilUtils::binarizer::code_uint16(value.bits, b);
+      stream->put(b, sizeof(char)*3);
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    
+  } // namespace MatrixIO
+  
+  ///////////////////////////////////////////////////////////////////////////
+
+  template class Matrix<Half>;
+
+} // namespace Basics
@@ -0,0 +1,88 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef MATRIX_HALF_H
+#define MATRIX_HALF_H
+
+#include "half_float.h"
+#include "lua_table.h"
+#include "matrix.h"
+
+namespace Basics {
+
+  namespace MatrixIO {
+      
+    /* Especialization of MatrixHalf ascii and binary extractors, sizers and
+       coders */
+    template<>
+    bool AsciiExtractor<AprilMath::Half>::operator()(AprilUtils::constString &line,
+                                                     AprilMath::Half &destination);
+  
+    template<>
+    bool BinaryExtractor<AprilMath::Half>::operator()(AprilUtils::constString &line,
+                                                      AprilMath::Half &destination);
+  
+    template<>
+    int AsciiSizer<AprilMath::Half>::operator()(const Matrix<AprilMath::Half> *mat);
+
+    template<>
+    int BinarySizer<AprilMath::Half>::operator()(const Matrix<AprilMath::Half> *mat);
+
+    template<>
+    void AsciiCoder<AprilMath::Half>::operator()(const AprilMath::Half &value,
+                                                 AprilIO::StreamInterface *stream);
+  
+    template<>
+    void BinaryCoder<AprilMath::Half>::operator()(const AprilMath::Half &value,
+                                                  AprilIO::StreamInterface *stream);
+  
+  } // namespace MatrixIO
+    
+  ////////////////////////////////////////////////////////////////////////////
+
+  /// Matrix of 16 bits floats, a storage type for large weight matrices.
+  typedef Matrix<AprilMath::Half> MatrixHalf;
+
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+namespace AprilUtils {
+
+  template<> AprilMath::Half LuaTable::
+  convertTo<AprilMath::Half>(lua_State *L, int idx);
+  
+  template<> void LuaTable::
+  pushInto<AprilMath::Half>(lua_State *L, AprilMath::Half value);
+
+  template<> bool LuaTable::
+  checkType<AprilMath::Half>(lua_State *L, int idx);
+
+  template<> Basics::MatrixHalf *LuaTable::
+  convertTo<Basics::MatrixHalf *>(lua_State *L, int idx);
+  
+  template<> void LuaTable::
+  pushInto<Basics::MatrixHalf *>(lua_State *L, Basics::MatrixHalf *value);
+
+  template<> bool LuaTable::
+  checkType<Basics::MatrixHalf *>(lua_State *L, int idx);
+}
+
+#endif // MATRIX_HALF_H
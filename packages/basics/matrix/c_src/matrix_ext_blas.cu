@@ -26,6 +26,7 @@
 #include "realfftwithhamming.h"
 #include "smart_ptr.h"
 #include "sparse_matrix.h"
+#include "utilMatrixHalf.h"
 
 // Must be defined in this order.
 #include "matrix_ext_blas.h"
@@ -38,6 +39,9 @@
 #include "reduce_matrix.h"
 #include "reduce_sparse_matrix.h"
 
+// number of columns of op(B) promoted to float by every panel of matHalfGemm
+#define HALF_GEMM_PANEL_SIZE 256
+
 using Basics::Matrix;
 using Basics::SparseMatrix;
 
@@ -241,6 +245,54 @@ namespace AprilMath {
         return C;
       }
 
+      Matrix<float> *matHalfGemm(Matrix<float> *C,
+                                 CBLAS_TRANSPOSE trans_A,
+                                 CBLAS_TRANSPOSE trans_B,
+                                 const float alpha,
+                                 const Matrix<float> *otherA,
+                                 const Matrix<Half> *otherB,
+                                 float beta) {
+        if (C->getNumDim() != 2 || otherB->getNumDim() != 2) {
+          ERROR_EXIT(128,"Incorrect number of dimensions, only allowed for numDim=2\n");
+        }
+#ifdef USE_CUDA
+        if (C->getCudaFlag() || otherA->getCudaFlag()) {
+          ERROR_EXIT(128, "Half precision GEMM is only available in CPU\n");
+        }
+#endif
+        const int row_idx_B = (trans_B == CblasTrans) ? 1 : 0;
+        const int col_idx_B = (trans_B == CblasTrans) ? 0 : 1;
+        const int M = C->getDimSize(0);
+        const int N = C->getDimSize(1);
+        const int K = otherB->getDimSize(row_idx_B);
+        if (otherB->getDimSize(col_idx_B) != N) {
+          ERROR_EXIT2(128, "Incorrect matrix sizes, op(B) has %d columns "
+                      "and C has %d columns\n",
+                      otherB->getDimSize(col_idx_B), N);
+        }
+        AprilUtils::SharedPtr< Matrix<float> > B_panel;
+        for (int n0=0; n0<N; n0+=HALF_GEMM_PANEL_SIZE) {
+          const int nb = AprilUtils::min(HALF_GEMM_PANEL_SIZE, N - n0);
+          int B_coords[2], B_sizes[2];
+          B_coords[row_idx_B] = 0;  B_sizes[row_idx_B] = K;
+          B_coords[col_idx_B] = n0; B_sizes[col_idx_B] = nb;
+          const int C_coords[2] = { 0, n0 }, C_sizes[2] = { M, nb };
+          AprilUtils::SharedPtr< Matrix<Half> >
+            B_half( new Matrix<Half>(otherB, B_coords, B_sizes, false) );
+          AprilUtils::SharedPtr< Matrix<float> >
+            C_panel( new Matrix<float>(C, C_coords, C_sizes, false) );
+          // the last panel could be narrower than the rest
+          if (B_panel.empty() || !B_panel->sameDim(B_half.get())) {
+            B_panel.reset( new Matrix<float>(2, B_sizes) );
+          }
+          Basics::convertFromMatrixHalfToMatrixFloat(B_half.get(),
+                                                     B_panel.get());
+          matGemm(C_panel.get(), trans_A, trans_B, alpha,
+                  otherA, B_panel.get(), beta);
+        }
+        return C;
+      }
+      
       // MM Sparse BLAS operation C = alpha * op(A)*op(B) + beta*op(C)
       template <typename T>
       Matrix<T> *matSparseMM(Matrix<T> *C,
@@ -629,6 +681,8 @@ namespace AprilMath {
       
       template Matrix<int32_t> *matCopy(Matrix<int32_t> *, const Matrix<int32_t> *);
 
+      template Matrix<Half> *matCopy(Matrix<Half> *, const Matrix<Half> *);
+
       template SparseMatrix<float> *matCopy(SparseMatrix<float> *,
                                             const SparseMatrix<float> *);
       template float matNorm2(SparseMatrix<float> *);
@@ -639,3 +693,5 @@ namespace AprilMath {
     
   } // namespace MatrixExt
 } // namespace AprilMath
+
+#undef HALF_GEMM_PANEL_SIZE
@@ -69,6 +69,24 @@ namespace AprilMath {
                                  const Basics::Matrix<T> *otherB,
                                  T beta);
 
+      /**
+       * @brief Mixed precision GEMM \f$ C = \alpha \text{op}(A) \times \text{op}(B) + \beta C \f$
+       *
+       * The B matrix is stored in half precision and it is promoted to float
+       * by panels of columns of \f$ \text{op}(B) \f$, every panel is
+       * multiplied using float GEMM, so all the accumulations are done in
+       * float precision and only a small float buffer is needed.
+       *
+       * @note Only available for CPU matrices.
+       */
+      Basics::Matrix<float> *matHalfGemm(Basics::Matrix<float> *C,
+                                         CBLAS_TRANSPOSE trans_A,
+                                         CBLAS_TRANSPOSE trans_B,
+                                         const float alpha,
+                                         const Basics::Matrix<float> *otherA,
+                                         const Basics::Matrix<AprilMath::Half> *otherB,
+                                         float beta);
+
       /// MM Sparse BLAS operation \f$ C = \alpha \text{op}(A) \times \text{op}(B) + \beta C \f$
       template <typename T>
       Basics::Matrix<T> *matSparseMM(Basics::Matrix<T> *C,
@@ -120,6 +120,11 @@ namespace AprilMath {
       template Matrix<bool> *matOnes(Matrix<bool> *);
       template Matrix<bool> *matDiag(Matrix<bool> *, const bool);
 
+      template Matrix<Half> *matFill(Matrix<Half> *, const Half);
+      template Matrix<Half> *matZeros(Matrix<Half> *);
+      template Matrix<Half> *matOnes(Matrix<Half> *);
+      template Matrix<Half> *matDiag(Matrix<Half> *, const Half);
+
       template Matrix<int32_t> *matFill(Matrix<int32_t> *, const int32_t);
       template Matrix<int32_t> *matZeros(Matrix<int32_t> *);
       template Matrix<int32_t> *matOnes(Matrix<int32_t> *);
@@ -240,6 +240,58 @@ namespace AprilMath {
         return A;
       }
 
+      void matQR(const Matrix<float> *obj,
+                 Matrix<float> **Q, Matrix<float> **R) {
+        if (obj->getNumDim() != 2) {
+          ERROR_EXIT(128, "Only bi-dimensional matrices are allowed\n");
+        }
+        const int m = obj->getDimSize(0);
+        const int n = obj->getDimSize(1);
+        const int k = (m<n) ? m : n;
+        // AT is the transposed matrix in row major, so A is in col major
+        const int dimsAT[2] = {n, m};
+        AprilUtils::SharedPtr< Matrix<float> > AT( new Matrix<float>(2, dimsAT) );
+        {
+          Matrix<float>::random_access_iterator at_it(AT.get());
+          Matrix<float>::const_random_access_iterator obj_it(obj);
+          for (int i=0; i<m; ++i) {
+            for (int j=0; j<n; ++j) {
+              at_it(j,i) = obj_it(i,j);
+            }
+          }
+        }
+        AprilUtils::UniquePtr<float []> TAU( new float[k] );
+        float *A_ptr = AT->getRawDataAccess()->getPPALForReadAndWrite();
+        int INFO;
+        INFO = clapack_sgeqrf(CblasColMajor, m, n, AT->getStrideSize(0),
+                              A_ptr, TAU.get());
+        checkLapackInfo(INFO);
+        // R is the upper triangle of the first k rows of A
+        const int dimsR[2] = {k, n};
+        *R = new Matrix<float>(2, dimsR);
+        {
+          Matrix<float>::random_access_iterator r_it(*R);
+          Matrix<float>::const_random_access_iterator a_it(AT.get());
+          for (int i=0; i<k; ++i) {
+            for (int j=0; j<n; ++j) {
+              r_it(i,j) = (j<i) ? 0.0f : a_it(j,i);
+            }
+          }
+        }
+        // Q is generated over the first k columns of A
+        INFO = clapack_sorgqr(CblasColMajor, m, k, k, AT->getStrideSize(0),
+                              A_ptr, TAU.get());
+        checkLapackInfo(INFO);
+        const int coords[2] = {0, 0};
+        const int sizes[2]  = {k, m};
+        AprilUtils::SharedPtr< Matrix<float> > QT( new Matrix<float>(AT.get(),
+                                                                     coords,
+                                                                     sizes,
+                                                                     false) );
+        AprilUtils::SharedPtr< Matrix<float> > Qview( QT->transpose() );
+        *Q = Qview->clone();
+      }
+
     } // namespace LAPACK
     
   } // namespace MatrixExt
@@ -74,6 +74,16 @@ namespace AprilMath {
        */
       Basics::Matrix<float> * matCholesky(const Basics::Matrix<float> *obj,
                                           char uplo);
+
+      /**
+       * @brief Computes the reduced QR decomposition of the given matrix.
+       *
+       * For a MxN matrix and K=min(M,N), Q is a MxK matrix with orthonormal
+       * columns and R is a KxN upper triangular matrix, so A = Q * R. Both are
+       * given by reference.
+       */
+      void matQR(const Basics::Matrix<float> *obj,
+                 Basics::Matrix<float> **Q, Basics::Matrix<float> **R);
       
     } // namespace LAPACK
     
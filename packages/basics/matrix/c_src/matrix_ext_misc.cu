@@ -121,6 +121,56 @@ namespace AprilMath {
         if (c == 0) c = a->clone();
         return AprilMath::MatrixExt::BLAS::matAxpy(c, T(-1.0f), b);
       }
+
+      /// For the implementation of matBroadcast* functions.
+      template <typename T, typename OP>
+      Matrix<T> *matBroadcastScalarMap(const OP &functor,
+                                       const Matrix<T> *a,
+                                       const Matrix<T> *b,
+                                       Matrix<T> *c) {
+        const int N = AprilUtils::max(a->getNumDim(), b->getNumDim());
+        AprilUtils::UniquePtr<int []> shape =
+          BroadcastHelper::resultShape(a->getDimPtr(), a->getNumDim(),
+                                       b->getDimPtr(), b->getNumDim());
+        if (c == 0) {
+          c = new Matrix<T>(N, shape.get());
+#ifdef USE_CUDA
+          c->setUseCuda(a->getCudaFlag() || b->getCudaFlag());
+#endif
+        }
+        else if (!c->sameDim(shape.get(), N)) {
+          ERROR_EXIT(128, "Incompatible shape in result matrix\n");
+        }
+        return MatrixBroadcastScalarMap2<T,T,T>(a, b, functor, c);
+      }
+
+      template <typename T>
+      Matrix<T> *matBroadcastAddition(const Matrix<T> *a,
+                                      const Matrix<T> *b,
+                                      Matrix<T> *c) {
+        return matBroadcastScalarMap(AprilMath::Functors::m_add<T>(), a, b, c);
+      }
+
+      template <typename T>
+      Matrix<T> *matBroadcastSubstraction(const Matrix<T> *a,
+                                          const Matrix<T> *b,
+                                          Matrix<T> *c) {
+        return matBroadcastScalarMap(AprilMath::Functors::m_sub<T>(), a, b, c);
+      }
+
+      template <typename T>
+      Matrix<T> *matBroadcastCmul(const Matrix<T> *a,
+                                  const Matrix<T> *b,
+                                  Matrix<T> *c) {
+        return matBroadcastScalarMap(AprilMath::Functors::m_mul<T>(), a, b, c);
+      }
+
+      template <typename T>
+      Matrix<T> *matBroadcastDiv(const Matrix<T> *a,
+                                 const Matrix<T> *b,
+                                 Matrix<T> *c) {
+        return matBroadcastScalarMap(AprilMath::Functors::m_div<T>(), a, b, c);
+      }
     
       template <typename T>
       Matrix<T> *matMultiply(const Matrix<T> *a,
@@ -296,6 +346,18 @@ namespace AprilMath {
       template Matrix<float> *matMultiply(const Matrix<float> *,
                                           const Matrix<float> *,
                                           Matrix<float> *);
+      template Matrix<float> *matBroadcastAddition(const Matrix<float> *,
+                                                   const Matrix<float> *,
+                                                   Matrix<float> *);
+      template Matrix<float> *matBroadcastSubstraction(const Matrix<float> *,
+                                                       const Matrix<float> *,
+                                                       Matrix<float> *);
+      template Matrix<float> *matBroadcastCmul(const Matrix<float> *,
+                                               const Matrix<float> *,
+                                               Matrix<float> *);
+      template Matrix<float> *matBroadcastDiv(const Matrix<float> *,
+                                              const Matrix<float> *,
+                                              Matrix<float> *);
       template Matrix<float> *matConvertTo(const Matrix<bool> *,
                                            Matrix<float> *);
       template Matrix<float> *matConvertTo(const Matrix<double> *,
@@ -322,6 +384,18 @@ namespace AprilMath {
       template Matrix<double> *matMultiply(const Matrix<double> *,
                                           const Matrix<double> *,
                                           Matrix<double> *);
+      template Matrix<double> *matBroadcastAddition(const Matrix<double> *,
+                                                    const Matrix<double> *,
+                                                    Matrix<double> *);
+      template Matrix<double> *matBroadcastSubstraction(const Matrix<double> *,
+                                                        const Matrix<double> *,
+                                                        Matrix<double> *);
+      template Matrix<double> *matBroadcastCmul(const Matrix<double> *,
+                                                const Matrix<double> *,
+                                                Matrix<double> *);
+      template Matrix<double> *matBroadcastDiv(const Matrix<double> *,
+                                               const Matrix<double> *,
+                                               Matrix<double> *);
       template Matrix<double> *matConvertTo(const Matrix<bool> *,
                                             Matrix<double> *);
       template Matrix<double> *matConvertTo(const Matrix<float> *,
@@ -342,6 +416,15 @@ namespace AprilMath {
       template Matrix<ComplexF> *matMultiply(const Matrix<ComplexF> *,
                                              const Matrix<ComplexF> *,
                                              Matrix<ComplexF> *);
+      template Matrix<ComplexF> *matBroadcastAddition(const Matrix<ComplexF> *,
+                                                      const Matrix<ComplexF> *,
+                                                      Matrix<ComplexF> *);
+      template Matrix<ComplexF> *matBroadcastSubstraction(const Matrix<ComplexF> *,
+                                                          const Matrix<ComplexF> *,
+                                                          Matrix<ComplexF> *);
+      template Matrix<ComplexF> *matBroadcastCmul(const Matrix<ComplexF> *,
+                                                  const Matrix<ComplexF> *,
+                                                  Matrix<ComplexF> *);
 
       template Matrix<char> *matConvertTo(const Matrix<bool> *,
                                           Matrix<char> *);
@@ -110,27 +110,6 @@ namespace AprilMath {
 
       class BroadcastHelper {
       
-        static AprilUtils::UniquePtr<int []> resultShape(const int *a_dim, const int Na,
-                                                         const int *b_dim, const int Nb) {
-          const int minN = AprilUtils::min(Na, Nb);
-          const int maxN = AprilUtils::max(Na, Nb);
-          int *shape = new int[maxN];
-          for (int i=0; i<minN; ++i) {
-            int n = a_dim[i], m = b_dim[i];
-            if (n != m && n != 1 && m != 1) {
-              ERROR_EXIT(256, "Not aligned matrix shapes\n");
-            }
-            shape[i] = AprilUtils::max(n, m);
-          }
-          if (maxN == Na) {
-            for (int i=minN; i<maxN; ++i) shape[i] = a_dim[i];
-          }
-          else {
-            for (int i=minN; i<maxN; ++i) shape[i] = b_dim[i];
-          }
-          return shape;
-        }
-
         template<typename T, typename OP>
         static void broadcast(const OP &func,
                               AprilUtils::SharedPtr<Basics::Matrix<T> > dest,
@@ -138,12 +117,19 @@ namespace AprilMath {
           AprilUtils::SharedPtr< Basics::Matrix<T> > other_squeezed;
           AprilUtils::SharedPtr< Basics::Matrix<T> > dest_slice;
           AprilUtils::SharedPtr< Basics::Matrix<T> > dest_slice_squeezed;
+          // other shape aligned at the trailing dimensions of dest
+          const int N = dest->getNumDim(), Nother = other->getNumDim();
+          AprilUtils::UniquePtr<int []> other_dim(new int[N]);
+          for (int i=0; i<N-Nother; ++i) other_dim[i] = 1;
+          for (int i=N-Nother; i<N; ++i) {
+            other_dim[i] = other->getDimSize(i - (N-Nother));
+          }
           other_squeezed = other->constSqueeze();
           typename Basics::Matrix<T>::sliding_window
             dest_sw(dest.get(),
-                    dest->getDimPtr(),  // sub_matrix_size
-                    0,                  // offset
-                    dest->getDimPtr()); // step
+                    other_dim.get(),  // sub_matrix_size
+                    0,                // offset
+                    other_dim.get()); // step
           while(!dest_sw.isEnd()) {
             dest_slice = dest_sw.getMatrix(dest_slice.get());
             if (dest_slice_squeezed.empty()) {
@@ -168,6 +154,27 @@ namespace AprilMath {
         };
 
       public:
+
+        /**
+         * @brief Computes the shape of a broadcast result.
+         *
+         * Shapes are aligned at their trailing dimensions, as in SciPy.
+         */
+        static AprilUtils::UniquePtr<int []> resultShape(const int *a_dim, const int Na,
+                                                         const int *b_dim, const int Nb) {
+          const int maxN = AprilUtils::max(Na, Nb);
+          int *shape = new int[maxN];
+          for (int i=0; i<maxN; ++i) {
+            const int ai = i - (maxN - Na), bi = i - (maxN - Nb);
+            int n = (ai < 0) ? 1 : a_dim[ai];
+            int m = (bi < 0) ? 1 : b_dim[bi];
+            if (n != m && n != 1 && m != 1) {
+              ERROR_EXIT(256, "Not aligned matrix shapes\n");
+            }
+            shape[i] = AprilUtils::max(n, m);
+          }
+          return shape;
+        }
         
         /**
          * @see AprilMath::MatrixExt::Misc::matBroadcast
@@ -221,6 +228,42 @@ namespace AprilMath {
         return BroadcastHelper::execute(func, a, b, result).weakRelease();
       }
       
+      /**
+       * @brief Returns the result of \f$ C = A + B \f$ broadcasting A and B
+       * shapes as in SciPy.
+       *
+       * The result is computed in one traversal of C, broadcast dimensions of
+       * A and B are traversed with zero stride.
+       *
+       * @note If the given @c c argument is 0, this operation allocates a
+       * new destination matrix, otherwise uses the given matrix, which can be
+       * @c a or @c b when its shape is the broadcast shape.
+       *
+       * @see AprilMath::MatrixExt::MatrixBroadcastScalarMap2
+       */
+      template <typename T>
+      Basics::Matrix<T> *matBroadcastAddition(const Basics::Matrix<T> *a,
+                                              const Basics::Matrix<T> *b,
+                                              Basics::Matrix<T> *c = 0);
+
+      /// Broadcast version of \f$ C = A - B \f$, see matBroadcastAddition.
+      template <typename T>
+      Basics::Matrix<T> *matBroadcastSubstraction(const Basics::Matrix<T> *a,
+                                                  const Basics::Matrix<T> *b,
+                                                  Basics::Matrix<T> *c = 0);
+
+      /// Broadcast version of \f$ C = A \circ B \f$, see matBroadcastAddition.
+      template <typename T>
+      Basics::Matrix<T> *matBroadcastCmul(const Basics::Matrix<T> *a,
+                                          const Basics::Matrix<T> *b,
+                                          Basics::Matrix<T> *c = 0);
+
+      /// Broadcast version of \f$ C = A / B \f$, see matBroadcastAddition.
+      template <typename T>
+      Basics::Matrix<T> *matBroadcastDiv(const Basics::Matrix<T> *a,
+                                         const Basics::Matrix<T> *b,
+                                         Basics::Matrix<T> *c = 0);
+      
       /**
        * @brief Changes the type of a matrix instance.
        */
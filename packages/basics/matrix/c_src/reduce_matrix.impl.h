@@ -25,15 +25,48 @@
 #include "matrix.h"
 
 #include "april_assert.h"
+#include "maxmin.h"
 #include "omp_utils.h"
 #include "reduce_matrix.h"
 #include "reduce_template.h"
 #include "smart_ptr.h"
 
+// Size of the chunks in which large contiguous inputs are split for whole
+// matrix reductions. It is fixed (not dependent on the number of threads), so
+// the combination tree and the result are deterministic.
+#define REDUCE_CHUNK_SIZE 32768u
+// Minimum number of reduced elements for OMP execution of reductions over
+// dimensions.
+#define REDUCE_OMP_SIZE_TH 16384
+
 namespace AprilMath {
 
   namespace MatrixExt {
 
+    /**
+     * @brief Combines pairwise the partial results of a whole matrix reduction
+     * and reduces the combination into the given @c dest position.
+     *
+     * @see AprilMath::pairwiseReducePartials
+     */
+    template<typename O, typename OP>
+    void reducePartialsIntoDest(AprilMath::GPUMirroredMemoryBlock<O> *partials,
+                                unsigned int N,
+                                const OP &intra_span_red_functor,
+                                AprilMath::GPUMirroredMemoryBlock<O> *dest,
+                                unsigned int dest_raw_pos,
+                                bool set_dest_to_zero) {
+      O result = pairwiseReducePartials(partials->getPPALForReadAndWrite(), N,
+                                        intra_span_red_functor);
+      if (set_dest_to_zero) {
+        dest->getPPALForWrite()[dest_raw_pos] = result;
+      }
+      else {
+        intra_span_red_functor(dest->getPPALForReadAndWrite()[dest_raw_pos],
+                               result);
+      }
+    }
+
     template<typename T, typename OP>
     Basics::Matrix<T> * MatrixScalarReduceMinMaxOverDimension(const Basics::Matrix<T> *input,
                                                               int dim,
@@ -81,8 +114,58 @@ namespace AprilMath {
       //                          set_dest_to_zero);
       // }
       
+      // One dimension, large enough to be split in chunks
+      if (input->getNumDim() == 1 && !cuda_flag &&
+          static_cast<unsigned int>(input->size()) > REDUCE_CHUNK_SIZE) {
+        const unsigned int size   = static_cast<unsigned int>(input->size());
+        const unsigned int stride = static_cast<unsigned int>(input->getStrideSize(0));
+        const unsigned int offset = static_cast<unsigned int>(input->getOffset());
+        const int num_chunks = static_cast<int>((size + REDUCE_CHUNK_SIZE - 1) /
+                                                REDUCE_CHUNK_SIZE);
+        AprilMath::GPUMirroredMemoryBlock<O> partials(num_chunks);
+        AprilMath::GPUMirroredMemoryBlock<int32_t> partials_which(num_chunks);
+        const AprilMath::GPUMirroredMemoryBlock<T> *input_mem = input->getRawDataAccess();
+#ifndef NO_OMP
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1)
+#endif
+        for (int c=0; c<num_chunks; ++c) {
+          const unsigned int first = static_cast<unsigned int>(c)*REDUCE_CHUNK_SIZE;
+          inter_span_red_functor(AprilUtils::min(size - first, REDUCE_CHUNK_SIZE),
+                                 input_mem, stride, offset + first*stride,
+                                 false, zero, intra_span_red_functor,
+                                 &partials_which, static_cast<unsigned int>(c),
+                                 &partials, static_cast<unsigned int>(c),
+                                 true);
+        }
+        // argmin/argmax of every chunk are relative to the chunk start
+        int32_t *partials_which_ptr = partials_which.getPPALForReadAndWrite();
+        for (int c=0; c<num_chunks; ++c) {
+          if (partials_which_ptr[c] > 0) {
+            partials_which_ptr[c] += c*static_cast<int32_t>(REDUCE_CHUNK_SIZE);
+          }
+        }
+        int32_t result_which;
+        O result = pairwiseReduceMinMaxPartials(partials.getPPALForReadAndWrite(),
+                                                partials_which_ptr,
+                                                static_cast<unsigned int>(num_chunks),
+                                                result_which,
+                                                intra_span_red_functor);
+        O *dest_ptr;
+        int32_t *which_ptr;
+        if (set_dest_to_zero) {
+          dest_ptr  = dest->getPPALForWrite() + dest_raw_pos;
+          which_ptr = which->getPPALForWrite() + which_raw_pos;
+          *dest_ptr  = result;
+          *which_ptr = result_which;
+        }
+        else {
+          dest_ptr  = dest->getPPALForReadAndWrite() + dest_raw_pos;
+          which_ptr = which->getPPALForReadAndWrite() + which_raw_pos;
+          intra_span_red_functor(*dest_ptr, result, *which_ptr, result_which);
+        }
+      }
       // One dimension
-      if (input->getNumDim() == 1) {
+      else if (input->getNumDim() == 1) {
         inter_span_red_functor(static_cast<unsigned int>(input->size()),
                                input->getRawDataAccess(),
                                static_cast<unsigned int>(input->getStrideSize(0)),
@@ -182,10 +265,43 @@ namespace AprilMath {
                     "expected %d, found %d\n", result_size, result->size());
       }
       typename Basics::Matrix<T>::span_iterator span_it(input, span_order.get());
-      typename Basics::Matrix<int32_t>::pos_iterator it2(result2);
       unsigned int span_size   = static_cast<unsigned int>(span_it.getSize());
       unsigned int span_stride = static_cast<unsigned int>(span_it.getStride());
       april_assert(span_it.numberOfIterations() == result->size());
+#ifndef NO_OMP
+      // every output position is independent, so they are distributed between
+      // threads when the result is contiguous (its raw position is given by the
+      // iteration number)
+      const int N = span_it.numberOfIterations();
+      if (!cuda_flag && N > 1 &&
+          result->getIsContiguous() && result2->getIsContiguous() &&
+          OMPUtils::get_num_threads() > 1 &&
+          static_cast<long>(N)*span_size > REDUCE_OMP_SIZE_TH) {
+        const AprilMath::GPUMirroredMemoryBlock<T> *input_mem = input->getRawDataAccess();
+        AprilMath::GPUMirroredMemoryBlock<T> *dest_mem = result->getRawDataAccess();
+        AprilMath::GPUMirroredMemoryBlock<int32_t> *which_mem = result2->getRawDataAccess();
+        const int dest_offset  = result->getOffset();
+        const int which_offset = result2->getOffset();
+#pragma omp parallel for firstprivate(span_it)
+        for (int i=0; i<N; ++i) {
+          span_it.setAtIteration(i);
+          inter_span_red_functor(span_size,
+                                 input_mem,
+                                 span_stride,
+                                 static_cast<unsigned int>(span_it.getOffset()),
+                                 cuda_flag,
+                                 zero,
+                                 intra_span_red_functor,
+                                 which_mem,
+                                 static_cast<unsigned int>(which_offset + i),
+                                 dest_mem,
+                                 static_cast<unsigned int>(dest_offset + i),
+                                 set_dest_to_zero);
+        }
+        return result;
+      }
+#endif
+      typename Basics::Matrix<int32_t>::pos_iterator it2(result2);
       // traverse in row major order
       for (typename Basics::Matrix<T>::pos_iterator it(result);
            !it.isEnd(); ++it, ++it2, ++span_it) {
@@ -270,6 +386,32 @@ namespace AprilMath {
       unsigned int span_size   = static_cast<unsigned int>(span_it.getSize());
       unsigned int span_stride = static_cast<unsigned int>(span_it.getStride());
       april_assert(span_it.numberOfIterations() == result->size());
+#ifndef NO_OMP
+      // every output position is independent, see
+      // MatrixSpanReduceMinMaxOverDimension
+      const int N = span_it.numberOfIterations();
+      if (!cuda_flag && N > 1 && result->getIsContiguous() &&
+          OMPUtils::get_num_threads() > 1 &&
+          static_cast<long>(N)*span_size > REDUCE_OMP_SIZE_TH) {
+        const AprilMath::GPUMirroredMemoryBlock<T> *input_mem = input->getRawDataAccess();
+        AprilMath::GPUMirroredMemoryBlock<O> *dest_mem = result->getRawDataAccess();
+        const int dest_offset = result->getOffset();
+#pragma omp parallel for firstprivate(span_it)
+        for (int i=0; i<N; ++i) {
+          span_it.setAtIteration(i);
+          inter_span_red_functor(span_size,
+                                 input_mem,
+                                 span_stride,
+                                 static_cast<unsigned int>(span_it.getOffset()),
+                                 cuda_flag,
+                                 zero, intra_span_red_functor,
+                                 dest_mem,
+                                 static_cast<unsigned int>(dest_offset + i),
+                                 set_dest_to_zero);
+        }
+        return result;
+      }
+#endif
       // traverse in row major order
       for (typename Basics::Matrix<O>::pos_iterator it(result);
            !it.isEnd(); ++it, ++span_it) {
@@ -323,6 +465,7 @@ namespace AprilMath {
       april_assert(input != 0);
       if (dest == 0) ERROR_EXIT(128, "Expected a non-NULL dest pointer\n");
       bool cuda_flag = input->getCudaFlag();
+      const AprilMath::GPUMirroredMemoryBlock<T> *input_mem = input->getRawDataAccess();
       // Contiguous memory block or one dimension.
       if (input->getIsContiguous() || input->getNumDim() == 1) {
         unsigned int size = static_cast<unsigned int>(input->size());
@@ -336,13 +479,38 @@ namespace AprilMath {
           // One dimension.
           input_stride = static_cast<unsigned int>(input->getStrideSize(0));
         }
-        inter_span_red_functor(size,
-                               input->getRawDataAccess(),
-                               input_stride, input_offset,
-                               cuda_flag,
-                               zero, intra_span_red_functor,
-                               dest, dest_raw_pos,
-                               set_dest_to_zero);
+        if (!cuda_flag && size > REDUCE_CHUNK_SIZE) {
+          // Large inputs are split in chunks which are reduced in parallel and
+          // combined pairwise.
+          const int num_chunks = static_cast<int>((size + REDUCE_CHUNK_SIZE - 1) /
+                                                  REDUCE_CHUNK_SIZE);
+          AprilMath::GPUMirroredMemoryBlock<O> partials(num_chunks);
+#ifndef NO_OMP
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1)
+#endif
+          for (int c=0; c<num_chunks; ++c) {
+            const unsigned int first = static_cast<unsigned int>(c)*REDUCE_CHUNK_SIZE;
+            inter_span_red_functor(AprilUtils::min(size - first, REDUCE_CHUNK_SIZE),
+                                   input_mem,
+                                   input_stride, input_offset + first*input_stride,
+                                   false,
+                                   zero, intra_span_red_functor,
+                                   &partials, static_cast<unsigned int>(c),
+                                   true);
+          }
+          reducePartialsIntoDest(&partials, static_cast<unsigned int>(num_chunks),
+                                 intra_span_red_functor,
+                                 dest, dest_raw_pos, set_dest_to_zero);
+        }
+        else {
+          inter_span_red_functor(size,
+                                 input_mem,
+                                 input_stride, input_offset,
+                                 cuda_flag,
+                                 zero, intra_span_red_functor,
+                                 dest, dest_raw_pos,
+                                 set_dest_to_zero);
+        }
       }
       // General case
       else {
@@ -350,20 +518,44 @@ namespace AprilMath {
         unsigned int size   = static_cast<unsigned int>(span_it.getSize());
         unsigned int stride = static_cast<unsigned int>(span_it.getStride());
         const int N = span_it.numberOfIterations();
-        for (int i=0; i<N; ++i) {
-          april_assert(span_it != input->end_span_iterator());
-          inter_span_red_functor(size,
-                                 input->getRawDataAccess(),
-                                 stride,
-                                 span_it.getOffset(),
-                                 cuda_flag,
-                                 zero, intra_span_red_functor,
-                                 dest, dest_raw_pos,
-                                 set_dest_to_zero);
-          set_dest_to_zero = false; // use only in the first iteration
-          ++span_it;
+        if (!cuda_flag) {
+          // Every span is reduced into its own partial result, in parallel
+          // when it is large enough, and partials are combined pairwise.
+          AprilMath::GPUMirroredMemoryBlock<O> partials(N);
+#ifndef NO_OMP
+#pragma omp parallel for firstprivate(span_it) if(OMPUtils::get_num_threads() > 1 && static_cast<long>(N)*size > REDUCE_OMP_SIZE_TH)
+#endif
+          for (int i=0; i<N; ++i) {
+            span_it.setAtIteration(i);
+            inter_span_red_functor(size,
+                                   input_mem,
+                                   stride,
+                                   static_cast<unsigned int>(span_it.getOffset()),
+                                   false,
+                                   zero, intra_span_red_functor,
+                                   &partials, static_cast<unsigned int>(i),
+                                   true);
+          }
+          reducePartialsIntoDest(&partials, static_cast<unsigned int>(N),
+                                 intra_span_red_functor,
+                                 dest, dest_raw_pos, set_dest_to_zero);
+        }
+        else {
+          for (int i=0; i<N; ++i) {
+            april_assert(span_it != input->end_span_iterator());
+            inter_span_red_functor(size,
+                                   input_mem,
+                                   stride,
+                                   span_it.getOffset(),
+                                   cuda_flag,
+                                   zero, intra_span_red_functor,
+                                   dest, dest_raw_pos,
+                                   set_dest_to_zero);
+            set_dest_to_zero = false; // use only in the first iteration
+            ++span_it;
+          }
+          april_assert(span_it == input->end_span_iterator());
         }
-        april_assert(span_it == input->end_span_iterator());
       }
     } // function MatrixSpanReduce1
 
@@ -415,6 +607,7 @@ namespace AprilMath {
       UNUSED_VARIABLE(SIZE_th);
 #endif
       bool cuda_flag = input->getCudaFlag();
+      const AprilMath::GPUMirroredMemoryBlock<T> *input_mem = input->getRawDataAccess();
       // Contiguous memory block or one dimension.
       if (input->getIsContiguous() || input->getNumDim() == 1) {
         unsigned int size = static_cast<unsigned int>(input->size());
@@ -428,13 +621,37 @@ namespace AprilMath {
           // One dimension.
           input_stride = static_cast<unsigned int>(input->getStrideSize(0));
         }
-        inter_span_red_functor(size,
-                               input->getRawDataAccess(),
-                               input_stride, input_offset,
-                               cuda_flag,
-                               T(0.0f), AprilMath::Functors::r_add<T,T>(),
-                               dest, dest_raw_pos,
-                               set_dest_to_zero);
+        if (!cuda_flag && size > REDUCE_CHUNK_SIZE) {
+          // Large inputs are split in chunks, see MatrixSpanReduce1.
+          const int num_chunks = static_cast<int>((size + REDUCE_CHUNK_SIZE - 1) /
+                                                  REDUCE_CHUNK_SIZE);
+          AprilMath::GPUMirroredMemoryBlock<T> partials(num_chunks);
+#ifndef NO_OMP
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1)
+#endif
+          for (int c=0; c<num_chunks; ++c) {
+            const unsigned int first = static_cast<unsigned int>(c)*REDUCE_CHUNK_SIZE;
+            inter_span_red_functor(AprilUtils::min(size - first, REDUCE_CHUNK_SIZE),
+                                   input_mem,
+                                   input_stride, input_offset + first*input_stride,
+                                   false,
+                                   T(0.0f), AprilMath::Functors::r_add<T,T>(),
+                                   &partials, static_cast<unsigned int>(c),
+                                   true);
+          }
+          reducePartialsIntoDest(&partials, static_cast<unsigned int>(num_chunks),
+                                 AprilMath::Functors::r_add<T,T>(),
+                                 dest, dest_raw_pos, set_dest_to_zero);
+        }
+        else {
+          inter_span_red_functor(size,
+                                 input_mem,
+                                 input_stride, input_offset,
+                                 cuda_flag,
+                                 T(0.0f), AprilMath::Functors::r_add<T,T>(),
+                                 dest, dest_raw_pos,
+                                 set_dest_to_zero);
+        }
       }
       // General case
       else {
@@ -442,41 +659,36 @@ namespace AprilMath {
         unsigned int size   = static_cast<unsigned int>(span_it.getSize());
         unsigned int stride = static_cast<unsigned int>(span_it.getStride());
         const int N = span_it.numberOfIterations();
+        if (!cuda_flag) {
+          // Every span is reduced into its own partial result and partials
+          // are combined pairwise, so the result doesn't depend on the number
+          // of threads.
+          AprilMath::GPUMirroredMemoryBlock<T> partials(N);
 #ifndef NO_OMP
-        // this if controls the execution using OMP only when the number of threads
-        // is more than 1 and the iterator size is big enough
-        if (OMPUtils::get_num_threads() > 1 && N > N_th && size > SIZE_th) {
-          T result;
-          if (set_dest_to_zero) result = T(0.0f);
-          else dest->getValue(dest_raw_pos, result);
-          GPUMirroredMemoryBlock<T> aux(1);
-          T partial;
-#ifdef USE_CUDA
-          // Forces execution of memory copy from GPU to PPAL or viceversa (if
-          // needed), avoiding race conditions on the following.
-          input->getRawDataAccess()->forceUpdate(cuda_flag);
+          // this if controls the execution using OMP only when the number of
+          // threads is more than 1 and the iterator size is big enough
+#pragma omp parallel for firstprivate(span_it) if(OMPUtils::get_num_threads() > 1 && N > N_th && size > SIZE_th)
 #endif
-#pragma omp parallel for reduction(+:result) firstprivate(span_it)
           for (int i=0; i<N; ++i) {
             span_it.setAtIteration(i);
             inter_span_red_functor(size,
-                                   input->getRawDataAccess(),
+                                   input_mem,
                                    stride,
-                                   span_it.getOffset(),
-                                   cuda_flag,
+                                   static_cast<unsigned int>(span_it.getOffset()),
+                                   false,
                                    T(0.0f), AprilMath::Functors::r_add<T,T>(),
-                                   &aux, 0, true);
-            aux.getValue(0, partial);
-            result += partial;
+                                   &partials, static_cast<unsigned int>(i),
+                                   true);
           }
-          dest->putValue(dest_raw_pos, result);
+          reducePartialsIntoDest(&partials, static_cast<unsigned int>(N),
+                                 AprilMath::Functors::r_add<T,T>(),
+                                 dest, dest_raw_pos, set_dest_to_zero);
         }
         else {
-#endif
           for (int i=0; i<N; ++i) {
             april_assert(span_it != input->end_span_iterator());
             inter_span_red_functor(size,
-                                   input->getRawDataAccess(),
+                                   input_mem,
                                    stride,
                                    span_it.getOffset(),
                                    cuda_flag,
@@ -487,9 +699,7 @@ namespace AprilMath {
             ++span_it;
           }
           april_assert(span_it == input->end_span_iterator());
-#ifndef NO_OMP
         }
-#endif
       } // General case
     } // function MatrixSpanSumReduce1
 
@@ -520,6 +730,8 @@ namespace AprilMath {
         ERROR_EXIT(128, "Incompatible matrix sizes\n");
       }
       bool cuda_flag = input1->getCudaFlag() || input2->getCudaFlag();
+      const AprilMath::GPUMirroredMemoryBlock<T1> *input1_mem = input1->getRawDataAccess();
+      const AprilMath::GPUMirroredMemoryBlock<T2> *input2_mem = input2->getRawDataAccess();
       // Contiguous memory block or one dimension.
       if ( (input1->getIsContiguous() || input1->getNumDim() == 1) &&
            (input2->getIsContiguous() || input2->getNumDim() == 1) ) {
@@ -543,15 +755,41 @@ namespace AprilMath {
           // One dimension.
           input2_stride = static_cast<unsigned int>(input2->getStrideSize(0));
         }
-        inter_span_red_functor(size,
-                               input1->getRawDataAccess(),
-                               input1_stride, input1_offset,
-                               input2->getRawDataAccess(),
-                               input2_stride, input2_offset,
-                               cuda_flag,
-                               zero, intra_span_red_functor,
-                               dest, dest_raw_pos,
-                               set_dest_to_zero);
+        if (!cuda_flag && size > REDUCE_CHUNK_SIZE) {
+          // Large inputs are split in chunks, see MatrixSpanReduce1.
+          const int num_chunks = static_cast<int>((size + REDUCE_CHUNK_SIZE - 1) /
+                                                  REDUCE_CHUNK_SIZE);
+          AprilMath::GPUMirroredMemoryBlock<O> partials(num_chunks);
+#ifndef NO_OMP
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1)
+#endif
+          for (int c=0; c<num_chunks; ++c) {
+            const unsigned int first = static_cast<unsigned int>(c)*REDUCE_CHUNK_SIZE;
+            inter_span_red_functor(AprilUtils::min(size - first, REDUCE_CHUNK_SIZE),
+                                   input1_mem,
+                                   input1_stride, input1_offset + first*input1_stride,
+                                   input2_mem,
+                                   input2_stride, input2_offset + first*input2_stride,
+                                   false,
+                                   zero, intra_span_red_functor,
+                                   &partials, static_cast<unsigned int>(c),
+                                   true);
+          }
+          reducePartialsIntoDest(&partials, static_cast<unsigned int>(num_chunks),
+                                 intra_span_red_functor,
+                                 dest, dest_raw_pos, set_dest_to_zero);
+        }
+        else {
+          inter_span_red_functor(size,
+                                 input1_mem,
+                                 input1_stride, input1_offset,
+                                 input2_mem,
+                                 input2_stride, input2_offset,
+                                 cuda_flag,
+                                 zero, intra_span_red_functor,
+                                 dest, dest_raw_pos,
+                                 set_dest_to_zero);
+        }
       }
       // General case
       else {
@@ -563,26 +801,54 @@ namespace AprilMath {
         const unsigned int input1_stride = static_cast<unsigned int>(input1_span_it.getStride());
         const unsigned int input2_stride = static_cast<unsigned int>(input2_span_it.getStride());
         april_assert(size == static_cast<unsigned int>(input2_span_it.getSize()));
-        for (int i=0; i<N; ++i) {
-          april_assert(input1_span_it != input1->end_span_iterator());
-          april_assert(input2_span_it != input2->end_span_iterator());
-          inter_span_red_functor(size,
-                                 input1->getRawDataAccess(),
-                                 input1_stride,
-                                 input1_span_it.getOffset(),
-                                 input2->getRawDataAccess(),
-                                 input2_stride,
-                                 input2_span_it.getOffset(),
-                                 cuda_flag,
-                                 zero, intra_span_red_functor,
-                                 dest, dest_raw_pos,
-                                 set_dest_to_zero);
-          set_dest_to_zero = false; // use only in the first iteration
-          ++input1_span_it;
-          ++input2_span_it;
+        if (!cuda_flag) {
+          // Every span is reduced into its own partial result, see
+          // MatrixSpanReduce1.
+          AprilMath::GPUMirroredMemoryBlock<O> partials(N);
+#ifndef NO_OMP
+#pragma omp parallel for firstprivate(input1_span_it) firstprivate(input2_span_it) if(OMPUtils::get_num_threads() > 1 && static_cast<long>(N)*size > REDUCE_OMP_SIZE_TH)
+#endif
+          for (int i=0; i<N; ++i) {
+            input1_span_it.setAtIteration(i);
+            input2_span_it.setAtIteration(i);
+            inter_span_red_functor(size,
+                                   input1_mem,
+                                   input1_stride,
+                                   static_cast<unsigned int>(input1_span_it.getOffset()),
+                                   input2_mem,
+                                   input2_stride,
+                                   static_cast<unsigned int>(input2_span_it.getOffset()),
+                                   false,
+                                   zero, intra_span_red_functor,
+                                   &partials, static_cast<unsigned int>(i),
+                                   true);
+          }
+          reducePartialsIntoDest(&partials, static_cast<unsigned int>(N),
+                                 intra_span_red_functor,
+                                 dest, dest_raw_pos, set_dest_to_zero);
+        }
+        else {
+          for (int i=0; i<N; ++i) {
+            april_assert(input1_span_it != input1->end_span_iterator());
+            april_assert(input2_span_it != input2->end_span_iterator());
+            inter_span_red_functor(size,
+                                   input1_mem,
+                                   input1_stride,
+                                   input1_span_it.getOffset(),
+                                   input2_mem,
+                                   input2_stride,
+                                   input2_span_it.getOffset(),
+                                   cuda_flag,
+                                   zero, intra_span_red_functor,
+                                   dest, dest_raw_pos,
+                                   set_dest_to_zero);
+            set_dest_to_zero = false; // use only in the first iteration
+            ++input1_span_it;
+            ++input2_span_it;
+          }
+          april_assert(input1_span_it == input1->end_span_iterator());
+          april_assert(input2_span_it == input2->end_span_iterator());
         }
-        april_assert(input1_span_it == input1->end_span_iterator());
-        april_assert(input2_span_it == input2->end_span_iterator());
       }
     } // function MatrixSpanReduce2
 
@@ -683,6 +949,37 @@ namespace AprilMath {
       april_assert(span1_it.numberOfIterations() == result->size());
       april_assert(span2_it.getSize() == span1_it.getSize());
       april_assert(span2_it.numberOfIterations() == span1_it.numberOfIterations());
+#ifndef NO_OMP
+      // every output position is independent, see
+      // MatrixSpanReduceMinMaxOverDimension
+      const int N = span1_it.numberOfIterations();
+      if (!cuda_flag && N > 1 && result->getIsContiguous() &&
+          OMPUtils::get_num_threads() > 1 &&
+          static_cast<long>(N)*span_size > REDUCE_OMP_SIZE_TH) {
+        const AprilMath::GPUMirroredMemoryBlock<T1> *input1_mem = input1->getRawDataAccess();
+        const AprilMath::GPUMirroredMemoryBlock<T2> *input2_mem = input2->getRawDataAccess();
+        AprilMath::GPUMirroredMemoryBlock<O> *dest_mem = result->getRawDataAccess();
+        const int dest_offset = result->getOffset();
+#pragma omp parallel for firstprivate(span1_it) firstprivate(span2_it)
+        for (int i=0; i<N; ++i) {
+          span1_it.setAtIteration(i);
+          span2_it.setAtIteration(i);
+          inter_span_red_functor(span_size,
+                                 input1_mem,
+                                 span1_stride,
+                                 static_cast<unsigned int>(span1_it.getOffset()),
+                                 input2_mem,
+                                 span2_stride,
+                                 static_cast<unsigned int>(span2_it.getOffset()),
+                                 cuda_flag,
+                                 zero, intra_span_red_functor,
+                                 dest_mem,
+                                 static_cast<unsigned int>(dest_offset + i),
+                                 set_dest_to_zero);
+        }
+        return result;
+      }
+#endif
       // traverse in row major order
       for (typename Basics::Matrix<O>::pos_iterator it(result);
            !it.isEnd(); ++it, ++span1_it, ++span2_it) {
@@ -709,4 +1006,7 @@ namespace AprilMath {
   
 } // namespace AprilMath
 
+#undef REDUCE_CHUNK_SIZE
+#undef REDUCE_OMP_SIZE_TH
+
 #endif // REDUCE_MATRIX_IMPL_H
@@ -21,13 +21,23 @@
  */
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "clamp.h"
 #include "constString.h"
+#include "error_print.h"
 #include "utilMatrixFloat.h"
 
 using AprilUtils::clamp;
 using AprilUtils::constString;
+using AprilUtils::vector;
 
 namespace Basics {
   
@@ -214,5 +224,369 @@ namespace Basics {
     *height = alto;
     return sizedata2+(r-b);
   }
-  
+
+  //////////////////////////////////////////////////////////////////////////////
+
+  namespace {
+
+    /// Approximated size in bytes of the chunks parsed in parallel.
+    const size_t CSV_CHUNK_SIZE = 1u << 20;
+
+    /// Powers of ten which are exactly represented as float.
+    const float CSV_POW10[] = {
+      1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+    };
+    const int CSV_MAX_POW10 = 10;
+
+    /// Largest integer mantissa which is exactly represented as float.
+    const uint64_t CSV_MAX_MANTISSA = 1u << 24;
+
+    enum CSVStatus { CSV_OK=0, CSV_WRONG_NCOLS, CSV_NOT_NUMBER };
+
+    inline bool isCSVBlank(char c) {
+      return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline bool isCSVDigit(char c) {
+      return '0' <= c && c <= '9';
+    }
+
+    /// Parses with strtof, as Matrix<T>::readTab does, the numbers which
+    /// are not short plain decimals (nan, inf, hexadecimal floats, long
+    /// mantissas, ...).
+    bool parseCSVFloatFallback(const char *b, const char *e, float &value) {
+      char small_buf[128];
+      const size_t len = static_cast<size_t>(e - b);
+      // fields which don't fit into the stack buffer are rare
+      vector<char> big_buf(len < sizeof(small_buf) ? 0 : len + 1);
+      char *buf = (len < sizeof(small_buf)) ? small_buf : big_buf.begin();
+      memcpy(buf, b, len);
+      buf[len] = '\0';
+      char *end;
+      value = strtof(buf, &end);
+      return end == buf + len;
+    }
+
+    /**
+     * Parses the number at [b,e) ignoring surrounding blanks, returns false
+     * if it isn't a complete number. When the significant digits and the
+     * power of ten are both exact floats their product or quotient is
+     * correctly rounded, so it is equal to the strtof result; any other
+     * number goes through strtof.
+     */
+    bool parseCSVFloat(const char *b, const char *e, float &value) {
+      while (b < e && isCSVBlank(*b)) ++b;
+      while (e > b && isCSVBlank(e[-1])) --e;
+      if (b == e) return false;
+      const char *p = b;
+      bool neg = false;
+      if (*p == '-' || *p == '+') neg = (*p++ == '-');
+      uint64_t mantissa = 0;
+      int ndigits = 0, exp10 = 0;
+      bool any_digit = false;
+      for (; p < e && isCSVDigit(*p); ++p) {
+        any_digit = true;
+        if (ndigits < 19) {
+          mantissa = mantissa*10u + static_cast<uint64_t>(*p - '0');
+          if (mantissa != 0u) ++ndigits;
+        }
+        else ++exp10;
+      }
+      if (p < e && *p == '.') {
+        for (++p; p < e && isCSVDigit(*p); ++p) {
+          any_digit = true;
+          if (ndigits < 19) {
+            mantissa = mantissa*10u + static_cast<uint64_t>(*p - '0');
+            if (mantissa != 0u) ++ndigits;
+            --exp10;
+          }
+        }
+      }
+      if (!any_digit) return parseCSVFloatFallback(b, e, value);
+      if (p < e && (*p == 'e' || *p == 'E')) {
+        bool exp_neg = false;
+        if (++p < e && (*p == '-' || *p == '+')) exp_neg = (*p++ == '-');
+        if (p == e || !isCSVDigit(*p)) return false;
+        int exp_value = 0;
+        for (; p < e && isCSVDigit(*p); ++p) {
+          if (exp_value < 100000) exp_value = exp_value*10 + (*p - '0');
+        }
+        exp10 += exp_neg ? -exp_value : exp_value;
+      }
+      if (p != e) return parseCSVFloatFallback(b, e, value);
+      if (mantissa > CSV_MAX_MANTISSA ||
+          (mantissa != 0u && (exp10 < -CSV_MAX_POW10 ||
+                              exp10 > CSV_MAX_POW10))) {
+        return parseCSVFloatFallback(b, e, value);
+      }
+      float v = static_cast<float>(mantissa);
+      if (mantissa != 0u) {
+        if (exp10 > 0) v *= CSV_POW10[exp10];
+        else if (exp10 < 0) v /= CSV_POW10[-exp10];
+      }
+      value = neg ? -v : v;
+      return true;
+    }
+
+    /**
+     * Splits a line into fields following the conventions of
+     * Matrix<T>::readTab: when empty fields are allowed every delimiter ends
+     * a field, otherwise consecutive delimiters are collapsed.
+     */
+    class CSVTokenizer {
+    public:
+      CSVTokenizer(const char *b, const char *e,
+                   const bool *is_delim, bool read_empty) :
+        p(b), e(e), is_delim(is_delim), read_empty(read_empty), done(false) {
+      }
+
+      bool next(const char *&field_b, const char *&field_e) {
+        if (read_empty) {
+          if (done) return false;
+          field_b = p;
+          while (p < e && !is_delim[static_cast<unsigned char>(*p)]) ++p;
+          field_e = p;
+          if (p < e) ++p; else done = true;
+          return true;
+        }
+        else {
+          while (p < e && is_delim[static_cast<unsigned char>(*p)]) ++p;
+          if (p == e) return false;
+          field_b = p;
+          while (p < e && !is_delim[static_cast<unsigned char>(*p)]) ++p;
+          field_e = p;
+          return true;
+        }
+      }
+
+    private:
+      const char *p, *e;
+      const bool *is_delim;
+      const bool read_empty;
+      bool done;
+    };
+
+    /// Returns the end of the line which starts at b, and the beginning of
+    /// the next line at next.
+    inline const char *findCSVLineEnd(const char *b, const char *e,
+                                      const char *&next) {
+      const char *nl = static_cast<const char*>(memchr(b, '\n', e - b));
+      if (nl == 0) {
+        next = e;
+        return e;
+      }
+      next = nl + 1;
+      return nl;
+    }
+
+    /// A line is a data row when it has any character which is not a blank
+    /// or, when empty fields are forbidden, a delimiter.
+    inline bool isCSVDataLine(const char *b, const char *e,
+                              const bool *is_delim, bool read_empty) {
+      for (; b < e; ++b) {
+        if (!isCSVBlank(*b) &&
+            (read_empty || !is_delim[static_cast<unsigned char>(*b)])) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /// Parsing state of one chunk of the file.
+    struct CSVChunk {
+      const char *b, *e;
+      int nrows;
+      CSVStatus status;
+      int error_row, error_col;
+      CSVChunk() : b(0), e(0), nrows(0), status(CSV_OK),
+                   error_row(0), error_col(0) { }
+    };
+
+    /**
+     * Parses all the rows of a chunk, writing them into dest. When columns
+     * is not empty, fields are parsed into the auxiliary buffer row and the
+     * selected ones copied into dest.
+     */
+    void parseCSVChunk(CSVChunk &chunk, float *dest, int ncols,
+                       const bool *is_delim, bool read_empty,
+                       float default_value, const vector<int> &columns) {
+      const int out_cols = columns.empty() ? ncols :
+        static_cast<int>(columns.size());
+      vector<float> row(columns.empty() ? 0 : ncols);
+      const char *next;
+      int r = 0;
+      for (const char *b = chunk.b; b < chunk.e; b = next) {
+        const char *e = findCSVLineEnd(b, chunk.e, next);
+        if (!isCSVDataLine(b, e, is_delim, read_empty)) continue;
+        float *out = columns.empty() ? dest + static_cast<size_t>(r)*ncols :
+          row.begin();
+        CSVTokenizer tokenizer(b, e, is_delim, read_empty);
+        const char *field_b, *field_e;
+        int c = 0;
+        while (tokenizer.next(field_b, field_e)) {
+          if (c < ncols) {
+            if (read_empty && !isCSVDataLine(field_b, field_e, is_delim, true)) {
+              out[c] = default_value;
+            }
+            else if (!parseCSVFloat(field_b, field_e, out[c])) {
+              chunk.status = CSV_NOT_NUMBER;
+              chunk.error_row = r;
+              chunk.error_col = c;
+              return;
+            }
+          }
+          ++c;
+        }
+        if (c != ncols) {
+          chunk.status = CSV_WRONG_NCOLS;
+          chunk.error_row = r;
+          chunk.error_col = c;
+          return;
+        }
+        if (!columns.empty()) {
+          float *dest_row = dest + static_cast<size_t>(r)*out_cols;
+          for (int j=0; j<out_cols; ++j) dest_row[j] = row[columns[j]];
+        }
+        ++r;
+      }
+    }
+
+  } // anonymous namespace
+
+  MatrixFloat *readMatrixFloatCSV(const char *filename,
+                                  const char *delim,
+                                  bool read_empty,
+                                  float default_value,
+                                  int skip_lines,
+                                  const vector<int> &columns) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) ERROR_EXIT1(256, "Unable to open file %s\n", filename);
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+      close(fd);
+      ERROR_EXIT1(256, "Unable to stat file %s\n", filename);
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0u) {
+      close(fd);
+      ERROR_EXIT1(256, "Found 0 rows or 0 cols at %s\n", filename);
+    }
+    void *addr = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) ERROR_EXIT1(256, "Unable to mmap file %s\n",
+                                        filename);
+    const char *data = static_cast<const char*>(addr);
+    const char *data_end = data + size;
+    bool is_delim[256];
+    for (int i=0; i<256; ++i) is_delim[i] = false;
+    for (const char *d = delim; *d != '\0'; ++d) {
+      if (*d != '\n') is_delim[static_cast<unsigned char>(*d)] = true;
+    }
+    // skip header lines
+    const char *first = data, *next;
+    for (int i=0; i<skip_lines && first < data_end; ++i) {
+      findCSVLineEnd(first, data_end, next);
+      first = next;
+    }
+    // the first data line gives the number of columns
+    int ncols = 0;
+    for (const char *b = first; b < data_end && ncols == 0; b = next) {
+      const char *e = findCSVLineEnd(b, data_end, next);
+      if (isCSVDataLine(b, e, is_delim, read_empty)) {
+        CSVTokenizer tokenizer(b, e, is_delim, read_empty);
+        const char *field_b, *field_e;
+        while (tokenizer.next(field_b, field_e)) ++ncols;
+      }
+    }
+    for (unsigned int j=0; j<columns.size(); ++j) {
+      if (columns[j] < 0 || columns[j] >= ncols) {
+        munmap(addr, size);
+        ERROR_EXIT2(128, "Column %d out of range, the file has %d columns\n",
+                    columns[j]+1, ncols);
+      }
+    }
+    // split the data at line boundaries and count the rows of every chunk
+    const size_t data_size = static_cast<size_t>(data_end - first);
+    const int nchunks = static_cast<int>(data_size / CSV_CHUNK_SIZE) + 1;
+    vector<CSVChunk> chunks(nchunks);
+    for (int k=0; k<nchunks; ++k) {
+      const char *b = (k == 0) ? first : chunks[k-1].e;
+      const char *e = (k == nchunks-1) ? data_end :
+        first + (static_cast<size_t>(k+1)*data_size) / nchunks;
+      if (e < b) e = b;
+      else if (e < data_end && e > first && e[-1] != '\n') {
+        findCSVLineEnd(e, data_end, next);
+        e = next;
+      }
+      chunks[k].b = b;
+      chunks[k].e = e;
+    }
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic) if(nchunks > 1)
+#endif
+    for (int k=0; k<nchunks; ++k) {
+      int nrows = 0;
+      const char *next_line;
+      for (const char *b = chunks[k].b; b < chunks[k].e; b = next_line) {
+        const char *e = findCSVLineEnd(b, chunks[k].e, next_line);
+        if (isCSVDataLine(b, e, is_delim, read_empty)) ++nrows;
+      }
+      chunks[k].nrows = nrows;
+    }
+    vector<int> row_offsets(nchunks);
+    int nrows = 0;
+    for (int k=0; k<nchunks; ++k) {
+      row_offsets[k] = nrows;
+      nrows += chunks[k].nrows;
+    }
+    if (nrows == 0 || ncols == 0) {
+      // ERROR_EXIT doesn't run destructors, the buffers are released here
+      munmap(addr, size);
+      vector<CSVChunk>().swap(chunks);
+      vector<int>().swap(row_offsets);
+      ERROR_EXIT1(256, "Found 0 rows or 0 cols at %s\n", filename);
+    }
+    // the matrix is allocated out of the parallel region, every chunk
+    // writes its rows at their final position
+    const int out_cols = columns.empty() ? ncols :
+      static_cast<int>(columns.size());
+    int dims[2] = { nrows, out_cols };
+    MatrixFloat *mat = new MatrixFloat(2, dims);
+    float *dest = mat->getRawDataAccess()->getPPALForWrite() + mat->getOffset();
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic) if(nchunks > 1)
+#endif
+    for (int k=0; k<nchunks; ++k) {
+      parseCSVChunk(chunks[k], dest + static_cast<size_t>(row_offsets[k])*out_cols,
+                    ncols, is_delim, read_empty, default_value, columns);
+    }
+    munmap(addr, size);
+    // the first error is copied out of the buffers, which are released
+    // before ERROR_EXIT
+    CSVStatus status = CSV_OK;
+    int error_row = 0, error_col = 0;
+    for (int k=0; k<nchunks && status == CSV_OK; ++k) {
+      if (chunks[k].status != CSV_OK) {
+        status = chunks[k].status;
+        error_row = row_offsets[k] + chunks[k].error_row + 1;
+        error_col = chunks[k].error_col;
+      }
+    }
+    if (status != CSV_OK) {
+      delete mat;
+      vector<CSVChunk>().swap(chunks);
+      vector<int>().swap(row_offsets);
+      if (status == CSV_WRONG_NCOLS) {
+        ERROR_EXIT4(128, "Incorrect number of elements at row %d of %s, "
+                    "expected %d, found %d\n", error_row, filename,
+                    ncols, error_col);
+      }
+      else {
+        ERROR_EXIT3(128, "Not a number at row %d, column %d of %s\n",
+                    error_row, error_col + 1, filename);
+      }
+    }
+    return mat;
+  }
+
 } // namespace Basics
@@ -23,6 +23,7 @@
 
 #include "constString.h"
 #include "matrixFloat.h"
+#include "vector.h"
 
 namespace Basics {
 
@@ -41,6 +42,35 @@ namespace Basics {
                          char **buffer,
                          int *width,
                          int *height);
+
+  /**
+   * @brief Reads a CSV or tabulated file of numbers into a bi-dimensional
+   * matrix, parsing the file in parallel.
+   *
+   * The file is mapped into memory and split into chunks at line boundaries.
+   * A first pass counts the rows of every chunk and a second one parses all
+   * the chunks in parallel, writing every row directly at its position of
+   * the returned matrix. Lines without data are ignored.
+   *
+   * @param filename - The path of the file.
+   * @param delim - Field delimiters, '\n' always ends a row.
+   * @param read_empty - When true every delimiter ends a field and empty
+   * fields take @c default_value, otherwise consecutive delimiters are
+   * collapsed as in Matrix<T>::readTab.
+   * @param default_value - The value of empty fields.
+   * @param skip_lines - Number of lines ignored at the beginning of the file.
+   * @param columns - 0-based indices of the columns stored in the matrix, in
+   * the given order. When empty all columns are stored.
+   *
+   * @note Lines with a wrong number of fields or not numeric fields raise an
+   * ERROR_EXIT.
+   */
+  Matrix<float>* readMatrixFloatCSV(const char *filename,
+                                    const char *delim,
+                                    bool read_empty,
+                                    float default_value,
+                                    int skip_lines,
+                                    const AprilUtils::vector<int> &columns);
   
   //////////////////////////////////////////////////////////////////////////////
 } // namespace Basics
@@ -0,0 +1,99 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include "omp_utils.h"
+#include "utilMatrixHalf.h"
+
+// number of elements converted by every OMP iteration
+#define HALF_CONVERSION_CHUNK_SIZE 16384
+
+using AprilMath::Half;
+
+namespace Basics {
+
+  namespace {
+    
+    /// Converts between two matrices with the same dimensions. Contiguous
+    /// matrices are converted by chunks, 2D matrices row by row and any other
+    /// layout falls back to iterators.
+    template<typename S, typename D, typename F>
+    void convertMatrixData(const Matrix<S> *src, Matrix<D> *dst, F convert) {
+      if (!src->sameDim(dst)) {
+        ERROR_EXIT(128, "Incompatible matrix sizes\n");
+      }
+      const S *src_ptr = src->getRawDataAccess()->getPPALForRead() +
+        src->getOffset();
+      D *dst_ptr = dst->getRawDataAccess()->getPPALForReadAndWrite() +
+        dst->getOffset();
+      if (src->getIsContiguous() && dst->getIsContiguous()) {
+        const int size = src->size();
+        const int num_chunks = ( (size + HALF_CONVERSION_CHUNK_SIZE - 1) /
+                                 HALF_CONVERSION_CHUNK_SIZE );
+#ifndef NO_OMP
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1 && num_chunks > 1)
+#endif
+        for (int c=0; c<num_chunks; ++c) {
+          const int first = c*HALF_CONVERSION_CHUNK_SIZE;
+          const int len = AprilUtils::min(HALF_CONVERSION_CHUNK_SIZE,
+                                          size - first);
+          convert(len, src_ptr + first, 1, dst_ptr + first, 1);
+        }
+      }
+      else if (src->getNumDim() == 2) {
+        const int rows = src->getDimSize(0);
+        const int cols = src->getDimSize(1);
+#ifndef NO_OMP
+#pragma omp parallel for if(OMPUtils::get_num_threads() > 1 && src->size() > HALF_CONVERSION_CHUNK_SIZE)
+#endif
+        for (int i=0; i<rows; ++i) {
+          convert(cols,
+                  src_ptr + i*src->getStrideSize(0), src->getStrideSize(1),
+                  dst_ptr + i*dst->getStrideSize(0), dst->getStrideSize(1));
+        }
+      }
+      else {
+        typename Matrix<S>::const_iterator src_it(src->begin());
+        typename Matrix<D>::iterator dst_it(dst->begin());
+        for (; src_it != src->end(); ++src_it, ++dst_it) {
+          convert(1, &(*src_it), 1, &(*dst_it), 1);
+        }
+      }
+    }
+    
+  } // anonymous namespace
+  
+  MatrixHalf *convertFromMatrixFloatToMatrixHalf(const MatrixFloat *mat) {
+    MatrixHalf *new_mat = new MatrixHalf(mat->getNumDim(), mat->getDimPtr());
+    convertMatrixData(mat, new_mat, AprilMath::halfFromFloat);
+    return new_mat;
+  }
+  
+  MatrixFloat *convertFromMatrixHalfToMatrixFloat(const MatrixHalf *mat,
+                                                  MatrixFloat *dest) {
+    if (dest == 0) {
+      dest = new MatrixFloat(mat->getNumDim(), mat->getDimPtr());
+    }
+    convertMatrixData(mat, dest, AprilMath::halfToFloat);
+    return dest;
+  }
+
+} // namespace Basics
+
+#undef HALF_CONVERSION_CHUNK_SIZE
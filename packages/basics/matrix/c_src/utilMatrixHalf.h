@@ -0,0 +1,45 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef UTILMATRIXHALF_H
+#define UTILMATRIXHALF_H
+
+#include "matrixFloat.h"
+#include "matrixHalf.h"
+
+namespace Basics {
+  
+  /// Rounds a MatrixFloat into a new contiguous MatrixHalf with the same
+  /// dimensions.
+  MatrixHalf *convertFromMatrixFloatToMatrixHalf(const MatrixFloat *mat);
+
+  /**
+   * @brief Promotes a MatrixHalf into float precision.
+   *
+   * @param mat - The source MatrixHalf.
+   * @param dest - An optional MatrixFloat with the same dimensions, if not
+   * given a new contiguous one will be allocated.
+   */
+  MatrixFloat *convertFromMatrixHalfToMatrixFloat(const MatrixHalf *mat,
+                                                  MatrixFloat *dest=0);
+  
+} // namespace Basics
+
+#endif // UTILMATRIXHALF_H
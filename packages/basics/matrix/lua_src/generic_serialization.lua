@@ -9,11 +9,19 @@ end
 
 matrix.__generic__ = matrix.__generic__ or {}
 
+-- When not nil, it is a function which receives a matrix and returns a Lua
+-- expression which references it, or nil to serialize it as a string. It
+-- allows to store matrices out of the Lua chunk (see trainable.checkpoint).
+matrix.__generic__.__tensor_sink__ = nil
+
 matrix.__generic__.__make_generic_to_lua_string__ = function(matrix_class,
                                                              defmode)
   local name = matrix_class.meta_instance.id
   class.extend(matrix_class, "to_lua_string",
                function(self, format)
+                 local sink = matrix.__generic__.__tensor_sink__
+                 local ref = sink and sink(self)
+                 if ref then return ref end
                  return string.format("%s.fromString[[%s]]",
                                       name, self:toString(format or defmode))
   end)
@@ -35,6 +43,12 @@ matrix.__generic__.__make_generic_fromTabFilename__ = function(matrix_class)
   matrix_class.fromTabFilename = function(filename)
     local f = april_assert(io.open(filename),
                            "Unable to open %s", filename)
+    if matrix_class.readCSV and io.type(f) == "file" then
+      -- plain files are parsed in parallel
+      f:close()
+      return matrix_class.readCSV(filename, { delim="\t,; ",
+                                              read_empty=false })
+    end
     local ret = table.pack(matrix_class.read(archive_wrapper( f ),
                                              { [matrix.options.tab] = true }))
     f:close()
@@ -48,18 +62,37 @@ matrix.__generic__.__make_generic_fromCSVFilename__ = function(matrix_class)
         [matrix.options.delim]   = { mandatory=true, type_match="string", default="," },
         [matrix.options.default] = { mandatory=false },
         header = { type_match="boolean" },
+        columns = { mandatory=false, type_match="table" },
         [matrix.options.map] = { mandatory=false, type_match="table", }, }, args)
     local header = args.header args.header = nil
+    local columns = args.columns args.columns = nil
     args[matrix.options.empty] = true
     args[matrix.options.tab] = true
     local f = april_assert(io.open(filename),
                            "Unable to open %s", filename)
+    local parallel = matrix_class.readCSV and io.type(f) == "file" and
+      not args[matrix.options.map]
     local f = archive_wrapper( f )
     if header then
       header = string.tokenize(f:read("*l"), args[matrix.options.delim])
+      if columns then
+        header = iterator(columns):map(function(j) return header[j] end):table()
+      end
+    end
+    local ret
+    if parallel then
+      -- plain files of float numbers are parsed in parallel
+      f:close()
+      ret = { matrix_class.readCSV(filename,
+                                   { delim = args[matrix.options.delim],
+                                     default = args[matrix.options.default],
+                                     skip = header and 1 or 0,
+                                     columns = columns, }) }
+    else
+      ret = table.pack(matrix_class.read(f, args))
+      f:close()
+      if columns then ret[1] = ret[1]:index(2, columns) end
     end
-    local ret = table.pack(matrix_class.read(f, args))
-    f:close()
     if header then table.insert(ret, header) end
     return table.unpack(ret)
   end
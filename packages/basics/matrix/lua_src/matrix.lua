@@ -67,6 +67,21 @@ matrix.ext.iterate =
         {self,slice,dim,d[dim]}, step>0 and 0 or d[dim]+1)
   end
 
+-- binary operators which are computed natively by matrix.ext.broadcast_map
+local native_broadcast_ops
+local function native_broadcast_op(func, a, b, result)
+  if not native_broadcast_ops then
+    native_broadcast_ops = {}
+    for _,name in ipairs{ "add", "sub", "cmul", "div" } do
+      native_broadcast_ops[class.consult(matrix, name)] = name
+    end
+  end
+  if class.is_a(a, matrix) and class.is_a(b, matrix) and
+  (not result or class.is_a(result, matrix)) then
+    return native_broadcast_ops[func]
+  end
+end
+
 matrix.ext.broadcast =
   april_doc{
     class = "function",
@@ -75,7 +90,8 @@ matrix.ext.broadcast =
       "Similar to scipy broadcasting: http://wiki.scipy.org/EricsBroadcastingDoc ",
       "The operator is called as: func(a,b,...) where 'a' and 'b' are slices",
       "of the given input matrices, and '...' is the given optional variadic",
-      "list of arguments.",
+      "list of arguments. Matrix add, sub, cmul and div methods without",
+      "extra arguments are computed in one traversal without slicing.",
     },
     params = {
       "A binary operator which receives two matrices, called as func(a,b,...)",
@@ -130,6 +146,10 @@ matrix.ext.broadcast =
                      i, shape[i], result:dim(i))
       end
     end
+    if select('#', ...) == 0 then
+      local op = native_broadcast_op(func, a, b, result)
+      if op then return matrix.ext.broadcast_map(op, a, b, result) end
+    end
     local result = result or matrix(table.unpack(shape))
     if same_cpp_ref(result, b) then
       private_broadcast(result, a, a_dim, func, ...)
@@ -685,13 +705,37 @@ april_set_doc(matrix.read, {
                   "A lua table with options",
 		}, })
 
+april_set_doc(matrix.readCSV, {
+		class = "function",
+		summary = "Reads a CSV or tabulated file of numbers in parallel.",
+		description ={
+		  "The file is mapped in memory and split into chunks at line",
+		  "boundaries, which are parsed in parallel and written directly",
+		  "into the matrix. It is used by fromCSVFilename and",
+		  "fromTabFilename when the file is not compressed.",
+		},
+		params = {
+		  "A filename path.",
+		  {
+		    "A table with options [optional]: delim=',',",
+		    "read_empty=true (every delimiter ends a field and empty",
+		    "fields take default value), default=0, skip=0 (number of",
+		    "header lines), columns (a table with the 1-based indices",
+		    "of the columns to be read, in the given order).",
+		  },
+		},
+		outputs = { "A matrix instantiated object" }, })
+
 april_set_doc(matrix.fromMMap, {
 		class = "function", summary = "Matrix fromMMap constructor",
 		description ={
 		  "Loads a matrix from a mmaped filename.",
 		},
 		params = {
-		  "A filename path.",
+		  {
+		    "A filename path, or a util.mmap.reader which allows to",
+		    "read several objects from the same file.",
+		  },
 		  {
 		    "A boolean indicating if writing is allowed [optional].",
 		    "By default it is true",
@@ -712,7 +756,11 @@ april_set_doc(matrix.."toMMap", {
 		  "It uses the format expected by fromMMap function.",
 		},
 		params = {
-		  "A filename path.",
+		  {
+		    "A filename path, or a util.mmap.writer which allows to",
+		    "write several objects into the same file. In this case",
+		    "matrix data is aligned to 64 bytes.",
+		  },
 		}, })
 
 april_set_doc(matrix.loadImage, {
@@ -1518,6 +1566,20 @@ april_set_doc(matrix.."svd",
 		},
 	      })
 
+april_set_doc(matrix.."qr",
+	      {
+		class = "method",
+		summary = "Computes the reduced QR decomposition of a matrix",
+		description = {
+		  "For a MxN matrix and K=min(M,N), the computation returns",
+		  "two matrices, so A=Q * R.",
+		},
+		outputs = {
+		  "The MxK matrix Q with orthonormal columns",
+		  "The KxN upper triangular matrix R",
+		},
+	      })
+
 april_set_doc(matrix.."diagonalize",
 	      {
 		class = "method",
@@ -0,0 +1,21 @@
+class.extend(matrixHalf, "t", matrixHalf.."transpose")
+
+-- serialization
+matrix.__generic__.__make_all_serialization_methods__(matrixHalf)
+
+matrixHalf.meta_instance.__call =
+  matrix.__generic__.__make_generic_call__()
+
+matrixHalf.meta_instance.__newindex =
+  matrix.__generic__.__make_generic_newindex__(matrixHalf)
+
+matrix.__generic__.__make_generic_index__(matrixHalf)
+
+matrixHalf.meta_instance.__tostring =
+  matrix.__generic__.__make_generic_print__("MatrixHalf",
+                                            function(value)
+                                              return string.format("% -11.4g", value)
+  end)
+
+matrixHalf.join =
+  matrix.__generic__.__make_generic_join__(matrixHalf)
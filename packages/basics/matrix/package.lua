@@ -25,6 +25,8 @@
 	 "test/test_matrix_math.lua",
 	 "test/test_sparse_matrix.lua",
 	 "test/test_convolution.lua",
+	 "test/test_matrix_half.lua",
+	 "test/test_lua_push.lua",
        },
      },
      -- FIXME: make it compile
@@ -41,6 +43,7 @@
      provide_bind{ file = "binding/bind_matrix_complex_float.lua.cc", dest_dir = "include" },
      provide_bind{ file = "binding/bind_matrix_double.lua.cc", dest_dir = "include" },
      provide_bind{ file = "binding/bind_matrix_int32.lua.cc", dest_dir = "include" },
+     provide_bind{ file = "binding/bind_matrix_half.lua.cc", dest_dir = "include" },
      provide_bind{ file = "binding/bind_matrix_char.lua.cc", dest_dir = "include" },
      provide_bind{ file = "binding/bind_matrix_bool.lua.cc", dest_dir = "include" },
      provide_bind{ file = "binding/bind_referenced_vector.lua.cc", dest_dir = "include" }
@@ -83,6 +86,10 @@
        file = "binding/bind_matrix_int32.lua.cc",
        dest_dir = "build",
      },
+     build_bind{
+        file = "binding/bind_matrix_half.lua.cc",
+        dest_dir = "build",
+     },
      build_bind{
         file = "binding/bind_matrix_char.lua.cc",
         dest_dir = "build",
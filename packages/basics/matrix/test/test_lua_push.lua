@@ -0,0 +1,21 @@
+local check = utest.check
+local T = utest.test
+
+T("PushHeldObjectTest", function()
+    -- memory blocks are held by their matrix and pushed several times while
+    -- the userdata of previous blocks become garbage, the registry slot of a
+    -- garbage userdata is cleared before its finalizer runs and it can be
+    -- reused by another object
+    local x = matrix(2,1):uniformf(0, 1, random(1234))
+    local prev
+    for i=1,3000 do
+      local m = matrix(2,1)
+      if prev then
+        -- a wrong object or nil was returned when the slot was reused
+        check.TRUE(class.is_a(m:data(), mathcore.block.float))
+        check.eq(m:data():size(), prev:size())
+      end
+      for j=1,20 do local garbage = { x:clone() } end
+      prev = m:data()
+    end
+end)
@@ -0,0 +1,84 @@
+local check = utest.check
+local T     = utest.test
+
+T("HalfConversionTest", function()
+    -- exactly representable values
+    local m = matrix(2,4,{ 0, 1, -2, 0.5, 2048, -65504, 0.333251953125, 6e-08 })
+    local h = m:to_half()
+    check.TRUE(class.is_a(h, matrixHalf))
+    check.eq(h:dim(1), 2)
+    check.eq(h:dim(2), 4)
+    check.eq(h:to_float(), m)
+    check.number_eq(h:get(1,1), 0)
+    check.number_eq(h:get(2,2), -65504)
+    -- rounding to nearest even, overflow to infinity
+    local r = matrix{ 2049, 2051, 1e-4, 70000, -70000 }:to_half():to_float()
+    check.number_eq(r:get(1), 2048)
+    check.number_eq(r:get(2), 2052)
+    check.number_eq(r:get(3), 1e-4, 1e-3)
+    check.eq(r:get(4), math.huge)
+    check.eq(r:get(5), -math.huge)
+    -- relative error bounded by 2^-11 in normal range
+    local x = matrix(1000):uniformf(-100, 100, random(1234))
+    local y = x:to_half():to_float()
+    local err = 0
+    for i=1,x:size() do
+      err = math.max(err, math.abs(x:get(i) - y:get(i)) / math.abs(x:get(i)))
+    end
+    check.lt(err, 2^-11 + 1e-7)
+    -- non contiguous sources
+    local xt = matrix(40,30):linspace():scal(0.01):t()
+    check.eq(xt:to_half():to_float(), xt:clone())
+    local xs = matrix(4,5,6):linspace():select(2,3)
+    check.eq(xs:to_half():to_float(), xs:clone())
+end)
+
+T("HalfAccessTest", function()
+    local h = matrixHalf(3,4):zeros()
+    h:set(2,3, 1.5)
+    check.number_eq(h:get(2,3), 1.5)
+    check.errored(function() return h:get(4,1) end)
+    check.errored(function() return h:set(1,5, 1.0) end)
+    check.number_eq(h:to_float():sum(), 1.5)
+    h:fill(0.25)
+    check.number_eq(h:to_float():sum(), 3)
+    check.eq(h:t():dim(1), 4)
+    check.number_eq(h:slice({2,1},{2,4}):to_float():sum(), 2)
+    local c = matrixHalf(3,4):copy(h)
+    check.eq(c:to_float(), h:to_float())
+end)
+
+T("HalfSerializationTest", function()
+    local m = matrix(5,7):uniformf(-10, 10, random(4321)):to_half()
+    for _,mode in ipairs{ "binary", "ascii" } do
+      local str = m:toString(mode)
+      local m2  = matrixHalf.fromString(str)
+      if mode == "binary" then
+        check.eq(m2:to_float(), m:to_float())
+      else
+        check.lt((m2:to_float() - m:to_float()):abs():max(), 1e-2)
+      end
+    end
+    local m3 = load("return " .. m:to_lua_string())()
+    check.eq(m3:to_float(), m:to_float())
+end)
+
+T("HalfGemmTest", function()
+    local rnd = random(5678)
+    for _,sizes in ipairs{ {3,5,4}, {17,300,65}, {8,513,32} } do
+      local M,N,K = table.unpack(sizes)
+      local A  = matrix(M,K):uniformf(-1, 1, rnd)
+      local W  = matrix(N,K):uniformf(-1, 1, rnd)
+      local Wh = W:to_half()
+      -- reference with the rounded weights promoted to float
+      local Wf = Wh:to_float()
+      local ref = matrix(M,N):gemm{ A=A, B=Wf, trans_B=true, alpha=2, beta=0 }
+      local C = matrix(M,N):half_gemm{ A=A, B=Wh, trans_B=true, alpha=2, beta=0 }
+      check.lt((C - ref):abs():max(), 1e-4)
+      -- not transposed B and beta accumulation
+      local Ch = matrix(M,N):fill(1.0)
+      Ch:half_gemm{ A=A, B=Wf:t():clone():to_half(), beta=0.5 }
+      local ref2 = matrix(M,N):fill(1.0):gemm{ A=A, B=Wf:t(), beta=0.5 }
+      check.lt((Ch - ref2):abs():max(), 1e-4)
+    end
+end)
@@ -220,6 +220,32 @@ ascii
   ---------------------------------------------------------------
   ---------------------------------------------------------------
 
+  T("QRTest",
+    function()
+      local rnd = random(1234)
+      for _,dims in ipairs{ {6,4}, {4,6}, {5,5} } do
+        local m = matrix(table.unpack(dims)):uniformf(-1,1,rnd)
+        local k = math.min(dims[1], dims[2])
+        local Q,R = m:qr()
+        check.eq(Q:dim(1), dims[1]) check.eq(Q:dim(2), k)
+        check.eq(R:dim(1), k)       check.eq(R:dim(2), dims[2])
+        check.eq(Q*R, m, "QR reconstruction")
+        check.eq(Q:transpose()*Q, matrix(k,k):zeros():diag(1),
+                 "Q orthonormality")
+        for i=2,k do
+          check.eq(R(i,{1,i-1}), matrix(1,i-1):zeros(), "R triangular")
+        end
+      end
+      -- a non contiguous matrix
+      local m = matrix(4,6):uniformf(-1,1,rnd):transpose()
+      local Q,R = m:qr()
+      check.eq(Q*R, m, "QR transposed")
+  end)
+
+  ---------------------------------------------------------------
+  ---------------------------------------------------------------
+  ---------------------------------------------------------------
+
   T("SliceTest",
     function()
       local m = matrix(20,20):uniformf()
@@ -273,6 +299,61 @@ ascii
   end)
   os.remove(tmpname)
 
+  local tmpname = os.tmpname()
+  T("ParallelCSVTest", function()
+      -- large enough to be split in several chunks
+      local m = matrix(40000,7):uniformf(-1e4,1e4)
+      m:toCSVFilename(tmpname)
+      local f = io.open(tmpname)
+      local ref = matrix.read(f, { [matrix.options.delim]=",",
+                                   [matrix.options.empty]=true,
+                                   [matrix.options.tab]=true })
+      f:close()
+      check.eq(matrix.fromCSVFilename(tmpname), ref)
+      check.eq(matrix.fromCSVFilename(tmpname), m)
+      m:toTabFilename(tmpname)
+      check.eq(matrix.fromTabFilename(tmpname), m)
+      -- header, columns selection and empty fields
+      local f = io.open(tmpname, "w")
+      f:write("a,b,c,d\n1,2.5,,-4e2\r\n\n5,,7,8\n-9.25e-1, 10 ,11,1.5E+1\n")
+      f:close()
+      local def = 0.0/0.0
+      local m,header = matrix.fromCSVFilename(tmpname,
+                                              { header=true,
+                                                default=-1,
+                                                columns={ 4, 2 } })
+      check.eq(m, matrix(3,2,{ -400, 2.5, 8, -1, 15, 10 }))
+      check.TRUE(header[1] == "d" and header[2] == "b" and #header == 2)
+      local m = matrix.fromCSVFilename(tmpname, { header=true, default=def })
+      check.TRUE(m:get(1,3) ~= m:get(1,3) and m:get(2,2) ~= m:get(2,2))
+      check.number_eq(m:get(3,1), -0.925)
+      local f = io.open(tmpname, "w")
+      f:write("1,2,3\n4,5\n")
+      f:close()
+      check.errored(function() return matrix.fromCSVFilename(tmpname) end)
+      local f = io.open(tmpname, "w")
+      f:write("1,2,3\n4,x,6\n")
+      f:close()
+      check.errored(function() return matrix.fromCSVFilename(tmpname) end)
+      -- long mantissas and large exponents are rounded as strtof does,
+      -- 7.038531e-26 rounds differently when narrowed from double
+      local f = io.open(tmpname, "w")
+      f:write("7.038531e-26,0.12345678912345678,16777217,1.00000005960464477\n")
+      f:write("3.4028234e38,1.17549435e-38,123456789012345678901234,-0.0\n")
+      f:write("8.589973e9,0.000000000001,4.5e-12,1e-45\n")
+      f:close()
+      local f = io.open(tmpname)
+      local ref = matrix.read(f, { [matrix.options.delim]=",",
+                                   [matrix.options.empty]=true,
+                                   [matrix.options.tab]=true })
+      f:close()
+      local m = matrix.fromCSVFilename(tmpname)
+      for i,v in ipairs(ref:toTable()) do
+        check.TRUE(m:toTable()[i] == v)
+      end
+  end)
+  os.remove(tmpname)
+
   T("EQandNEQTest", function()
       local m   = load_csv()
       local def = 0.0/0.0
@@ -416,6 +497,51 @@ ascii
                            1,2,3,4}))
   end)
   
+  T("NativeBroadcastTest", function()
+      local rnd = random(5678)
+      -- generic sliced broadcast, used as reference
+      local function generic(name)
+        return function(x, y) return x[name](x, y) end
+      end
+      local function check_op(name, a, b)
+        local ref = matrix.ext.broadcast(generic(name), a, b)
+        local out = matrix.ext.broadcast(a[name], a, b)
+        check.eq(out, ref, name)
+        -- in-place computation when the result has the shape of a
+        if ref:size() == a:size() then
+          local a2 = a:clone()
+          matrix.ext.broadcast(a2[name], a2, b, a2)
+          check.eq(a2, ref, name .. " in-place")
+        end
+      end
+      local a = matrix(20,4,3):uniformf(1, 2, rnd)
+      for _,b in ipairs{ matrix(3):uniformf(1, 2, rnd),
+                         matrix(4,1):uniformf(1, 2, rnd),
+                         matrix(20,1,3):uniformf(1, 2, rnd),
+                         matrix(1,4,3):uniformf(1, 2, rnd),
+                         matrix(3,4):uniformf(1, 2, rnd):t(), } do
+        for _,name in ipairs{ "add", "sub", "cmul", "div" } do
+          check_op(name, a, b)
+          check_op(name, b, a)
+        end
+      end
+      -- non-contiguous inputs
+      local a = matrix(5,6):uniformf(1, 2, rnd):t()
+      local b = matrix(5,2):uniformf(1, 2, rnd):select(2,2)
+      check_op("sub", a, b)
+      check_op("cmul", b, a)
+      -- large computation traversed in parallel
+      local a = matrix(1000,1):uniformf(1, 2, rnd)
+      local b = matrix(300):uniformf(1, 2, rnd)
+      check_op("add", a, b)
+      check.errored(function()
+          matrix.ext.broadcast_map("add", matrix(4), matrix(5))
+      end)
+      -- plain add/sub don't broadcast
+      check.errored(function() return matrix(4,1):add(matrix(3)) end)
+      check.errored(function() return matrix(4,1):sub(matrix(1,3)) end)
+  end)
+  
   T("IndexMethods", function()
       local m1 = matrix(30,20,10):linspace()
       check.eq(m1:select(1,20), m1[20])
@@ -431,6 +557,52 @@ ascii
       check.eq(m, matrix(2,3,2,3):linear())
   end)
   
+  T("LargeReductionsTest", function()
+      local rnd = random(1234)
+      -- larger than the chunk size used to split whole matrix reductions
+      local m = matrix(300, 500):uniformf(-1, 1, rnd)
+      local ref_sum, ref_max, ref_argmax = 0, -math.huge, 0
+      for i=1,m:size() do
+        local v = m:raw_get(i-1)
+        ref_sum = ref_sum + v
+        if v > ref_max then ref_max, ref_argmax = v, i end
+      end
+      check.number_eq(m:sum(), ref_sum, 1e-03, "sum()")
+      check.number_eq(m:t():sum(), ref_sum, 1e-03, "t():sum()")
+      check.number_eq(m:select(2,3):sum(), m:select(2,3):clone():sum(),
+                      1e-03, "select():sum()")
+      local mx,arg = m:max()
+      check.eq(mx, ref_max, "max()")
+      check.eq(arg, ref_argmax, "max() arg")
+      check.number_eq(m:dot(m:clone():fill(1)), ref_sum, 1e-03, "dot()")
+      -- over dimension reductions, compared with results computed over
+      -- cloned (contiguous) slices
+      local s1,s2 = m:sum(1),m:sum(2)
+      local mx1,arg1 = m:max(1)
+      local mn2,arg2 = m:min(2)
+      for j=1,m:dim(2) do
+        local col = m:select(2,j):clone()
+        check.number_eq(s1:get(1,j), col:sum(), 1e-03, "sum(1)")
+        local v,p = col:max()
+        check.eq(mx1:get(1,j), v, "max(1)")
+        check.eq(arg1:get(1,j), p, "max(1) arg")
+      end
+      for i=1,m:dim(1) do
+        local row = m:select(1,i):clone()
+        check.number_eq(s2:get(i,1), row:sum(), 1e-03, "sum(2)")
+        local v,p = row:min()
+        check.eq(mn2:get(i,1), v, "min(2)")
+        check.eq(arg2:get(i,1), p, "min(2) arg")
+      end
+      -- results don't depend on the number of threads
+      local n = util.omp_get_num_threads()
+      util.omp_set_num_threads(1)
+      local seq_sum, seq_s1 = m:t():sum(), m:sum(1)
+      util.omp_set_num_threads(n)
+      check.eq(m:t():sum(), seq_sum, "deterministic sum()")
+      check.eq(m:sum(1), seq_s1, "deterministic sum(1)")
+  end)
+
   T("LargeMatrices", function()
       local m1 = matrix(300,200,100)
       local m2 = matrix(300,200,100)
@@ -243,6 +243,46 @@ T("SparseGEMVTest",
       "CSR + transpose + CSC GEMV")
 end)
 
+-- large enough to be computed using OMP
+local rnd = random(4321)
+local big_dense = matrix(300,200):uniformf(-1,1,rnd):
+  map(function(x) if math.abs(x) > 0.9 then return x else return 0 end end)
+local big_b = matrix(200,100):uniformf(-1,1,rnd)
+local big_x = matrix(200):uniformf(-1,1,rnd)
+
+T("SparseLargeMMTest",
+  function()
+    local ref = big_dense * big_b
+    for _,fmt in ipairs{ "csr", "csc" } do
+      local A = matrix.sparse[fmt](big_dense)
+      check(function()
+          local c = matrix(300,100):zeros():sparse_mm({
+              trans_A=false, alpha=1.0, A=A, B=big_b, beta=0.0,
+          })
+          return make_eq(ref, c)()
+      end, fmt .. " large sparse_mm")
+      check(function()
+          local c = matrix(300,100):zeros():sparse_mm({
+              trans_A=true, alpha=1.0, A=A:transpose(), B=big_b, beta=0.0,
+          })
+          return make_eq(ref, c)()
+      end, fmt .. " + transpose large sparse_mm")
+      check(function()
+          local c = matrix(300,100):ones():sparse_mm({
+              trans_A=false, trans_B=true, alpha=2.0, A=A,
+              B=big_b:transpose():clone(), beta=0.5,
+          })
+          return make_eq(ref*2 + 0.5, c)()
+      end, fmt .. " + transpose B large sparse_mm")
+      check(function()
+          local y = matrix(300):ones():gemv({
+              trans_A=false, alpha=1.0, A=A, X=big_x, beta=1.0,
+          })
+          return make_eq(big_dense*big_x + 1.0, y)()
+      end, fmt .. " large GEMV")
+    end
+end)
+
 ----------------------------------------------------------------------------
 
 T("SparseDotTest",
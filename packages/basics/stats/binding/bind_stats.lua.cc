@@ -22,9 +22,33 @@
 #include "bind_matrix.h"
 #include "bind_sparse_matrix.h"
 #include "bind_mtrand.h"
+
+namespace Stats {
+  /// Receives numbers or matrices, missing optional params are zero
+  template<typename K>
+  BatchDistribution<K> *newBatchDistribution(lua_State *L, int num_mandatory) {
+    MatrixFloat *params[K::NUM_PARAMS];
+    for (int k=0; k<K::NUM_PARAMS; ++k) {
+      if (lua_isMatrixFloat(L, k+1)) {
+        params[k] = lua_toMatrixFloat(L, k+1);
+      }
+      else {
+        float value = 0.0f;
+        if (k < num_mandatory || !lua_isnoneornil(L, k+1)) {
+          value = static_cast<float>(luaL_checknumber(L, k+1));
+        }
+        int dims[1] = { 1 };
+        params[k] = new MatrixFloat(1, dims);
+        (*params[k])(0) = value;
+      }
+    }
+    return new BatchDistribution<K>(params);
+  }
+}
 //BIND_END
 
 //BIND_HEADER_H
+#include "batch_distribution.h"
 #include "beta_distribution.h"
 #include "binomial_distribution.h"
 #include "combinations.h"
@@ -510,3 +534,169 @@ using namespace Stats;
                  static_cast<BinomialDistribution*>(obj->clone()));
 }
 //BIND_END
+
+//////////////////////////////////////////////////////////////////////////
+// BATCH DISTRIBUTIONS: one univariate distribution per row, params are
+// numbers (shared by all rows) or one-dimensional matrices with one value
+// per row.
+
+//BIND_LUACLASSNAME BatchNormalDistribution stats.dist.batch.normal
+//BIND_CPP_CLASS    BatchNormalDistribution
+//BIND_SUBCLASS_OF  BatchNormalDistribution StatisticalDistributionBase
+
+//BIND_CONSTRUCTOR BatchNormalDistribution
+{
+  obj = newBatchDistribution<Kernels::Normal>(L, 2);
+  LUABIND_RETURN(BatchNormalDistribution, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchNormalDistribution clone
+{
+  LUABIND_RETURN(BatchNormalDistribution, static_cast<BatchNormalDistribution*>(obj->clone()));
+}
+//BIND_END
+
+//BIND_METHOD BatchNormalDistribution batch_size
+{
+  LUABIND_RETURN(int, obj->getBatchSize());
+}
+//BIND_END
+
+//BIND_LUACLASSNAME BatchLogNormalDistribution stats.dist.batch.lognormal
+//BIND_CPP_CLASS    BatchLogNormalDistribution
+//BIND_SUBCLASS_OF  BatchLogNormalDistribution StatisticalDistributionBase
+
+//BIND_CONSTRUCTOR BatchLogNormalDistribution
+{
+  obj = newBatchDistribution<Kernels::LogNormal>(L, 2);
+  LUABIND_RETURN(BatchLogNormalDistribution, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchLogNormalDistribution clone
+{
+  LUABIND_RETURN(BatchLogNormalDistribution, static_cast<BatchLogNormalDistribution*>(obj->clone()));
+}
+//BIND_END
+
+//BIND_METHOD BatchLogNormalDistribution batch_size
+{
+  LUABIND_RETURN(int, obj->getBatchSize());
+}
+//BIND_END
+
+//BIND_LUACLASSNAME BatchExponentialDistribution stats.dist.batch.exponential
+//BIND_CPP_CLASS    BatchExponentialDistribution
+//BIND_SUBCLASS_OF  BatchExponentialDistribution StatisticalDistributionBase
+
+//BIND_CONSTRUCTOR BatchExponentialDistribution
+{
+  obj = newBatchDistribution<Kernels::Exponential>(L, 1);
+  LUABIND_RETURN(BatchExponentialDistribution, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchExponentialDistribution clone
+{
+  LUABIND_RETURN(BatchExponentialDistribution, static_cast<BatchExponentialDistribution*>(obj->clone()));
+}
+//BIND_END
+
+//BIND_METHOD BatchExponentialDistribution batch_size
+{
+  LUABIND_RETURN(int, obj->getBatchSize());
+}
+//BIND_END
+
+//BIND_LUACLASSNAME BatchUniformDistribution stats.dist.batch.uniform
+//BIND_CPP_CLASS    BatchUniformDistribution
+//BIND_SUBCLASS_OF  BatchUniformDistribution StatisticalDistributionBase
+
+//BIND_CONSTRUCTOR BatchUniformDistribution
+{
+  obj = newBatchDistribution<Kernels::Uniform>(L, 2);
+  LUABIND_RETURN(BatchUniformDistribution, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchUniformDistribution clone
+{
+  LUABIND_RETURN(BatchUniformDistribution, static_cast<BatchUniformDistribution*>(obj->clone()));
+}
+//BIND_END
+
+//BIND_METHOD BatchUniformDistribution batch_size
+{
+  LUABIND_RETURN(int, obj->getBatchSize());
+}
+//BIND_END
+
+//BIND_LUACLASSNAME BatchGammaDistribution stats.dist.batch.gamma
+//BIND_CPP_CLASS    BatchGammaDistribution
+//BIND_SUBCLASS_OF  BatchGammaDistribution StatisticalDistributionBase
+
+//BIND_CONSTRUCTOR BatchGammaDistribution
+{
+  obj = newBatchDistribution<Kernels::Gamma>(L, 2);
+  LUABIND_RETURN(BatchGammaDistribution, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchGammaDistribution clone
+{
+  LUABIND_RETURN(BatchGammaDistribution, static_cast<BatchGammaDistribution*>(obj->clone()));
+}
+//BIND_END
+
+//BIND_METHOD BatchGammaDistribution batch_size
+{
+  LUABIND_RETURN(int, obj->getBatchSize());
+}
+//BIND_END
+
+//BIND_LUACLASSNAME BatchBetaDistribution stats.dist.batch.beta
+//BIND_CPP_CLASS    BatchBetaDistribution
+//BIND_SUBCLASS_OF  BatchBetaDistribution StatisticalDistributionBase
+
+//BIND_CONSTRUCTOR BatchBetaDistribution
+{
+  obj = newBatchDistribution<Kernels::Beta>(L, 2);
+  LUABIND_RETURN(BatchBetaDistribution, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchBetaDistribution clone
+{
+  LUABIND_RETURN(BatchBetaDistribution, static_cast<BatchBetaDistribution*>(obj->clone()));
+}
+//BIND_END
+
+//BIND_METHOD BatchBetaDistribution batch_size
+{
+  LUABIND_RETURN(int, obj->getBatchSize());
+}
+//BIND_END
+
+//BIND_LUACLASSNAME BatchBinomialDistribution stats.dist.batch.binomial
+//BIND_CPP_CLASS    BatchBinomialDistribution
+//BIND_SUBCLASS_OF  BatchBinomialDistribution StatisticalDistributionBase
+
+//BIND_CONSTRUCTOR BatchBinomialDistribution
+{
+  obj = newBatchDistribution<Kernels::Binomial>(L, 2);
+  LUABIND_RETURN(BatchBinomialDistribution, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchBinomialDistribution clone
+{
+  LUABIND_RETURN(BatchBinomialDistribution, static_cast<BatchBinomialDistribution*>(obj->clone()));
+}
+//BIND_END
+
+//BIND_METHOD BatchBinomialDistribution batch_size
+{
+  LUABIND_RETURN(int, obj->getBatchSize());
+}
+//BIND_END
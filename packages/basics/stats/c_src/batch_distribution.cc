@@ -0,0 +1,143 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include "batch_distribution.h"
+#include "c_string.h"
+#include "error_print.h"
+
+using AprilUtils::SharedPtr;
+using AprilIO::CStringStream;
+using Basics::MatrixFloat;
+using Basics::MTRand;
+
+namespace Stats {
+
+  template<typename K>
+  BatchDistribution<K>::BatchDistribution(MatrixFloat **params) :
+    StatisticalDistributionBase(1), batch_size(1) {
+    for (int k=0; k<K::NUM_PARAMS; ++k) {
+      MatrixFloat *p = params[k];
+      if (p->getNumDim() != 1) {
+        ERROR_EXIT2(128, "Expected one-dimensional matrix at param %d "
+                    "of %s distribution\n", k+1, K::name());
+      }
+      int sz = p->size();
+      if (sz != 1) {
+        if (batch_size != 1 && batch_size != sz) {
+          ERROR_EXIT3(128, "Incompatible param %d size of %s distribution, "
+                      "expected 1 or %d\n", k+1, K::name(), batch_size);
+        }
+        batch_size = sz;
+      }
+      this->params[k] = p;
+    }
+    updateParams();
+  }
+
+  template<typename K>
+  BatchDistribution<K>::~BatchDistribution() {
+  }
+
+  template<typename K>
+  void BatchDistribution<K>::updateParams() {
+    consts.resize(batch_size * K::NUM_CONSTS);
+    float p[K::NUM_PARAMS];
+    for (int i=0; i<batch_size; ++i) {
+      for (int k=0; k<K::NUM_PARAMS; ++k) {
+        MatrixFloat *m = params[k].get();
+        p[k] = (*m)( (m->size() == 1) ? 0 : i );
+      }
+      if (!K::prepare(p, consts.begin() + i*K::NUM_CONSTS)) {
+        ERROR_EXIT2(128, "Incorrect params of %s distribution at row %d\n",
+                    K::name(), i+1);
+      }
+    }
+  }
+
+  template<typename K>
+  int BatchDistribution<K>::getRowStep(const MatrixFloat *x) const {
+    if (batch_size == 1) return 0;
+    if (x->getDimSize(0) != batch_size) {
+      ERROR_EXIT3(128, "Expected a matrix with %d rows for %s "
+                  "distribution, found %d rows\n", batch_size, K::name(),
+                  x->getDimSize(0));
+    }
+    return K::NUM_CONSTS;
+  }
+
+  template<typename K>
+  void BatchDistribution<K>::privateSample(MTRand *rng, MatrixFloat *result) {
+    Kernels::applySample<K>(rng, consts.begin(), getRowStep(result), 0,
+                            result);
+  }
+
+  template<typename K>
+  void BatchDistribution<K>::privateLogpdf(const MatrixFloat *x,
+                                           MatrixFloat *result) {
+    Kernels::applyLogpdf<K>(consts.begin(), getRowStep(x), 0, x, result);
+  }
+  
+  template<typename K>
+  void BatchDistribution<K>::privateLogcdf(const MatrixFloat *x,
+                                           MatrixFloat *result) {
+    Kernels::applyLogcdf<K>(consts.begin(), getRowStep(x), 0, x, result);
+  }
+
+  template<typename K>
+  void BatchDistribution<K>::privateLogpdfDerivative(const MatrixFloat *x,
+                                                     MatrixFloat *result) {
+    Kernels::applyLogpdfDerivative<K>(consts.begin(), getRowStep(x), 0,
+                                      x, result);
+  }
+
+  template<typename K>
+  StatisticalDistributionBase *BatchDistribution<K>::clone() {
+    MatrixFloat *cloned[K::NUM_PARAMS];
+    for (int k=0; k<K::NUM_PARAMS; ++k) cloned[k] = params[k]->clone();
+    return new BatchDistribution<K>(cloned);
+  }
+
+  template<typename K>
+  char *BatchDistribution<K>::toLuaString(bool is_ascii) const {
+    SharedPtr<CStringStream> stream(new CStringStream());
+    AprilUtils::LuaTable options;
+    options.put("ascii", is_ascii);
+    stream->put("stats.dist.batch.");
+    stream->put(K::name());
+    stream->put("(");
+    for (int k=0; k<K::NUM_PARAMS; ++k) {
+      if (k > 0) stream->put(", ");
+      stream->put("matrix.fromString[[");
+      params[k]->write(stream.get(), options);
+      stream->put("]]");
+    }
+    stream->put(")\0",2); // forces a \0 at the end of the buffer
+    return stream->releaseString();
+  }
+
+  template class BatchDistribution<Kernels::Normal>;
+  template class BatchDistribution<Kernels::LogNormal>;
+  template class BatchDistribution<Kernels::Exponential>;
+  template class BatchDistribution<Kernels::Uniform>;
+  template class BatchDistribution<Kernels::Gamma>;
+  template class BatchDistribution<Kernels::Beta>;
+  template class BatchDistribution<Kernels::Binomial>;
+  
+}
@@ -0,0 +1,86 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef BATCH_DISTRIBUTION_H
+#define BATCH_DISTRIBUTION_H
+
+#include "distribution_kernels.h"
+#include "smart_ptr.h"
+#include "statistical_distribution.h"
+#include "vector.h"
+
+namespace Stats {
+
+  /**
+   * @brief Batch of univariate distributions, one distribution per row.
+   *
+   * Every parameter is a one-dimensional matrix with size 1 or B, where B is
+   * the batch size. Parameters with size 1 are shared by all the rows, so a
+   * batch where all parameters have size 1 is a univariate distribution
+   * which can be evaluated over any number of rows. Otherwise, x matrices
+   * given to sample, logpdf, logcdf and logpdfDerivative must have B rows,
+   * and row i is evaluated with the i-th distribution.
+   *
+   * @note The template argument is one of the kernels at Stats::Kernels
+   * namespace.
+   */
+  template<typename K>
+  class BatchDistribution : public StatisticalDistributionBase {
+    /// mutable because Matrix::write is not const, used by toLuaString
+    mutable AprilUtils::SharedPtr<Basics::MatrixFloat> params[K::NUM_PARAMS];
+    /// constants computed by K::prepare, with B*K::NUM_CONSTS size
+    AprilUtils::vector<float> consts;
+    int batch_size;
+    
+    void updateParams();
+    /// checks the number of rows of x and returns the row step of consts
+    int getRowStep(const Basics::MatrixFloat *x) const;
+    
+  protected:
+    virtual void privateSample(Basics::MTRand *rng,
+                               Basics::MatrixFloat *result);
+    virtual void privateLogpdf(const Basics::MatrixFloat *x,
+                               Basics::MatrixFloat *result);
+    virtual void privateLogcdf(const Basics::MatrixFloat *x,
+                               Basics::MatrixFloat *result);
+    virtual void privateLogpdfDerivative(const Basics::MatrixFloat *x,
+                                         Basics::MatrixFloat *result);
+    
+  public:
+    /// Receives an array with K::NUM_PARAMS one-dimensional matrices
+    BatchDistribution(Basics::MatrixFloat **params);
+    virtual ~BatchDistribution();
+    /// Returns the number of distributions, 1 when all are the same
+    int getBatchSize() const { return batch_size; }
+    virtual StatisticalDistributionBase *clone();
+    virtual char *toLuaString(bool is_ascii) const;
+  };
+
+  typedef BatchDistribution<Kernels::Normal>      BatchNormalDistribution;
+  typedef BatchDistribution<Kernels::LogNormal>   BatchLogNormalDistribution;
+  typedef BatchDistribution<Kernels::Exponential> BatchExponentialDistribution;
+  typedef BatchDistribution<Kernels::Uniform>     BatchUniformDistribution;
+  typedef BatchDistribution<Kernels::Gamma>       BatchGammaDistribution;
+  typedef BatchDistribution<Kernels::Beta>        BatchBetaDistribution;
+  typedef BatchDistribution<Kernels::Binomial>    BatchBinomialDistribution;
+  
+}
+
+#endif // BATCH_DISTRIBUTION_H
@@ -23,11 +23,9 @@
 #include "buffer_list.h"
 #include "error_print.h"
 #include "beta_distribution.h"
-#include "gamma_variate.h"
 #include "utilMatrixFloat.h"
 
 using AprilUtils::buffer_list;
-using AprilUtils::log_float;
 using Basics::MatrixFloat;
 using Basics::MTRand;
 
@@ -48,52 +46,30 @@ namespace Stats {
   void BetaDistribution::updateParams() {
     alphaf = (*alpha)(0);
     betaf  = (*beta)(0);
-    if (!(alphaf > 0.0f) || !(betaf > 0.0f))
+    float params[2] = { alphaf, betaf };
+    if (!Kernels::Beta::prepare(params, consts))
       ERROR_EXIT(128, "Beta distribution needs > 0 alpha and beta params\n");
-    log_float gamma_a(lgamma(alphaf));
-    log_float gamma_b(lgamma(betaf));
-    log_float gamma_ab(lgamma(alphaf + betaf));
-    Bab = ( gamma_a * gamma_b / gamma_ab );
   }
   
   void BetaDistribution::privateSample(MTRand *rng,
                                        MatrixFloat *result) {
     // generation via gamma variate
-    for (MatrixFloat::iterator result_it(result->begin());
-         result_it != result->end(); ++result_it) {
-      double y1 = gammaVariate(rng, 0.0f, 1.0f, alphaf);
-      double y2 = gammaVariate(rng, 0.0f, 1.0f, betaf);
-      *result_it = static_cast<float>( y1 / (y1 + y2) );
-    }
+    Kernels::applySample<Kernels::Beta>(rng, consts, 0, 0, result);
   }
   
   void BetaDistribution::privateLogpdf(const MatrixFloat *x,
                                        MatrixFloat *result) {
-    MatrixFloat::const_iterator x_it(x->begin());
-    MatrixFloat::iterator result_it(result->begin());
-    while(x_it != x->end()) {
-      if (*x_it < 0.0f || *x_it > 1.0f)
-        *result_it = log_float::zero().log();
-      else {
-        log_float vx  = log_float::from_float(*x_it).raise_to(alphaf - 1.0f);
-        log_float v1x = log_float::from_float(1.0f - *x_it).raise_to(betaf - 1.0f);
-        log_float r;
-        if (vx <= log_float::zero() || v1x <= log_float::zero())
-          r = log_float::zero();
-        else
-          r = vx * v1x / Bab;
-        *result_it = r.log();
-      }
-      ++x_it;
-      ++result_it;
-    }
+    Kernels::applyLogpdf<Kernels::Beta>(consts, 0, 0, x, result);
   }
 
   void BetaDistribution::privateLogcdf(const MatrixFloat *x,
                                        MatrixFloat *result) {
-    UNUSED_VARIABLE(x);
-    UNUSED_VARIABLE(result);
-    ERROR_EXIT(128, "NOT IMPLEMENTED\n");
+    Kernels::applyLogcdf<Kernels::Beta>(consts, 0, 0, x, result);
+  }
+
+  void BetaDistribution::privateLogpdfDerivative(const MatrixFloat *x,
+                                                 MatrixFloat *result) {
+    Kernels::applyLogpdfDerivative<Kernels::Beta>(consts, 0, 0, x, result);
   }
 
   StatisticalDistributionBase *BetaDistribution::clone() {
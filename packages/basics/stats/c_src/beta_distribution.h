@@ -21,7 +21,7 @@
 #ifndef BETA_DISTRIBUTION_H
 #define BETA_DISTRIBUTION_H
 
-#include "logbase.h"
+#include "distribution_kernels.h"
 #include "statistical_distribution.h"
 
 namespace Stats {
@@ -29,7 +29,7 @@ namespace Stats {
   class BetaDistribution : public StatisticalDistributionBase {
     Basics::MatrixFloat *alpha, *beta;
     float alphaf, betaf;
-    AprilUtils::log_float Bab;
+    float consts[Kernels::Beta::NUM_CONSTS];
 
     void updateParams();
     
@@ -39,6 +39,8 @@ namespace Stats {
                                Basics::MatrixFloat *result);
     virtual void privateLogcdf(const Basics::MatrixFloat *x,
                                Basics::MatrixFloat *result);
+    virtual void privateLogpdfDerivative(const Basics::MatrixFloat *x,
+                                         Basics::MatrixFloat *result);
     
   public:
     BetaDistribution(Basics::MatrixFloat *alpha, Basics::MatrixFloat *beta);
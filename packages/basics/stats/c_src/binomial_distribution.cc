@@ -23,11 +23,9 @@
 #include "buffer_list.h"
 #include "error_print.h"
 #include "binomial_distribution.h"
-#include "combinations.h"
 #include "utilMatrixFloat.h"
 
 using AprilUtils::buffer_list;
-using AprilUtils::log_float;
 using Basics::MatrixFloat;
 using Basics::MTRand;
 
@@ -58,84 +56,24 @@ namespace Stats {
     if (floorf(nf) != nf)
       ERROR_EXIT(128, "Binomial distribution needs an integer n param\n");
     //
-    pfm1 = 1.0f - pf;
-    if (pf == 1.0f) {
-      lpf = log_float::one();
-      lpfm1 = log_float::zero();
-    }
-    else if (pf == 0.0f) {
-      lpf = log_float::zero();
-      lpfm1 = log_float::one();
-    }
-    else {
-      lpf = log_float::from_float(pf);
-      lpfm1 = log_float::from_float(pfm1);
-    }
+    float params[2] = { nf, pf };
+    Kernels::Binomial::prepare(params, consts);
     ni = static_cast<int>(nf);
   }
   
   void BinomialDistribution::privateSample(MTRand *rng,
                                            MatrixFloat *result) {
-    // generation via gamma variate
-    for (MatrixFloat::iterator result_it(result->begin());
-         result_it != result->end(); ++result_it) {
-      // simulate n Bernoulli trials, and sum all values
-      int counts = 0;
-      for (int i=0; i<ni; ++i) {
-        if (rng->rand() < pf) ++counts;
-      }
-      *result_it = static_cast<float>(counts);
-    }
+    Kernels::applySample<Kernels::Binomial>(rng, consts, 0, 0, result);
   }
   
-  log_float BinomialDistribution::computeDensity(int k) {
-    unsigned int Ci = Combinations::get(ni, k);
-    log_float C = log_float::from_float(static_cast<float>(Ci));
-    return ( C *
-             lpf.raise_to(static_cast<float>(k)) *
-             lpfm1.raise_to(static_cast<float>(ni - k)) );
-  }
-
   void BinomialDistribution::privateLogpdf(const MatrixFloat *x,
                                            MatrixFloat *result) {
-    MatrixFloat::const_iterator x_it(x->begin());
-    MatrixFloat::iterator result_it(result->begin());
-    while(x_it != x->end()) {
-      if (floorf(*x_it) != *x_it)
-        ERROR_EXIT(128, "All values must be integers\n");
-      if (*x_it < 0.0f || *x_it > static_cast<float>(ni))
-        *result_it = log_float::zero().log();
-      else {
-        unsigned int k  = static_cast<unsigned int>(*x_it);
-        *result_it = computeDensity(k).log();
-      }
-      ++x_it;
-      ++result_it;
-    }
+    Kernels::applyLogpdf<Kernels::Binomial>(consts, 0, 0, x, result);
   }
 
   void BinomialDistribution::privateLogcdf(const MatrixFloat *x,
                                            MatrixFloat *result) {
-    MatrixFloat::const_iterator x_it(x->begin());
-    MatrixFloat::iterator result_it(result->begin());
-    while(x_it != x->end()) {
-      if (floorf(*x_it) != *x_it)
-        ERROR_EXIT(128, "All values must be integers\n");
-      if (*x_it < 0.0f)
-        *result_it = log_float::zero().log();
-      else if (*x_it > static_cast<float>(ni))
-        *result_it = log_float::one().log();
-      else {
-        log_float r = computeDensity(0);
-        int k = static_cast<int>(*x_it);
-        for (int i=1; i<=k; ++i) {
-          r += computeDensity(i);
-        }
-        *result_it = r.log();
-      }
-      ++x_it;
-      ++result_it;
-    }
+    Kernels::applyLogcdf<Kernels::Binomial>(consts, 0, 0, x, result);
   }
 
   StatisticalDistributionBase *BinomialDistribution::clone() {
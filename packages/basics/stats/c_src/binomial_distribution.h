@@ -21,7 +21,7 @@
 #ifndef BINOMIAL_DISTRIBUTION_H
 #define BINOMIAL_DISTRIBUTION_H
 
-#include "logbase.h"
+#include "distribution_kernels.h"
 #include "statistical_distribution.h"
 
 namespace Stats {
@@ -29,11 +29,10 @@ namespace Stats {
   class BinomialDistribution : public StatisticalDistributionBase {
     Basics::MatrixFloat *n, *p;
     int ni;
-    float pf, pfm1;
-    AprilUtils::log_float lpf, lpfm1;
+    float pf;
+    float consts[Kernels::Binomial::NUM_CONSTS];
     
     void updateParams();
-    AprilUtils::log_float computeDensity(int k);
 
   protected:
     virtual void privateSample(Basics::MTRand *rng,
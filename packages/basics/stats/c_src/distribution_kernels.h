@@ -0,0 +1,556 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef DISTRIBUTION_KERNELS_H
+#define DISTRIBUTION_KERNELS_H
+
+#include <cmath>
+#include "error_print.h"
+#include "gamma_variate.h"
+#include "matrixFloat.h"
+#include "MersenneTwister.h"
+#include "omp_utils.h"
+#include "unused_variable.h"
+
+namespace Stats {
+
+  /**
+   * @brief Scalar kernels of univariate distributions and the parallel loops
+   * which apply them over the NxM matrices of StatisticalDistributionBase.
+   *
+   * Every kernel K defines NUM_PARAMS, NUM_CONSTS, a prepare() method which
+   * validates the parameters and computes the constants used by the rest of
+   * methods, and logpdf(), logcdf(), dlogpdf(), draw() and transform()
+   * methods which receive a pointer to the constants. Sampling is splitted in
+   * draw(), which consumes the random generator and is executed sequentially,
+   * and transform(), which maps the drawn value to the sample and is executed
+   * in parallel. So, sampled values depend only in the random generator state
+   * and not in the number of threads.
+   */
+  namespace Kernels {
+
+    /// Value of log(0), the same of AprilUtils::log_float::zero()
+    const float LOG_ZERO = -1e12f;
+    /// Minimum number of elements to execute loops in parallel
+    const int PARALLEL_THRESHOLD = 4096;
+
+    inline float clampLog(double x) {
+      return (x > LOG_ZERO) ? static_cast<float>(x) : LOG_ZERO;
+    }
+
+    /// Computes log( Phi(z) ), the log cdf of the standard normal
+    inline double logNormalCDF(double z) {
+      if (z < -20.0) {
+        // asymptotic expansion, erfc underflows at the left tail
+        return -0.5*z*z - log(-z) - 0.5*log(2.0*M_PI);
+      }
+      return log(0.5*erfc(-z*M_SQRT1_2));
+    }
+
+    /// Continued fraction of the incomplete beta function (Lentz method)
+    inline double betaContinuedFraction(double a, double b, double x) {
+      const int MAX_IT = 300;
+      const double EPS = 1e-12, FP_MIN = 1e-300;
+      double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+      double c = 1.0, d = 1.0 - qab*x/qap;
+      if (fabs(d) < FP_MIN) d = FP_MIN;
+      d = 1.0/d;
+      double h = d;
+      for (int m=1; m<=MAX_IT; ++m) {
+        double m2 = 2.0*m;
+        double aa = m*(b - m)*x/((qam + m2)*(a + m2));
+        d = 1.0 + aa*d; if (fabs(d) < FP_MIN) d = FP_MIN;
+        c = 1.0 + aa/c; if (fabs(c) < FP_MIN) c = FP_MIN;
+        d = 1.0/d;
+        h *= d*c;
+        aa = -(a + m)*(qab + m)*x/((a + m2)*(qap + m2));
+        d = 1.0 + aa*d; if (fabs(d) < FP_MIN) d = FP_MIN;
+        c = 1.0 + aa/c; if (fabs(c) < FP_MIN) c = FP_MIN;
+        d = 1.0/d;
+        double del = d*c;
+        h *= del;
+        if (fabs(del - 1.0) < EPS) break;
+      }
+      return h;
+    }
+
+    /**
+     * @brief Computes log( I_x(a,b) ), the log of the regularized incomplete
+     * beta function, given lbeta = log( B(a,b) ).
+     */
+    inline double logIncompleteBeta(double a, double b, double lbeta,
+                                    double x) {
+      if (x <= 0.0) return LOG_ZERO;
+      if (x >= 1.0) return 0.0;
+      double lfront = a*log(x) + b*log1p(-x) - lbeta;
+      if (x < (a + 1.0)/(a + b + 2.0)) {
+        return lfront + log(betaContinuedFraction(a, b, x)/a);
+      }
+      return log1p(-exp(lfront + log(betaContinuedFraction(b, a, 1.0 - x)/b)));
+    }
+
+    /**
+     * @brief Computes log( P(a,x) ), the log of the regularized lower
+     * incomplete gamma function, given lgamma_a = log( Gamma(a) ).
+     */
+    inline double logIncompleteGamma(double a, double lgamma_a, double x) {
+      const int MAX_IT = 500;
+      const double EPS = 1e-12, FP_MIN = 1e-300;
+      if (x <= 0.0) return LOG_ZERO;
+      double lfront = a*log(x) - x - lgamma_a;
+      if (x < a + 1.0) {
+        // series representation
+        double ap = a, del = 1.0/a, sum = del;
+        for (int n=0; n<MAX_IT; ++n) {
+          ap += 1.0;
+          del *= x/ap;
+          sum += del;
+          if (fabs(del) < fabs(sum)*EPS) break;
+        }
+        return lfront + log(sum);
+      }
+      // continued fraction of the upper function Q(a,x)
+      double b = x + 1.0 - a, c = 1.0/FP_MIN, d = 1.0/b, h = d;
+      for (int i=1; i<=MAX_IT; ++i) {
+        double an = -i*(i - a);
+        b += 2.0;
+        d = an*d + b; if (fabs(d) < FP_MIN) d = FP_MIN;
+        c = b + an/c; if (fabs(c) < FP_MIN) c = FP_MIN;
+        d = 1.0/d;
+        double del = d*c;
+        h *= del;
+        if (fabs(del - 1.0) < EPS) break;
+      }
+      return log1p(-exp(lfront + log(h)));
+    }
+
+    /// Normal kernel, params = { mean, variance }
+    struct Normal {
+      static const int NUM_PARAMS = 2;
+      static const int NUM_CONSTS = 4; // mean, stddev, 1/variance, log K
+      static const bool HAS_DERIVATIVE = true;
+      static const char *name() { return "normal"; }
+      static bool prepare(const float *p, float *c) {
+        if (!(p[1] > 0.0f)) return false;
+        c[0] = p[0];
+        c[1] = sqrtf(p[1]);
+        c[2] = 1.0f/p[1];
+        c[3] = -0.5f*logf(2.0f*M_PI*p[1]);
+        return true;
+      }
+      static bool check(float x) { UNUSED_VARIABLE(x); return true; }
+      static float logpdf(float x, const float *c) {
+        float d = x - c[0];
+        return c[3] - 0.5f*d*d*c[2];
+      }
+      static float logcdf(float x, const float *c) {
+        return clampLog(logNormalCDF((x - c[0])/c[1]));
+      }
+      static float dlogpdf(float x, const float *c) {
+        return -(x - c[0])*c[2];
+      }
+      static float draw(Basics::MTRand *rng, const float *c) {
+        UNUSED_VARIABLE(c);
+        return static_cast<float>(rng->randNorm(0.0, 1.0));
+      }
+      static float transform(float u, const float *c) {
+        return c[0] + u*c[1];
+      }
+    };
+
+    /// Log-normal kernel, params = { mean, variance, location }
+    struct LogNormal {
+      static const int NUM_PARAMS = 3;
+      static const int NUM_CONSTS = 5; // Normal constants plus location
+      static const bool HAS_DERIVATIVE = true;
+      static const char *name() { return "lognormal"; }
+      static bool prepare(const float *p, float *c) {
+        if (!Normal::prepare(p, c)) return false;
+        c[4] = p[2];
+        return true;
+      }
+      static bool check(float x) { UNUSED_VARIABLE(x); return true; }
+      static float logpdf(float x, const float *c) {
+        float y = x - c[4];
+        if (!(y > 0.0f)) return LOG_ZERO;
+        float ly = logf(y);
+        return Normal::logpdf(ly, c) - ly;
+      }
+      static float logcdf(float x, const float *c) {
+        float y = x - c[4];
+        if (!(y > 0.0f)) return LOG_ZERO;
+        return Normal::logcdf(logf(y), c);
+      }
+      static float dlogpdf(float x, const float *c) {
+        float y = x - c[4];
+        if (!(y > 0.0f)) return 0.0f;
+        return -(1.0f + (logf(y) - c[0])*c[2])/y;
+      }
+      static float draw(Basics::MTRand *rng, const float *c) {
+        return Normal::draw(rng, c);
+      }
+      static float transform(float u, const float *c) {
+        return expf(Normal::transform(u, c)) + c[4];
+      }
+    };
+
+    /// Exponential kernel, params = { lambda }
+    struct Exponential {
+      static const int NUM_PARAMS = 1;
+      static const int NUM_CONSTS = 3; // lambda, log lambda, 1/lambda
+      static const bool HAS_DERIVATIVE = true;
+      static const char *name() { return "exponential"; }
+      static bool prepare(const float *p, float *c) {
+        if (!(p[0] > 0.0f)) return false;
+        c[0] = p[0];
+        c[1] = logf(p[0]);
+        c[2] = 1.0f/p[0];
+        return true;
+      }
+      /// Exponential distribution is not defined for negative numbers
+      static bool check(float x) { return !(x < 0.0f); }
+      static float logpdf(float x, const float *c) {
+        return c[1] - c[0]*x;
+      }
+      static float logcdf(float x, const float *c) {
+        if (!(x > 0.0f)) return LOG_ZERO;
+        return clampLog(log1p(-exp(-static_cast<double>(c[0])*x)));
+      }
+      static float dlogpdf(float x, const float *c) {
+        UNUSED_VARIABLE(x);
+        return -c[0];
+      }
+      static float draw(Basics::MTRand *rng, const float *c) {
+        UNUSED_VARIABLE(c);
+        return static_cast<float>(rng->randDblExc());
+      }
+      static float transform(float u, const float *c) {
+        return -logf(u)*c[2];
+      }
+    };
+
+    /// Uniform kernel, params = { low, high }
+    struct Uniform {
+      static const int NUM_PARAMS = 2;
+      static const int NUM_CONSTS = 4; // low, high, high-low, -log(high-low)
+      static const bool HAS_DERIVATIVE = true;
+      static const char *name() { return "uniform"; }
+      static bool prepare(const float *p, float *c) {
+        if (!(p[0] < p[1])) return false;
+        c[0] = p[0];
+        c[1] = p[1];
+        c[2] = p[1] - p[0];
+        c[3] = -logf(c[2]);
+        return true;
+      }
+      static bool check(float x) { UNUSED_VARIABLE(x); return true; }
+      static float logpdf(float x, const float *c) {
+        return (c[0] <= x && x <= c[1]) ? c[3] : LOG_ZERO;
+      }
+      static float logcdf(float x, const float *c) {
+        if (x < c[0]) return LOG_ZERO;
+        if (x < c[1]) return clampLog(log((x - c[0])/c[2]));
+        return 0.0f;
+      }
+      static float dlogpdf(float x, const float *c) {
+        UNUSED_VARIABLE(x);
+        UNUSED_VARIABLE(c);
+        return 0.0f;
+      }
+      static float draw(Basics::MTRand *rng, const float *c) {
+        UNUSED_VARIABLE(c);
+        return static_cast<float>(rng->rand());
+      }
+      static float transform(float u, const float *c) {
+        return c[0] + u*c[2];
+      }
+    };
+
+    /// Gamma kernel, params = { shape, scale }
+    struct Gamma {
+      static const int NUM_PARAMS = 2;
+      // shape, 1/scale, lgamma(shape), scale, log(1/scale)
+      static const int NUM_CONSTS = 5;
+      static const bool HAS_DERIVATIVE = true;
+      static const char *name() { return "gamma"; }
+      static bool prepare(const float *p, float *c) {
+        if (!(p[0] > 0.0f) || !(p[1] > 0.0f)) return false;
+        c[0] = p[0];
+        c[1] = 1.0f/p[1];
+        c[2] = lgamma(p[0]);
+        c[3] = p[1];
+        c[4] = logf(c[1]);
+        return true;
+      }
+      static bool check(float x) { UNUSED_VARIABLE(x); return true; }
+      static float logpdf(float x, const float *c) {
+        if (x < 0.0f) return LOG_ZERO;
+        float y = x*c[1];
+        float ly = (c[0] == 1.0f) ? 0.0f : ((y > 0.0f) ?
+                                            (c[0] - 1.0f)*logf(y) :
+                                            LOG_ZERO);
+        return clampLog(ly - y - c[2] + c[4]);
+      }
+      static float logcdf(float x, const float *c) {
+        return clampLog(logIncompleteGamma(c[0], c[2], x*c[1]));
+      }
+      static float dlogpdf(float x, const float *c) {
+        if (!(x > 0.0f)) return 0.0f;
+        return (c[0] - 1.0f)/x - c[1];
+      }
+      static float draw(Basics::MTRand *rng, const float *c) {
+        return static_cast<float>(gammaVariate(rng, 0.0, 1.0, c[0]));
+      }
+      static float transform(float u, const float *c) {
+        return u*c[3];
+      }
+    };
+
+    /// Beta kernel, params = { alpha, beta }
+    struct Beta {
+      static const int NUM_PARAMS = 2;
+      static const int NUM_CONSTS = 3; // alpha, beta, log B(alpha,beta)
+      static const bool HAS_DERIVATIVE = true;
+      static const char *name() { return "beta"; }
+      static bool prepare(const float *p, float *c) {
+        if (!(p[0] > 0.0f) || !(p[1] > 0.0f)) return false;
+        c[0] = p[0];
+        c[1] = p[1];
+        c[2] = lgamma(p[0]) + lgamma(p[1]) - lgamma(p[0] + p[1]);
+        return true;
+      }
+      static bool check(float x) { UNUSED_VARIABLE(x); return true; }
+      static float logpdf(float x, const float *c) {
+        if (x < 0.0f || x > 1.0f) return LOG_ZERO;
+        float lx  = (c[0] == 1.0f) ? 0.0f : ((x > 0.0f) ?
+                                             (c[0] - 1.0f)*logf(x) :
+                                             LOG_ZERO);
+        float l1x = (c[1] == 1.0f) ? 0.0f : ((x < 1.0f) ?
+                                             (c[1] - 1.0f)*logf(1.0f - x) :
+                                             LOG_ZERO);
+        return clampLog(lx + l1x - c[2]);
+      }
+      static float logcdf(float x, const float *c) {
+        return clampLog(logIncompleteBeta(c[0], c[1], c[2], x));
+      }
+      static float dlogpdf(float x, const float *c) {
+        if (!(x > 0.0f && x < 1.0f)) return 0.0f;
+        return (c[0] - 1.0f)/x - (c[1] - 1.0f)/(1.0f - x);
+      }
+      static float draw(Basics::MTRand *rng, const float *c) {
+        double y1 = gammaVariate(rng, 0.0f, 1.0f, c[0]);
+        double y2 = gammaVariate(rng, 0.0f, 1.0f, c[1]);
+        return static_cast<float>( y1 / (y1 + y2) );
+      }
+      static float transform(float u, const float *c) {
+        UNUSED_VARIABLE(c);
+        return u;
+      }
+    };
+
+    /// Binomial kernel, params = { n, p }
+    struct Binomial {
+      static const int NUM_PARAMS = 2;
+      static const int NUM_CONSTS = 5; // n, p, log p, log(1-p), lgamma(n+1)
+      static const bool HAS_DERIVATIVE = false;
+      static const char *name() { return "binomial"; }
+      static bool prepare(const float *p, float *c) {
+        if (!(p[0] > 0.0f) || floorf(p[0]) != p[0]) return false;
+        if (!(p[1] > 0.0f) || !(p[1] < 1.0f)) return false;
+        c[0] = p[0];
+        c[1] = p[1];
+        c[2] = logf(p[1]);
+        c[3] = log1pf(-p[1]);
+        c[4] = lgamma(p[0] + 1.0f);
+        return true;
+      }
+      /// Binomial distribution is only defined for integer values
+      static bool check(float x) { return floorf(x) == x; }
+      static float logpdf(float x, const float *c) {
+        if (x < 0.0f || x > c[0]) return LOG_ZERO;
+        return clampLog(c[4] - lgamma(x + 1.0f) - lgamma(c[0] - x + 1.0f) +
+                        x*c[2] + (c[0] - x)*c[3]);
+      }
+      static float logcdf(float x, const float *c) {
+        if (x < 0.0f) return LOG_ZERO;
+        if (x >= c[0]) return 0.0f;
+        // P(X <= k) = I_{1-p}(n-k, k+1)
+        double a = c[0] - x, b = x + 1.0;
+        double lbeta = lgamma(a) + lgamma(b) - c[4];
+        return clampLog(logIncompleteBeta(a, b, lbeta, 1.0 - c[1]));
+      }
+      static float dlogpdf(float x, const float *c) {
+        UNUSED_VARIABLE(x);
+        UNUSED_VARIABLE(c);
+        return 0.0f;
+      }
+      static float draw(Basics::MTRand *rng, const float *c) {
+        // simulate n Bernoulli trials, and sum all values
+        const int n = static_cast<int>(c[0]);
+        int counts = 0;
+        for (int i=0; i<n; ++i) {
+          if (rng->rand() < c[1]) ++counts;
+        }
+        return static_cast<float>(counts);
+      }
+      static float transform(float u, const float *c) {
+        UNUSED_VARIABLE(c);
+        return u;
+      }
+    };
+
+    ////////////////////////////////////////////////////////////////////////
+
+    /*
+     * The following loops traverse a NxM matrix x where element (i,j) uses
+     * the constants at consts + i*row_step + j*col_step. A zero row_step
+     * means all rows share the same parameters, a zero col_step means all
+     * columns share the same parameters.
+     */
+
+    /// result(i) = sum_j logpdf( x(i,j) )
+    template<typename K>
+    void applyLogpdf(const float *consts, int row_step, int col_step,
+                     const Basics::MatrixFloat *x,
+                     Basics::MatrixFloat *result) {
+      const int N = x->getDimSize(0), M = x->getDimSize(1);
+      const int x_s0 = x->getStrideSize(0), x_s1 = x->getStrideSize(1);
+      const int r_s0 = result->getStrideSize(0);
+      const float *x_ptr = x->getRawDataAccess()->getPPALForRead() +
+        x->getOffset();
+      float *r_ptr = result->getRawDataAccess()->getPPALForWrite() +
+        result->getOffset();
+      int errors = 0;
+#ifndef NO_OMP
+#pragma omp parallel for reduction(+:errors) if(N*M > PARALLEL_THRESHOLD)
+#endif
+      for (int i=0; i<N; ++i) {
+        const float *xi = x_ptr + i*x_s0;
+        const float *ci = consts + i*row_step;
+        float acc = 0.0f;
+        for (int j=0; j<M; ++j) {
+          const float v = xi[j*x_s1];
+          if (!K::check(v)) ++errors;
+          acc += K::logpdf(v, ci + j*col_step);
+        }
+        r_ptr[i*r_s0] = (acc > LOG_ZERO) ? acc : LOG_ZERO;
+      }
+      if (errors > 0) {
+        ERROR_EXIT2(128, "Found %d incorrect values for %s distribution\n",
+                    errors, K::name());
+      }
+    }
+
+    /// result(i) = sum_j logcdf( x(i,j) )
+    template<typename K>
+    void applyLogcdf(const float *consts, int row_step, int col_step,
+                     const Basics::MatrixFloat *x,
+                     Basics::MatrixFloat *result) {
+      const int N = x->getDimSize(0), M = x->getDimSize(1);
+      const int x_s0 = x->getStrideSize(0), x_s1 = x->getStrideSize(1);
+      const int r_s0 = result->getStrideSize(0);
+      const float *x_ptr = x->getRawDataAccess()->getPPALForRead() +
+        x->getOffset();
+      float *r_ptr = result->getRawDataAccess()->getPPALForWrite() +
+        result->getOffset();
+      int errors = 0;
+#ifndef NO_OMP
+#pragma omp parallel for reduction(+:errors) if(N*M > PARALLEL_THRESHOLD/8)
+#endif
+      for (int i=0; i<N; ++i) {
+        const float *xi = x_ptr + i*x_s0;
+        const float *ci = consts + i*row_step;
+        float acc = 0.0f;
+        for (int j=0; j<M; ++j) {
+          const float v = xi[j*x_s1];
+          if (!K::check(v)) ++errors;
+          acc += K::logcdf(v, ci + j*col_step);
+        }
+        r_ptr[i*r_s0] = (acc > LOG_ZERO) ? acc : LOG_ZERO;
+      }
+      if (errors > 0) {
+        ERROR_EXIT2(128, "Found %d incorrect values for %s distribution\n",
+                    errors, K::name());
+      }
+    }
+
+    /// grads(i,j) += dlogpdf( x(i,j) )
+    template<typename K>
+    void applyLogpdfDerivative(const float *consts, int row_step, int col_step,
+                               const Basics::MatrixFloat *x,
+                               Basics::MatrixFloat *grads) {
+      if (!K::HAS_DERIVATIVE) {
+        ERROR_EXIT1(128, "Derivative not implemented for %s distribution\n",
+                    K::name());
+      }
+      const int N = x->getDimSize(0), M = x->getDimSize(1);
+      const int x_s0 = x->getStrideSize(0), x_s1 = x->getStrideSize(1);
+      const int g_s0 = grads->getStrideSize(0), g_s1 = grads->getStrideSize(1);
+      const float *x_ptr = x->getRawDataAccess()->getPPALForRead() +
+        x->getOffset();
+      float *g_ptr = grads->getRawDataAccess()->getPPALForReadAndWrite() +
+        grads->getOffset();
+#ifndef NO_OMP
+#pragma omp parallel for if(N*M > PARALLEL_THRESHOLD)
+#endif
+      for (int i=0; i<N; ++i) {
+        const float *xi = x_ptr + i*x_s0;
+        const float *ci = consts + i*row_step;
+        float *gi = g_ptr + i*g_s0;
+        for (int j=0; j<M; ++j) {
+          gi[j*g_s1] += K::dlogpdf(xi[j*x_s1], ci + j*col_step);
+        }
+      }
+    }
+
+    /// result(i,j) = transform( draw() ), draws are done in row-major order
+    template<typename K>
+    void applySample(Basics::MTRand *rng,
+                     const float *consts, int row_step, int col_step,
+                     Basics::MatrixFloat *result) {
+      const int N = result->getDimSize(0), M = result->getDimSize(1);
+      const int r_s0 = result->getStrideSize(0);
+      const int r_s1 = result->getStrideSize(1);
+      float *r_ptr = result->getRawDataAccess()->getPPALForWrite() +
+        result->getOffset();
+      // the random generator is not thread safe
+      for (int i=0; i<N; ++i) {
+        for (int j=0; j<M; ++j) {
+          r_ptr[i*r_s0 + j*r_s1] = K::draw(rng, consts + i*row_step +
+                                           j*col_step);
+        }
+      }
+#ifndef NO_OMP
+#pragma omp parallel for if(N*M > PARALLEL_THRESHOLD)
+#endif
+      for (int i=0; i<N; ++i) {
+        float *ri = r_ptr + i*r_s0;
+        const float *ci = consts + i*row_step;
+        for (int j=0; j<M; ++j) {
+          ri[j*r_s1] = K::transform(ri[j*r_s1], ci + j*col_step);
+        }
+      }
+    }
+    
+  } // namespace Kernels
+  
+} // namespace Stats
+
+#endif // DISTRIBUTION_KERNELS_H
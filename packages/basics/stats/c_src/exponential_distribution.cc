@@ -22,15 +22,8 @@
 #include "c_string.h"
 #include "error_print.h"
 #include "exponential_distribution.h"
-#include "matrix_ext.h"
 #include "smart_ptr.h"
-#include "utilMatrixFloat.h"
 
-using namespace AprilMath::MatrixExt::BLAS;
-using namespace AprilMath::MatrixExt::Initializers;
-using namespace AprilMath::MatrixExt::Operations;
-using namespace AprilMath::MatrixExt::Reductions;
-using AprilUtils::log_float;
 using AprilUtils::SharedPtr;
 using AprilIO::CStringStream;
 using Basics::MatrixFloat;
@@ -40,7 +33,7 @@ namespace Stats {
   
   ExponentialDistribution::ExponentialDistribution(MatrixFloat *lambda) :
     StatisticalDistributionBase(lambda->size()),
-    lambda(lambda), inv_lambda(0) {
+    lambda(lambda) {
     if (lambda->getNumDim() != 1)
       ERROR_EXIT(128, "Expected one-dimensional lambda matrix\n");
     IncRef(lambda);
@@ -49,81 +42,46 @@ namespace Stats {
 
   ExponentialDistribution::~ExponentialDistribution() {
     DecRef(lambda);
-    if (inv_lambda != 0) DecRef(inv_lambda);
   }
   
   void ExponentialDistribution::updateParams() {
+    consts.resize(lambda->size() * Kernels::Exponential::NUM_CONSTS);
+    float *c = consts.begin();
     for (MatrixFloat::iterator it(lambda->begin()); it != lambda->end(); ++it) {
-      if (*it < 0.0f) {
-        ERROR_EXIT1(128, "Found negative lambda parameter at position %d\n",
+      if (!Kernels::Exponential::prepare(&(*it), c)) {
+        ERROR_EXIT1(128, "Found not positive lambda parameter at position %d\n",
                     it.getIdx());
       }
-    }
-    MatrixFloat *log_lambda = lambda->clone();
-    IncRef(log_lambda);
-    matLog(log_lambda);
-    lambda_prod = log_float(matSum(log_lambda));
-    DecRef(log_lambda);
-    if (inv_lambda) {
-      DecRef(inv_lambda);
-      inv_lambda = 0;
+      c += Kernels::Exponential::NUM_CONSTS;
     }
   }
   
   void ExponentialDistribution::privateSample(MTRand *rng,
                                               MatrixFloat *result) {
-    if (inv_lambda == 0) {
-      AssignRef(inv_lambda, lambda->clone());
-      matDiv(inv_lambda,1.0f);
-    }
-    for (MatrixFloat::iterator it(result->begin()); it != result->end(); ++it) {
-      float v = static_cast<float>(rng->randDblExc());
-      april_assert(v > 0.0f && v < 1.0f);
-      *it = v;
-    }
-    matLog(result);
-    matScal(result,-1.0f);
-    MatrixFloat *result_row = 0;
-    for (int i=0; i<result->getDimSize(0); ++i) {
-      result_row = result->select(0, i, result_row);
-      matCmul(result_row, inv_lambda);
-    }
-    delete result_row;
+    Kernels::applySample<Kernels::Exponential>(rng, consts.begin(),
+                                               0, Kernels::Exponential::NUM_CONSTS,
+                                               result);
   }
   
   void ExponentialDistribution::privateLogpdf(const MatrixFloat *x,
                                               MatrixFloat *result) {
-    int a,b;
-    if (matMin(x,a,b) < 0.0f) {
-      ERROR_EXIT(128, "Exponential dist. is not defined for neg. numbers\n");
-    }
-    UNUSED_VARIABLE(a);
-    UNUSED_VARIABLE(b);
-    matFill(result, lambda_prod.log());
-    matGemv(result, CblasNoTrans, -1.0f, x, lambda, 1.0f);
+    Kernels::applyLogpdf<Kernels::Exponential>(consts.begin(),
+                                               0, Kernels::Exponential::NUM_CONSTS,
+                                               x, result);
   }
 
   void ExponentialDistribution::privateLogcdf(const MatrixFloat *x,
                                               MatrixFloat *result) {
-    int a,b;
-    if (matMin(x,a,b) < 0.0f)
-      ERROR_EXIT(128, "Exponential dist. is not defined for neg. numbers\n");
-    UNUSED_VARIABLE(a);
-    UNUSED_VARIABLE(b);
-    int dims[2] = { result->getDimSize(0), 1 };
-    // FIXME: needs a contiguous result matrix
-    SharedPtr<MatrixFloat> rewrapped_result( result->rewrap(dims, 2) );
-    SharedPtr<MatrixFloat> x_clone( x->clone() ), x_row;
-    //
-    for (int i=0; i<x->getDimSize(0); ++i) {
-      x_row = x_clone->select(0, i, x_row.get());
-      matCmul(x_row.get(), lambda);
-    }
-    matScal(x_clone.get(), -1.0f);
-    matExp(x_clone.get());
-    matScal(x_clone.get(), -1.0f);
-    matLog1p(x_clone.get());
-    matSum(x_clone.get(), 1, rewrapped_result.get());
+    Kernels::applyLogcdf<Kernels::Exponential>(consts.begin(),
+                                               0, Kernels::Exponential::NUM_CONSTS,
+                                               x, result);
+  }
+
+  void ExponentialDistribution::privateLogpdfDerivative(const MatrixFloat *x,
+                                                        MatrixFloat *result) {
+    Kernels::applyLogpdfDerivative<Kernels::Exponential>(consts.begin(),
+                                                         0, Kernels::Exponential::NUM_CONSTS,
+                                                         x, result);
   }
 
   StatisticalDistributionBase *ExponentialDistribution::clone() {
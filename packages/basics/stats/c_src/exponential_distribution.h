@@ -21,14 +21,16 @@
 #ifndef EXPONENTIAL_DISTRIBUTION_H
 #define EXPONENTIAL_DISTRIBUTION_H
 
-#include "logbase.h"
+#include "distribution_kernels.h"
 #include "statistical_distribution.h"
+#include "vector.h"
 
 namespace Stats {
 
   class ExponentialDistribution : public StatisticalDistributionBase {
-    Basics::MatrixFloat *lambda, *inv_lambda;
-    AprilUtils::log_float lambda_prod;
+    Basics::MatrixFloat *lambda;
+    /// Kernels::Exponential constants, one row per data point component
+    AprilUtils::vector<float> consts;
     
     void updateParams();
 
@@ -39,6 +41,8 @@ namespace Stats {
                                Basics::MatrixFloat *result);
     virtual void privateLogcdf(const Basics::MatrixFloat *x,
                                Basics::MatrixFloat *result);
+    virtual void privateLogpdfDerivative(const Basics::MatrixFloat *x,
+                                         Basics::MatrixFloat *result);
     
   public:
     ExponentialDistribution(Basics::MatrixFloat *lambda);
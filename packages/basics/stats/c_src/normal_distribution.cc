@@ -161,7 +161,7 @@ namespace Stats {
   DiagonalNormalDistribution::DiagonalNormalDistribution(MatrixFloat *mean,
                                                          SparseMatrixFloat *cov) :
     StatisticalDistributionBase(mean->size()),
-    mean(mean), cov(cov), inv_cov(0), L(0) {
+    mean(mean), cov(cov) {
     if (mean->getNumDim() != 1)
       ERROR_EXIT(128, "Expected one-dimensional mean matrix\n");
     if (cov->getNumDim() != 2 || cov->getDimSize(0) != cov->getDimSize(1))
@@ -176,96 +176,61 @@ namespace Stats {
   DiagonalNormalDistribution::~DiagonalNormalDistribution() {
     DecRef(mean);
     DecRef(cov);
-    DecRef(inv_cov);
-    if (L != 0) DecRef(L);
   }
   
   void DiagonalNormalDistribution::updateParams() {
     if (!cov->isDiagonal())
       ERROR_EXIT(256, "Expected diagonal cov sparse matrix\n");
-    // K = 1 / sqrtf( 2*pi^k * |cov| )
-    AssignRef(inv_cov, cov->clone());
-    matDiv(inv_cov, 1.0f);
-    // inv_cov->pruneSubnormalAndCheckNormal();
-    cov_det = log_float::one();
+    const int size = mean->getDimSize(0);
+    AprilUtils::vector<float> var(size, 0.0f);
     for (SparseMatrixFloat::iterator it(cov->begin());
          it != cov->end(); ++it) {
+      int x0,x1;
+      it.getCoords(x0,x1);
       if (!std::isfinite(*it)) {
-        int x0,x1;
-        it.getCoords(x0,x1);
 	ERROR_EXIT3(256, "No finite number at position %d,%d with value %g\n",
                     x0, x1, *it);
       }
       if (*it < 0.0f)
         ERROR_EXIT(256, "Expected a definite positive covariance matrix\n");
-      cov_det *= log_float::from_float(*it);
+      var[x0] = *it;
+    }
+    consts.resize(size * Kernels::Normal::NUM_CONSTS);
+    MatrixFloat::const_iterator mean_it(mean->begin());
+    for (int i=0; i<size; ++i, ++mean_it) {
+      float params[2] = { *mean_it, var[i] };
+      if (!Kernels::Normal::prepare(params,
+                                    consts.begin() + i*Kernels::Normal::NUM_CONSTS))
+        ERROR_EXIT(256, "Expected a definite positive covariance matrix\n");
     }
-    log_float KM_2PI = log_float::from_float(M_2PI).
-      raise_to(static_cast<float>(mean->getDimSize(0)));
-    log_float denom = (KM_2PI * cov_det).raise_to(0.5f);
-    K = log_float::one() / denom;
-    if (L != 0) DecRef(L);
-    L = 0;
   }
   
   void DiagonalNormalDistribution::privateSample(MTRand *rng,
                                                  MatrixFloat *result) {
-    if (L == 0) {
-      L = cov->clone();
-      matSqrt(L);
-      IncRef(L);
-    }
-    SharedPtr<MatrixFloat> z( result->cloneOnlyDims() );
-    for (MatrixFloat::iterator z_it = z->begin(); z_it != z->end(); ++z_it) {
-      *z_it = static_cast<float>(rng->randNorm(0.0, 1.0));
-    }
-    SharedPtr<MatrixFloat> rT(result->transpose());
-    matSparseMM(rT.get(), CblasTrans, CblasTrans,
-                1.0f, L, z.get(), 0.0f);
-    SharedPtr<MatrixFloat> result_row;
-    for (int i=0; i<result->getDimSize(0); ++i) {
-      result_row = result->select(0, i, result_row.get());
-      matAxpy(result_row.get(), 1.0f, mean);
-    }
+    Kernels::applySample<Kernels::Normal>(rng, consts.begin(),
+                                          0, Kernels::Normal::NUM_CONSTS,
+                                          result);
   }
   
   void DiagonalNormalDistribution::privateLogpdf(const MatrixFloat *x,
                                                  MatrixFloat *result) {
-    SharedPtr<MatrixFloat> diff( x->clone() );
-    int dims[1] = { x->getDimSize(1) };
-    SharedPtr<MatrixFloat> mult( new MatrixFloat(1, dims) );
-    // over all samples (bunch_size)
-    MatrixFloat::iterator result_it(result->begin());
-    SharedPtr<MatrixFloat> diff_row;
-    for (int i=0; i<x->getDimSize(0); ++i, ++result_it) {
-      diff_row = diff->select(0, i, diff_row.get());
-      matAxpy(diff_row.get(), -1.0f, mean);
-      matGemv(mult.get(), CblasNoTrans, 1.0f, inv_cov, diff_row.get(), 0.0f);
-      *result_it = -0.5 * matDot(mult.get(), diff_row.get());
-    }
-    matScalarAdd(result, K.log() );
+    Kernels::applyLogpdf<Kernels::Normal>(consts.begin(),
+                                          0, Kernels::Normal::NUM_CONSTS,
+                                          x, result);
   }
 
   void DiagonalNormalDistribution::privateLogcdf(const MatrixFloat *x,
                                                  MatrixFloat *result) {
-    UNUSED_VARIABLE(x);
-    UNUSED_VARIABLE(result);
-    ERROR_EXIT(128, "Not implemented");
+    Kernels::applyLogcdf<Kernels::Normal>(consts.begin(),
+                                          0, Kernels::Normal::NUM_CONSTS,
+                                          x, result);
   }
 
   void DiagonalNormalDistribution::privateLogpdfDerivative(const MatrixFloat *x,
                                                            MatrixFloat *result) {
-    SharedPtr<MatrixFloat> diff( x->clone() );
-    // over all samples (bunch_size)
-    SharedPtr<MatrixFloat> diff_row;
-    SharedPtr<MatrixFloat> result_row;
-    for (int i=0; i<x->getDimSize(0); ++i) {
-      diff_row = diff->select(0, i, diff_row.get());
-      result_row = result->select(0, i, result_row.get());
-      matAxpy(diff_row.get(), -1.0f, mean);
-      matGemv(result_row.get(), CblasNoTrans, -1.0f,
-              inv_cov, diff_row.get(), 1.0f);
-    }
+    Kernels::applyLogpdfDerivative<Kernels::Normal>(consts.begin(),
+                                                    0, Kernels::Normal::NUM_CONSTS,
+                                                    x, result);
   }
 
   StatisticalDistributionBase *DiagonalNormalDistribution::clone() {
@@ -429,50 +394,52 @@ namespace Stats {
     IncRef(location);
     if (!location->sameDim(mean))
       ERROR_EXIT(256, "Expected location param with same shape as mean param\n");
-    updateParams();
+    updateLogParams();
   }
 
   DiagonalLogNormalDistribution::~DiagonalLogNormalDistribution() {
     DecRef(location);
   }
+
+  void DiagonalLogNormalDistribution::updateLogParams() {
+    const int size = mean->getDimSize(0);
+    log_consts.resize(size * Kernels::LogNormal::NUM_CONSTS);
+    MatrixFloat::const_iterator location_it(location->begin());
+    for (int i=0; i<size; ++i, ++location_it) {
+      const float *c = consts.begin() + i*Kernels::Normal::NUM_CONSTS;
+      // mean and variance are recovered from normal constants
+      float params[3] = { c[0], c[1]*c[1], *location_it };
+      Kernels::LogNormal::prepare(params,
+                                  log_consts.begin() + i*Kernels::LogNormal::NUM_CONSTS);
+    }
+  }
   
   void DiagonalLogNormalDistribution::privateSample(MTRand *rng,
                                                     MatrixFloat *result) {
-    DiagonalNormalDistribution::privateSample(rng, result);
-    matExp(result);
-    SharedPtr<MatrixFloat> result_row;
-    for (int i=0; i<result->getDimSize(0); ++i) {
-      result_row = result->select(0, i, result_row.get());
-      matAxpy(result_row.get(), 1.0f, location);
-    }
+    Kernels::applySample<Kernels::LogNormal>(rng, log_consts.begin(),
+                                             0, Kernels::LogNormal::NUM_CONSTS,
+                                             result);
   }
   
   void DiagonalLogNormalDistribution::privateLogpdf(const MatrixFloat *x,
                                                     MatrixFloat *result) {
-    SharedPtr<MatrixFloat> xlog( x->clone() );
-    SharedPtr<MatrixFloat> xlog_row;
-    for (int i=0; i<x->getDimSize(0); ++i) {
-      xlog_row = xlog->select(0, i, xlog_row.get());
-      matAxpy(xlog_row.get(), -1.0f, location);
-    }
-    matLog(xlog.get());
-    DiagonalNormalDistribution::privateLogpdf(xlog.get(), result);
-    SharedPtr<MatrixFloat> xlog_sum( matSum(xlog.get(), 1) );
-    matAxpy(result, -1.0f, xlog_sum.get());
+    Kernels::applyLogpdf<Kernels::LogNormal>(log_consts.begin(),
+                                             0, Kernels::LogNormal::NUM_CONSTS,
+                                             x, result);
   }
 
   void DiagonalLogNormalDistribution::privateLogcdf(const MatrixFloat *x,
                                                     MatrixFloat *result) {
-    UNUSED_VARIABLE(x);
-    UNUSED_VARIABLE(result);
-    ERROR_EXIT(128, "Not implemented");
+    Kernels::applyLogcdf<Kernels::LogNormal>(log_consts.begin(),
+                                             0, Kernels::LogNormal::NUM_CONSTS,
+                                             x, result);
   }
 
   void DiagonalLogNormalDistribution::privateLogpdfDerivative(const MatrixFloat *x,
                                                               MatrixFloat *result) {
-    UNUSED_VARIABLE(x);
-    UNUSED_VARIABLE(result);
-    ERROR_EXIT(128, "Not implemented");
+    Kernels::applyLogpdfDerivative<Kernels::LogNormal>(log_consts.begin(),
+                                                       0, Kernels::LogNormal::NUM_CONSTS,
+                                                       x, result);
   }
 
   StatisticalDistributionBase *DiagonalLogNormalDistribution::clone() {
@@ -21,9 +21,11 @@
 #ifndef NORMAL_DISTRIBUTION_H
 #define NORMAL_DISTRIBUTION_H
 
+#include "distribution_kernels.h"
 #include "matrixFloat.h"
 #include "sparse_matrixFloat.h"
 #include "statistical_distribution.h"
+#include "vector.h"
 
 namespace Stats {
 
@@ -56,9 +58,9 @@ namespace Stats {
   class DiagonalNormalDistribution : public StatisticalDistributionBase {
   protected:
     Basics::MatrixFloat *mean;
-    AprilUtils::log_float cov_det, K;
-    float cov_det_sign;
-    Basics::SparseMatrixFloat *cov, *inv_cov, *L;
+    Basics::SparseMatrixFloat *cov;
+    /// Kernels::Normal constants, one row per data point component
+    AprilUtils::vector<float> consts;
 
     void updateParams();
     virtual void privateSample(Basics::MTRand *rng,
@@ -126,6 +128,10 @@ namespace Stats {
   /// Log-LogNormal distribution with diagonal covariance sparse matrix
   class DiagonalLogNormalDistribution : public DiagonalNormalDistribution {
     Basics::MatrixFloat *location;
+    /// Kernels::LogNormal constants, one row per data point component
+    AprilUtils::vector<float> log_consts;
+
+    void updateLogParams();
 
   protected:
     virtual void privateSample(Basics::MTRand *rng,
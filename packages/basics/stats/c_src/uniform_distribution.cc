@@ -22,7 +22,6 @@
 #include "smart_ptr.h"
 #include "uniform_distribution.h"
 
-using AprilUtils::log_float;
 using AprilUtils::SharedPtr;
 using AprilIO::CStringStream;
 using Basics::MatrixFloat;
@@ -33,7 +32,7 @@ namespace Stats {
   UniformDistribution::UniformDistribution(MatrixFloat *low,
                                            MatrixFloat *high) :
     StatisticalDistributionBase(low->size()),
-    low(low), high(high), diff(0) {
+    low(low), high(high) {
     IncRef(low);
     IncRef(high);
     if (!low->sameDim(high))
@@ -52,86 +51,26 @@ namespace Stats {
   UniformDistribution::~UniformDistribution() {
     DecRef(low);
     DecRef(high);
-    DecRef(diff);
   }
 
   void UniformDistribution::privateSample(MTRand *rng, MatrixFloat *result) {
-    // traverse in row_major result matrix
-    MatrixFloat::iterator it(result->begin());
-    while(it != result->end()) {
-      // traverse in row_major low and diff matrices
-      MatrixFloat::const_iterator low_it(low->begin()), diff_it(diff->begin());
-      while(low_it != low->end()) {
-        *it = rng->rand(*diff_it) + *low_it;
-        ++it;
-        ++low_it;
-        ++diff_it;
-      }
-    }
+    Kernels::applySample<Kernels::Uniform>(rng, consts.begin(),
+                                           0, Kernels::Uniform::NUM_CONSTS,
+                                           result);
   }
 
   void UniformDistribution::privateLogpdf(const MatrixFloat *x,
                                           MatrixFloat *result) {
-    MatrixFloat::iterator result_it(result->begin());
-    MatrixFloat::const_iterator x_it(x->begin());
-    while(x_it != x->end()) {
-      log_float one = log_float::one();
-      log_float current_result = log_float::one();
-      MatrixFloat::const_iterator low_it(low->begin()), high_it(high->begin());
-      MatrixFloat::const_iterator diff_it(diff->begin());
-      while(low_it != low->end() && current_result > log_float::zero()) {
-        if (*low_it <= *x_it && *x_it <= *high_it)
-          current_result *= one / log_float::from_float(*diff_it);
-        else current_result *= log_float::zero();
-        ++low_it;
-        ++high_it;
-        ++x_it;
-        ++diff_it;
-      }
-      while(low_it != low->end()) {
-        ++low_it;
-        ++high_it;
-        ++x_it;
-        ++diff_it;
-      }
-      *result_it = current_result.log();
-      ++result_it;
-    }
+    Kernels::applyLogpdf<Kernels::Uniform>(consts.begin(),
+                                           0, Kernels::Uniform::NUM_CONSTS,
+                                           x, result);
   }
 
   void UniformDistribution::privateLogcdf(const MatrixFloat *x,
                                           MatrixFloat *result) {
-    MatrixFloat::iterator result_it(result->begin());
-    MatrixFloat::const_iterator x_it(x->begin());
-    while(x_it != x->end()) {
-      log_float one = log_float::one();
-      log_float current_result = log_float::one();
-      MatrixFloat::const_iterator low_it(low->begin()), high_it(high->begin());
-      MatrixFloat::const_iterator diff_it(diff->begin());
-      while(low_it != low->end() && current_result > log_float::zero()) {
-        if (*x_it < *low_it) {
-          current_result *= log_float::zero();
-        }
-        else if (*low_it <= *x_it && *x_it < *high_it) {
-          current_result *= log_float::from_float(*x_it - *low_it) / log_float::from_float(*diff_it);
-        }
-        else {
-          current_result *= log_float::one();
-        }
-        ++low_it;
-        ++high_it;
-        ++x_it;
-        ++diff_it;
-      }
-      while(low_it != low->end()) {
-        ++low_it;
-        ++high_it;
-        ++x_it;
-        ++diff_it;
-      }
-      *result_it = current_result.log();
-      ++result_it;
-    }
+    Kernels::applyLogcdf<Kernels::Uniform>(consts.begin(),
+                                           0, Kernels::Uniform::NUM_CONSTS,
+                                           x, result);
   }
 
   StatisticalDistributionBase *UniformDistribution::clone() {
@@ -151,7 +90,14 @@ namespace Stats {
   }
   
   void UniformDistribution::updateParams() {
-    AssignRef(diff, high->clone());
-    AprilMath::MatrixExt::BLAS::matAxpy(diff, -1.0f, low);
+    consts.resize(low->size() * Kernels::Uniform::NUM_CONSTS);
+    float *c = consts.begin();
+    MatrixFloat::const_iterator low_it(low->begin());
+    MatrixFloat::const_iterator high_it(high->begin());
+    for (; low_it != low->end(); ++low_it, ++high_it) {
+      float params[2] = { *low_it, *high_it };
+      Kernels::Uniform::prepare(params, c);
+      c += Kernels::Uniform::NUM_CONSTS;
+    }
   }
 }
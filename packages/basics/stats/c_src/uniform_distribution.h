@@ -21,13 +21,17 @@
 #ifndef UNIFORM_DISTRIBUTION_H
 #define UNIFORM_DISTRIBUTION_H
 
-#include "unused_variable.h"
+#include "distribution_kernels.h"
 #include "statistical_distribution.h"
+#include "unused_variable.h"
+#include "vector.h"
 
 namespace Stats {
   
   class UniformDistribution : public StatisticalDistributionBase {
-    Basics::MatrixFloat *low, *high, *diff;
+    Basics::MatrixFloat *low, *high;
+    /// Kernels::Uniform constants, one row per data point component
+    AprilUtils::vector<float> consts;
     
     void updateParams();
 
@@ -143,6 +143,135 @@ stats.pca =
 
 -------------------------------------------------------------------------------
 
+-- traverses the rows of X (a matrix or a dataset) in chunks, calling f(chunk,
+-- first) for every chunk. Chunks are views of X when possible, and rows are
+-- centered (by pattern) when centered=false, storing the row means into the
+-- center vector when given.
+local function foreach_chunk(X, chunk_size, centered, center, f)
+  local M,N,get_chunk
+  if class.is_a(X, matrix) then
+    M,N = X:dim(1),X:dim(2)
+    get_chunk = function(first, last)
+      return X:slice({first,1}, {last-first+1,N})
+    end
+  else
+    M,N = X:numPatterns(),X:patternSize()
+    local ds = dataset.token.wrapper(X)
+    get_chunk = function(first, last)
+      return ds:getPatternBunch(iterator(range(first,last)):table())
+    end
+  end
+  local ones = not centered and matrix(N):ones()
+  for first=1,M,chunk_size do
+    local last  = math.min(M, first + chunk_size - 1)
+    local chunk = get_chunk(first, last)
+    if not centered then
+      chunk = chunk:clone()
+      local mu = chunk:sum(2):rewrap(last-first+1):scal(1/N)
+      chunk:ger{ alpha=-1.0, X=mu, Y=ones }
+      if center then center:slice({first},{last-first+1}):copy(mu) end
+    end
+    f(chunk, first)
+  end
+end
+
+-- computes Y = X' * X * Q / (M-1) in one pass over the rows of X, without
+-- building the covariance matrix
+local function cov_product(X, M, Q, Y, chunk_size, centered, center)
+  local T
+  Y:zeros()
+  foreach_chunk(X, chunk_size, centered, center,
+                function(chunk)
+                  local rows = chunk:dim(1)
+                  if not T or T:dim(1) ~= rows then
+                    T = matrix(rows, Q:dim(2))
+                  end
+                  T:gemm{ alpha=1.0, A=chunk, B=Q, beta=0.0 }
+                  Y:gemm{ alpha=1.0, A=chunk, B=T, trans_A=true, beta=1.0 }
+  end)
+  Y:scal(1/(M-1))
+  return Y
+end
+
+stats.pca.randomized =
+  april_doc{
+    class = "function",
+    summary = "Computes the top K PCA components using randomized SVD",
+    description = {
+      "Data is ordered by rows, features by columns. The covariance",
+      "matrix is never built, its products are accumulated over chunks",
+      "of rows of the data, so only NxL matrices are kept in memory,",
+      "being L=K+oversampling. A range finder with power iterations",
+      "computes an orthonormal basis Q of the covariance range, and",
+      "the SVD of Q'*C*Q gives the components. The result is",
+      "equivalent to the first K components of stats.pca, and can",
+      "be given to ann.components.pca_whitening and zca_whitening.",
+    },
+    params = {
+      X = "A 2D matrix or a dataset with M patterns of size N",
+      K = "The number of components, K <= N",
+      oversampling = "Extra random vectors [optional], by default 10",
+      power_iterations = "Number of power iterations [optional], by default 2",
+      chunk_size = "Number of rows by chunk [optional], by default 1024",
+      centered = "A boolean [optional], by default false, as in stats.pca",
+      random = "A random object [optional]",
+    },
+    outputs = {
+      "U matrix NxK with the principal components",
+      "S diagonal sparse matrix KxK with the singular values",
+      "VT transpose of U",
+      "In case centered=false, fourth result is the center vector [optional]",
+    },
+  } ..
+  function(params)
+    local params = get_table_fields(
+      {
+        X = { mandatory=true },
+        K = { type_match="number", mandatory=true },
+        oversampling = { type_match="number", mandatory=false, default=10 },
+        power_iterations = { type_match="number", mandatory=false, default=2 },
+        chunk_size = { type_match="number", mandatory=false, default=1024 },
+        centered = { type_match="boolean", mandatory=false, default=false },
+        random = { isa_match=random, mandatory=false, default=nil },
+      },
+      params)
+    local X,K,centered = params.X,params.K,params.centered
+    local chunk_size = params.chunk_size
+    local M,N
+    if class.is_a(X, matrix) then
+      assert(#X:dim() == 2, "Expected a bi-dimensional matrix")
+      M,N = X:dim(1),X:dim(2)
+    else
+      M,N = X:numPatterns(),X:patternSize()
+    end
+    assert(K <= N, "K <= N failed")
+    assert(M > 1, "At least two patterns are needed")
+    local L = math.min(K + params.oversampling, N)
+    local rnd = params.random or random()
+    local center = not centered and matrix(M) or nil
+    -- range finder with power iterations, Q is re-orthonormalized after every
+    -- product to avoid loosing the smallest components
+    local Y = matrix(N, L):uniformf(-1, 1, rnd)
+    local Q = Y:clone()
+    cov_product(X, M, Q, Y, chunk_size, centered, center)
+    for i=1,params.power_iterations do
+      Q = Y:qr()
+      cov_product(X, M, Q, Y, chunk_size, centered)
+    end
+    Q = Y:qr()
+    -- B = Q' * C * Q is a small symmetric LxL matrix
+    cov_product(X, M, Q, Y, chunk_size, centered)
+    local B = matrix(L, L):gemm{ alpha=1.0, A=Q, B=Y, trans_A=true, beta=0.0 }
+    B:axpy(1.0, B:transpose():clone()):scal(0.5)
+    local Ub,Sb = B:svd()
+    local U = matrix(N, K):gemm{ alpha=1.0, A=Q, B=Ub:slice({1,1},{L,K}),
+                                 beta=0.0 }
+    local S = Sb:slice({1,1},{K,K})
+    return U,S,U:transpose():clone(),center
+  end
+
+-------------------------------------------------------------------------------
+
 stats.pca.gs_pca =
   april_doc{
     class = "function",
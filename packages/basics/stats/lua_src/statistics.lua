@@ -20,7 +20,7 @@ local function center(x,mu)
     return x - mu, mu
   else
     mu = mu or x:sum(1):scal(1/N)
-    return matrix.ext.broadcast(bind(x.axpy, nil, -1.0), x, mu), mu
+    return matrix.ext.broadcast(x.sub, x, mu), mu
   end
 end
 
@@ -44,7 +44,7 @@ stats.standardize =
     elseif not mu then
       mu = stats.amean(x,1)
     end
-    local x = matrix.ext.broadcast(bind(x.axpy, nil, -1.0), x, mu)
+    local x = matrix.ext.broadcast(x.sub, x, mu)
     x = matrix.ext.broadcast(x.cmul, x, 1/sigma)
     return x,mu,sigma
   end
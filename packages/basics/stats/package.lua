@@ -29,6 +29,7 @@
 	 "test/test_distributions.lua",
 	 "test/test-gs-pca.lua",
 	 "test/test_means.lua",
+	 "test/test-randomized-pca.lua",
 	 "test/test-zca-whitening.lua",
        },
      },
@@ -0,0 +1,66 @@
+local check = utest.check
+local T = utest.test
+--
+local rnd = random(1234)
+local M,N,R = 400,120,10
+-- low rank data plus noise
+local X = matrix(M,R):uniformf(-1,1,rnd) * matrix(R,N):uniformf(-1,1,rnd)
+X:axpy(0.01, matrix(M,N):uniformf(-1,1,rnd))
+local aU,aS = stats.pca(X)
+
+-- checks that columns of U and aU are equal up to the sign
+local function check_components(U, aU, K)
+  local dots = (U:transpose() * aU:slice({1,1},{N,K})):abs()
+  check.eq(dots, matrix(K,K):zeros():diag(1), 1e-02)
+end
+
+T("RandomizedPCATest",
+  function()
+    local K = 8
+    local U,S,VT,center = stats.pca.randomized{ X=X, K=K, random=rnd,
+                                                chunk_size=64 }
+    check.eq(U:dim(1), N) check.eq(U:dim(2), K)
+    check.eq(S:dim(1), K) check.eq(S:dim(2), K)
+    check.eq(S:to_dense(), aS:to_dense():slice({1,1},{K,K}), 1e-03)
+    check.eq(U:transpose() * U, matrix(K,K):zeros():diag(1))
+    check.eq(VT, U:transpose())
+    check.eq(center, X:sum(2):rewrap(M):scal(1/N))
+    check_components(U, aU, K)
+end)
+
+T("RandomizedPCACenteredTest",
+  function()
+    local K = 5
+    local Xc = stats.pca.center_by_pattern(X)
+    local U,S,VT,center = stats.pca.randomized{ X=Xc, K=K, centered=true,
+                                                random=rnd, chunk_size=1000 }
+    check.FALSE(center)
+    check.eq(S:to_dense(), aS:to_dense():slice({1,1},{K,K}), 1e-03)
+    check_components(U, aU, K)
+end)
+
+T("RandomizedPCADatasetTest",
+  function()
+    local K = 5
+    local U,S = stats.pca.randomized{ X=dataset.matrix(X), K=K, random=rnd,
+                                      chunk_size=50 }
+    check.eq(S:to_dense(), aS:to_dense():slice({1,1},{K,K}), 1e-03)
+    check_components(U, aU, K)
+end)
+
+if ann.components.zca_whitening then
+  T("RandomizedPCAWhiteningTest",
+    function()
+      local K = R
+      local U,S = stats.pca.randomized{ X=X, K=K, random=rnd }
+      local Xc = stats.pca.center_by_pattern(X)
+      local pca = ann.components.pca_whitening{ U=U, S=S, epsilon=1e-05 }
+      local zca = ann.components.zca_whitening{ U=U, S=S, epsilon=1e-05 }
+      local out = pca:forward(Xc)
+      check.eq(out, stats.pca.whitening(Xc, U, S, 1e-05))
+      -- whitened data has an identity covariance
+      check.eq(stats.cov(out, { centered=true }),
+               matrix(K,K):zeros():diag(1), 1e-02)
+      check.eq(zca:forward(Xc):dim(2), N)
+  end)
+end
@@ -232,3 +232,96 @@ T("DiagLogNormalDistTest", function()
       end
     end
 end)
+
+-----------------------------------------------------------------------------
+-- BETA AND GAMMA DISTRIBUTIONS
+
+T("BetaDistTest", function()
+    local d = stats.dist.beta(2,3)
+    local x = M(3,1,{0.1,0.5,0.9})
+    check.eq( d:logpdf(x), M(3,{-0.0283995, 0.405465, -2.22562}) )
+    check.eq( d:logcdf(x), M(3,{-2.95076, -0.374693, -0.00370686}) )
+    for i=1,3 do check_grads(d, x(i,':')) end
+end)
+
+T("GammaDistTest", function()
+    local d = stats.dist.batch.gamma(M(3,{1,2,5}), M(3,{1,0.5,2}))
+    local x = M(3,1,{0.5,1.5,7})
+    check.eq( d:logpdf(x), M(3,{-0.5, -1.20824, -2.36015}) )
+    check.eq( d:logcdf(x), M(3,{-0.932752, -0.222079, -1.2926}) )
+    local d = stats.dist.batch.gamma(2, 3)
+    local data = d:sample( random(1234), M(N*10,1) )
+    check.number_eq(data:sum()/data:size(), 6, 0.05)
+    for i=1,10 do check_grads(d, data(i,':')) end
+end)
+
+-----------------------------------------------------------------------------
+-- BATCH DISTRIBUTIONS
+
+T("BatchDistTest", function()
+    -- every row of a batch must be equal to the univariate distribution
+    local x = M(4,1,{0.2,0.4,3.0,1.5})
+    local function check_rows(batch, dists, x)
+      local logpdf = batch:logpdf(x)
+      local logcdf = batch:logcdf(x)
+      for i,d in ipairs(dists) do
+        check.number_eq(logpdf:get(i), d:logpdf(x(i,':')):get(1))
+        check.number_eq(logcdf:get(i), d:logcdf(x(i,':')):get(1))
+      end
+    end
+    local mu,var = M(4,{0,1,-1,2}),M(4,{1,0.5,2,4})
+    check_rows(stats.dist.batch.normal(mu, var),
+               iterator(range(1,4)):
+                 map(function(i) return stats.dist.normal(mu:get(i),
+                                                          var:get(i)) end):
+                 table(),
+               x)
+    check_rows(stats.dist.batch.exponential(var),
+               iterator(range(1,4)):
+                 map(function(i) return stats.dist.exponential(var:get(i)) end):
+                 table(),
+               x)
+    check_rows(stats.dist.batch.uniform(mu - 1, mu + 1),
+               iterator(range(1,4)):
+                 map(function(i) return stats.dist.uniform(mu:get(i)-1,
+                                                           mu:get(i)+1) end):
+                 table(),
+               x)
+    check.eq( stats.dist.batch.binomial(M(2,{10,20}),
+                                        M(2,{0.3,0.6})):logcdf(M(2,1,{4,11})),
+              M(2,{-0.162835, -0.905347}) )
+    check.eq( stats.dist.batch.binomial(10, 0.5):logcdf(M(3,1,{4,8,1})),
+              stats.dist.binomial(10, 0.5):logcdf(M(3,1,{4,8,1})) )
+    local d = stats.dist.batch.lognormal(M(2,{0,1}), 1, 0.5)
+    check.eq( d:logpdf(M(2,1,{1,3})), M(2,{-0.466018, -1.83873}) )
+    check.eq( d:logcdf(M(2,1,{1,3})), M(2,{-1.41014, -0.762189}) )
+    check_grads(d, M(2,1,{1,3}))
+    -- the number of rows must be equal to the batch size
+    check.errored(function() return d:logpdf(M(3,1)) end)
+    -- the sample of a batch follows every row distribution
+    local d = stats.dist.batch.normal(M(2,{-10,10}), 1)
+    check.eq(d:batch_size(), 2)
+    local data = iterator(range(1,N)):
+      map(function(i) return d:sample(random(i), M(2,1)) end):
+      reduce(function(acc,s) return acc + s end, M(2,1):zeros())
+    check.eq(data:scal(1/N), M(2,1,{-10,10}), 0.02)
+    -- serialization
+    local d2 = util.deserialize(util.serialize(d))
+    check.eq(type(d2), "stats.dist.batch.normal")
+    check.eq(d2:logpdf(M(2,1,{0,1})), d:logpdf(M(2,1,{0,1})))
+end)
+
+-----------------------------------------------------------------------------
+-- LARGE MATRICES
+
+T("LargeMatrixDistTest", function()
+    -- parallel loops give the same result than row by row evaluation
+    local d = stats.dist.exponential(M(3,{1,2,3}))
+    local x = M(20000,3):uniformf(0,4,random(1234))
+    local logpdf = d:logpdf(x)
+    local grads = d:logpdf_derivative(x)
+    for _,i in ipairs{1,777,20000} do
+      check.number_eq(logpdf:get(i), d:logpdf(x(i,':')):get(1))
+    end
+    check.eq(grads:sum(1), M(1,3,{-20000,-40000,-60000}))
+end)
@@ -232,6 +232,27 @@ FILE **newfile (lua_State *L) {
 }
 //BIND_END
 
+//BIND_FUNCTION util.waitpid
+//DOC_BEGIN
+// pid,status waitpid(pid)
+/// waits until the given child process finishes
+//DOC_END
+{
+  int status, pid;
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_GET_PARAMETER(1, int, pid);
+  pid_t result;
+  do {
+    result = waitpid(static_cast<pid_t>(pid), &status, 0);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0) {
+    LUABIND_FERROR2("Error in waitpid(%d): %s", pid, strerror(errno));
+  }
+  LUABIND_RETURN(int,result);
+  LUABIND_RETURN(int,status);
+}
+//BIND_END
+
 //BIND_FUNCTION util.stdout_is_a_terminal
 //DOC_BEGIN
 // bool stdout_is_a_terminal()
@@ -861,6 +882,33 @@ FILE **newfile (lua_State *L) {
 }
 //BIND_END
 
+//BIND_METHOD MMappedDataReader get_uint
+{
+  LUABIND_RETURN(uint, *(obj->get<uint32_t>()));
+}
+//BIND_END
+
+//BIND_METHOD MMappedDataReader get_string
+{
+  size_t len = *(obj->get<size_t>());
+  const char *str = obj->get<char>(len);
+  lua_pushlstring(L, str, len);
+  LUABIND_INCREASE_NUM_RETURNS(1);
+}
+//BIND_END
+
+//BIND_METHOD MMappedDataReader align
+{
+  unsigned int alignment, offset;
+  LUABIND_CHECK_ARGN(>=,1);
+  LUABIND_CHECK_ARGN(<=,2);
+  LUABIND_GET_PARAMETER(1, uint, alignment);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, uint, offset, 0);
+  obj->align(alignment, offset);
+  LUABIND_RETURN(MMappedDataReader, obj);
+}
+//BIND_END
+
 //BIND_LUACLASSNAME MMappedDataWriter util.mmap.writer
 //BIND_CPP_CLASS    MMappedDataWriter
 
@@ -874,6 +922,48 @@ FILE **newfile (lua_State *L) {
 }
 //BIND_END
 
+//BIND_METHOD MMappedDataWriter put_uint
+{
+  unsigned int v;
+  LUABIND_CHECK_ARGN(==,1);
+  LUABIND_GET_PARAMETER(1, uint, v);
+  uint32_t v32 = static_cast<uint32_t>(v);
+  obj->put(&v32);
+  LUABIND_RETURN(MMappedDataWriter, obj);
+}
+//BIND_END
+
+//BIND_METHOD MMappedDataWriter put_string
+{
+  size_t len;
+  LUABIND_CHECK_ARGN(==,1);
+  LUABIND_CHECK_PARAMETER(1, string);
+  const char *str = lua_tolstring(L, 1, &len);
+  obj->put(&len);
+  obj->put(str, len);
+  LUABIND_RETURN(MMappedDataWriter, obj);
+}
+//BIND_END
+
+//BIND_METHOD MMappedDataWriter align
+{
+  unsigned int alignment, offset;
+  LUABIND_CHECK_ARGN(>=,1);
+  LUABIND_CHECK_ARGN(<=,2);
+  LUABIND_GET_PARAMETER(1, uint, alignment);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, uint, offset, 0);
+  obj->align(alignment, offset);
+  LUABIND_RETURN(MMappedDataWriter, obj);
+}
+//BIND_END
+
+//BIND_METHOD MMappedDataWriter close
+{
+  obj->close();
+  LUABIND_RETURN(MMappedDataWriter, obj);
+}
+//BIND_END
+
 /////////////////////////////////////////////////////////////////////////////
 
 //BIND_FUNCTION math.log1p
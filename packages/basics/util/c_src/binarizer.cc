@@ -121,7 +121,6 @@ namespace AprilUtils {
 
 
   // ------------------- 16 bits -------------------
-#ifdef HAVE_UINT16
   uint16_t binarizer::decode_uint16(const char b[3]) {
     return
       uncod[(int)b[0]] * BASE2 +
@@ -152,7 +151,6 @@ namespace AprilUtils {
     memcpy(&ui, &a0, sizeof(uint16_t));
     code_uint16(ui,b);
   }
-#endif
 
   // ------------------- 32 bits -------------------
   uint32_t binarizer::decode_uint32(const char c[5]) {
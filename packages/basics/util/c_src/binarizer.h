@@ -53,12 +53,10 @@ namespace AprilUtils {
     static float  decode_float (const char b[5]);
     static double decode_double(const char b[10]);
 
-#ifdef HAVE_UINT16
     static void code_uint16(uint16_t i, char b[3]);
     static void code_int16 ( int16_t i, char b[3]);
     static uint16_t decode_uint16(const char b[3]);
     static int16_t  decode_int16 (const char b[3]);
-#endif
 
 #ifdef HAVE_UINT64
     static void code_uint64(uint64_t i, char b[10]);
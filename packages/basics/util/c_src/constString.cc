@@ -288,7 +288,6 @@ namespace AprilUtils {
     return true;
   }
 
-#ifdef HAVE_UINT16
   bool constString::extract_uint16_binary(uint16_t *resul) {
     if (empty()) return false;
     if (buffer[0] == '\n') skip(1);
@@ -308,7 +307,6 @@ namespace AprilUtils {
     skip(3);
     return true;  
   }
-#endif
 
   bool constString::extract_uint32_binary(uint32_t *resul) {
     if (empty()) return false;
@@ -98,10 +98,8 @@ namespace AprilUtils {
 
     bool extract_log_float_binary(log_float *resul);
     bool extract_log_double_binary(log_double *resul);
-#ifdef HAVE_UINT16
     bool extract_uint16_binary(uint16_t *resul);
     bool extract_int16_binary(int16_t *resul);
-#endif
     bool extract_uint32_binary(uint32_t *resul);
     bool extract_int32_binary(int32_t *resul);
 #ifdef HAVE_UINT64
@@ -70,7 +70,7 @@ namespace AprilUtils {
   
   ////////////////////////////////////////////////////////////////
   
-  MMappedDataWriter::MMappedDataWriter(const char *path) {
+  MMappedDataWriter::MMappedDataWriter(const char *path) : pos(0) {
     if ((fd = open(path, O_CREAT | O_WRONLY | O_TRUNC,
 		   S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH)) < 0)
       ERROR_EXIT1(128,"Unable to open file %s\n", path);
@@ -81,6 +81,11 @@ namespace AprilUtils {
   }
   
   MMappedDataWriter::~MMappedDataWriter() {
-    close(fd);
+    close();
+  }
+
+  void MMappedDataWriter::close() {
+    if (fd != -1) ::close(fd);
+    fd = -1;
   }
 }
@@ -56,16 +56,46 @@ namespace AprilUtils {
       return ptr;
     }
     int getCommitNumber() const { return commit_number; }
+    /// Skips padding bytes until (position + offset) % alignment == 0, as
+    /// written by MMappedDataWriter::align().
+    void align(size_t alignment, size_t offset=0) {
+      size_t r = (pos + offset) % alignment;
+      if (r != 0) get<char>(alignment - r);
+    }
   };
 
   class MMappedDataWriter : public Referenced {
     int fd;
+    size_t pos;
   public:
     MMappedDataWriter(const char *path);
     ~MMappedDataWriter();
+    /// Closes the file, it is done by the destructor when not called.
+    void close();
     template<typename T>
     void put(const T *data, size_t n=1) {
-      IGNORE_RESULT(write(fd, data, sizeof(T)*n));
+      if (fd < 0) ERROR_EXIT(128, "Writing to a closed mmap file\n");
+      const char *ptr = reinterpret_cast<const char*>(data);
+      size_t sz = sizeof(T)*n;
+      // write() may write less bytes than requested for large buffers
+      while(sz > 0) {
+        ssize_t w = write(fd, ptr, sz);
+        if (w < 0) ERROR_EXIT(128, "Error writing to mmap file\n");
+        ptr += w;
+        sz  -= static_cast<size_t>(w);
+        pos += static_cast<size_t>(w);
+      }
+    }
+    /// Writes zero bytes until (position + offset) % alignment == 0, allowing
+    /// to align data which follows a header of offset bytes.
+    void align(size_t alignment, size_t offset=0) {
+      const char zeros[64] = { 0 };
+      size_t r = (pos + offset) % alignment;
+      if (r != 0) {
+        size_t n = alignment - r;
+        for (; n > sizeof(zeros); n -= sizeof(zeros)) put(zeros, sizeof(zeros));
+        put(zeros, n);
+      }
     }
   };
 }
@@ -0,0 +1,160 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+//BIND_HEADER_C
+#include "bind_matrix.h"
+#include "bind_mtrand.h"
+
+/// Reads an array table of matrices at the given stack position
+static void readMatrixArray(lua_State *L, int n,
+                            AprilUtils::vector<Basics::MatrixFloat*> &v) {
+  if (lua_isMatrixFloat(L, n)) {
+    v.push_back(lua_toMatrixFloat(L, n));
+    return;
+  }
+  if (!lua_istable(L, n)) {
+    luaL_error(L, "Expected a matrix or a table of matrices at argument %d", n);
+  }
+  int len = luaL_len(L, n);
+  for (int i=1; i<=len; ++i) {
+    lua_rawgeti(L, n, i);
+    if (!lua_isMatrixFloat(L, -1)) {
+      luaL_error(L, "Expected a matrix at position %d of argument %d", i, n);
+    }
+    v.push_back(lua_toMatrixFloat(L, -1));
+    lua_pop(L, 1);
+  }
+}
+//BIND_END
+
+//BIND_HEADER_H
+#include "leapfrog.h"
+using namespace Bayesian;
+//BIND_END
+
+//BIND_LUACLASSNAME Leapfrog bayesian.leapfrog
+//BIND_CPP_CLASS    Leapfrog
+
+//BIND_CONSTRUCTOR Leapfrog
+//DOC_BEGIN
+// leapfrog(positions, mass=1, momentum=nil)
+/// Leapfrog integrator over a matrix or an array table of matrices.
+//DOC_END
+{
+  AprilUtils::vector<MatrixFloat*> positions;
+  readMatrixArray(L, 1, positions);
+  float mass;
+  MatrixFloat *momentum;
+  LUABIND_GET_OPTIONAL_PARAMETER(2, float, mass, 1.0f);
+  LUABIND_GET_OPTIONAL_PARAMETER(3, MatrixFloat, momentum, 0);
+  obj = new Leapfrog(positions, mass, momentum);
+  LUABIND_RETURN(Leapfrog, obj);
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog sample_momentum
+//DOC_BEGIN
+// sample_momentum(rng, decay=0)
+/// p = decay*p + sqrt(1-decay^2)*N(0,1), returns the kinetic energy.
+//DOC_END
+{
+  MTRand *rng;
+  float decay;
+  LUABIND_GET_PARAMETER(1, MTRand, rng);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, float, decay, 0.0f);
+  LUABIND_RETURN(double, obj->sampleMomentum(rng, decay));
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog update_momentum
+//DOC_BEGIN
+// update_momentum(grads, alpha)
+/// p = p + alpha*grads, returns the kinetic energy.
+//DOC_END
+{
+  AprilUtils::vector<MatrixFloat*> grads;
+  float alpha;
+  readMatrixArray(L, 1, grads);
+  LUABIND_GET_PARAMETER(2, float, alpha);
+  LUABIND_RETURN(double, obj->updateMomentum(grads, alpha));
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog update_position
+//DOC_BEGIN
+// update_position(alpha)
+/// x = x + alpha/mass * p
+//DOC_END
+{
+  float alpha;
+  LUABIND_GET_PARAMETER(1, float, alpha);
+  obj->updatePosition(alpha);
+  LUABIND_RETURN(Leapfrog, obj);
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog step
+//DOC_BEGIN
+// step(grads, alpha_p, alpha_x)
+/// p = p + alpha_p*grads and x = x + alpha_x/mass * p, returns the kinetic energy.
+//DOC_END
+{
+  AprilUtils::vector<MatrixFloat*> grads;
+  float alpha_p, alpha_x;
+  readMatrixArray(L, 1, grads);
+  LUABIND_GET_PARAMETER(2, float, alpha_p);
+  LUABIND_GET_PARAMETER(3, float, alpha_x);
+  LUABIND_RETURN(double, obj->step(grads, alpha_p, alpha_x));
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog kinetic_energy
+{
+  LUABIND_RETURN(double, obj->kineticEnergy());
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog save
+{
+  obj->save();
+  LUABIND_RETURN(Leapfrog, obj);
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog restore
+{
+  bool with_momentum;
+  LUABIND_GET_OPTIONAL_PARAMETER(1, bool, with_momentum, false);
+  obj->restore(with_momentum);
+  LUABIND_RETURN(Leapfrog, obj);
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog momentum
+{
+  LUABIND_RETURN(MatrixFloat, obj->getMomentum());
+}
+//BIND_END
+
+//BIND_METHOD Leapfrog size
+{
+  LUABIND_RETURN(int, obj->size());
+}
+//BIND_END
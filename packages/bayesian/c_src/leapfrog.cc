@@ -0,0 +1,350 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#include <cstring>
+#include "error_print.h"
+#include "leapfrog.h"
+#include "matrix_ext.h"
+#include "omp_utils.h"
+
+using AprilUtils::SharedPtr;
+using AprilUtils::vector;
+using Basics::MatrixFloat;
+using Basics::MTRand;
+
+namespace Bayesian {
+
+  /// Minimum number of parameters to execute loops in parallel
+  const int PARALLEL_THRESHOLD = 8192;
+  /// Number of momentum components sampled with the same seed
+  const int SAMPLE_BLOCK_SIZE  = 16384;
+  /// Number of components updated before accumulating its kinetic energy
+  const int UPDATE_BLOCK_SIZE  = 1024;
+
+  static float *getData(MatrixFloat *m) {
+    return m->getRawDataAccess()->getPPALForReadAndWrite() + m->getOffset();
+  }
+
+  static const float *getData(const MatrixFloat *m) {
+    return m->getRawDataAccess()->getPPALForRead() + m->getOffset();
+  }
+
+  /// Sum of squares with independent partial sums, so it is not limited by
+  /// the latency of one accumulator
+  static double sumSquares(const float *v, int n) {
+    float acc[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    int i=0;
+    for (; i+8 <= n; i+=8) {
+      for (int j=0; j<8; ++j) acc[j] += v[i+j]*v[i+j];
+    }
+    double sum = 0.0;
+    for (; i<n; ++i) sum += v[i]*v[i];
+    for (int j=0; j<8; ++j) sum += acc[j];
+    return sum;
+  }
+
+  /// Returns a raw pointer for contiguous matrices, otherwise NULL
+  static float *getContiguousData(MatrixFloat *m) {
+    return (m->getIsContiguous()) ? getData(m) : 0;
+  }
+
+  static const float *getContiguousData(const MatrixFloat *m) {
+    return (m->getIsContiguous()) ? getData(m) : 0;
+  }
+  
+  Leapfrog::Leapfrog(const vector<MatrixFloat*> &positions,
+                     float mass, MatrixFloat *momentum) :
+    Referenced(), positions(positions), offsets(positions.size() + 1),
+    inv_mass(1.0f/mass) {
+    if (!(mass > 0.0f)) ERROR_EXIT(128, "Expected a positive mass\n");
+    offsets[0] = 0;
+    for (unsigned int i=0; i<positions.size(); ++i) {
+      IncRef(positions[i]);
+      offsets[i+1] = offsets[i] + positions[i]->size();
+    }
+    if (momentum != 0) {
+      if (momentum->size() != size() || !momentum->getIsContiguous()) {
+        ERROR_EXIT1(128, "Expected a contiguous momentum matrix with "
+                    "size %d\n", size());
+      }
+      this->momentum = momentum;
+    }
+    else {
+      int dims[1] = { size() };
+      this->momentum = new MatrixFloat(1, dims);
+      AprilMath::MatrixExt::Initializers::matZeros(this->momentum.get());
+    }
+  }
+
+  Leapfrog::~Leapfrog() {
+    for (unsigned int i=0; i<positions.size(); ++i) DecRef(positions[i]);
+  }
+
+  void Leapfrog::checkGradients(const vector<MatrixFloat*> &grads) const {
+    if (grads.size() != positions.size()) {
+      ERROR_EXIT2(128, "Expected %lu gradient matrices, found %lu\n",
+                  static_cast<unsigned long>(positions.size()),
+                  static_cast<unsigned long>(grads.size()));
+    }
+    for (unsigned int i=0; i<grads.size(); ++i) {
+      if (grads[i]->size() != positions[i]->size()) {
+        ERROR_EXIT3(128, "Incorrect gradient size at position %u, "
+                    "expected %d, found %d\n", i+1, positions[i]->size(),
+                    grads[i]->size());
+      }
+    }
+  }
+
+  double Leapfrog::sampleMomentum(MTRand *rng, float decay) {
+    if (decay < -1.0f || decay > 1.0f) {
+      ERROR_EXIT(128, "Expected a decay in range [-1,1]\n");
+    }
+    const int N = size();
+    const int num_blocks = (N + SAMPLE_BLOCK_SIZE - 1) / SAMPLE_BLOCK_SIZE;
+    const float noise = sqrtf(1.0f - decay*decay);
+    // seeds are drawn sequentially, the generator is not thread safe
+    vector<uint32_t> seeds(num_blocks);
+    for (int b=0; b<num_blocks; ++b) seeds[b] = rng->randInt();
+    float *p = getData(momentum.get());
+    double sum = 0.0;
+#ifndef NO_OMP
+#pragma omp parallel for reduction(+:sum) schedule(static) if(N > PARALLEL_THRESHOLD)
+#endif
+    for (int b=0; b<num_blocks; ++b) {
+      MTRand block_rng(seeds[b]);
+      const int first = b*SAMPLE_BLOCK_SIZE;
+      const int last  = (first + SAMPLE_BLOCK_SIZE < N) ?
+        first + SAMPLE_BLOCK_SIZE : N;
+      for (int i=first; i<last; ++i) {
+        const float z = static_cast<float>(block_rng.randNorm(0.0, 1.0));
+        const float v = (decay != 0.0f) ? decay*p[i] + noise*z : z;
+        p[i] = v;
+        sum += v*v;
+      }
+    }
+    return 0.5*inv_mass*sum;
+  }
+
+  double Leapfrog::updateMomentum(const vector<MatrixFloat*> &grads,
+                                  float alpha) {
+    checkGradients(grads);
+    vector<const float*> g_ptrs(grads.size());
+    for (unsigned int k=0; k<grads.size(); ++k) {
+      g_ptrs[k] = getContiguousData(static_cast<const MatrixFloat*>(grads[k]));
+    }
+    float *p = getData(momentum.get());
+    const int num_mats = static_cast<int>(positions.size());
+    double sum = 0.0;
+#ifndef NO_OMP
+#pragma omp parallel reduction(+:sum) if(size() > PARALLEL_THRESHOLD)
+#endif
+    {
+      for (int k=0; k<num_mats; ++k) {
+        const float *g = g_ptrs[k];
+        if (g == 0) continue;
+        float *pk = p + offsets[k];
+        const int n = offsets[k+1] - offsets[k];
+        const int num_blocks = (n + UPDATE_BLOCK_SIZE - 1) / UPDATE_BLOCK_SIZE;
+#ifndef NO_OMP
+#pragma omp for schedule(static) nowait
+#endif
+        for (int b=0; b<num_blocks; ++b) {
+          const int first = b*UPDATE_BLOCK_SIZE;
+          const int last  = (first + UPDATE_BLOCK_SIZE < n) ?
+            first + UPDATE_BLOCK_SIZE : n;
+          for (int i=first; i<last; ++i) pk[i] += alpha*g[i];
+          sum += sumSquares(pk + first, last - first);
+        }
+      }
+    }
+    // non contiguous gradients are traversed sequentially
+    for (int k=0; k<num_mats; ++k) {
+      if (g_ptrs[k] != 0) continue;
+      const MatrixFloat *g = grads[k];
+      float *pk = p + offsets[k];
+      for (MatrixFloat::const_iterator it(g->begin()); it != g->end(); ++it) {
+        const float v = *pk + alpha*(*it);
+        *pk++ = v;
+        sum += v*v;
+      }
+    }
+    return 0.5*inv_mass*sum;
+  }
+
+  void Leapfrog::updatePosition(float alpha) {
+    vector<float*> x_ptrs(positions.size());
+    for (unsigned int k=0; k<positions.size(); ++k) {
+      x_ptrs[k] = getContiguousData(positions[k]);
+    }
+    const float *p = getData(static_cast<const MatrixFloat*>(momentum.get()));
+    const float alpha_x = alpha*inv_mass;
+    const int num_mats = static_cast<int>(positions.size());
+#ifndef NO_OMP
+#pragma omp parallel if(size() > PARALLEL_THRESHOLD)
+#endif
+    {
+      for (int k=0; k<num_mats; ++k) {
+        float *x = x_ptrs[k];
+        if (x == 0) continue;
+        const float *pk = p + offsets[k];
+        const int n = offsets[k+1] - offsets[k];
+#ifndef NO_OMP
+#pragma omp for schedule(static) nowait
+#endif
+        for (int i=0; i<n; ++i) x[i] += alpha_x*pk[i];
+      }
+    }
+    // non contiguous positions are traversed sequentially
+    for (int k=0; k<num_mats; ++k) {
+      if (x_ptrs[k] != 0) continue;
+      MatrixFloat *x = positions[k];
+      const float *pk = p + offsets[k];
+      for (MatrixFloat::iterator it(x->begin()); it != x->end(); ++it) {
+        *it += alpha_x*(*pk++);
+      }
+    }
+  }
+
+  double Leapfrog::step(const vector<MatrixFloat*> &grads,
+                        float alpha_p, float alpha_x) {
+    checkGradients(grads);
+    vector<float*> x_ptrs(positions.size());
+    vector<const float*> g_ptrs(grads.size());
+    for (unsigned int k=0; k<positions.size(); ++k) {
+      x_ptrs[k] = getContiguousData(positions[k]);
+      g_ptrs[k] = getContiguousData(static_cast<const MatrixFloat*>(grads[k]));
+      if (x_ptrs[k] == 0 || g_ptrs[k] == 0) x_ptrs[k] = 0;
+    }
+    float *p = getData(momentum.get());
+    const float alpha_xm = alpha_x*inv_mass;
+    const int num_mats = static_cast<int>(positions.size());
+    double sum = 0.0;
+#ifndef NO_OMP
+#pragma omp parallel reduction(+:sum) if(size() > PARALLEL_THRESHOLD)
+#endif
+    {
+      for (int k=0; k<num_mats; ++k) {
+        float *x = x_ptrs[k];
+        if (x == 0) continue;
+        const float *g = g_ptrs[k];
+        float *pk = p + offsets[k];
+        const int n = offsets[k+1] - offsets[k];
+        const int num_blocks = (n + UPDATE_BLOCK_SIZE - 1) / UPDATE_BLOCK_SIZE;
+#ifndef NO_OMP
+#pragma omp for schedule(static) nowait
+#endif
+        for (int b=0; b<num_blocks; ++b) {
+          const int first = b*UPDATE_BLOCK_SIZE;
+          const int last  = (first + UPDATE_BLOCK_SIZE < n) ?
+            first + UPDATE_BLOCK_SIZE : n;
+          for (int i=first; i<last; ++i) {
+            const float v = pk[i] + alpha_p*g[i];
+            pk[i] = v;
+            x[i] += alpha_xm*v;
+          }
+          sum += sumSquares(pk + first, last - first);
+        }
+      }
+    }
+    // non contiguous matrices are traversed sequentially
+    for (int k=0; k<num_mats; ++k) {
+      if (x_ptrs[k] != 0) continue;
+      MatrixFloat *x = positions[k];
+      const MatrixFloat *g = grads[k];
+      float *pk = p + offsets[k];
+      MatrixFloat::const_iterator g_it(g->begin());
+      for (MatrixFloat::iterator x_it(x->begin()); x_it != x->end();
+           ++x_it, ++g_it) {
+        const float v = *pk + alpha_p*(*g_it);
+        *pk++ = v;
+        *x_it += alpha_xm*v;
+        sum += v*v;
+      }
+    }
+    return 0.5*inv_mass*sum;
+  }
+
+  double Leapfrog::kineticEnergy() const {
+    const float *p = getData(static_cast<const MatrixFloat*>(momentum.get()));
+    const int N = size();
+    const int num_blocks = (N + UPDATE_BLOCK_SIZE - 1) / UPDATE_BLOCK_SIZE;
+    double sum = 0.0;
+#ifndef NO_OMP
+#pragma omp parallel for reduction(+:sum) schedule(static) if(N > PARALLEL_THRESHOLD)
+#endif
+    for (int b=0; b<num_blocks; ++b) {
+      const int first = b*UPDATE_BLOCK_SIZE;
+      const int last  = (first + UPDATE_BLOCK_SIZE < N) ?
+        first + UPDATE_BLOCK_SIZE : N;
+      sum += sumSquares(p + first, last - first);
+    }
+    return 0.5*inv_mass*sum;
+  }
+
+  void Leapfrog::save() {
+    if (saved_positions.empty()) {
+      int dims[1] = { size() };
+      saved_positions = new MatrixFloat(1, dims);
+    }
+    float *dest = getData(saved_positions.get());
+    for (unsigned int k=0; k<positions.size(); ++k) {
+      const MatrixFloat *x = positions[k];
+      const float *src = getContiguousData(x);
+      if (src != 0) {
+        memcpy(dest + offsets[k], src, sizeof(float)*x->size());
+      }
+      else {
+        float *d = dest + offsets[k];
+        for (MatrixFloat::const_iterator it(x->begin()); it != x->end(); ++it) {
+          *d++ = *it;
+        }
+      }
+    }
+    if (saved_momentum.empty()) {
+      saved_momentum = momentum->clone();
+    }
+    else {
+      AprilMath::MatrixExt::BLAS::matCopy(saved_momentum.get(), momentum.get());
+    }
+  }
+
+  void Leapfrog::restore(bool with_momentum) {
+    if (saved_positions.empty()) ERROR_EXIT(128, "Needs a previous save\n");
+    const float *src = getData(static_cast<const MatrixFloat*>(saved_positions.get()));
+    for (unsigned int k=0; k<positions.size(); ++k) {
+      MatrixFloat *x = positions[k];
+      float *dest = getContiguousData(x);
+      if (dest != 0) {
+        memcpy(dest, src + offsets[k], sizeof(float)*x->size());
+      }
+      else {
+        const float *s = src + offsets[k];
+        for (MatrixFloat::iterator it(x->begin()); it != x->end(); ++it) {
+          *it = *s++;
+        }
+      }
+    }
+    if (with_momentum) {
+      AprilMath::MatrixExt::BLAS::matCopy(momentum.get(), saved_momentum.get());
+    }
+  }
+  
+} // namespace Bayesian
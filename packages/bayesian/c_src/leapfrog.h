@@ -0,0 +1,107 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef LEAPFROG_H
+#define LEAPFROG_H
+
+#include "matrixFloat.h"
+#include "MersenneTwister.h"
+#include "referenced.h"
+#include "smart_ptr.h"
+#include "vector.h"
+
+/// Native helpers for Bayesian samplers.
+namespace Bayesian {
+
+  /**
+   * @brief Leapfrog integrator of Hamiltonian dynamics over all the
+   * parameter matrices of a model.
+   *
+   * The momentum is a flat matrix with the size of all positions, and the
+   * position matrices are traversed as consecutive segments of it, so every
+   * update is done in one parallel pass over all the parameters, instead of
+   * one axpy call per matrix. The methods which modify the momentum return
+   * its kinetic energy, computed in the same pass.
+   *
+   * @note Non contiguous position or gradient matrices are supported, but
+   * they are traversed sequentially.
+   */
+  class Leapfrog : public Referenced {
+    AprilUtils::vector<Basics::MatrixFloat*> positions;
+    /// first position of every matrix in the flat buffers, plus total size
+    AprilUtils::vector<int> offsets;
+    AprilUtils::SharedPtr<Basics::MatrixFloat> momentum;
+    /// positions and momentum saved by save() method
+    AprilUtils::SharedPtr<Basics::MatrixFloat> saved_positions, saved_momentum;
+    float inv_mass;
+
+    void checkGradients(const AprilUtils::vector<Basics::MatrixFloat*> &grads) const;
+    
+  public:
+    /**
+     * @param positions - The parameter matrices.
+     * @param mass - The mass of the particles.
+     * @param momentum - A flat matrix with the momentum [optional], if not
+     * given it is allocated and initialized with zeros.
+     */
+    Leapfrog(const AprilUtils::vector<Basics::MatrixFloat*> &positions,
+             float mass, Basics::MatrixFloat *momentum=0);
+    virtual ~Leapfrog();
+    /**
+     * @brief Samples the momentum: p = decay*p + sqrt(1 - decay^2)*z, being
+     * z a standard normal sample.
+     *
+     * The generator gives a seed to every block of the momentum, and blocks
+     * are sampled in parallel, so the result doesn't depend on the number of
+     * threads.
+     *
+     * @return The kinetic energy of the new momentum.
+     */
+    double sampleMomentum(Basics::MTRand *rng, float decay=0.0f);
+    /**
+     * @brief p = p + alpha*grads
+     * @return The kinetic energy of the new momentum.
+     */
+    double updateMomentum(const AprilUtils::vector<Basics::MatrixFloat*> &grads,
+                          float alpha);
+    /// x = x + alpha/mass * p
+    void updatePosition(float alpha);
+    /**
+     * @brief Fused momentum and position updates, p = p + alpha_p*grads
+     * followed by x = x + alpha_x/mass * p.
+     * @return The kinetic energy of the new momentum.
+     */
+    double step(const AprilUtils::vector<Basics::MatrixFloat*> &grads,
+                float alpha_p, float alpha_x);
+    /// 0.5/mass * p'p
+    double kineticEnergy() const;
+    /// Copies positions and momentum into internal buffers
+    void save();
+    /// Restores the positions, and the momentum if requested, from save()
+    void restore(bool with_momentum);
+    /// Returns the flat momentum matrix
+    Basics::MatrixFloat *getMomentum() { return momentum.get(); }
+    /// Returns the number of parameters
+    int size() const { return offsets.back(); }
+  };
+  
+} // namespace Bayesian
+
+#endif // LEAPFROG_H
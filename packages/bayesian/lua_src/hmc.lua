@@ -46,8 +46,6 @@ local function hmc(self, eval, theta)
   --
   assert(persistence >= 0.0 and persistence <= 1.0,
          "Incorrect persistence ratio")
-  local inv_mass     = 1.0/mass
-  local spersistence = math.sqrt(1 - persistence*persistence)
   state.acceptance_rate = state.acceptance_rate
   --
   local eval_with_priors = function(w, ...)
@@ -57,41 +55,41 @@ local function hmc(self, eval, theta)
     return table.unpack(aux)
   end
   --
-  -- kinetic energy associated with given velocity
-  local kinetic_energy = function(vel)
-    return 0.5 * md.dot(vel,vel)
+  -- the leapfrog integrator works over a flattened view of all the matrices,
+  -- given as an array sorted by name
+  local names = {}
+  if type(theta) == "table" then
+    for name in pairs(theta) do names[#names+1] = name end
+    table.sort(names)
   end
-  --
-  -- executes the simulation chain of HMC using leapfrog updates
-  local simulation = function(pos, vel, epsilon, nsteps)
-    --
-    -- receives the optimizer table, a matrix dict with positions, other with
-    -- velocities, and the epsilon for the step
-    local leapfrog = function(pos, vel, epsilon, i)
-      -- from pos(t) and vel(t - eps/2), compute vel(t + eps/2)
-      local _,grads = eval_with_priors(origw, i)
-      md.axpy(vel, -epsilon, grads)
-      -- from vel(t + eps/2) compute pos(t + eps)
-      md.axpy(pos, epsilon*inv_mass, vel)
-      -- local eval_result,grads = eval_with_priors(origw, i)
-      -- md.axpy(vel, -epsilon*0.5, grads)
+  local to_array = function(tbl)
+    if type(tbl) ~= "table" then return tbl end
+    local t = {}
+    for i,name in ipairs(names) do
+      t[i] = april_assert(tbl[name], "Unable to find key %s", name)
     end
-    --
-    -- compute velocity at time: t + eps/2
+    return t
+  end
+  --
+  -- executes the simulation chain of HMC using leapfrog updates, returns the
+  -- initial and final energies and the final kinetic energy
+  local simulation = function(leapfrog, epsilon, nsteps)
+    -- compute velocity at time: t + eps/2 and position at time: t + eps
     local initial_energy,grads = eval_with_priors(origw, 0)
-    initial_energy = scale*initial_energy + priors:compute_neg_log_prior(pos)
-    md.axpy(vel, -0.5*epsilon, grads)
-    -- compute position at time: t + eps
-    md.axpy(pos, epsilon*inv_mass, vel)
-    -- compute from 2 to nsteps leapfrog updates
+    initial_energy = scale*initial_energy + priors:compute_neg_log_prior(theta)
+    leapfrog:step(to_array(grads), -0.5*epsilon, epsilon)
+    -- compute from 2 to nsteps leapfrog updates, from pos(t) and
+    -- vel(t - eps/2) compute vel(t + eps/2) and pos(t + eps)
     for i=2,nsteps do
-      leapfrog(pos, vel, epsilon, i-1)
+      local _,grads = eval_with_priors(origw, i-1)
+      leapfrog:step(to_array(grads), -epsilon, epsilon)
     end
     -- compute velocity at time: t + nsteps*eps
     local final_energy,grads = eval_with_priors(origw, nsteps)
-    final_energy = scale*final_energy + priors:compute_neg_log_prior(pos)
-    md.axpy(vel, -0.5*epsilon, grads)
-    return initial_energy, final_energy
+    final_energy = scale*final_energy + priors:compute_neg_log_prior(theta)
+    local final_kinetic = leapfrog:update_momentum(to_array(grads),
+                                                   -0.5*epsilon)
+    return initial_energy, final_energy, final_kinetic
   end
   --
   -- metropolis hastings reject procedure
@@ -105,43 +103,38 @@ local function hmc(self, eval, theta)
   priors:sample(rng, theta)
   --
   -- one HMC sample procedure
-  local norm01 = state.norm01 or stats.dist.normal()
-  local theta0 = md.clone(theta) -- for in case of rejection
-  local vel    = self.state.vel
-  local vel0 -- only if persistent
-  -- sample velocity from a standard normal distribution
+  local leapfrog = bayesian.leapfrog(to_array(theta), mass)
+  local vel = state.vel
+  if not class.is_a(vel, matrix) or vel:size() ~= leapfrog:size() then
+    vel = nil
+  else
+    leapfrog:momentum():copy(vel)
+  end
+  leapfrog:save() -- for in case of rejection
+  -- sample velocity from a standard normal distribution, with the given
+  -- persistence of the previous one
+  local initial_kinetic
   if persistence == 0.0 or not vel then
-    vel = vel or md.clone_only_dims(theta)
-    for _,v in pairs(vel) do
-      norm01:sample(rng, v:rewrap(v:size(), 1))
-    end
+    initial_kinetic = leapfrog:sample_momentum(rng)
   else
-    vel0 = md.clone(vel) -- for in case of rejection
-    md.scal(vel, -persistence)
-    for _,v in pairs(vel) do
-      local aux = matrix(v:size(),1)
-      norm01:sample(rng, aux)
-      v:rewrap(v:size(),1):axpy(spersistence, aux)
-    end
+    initial_kinetic = leapfrog:sample_momentum(rng, -persistence)
   end
   -- epsilon perturbation
   local p_epsilon = epsilon + rng:randNorm(0,alpha*alpha)
-  local initial_kinetic = kinetic_energy(vel) * inv_mass
   -- simulate the HMC mechanics
-  local initial_energy, final_energy = simulation(theta, vel, p_epsilon, nsteps)
-  md.scal(vel, -1.0)
-  local final_kinetic = kinetic_energy(vel) * inv_mass
+  local initial_energy, final_energy, final_kinetic =
+    simulation(leapfrog, p_epsilon, nsteps)
+  leapfrog:momentum():scal(-1.0)
   -- rejection based in metropolis hastings
   local accept = metropolis_hastings(initial_energy + initial_kinetic,
                                      final_energy + final_kinetic)
   --
   local energy = final_energy
-  local ok =  pcall(theta.prune_subnormal_and_check_normal, theta)
+  local ok =  pcall(md.prune_subnormal_and_check_normal, theta)
   -- if not ok then print(ok, "PROBLEM") end
   if not accept or not ok then
     energy = initial_energy
-    md.copy(theta, theta0)
-    if persistent then md.copy(vel, vel0) end
+    leapfrog:restore(persistence > 0.0)
   end
   local accepted = (accept and 1) or 0
   -- accept rate update (exponential mean)
@@ -177,9 +170,8 @@ local function hmc(self, eval, theta)
   state.initial_kinetic = initial_kinetic
   state.final_kinetic = final_kinetic
   state.epsilon = epsilon
-  state.norm01 = norm01
   state.rng = rng
-  state.vel = vel
+  state.vel = leapfrog:momentum()
   --
   -- if #samples > samples_max_size then
   --   local next_samples = {}
@@ -13,7 +13,7 @@ get_table_from_dotted_string("bayesian.optimizer", true)
 -- implemented to minimize the negative of the log-likelihood (maximize the
 -- log-likelihood)
 local function nuts(self, eval, theta)
-  local theta       = wrap_matrices(theta)
+  local md          = matrix.dict
   local state       = self.state
   local samples     = state.samples
   local epsilon     = state.epsilon or self:get_option("epsilon")
@@ -30,92 +30,77 @@ local function nuts(self, eval, theta)
   local epsilon_max = self:get_option("epsilon_max")
   local scale       = self:get_option("scale")
   local target_acceptance_rate = self:get_option("target_acceptance_rate")
-  local inv_var     = 1.0/var
   state.acceptance_rate = state.acceptance_rate or target_acceptance_rate*0.5
   --
-  -- kinetic energy associated with given velocity
-  kinetic_energy = function(vel)
-    return 0.5 * vel:dot(vel)
+  -- the leapfrog integrator works over a flattened view of all the matrices,
+  -- given as an array sorted by name
+  local names = {}
+  if type(theta) == "table" then
+    for name in pairs(theta) do names[#names+1] = name end
+    table.sort(names)
   end
-  --
-  -- executes the simulation chain of HMC using leapfrog updates
-  simulation = function(pos, vel, epsilon, nsteps)
-    --
-    -- receives the optimizer table, a matrix dict with positions, other with
-    -- velocities, and the epsilon for the step
-    leapfrog = function(pos, vel, epsilon)
-      -- from pos(t) and vel(t - eps/2), compute vel(t + eps/2)
-      local energy,grads = eval()
-      grads = wrap_matrices(grads)
-      vel:axpy(-epsilon, grads:scal(scale))
-      -- from vel(t + eps/2) compute pos(t + eps)
-      pos:axpy(epsilon*inv_var, vel)
-      -- local eval_result,grads = eval()
-      -- vel:axpy(-epsilon*0.5, grads)
-      return energy
+  local to_array = function(tbl)
+    if type(tbl) ~= "table" then return tbl end
+    local t = {}
+    for i,name in ipairs(names) do
+      t[i] = april_assert(tbl[name], "Unable to find key %s", name)
     end
-    --
-    -- compute velocity at time: t + eps/2
+    return t
+  end
+  --
+  -- executes the simulation chain of HMC using leapfrog updates, the
+  -- gradients are scaled by the momentum update step
+  local simulation = function(leapfrog, epsilon, nsteps)
+    -- compute velocity at time: t + eps/2 and position at time: t + eps
     local initial_energy,grads = eval()
-    grads = wrap_matrices(grads)
-    vel:axpy(-0.5*epsilon, grads:scal(scale))
-    -- compute position at time: t + eps
-    pos:axpy(epsilon*inv_var, vel)
-    -- compute from 2 to nsteps leapfrog updates
+    leapfrog:step(to_array(grads), -0.5*epsilon*scale, epsilon)
+    -- compute from 2 to nsteps leapfrog updates, from pos(t) and
+    -- vel(t - eps/2) compute vel(t + eps/2) and pos(t + eps)
     for i=2,nsteps do
-      leapfrog(pos, vel, epsilon)
+      local _,grads = eval()
+      leapfrog:step(to_array(grads), -epsilon*scale, epsilon)
     end
     -- compute velocity at time: t + nsteps*eps
     local final_energy,grads = eval()
-    grads = wrap_matrices(grads)
-    vel:axpy(-0.5*epsilon, grads:scal(scale))
-    return initial_energy, final_energy
+    local final_kinetic = leapfrog:update_momentum(to_array(grads),
+                                                   -0.5*epsilon*scale)
+    return initial_energy, final_energy, final_kinetic
   end
   --
   -- metropolis hastings reject procedure
-  function metropolis_hastings(initial_p, final_p)
+  local metropolis_hastings = function(initial_p, final_p)
     local alpha = initial_p - final_p
     local accept_threshold = math.log(rng:randDblExc())
     return accept_threshold < alpha
   end
   --
   -- one HMC sample procedure
-  local norm01 = stats.dist.normal()
-  local theta0 = theta:clone()
-  local vel = theta:clone_only_dims()
+  local leapfrog = bayesian.leapfrog(to_array(theta), var)
+  leapfrog:save() -- for in case of rejection
   -- sample velocity from a standard normal distribution
-  for name,v in pairs(vel) do
-    norm01:sample(rng, v:rewrap(v:size(), 1))
-  end
+  local initial_kinetic = leapfrog:sample_momentum(rng)
   -- epsilon perturbation
   local lambda = ((rng:rand() < beta) and -1) or 1
   local p_epsilon = lambda * epsilon * (1.0 + alpha * rng:randNorm(0,1))
-  local initial_kinetic = kinetic_energy(vel) * inv_var
-  local initial_energy,grads = eval()
-  grads = wrap_matrices(grads)
-  local initial_joint = scale*initial_energy + initial_kinetic
-  local logu = rnd:rand(0, math.exp(-initial_joint))
-  
-  
   -- simulate the HMC mechanics
-  local initial_energy, final_energy = simulation(theta, vel, p_epsilon, nsteps)
-  vel:scal(-1.0)
-  local final_kinetic = kinetic_energy(vel) * inv_var
+  local initial_energy, final_energy, final_kinetic =
+    simulation(leapfrog, p_epsilon, nsteps)
+  leapfrog:momentum():scal(-1.0)
   -- rejection based in metropolis hastings
   local accept = metropolis_hastings(scale*initial_energy + initial_kinetic,
                                      scale*final_energy + final_kinetic)
   --
   local energy = final_energy
-  local ok =  pcall(theta.prune_subnormal_and_check_normal, theta)
+  local ok =  pcall(md.prune_subnormal_and_check_normal, theta)
   -- if not ok then print(ok, "PROBLEM") end
-  if not accept or not ok then energy = initial_energy theta:copy(theta0) end
+  if not accept or not ok then energy = initial_energy leapfrog:restore() end
   local accepted = (accept and 1) or 0
   -- accept rate update (exponential mean)
   assert(acc_decay > 0.0 and acc_decay < 1.0)
   --
   self:count_one()
   if self:get_count() % thin == 0 then
-    table.insert(samples, theta:clone())
+    table.insert(samples, md.clone(theta))
   end
   local acceptance_rate = acc_decay * state.acceptance_rate + (1.0 - acc_decay) * accepted
   -- sanity check
@@ -14,6 +14,13 @@ local make_transform = function(func, arg)
   return { t="transform", func=func, arg=arg }
 end
 
+-- looks for dotted names as "batch.gamma" in stats.dist table
+local get_dist = function(dist)
+  local d = stats.dist
+  for name in dist:gmatch("[^%.]+") do d = d and d[name] end
+  return d
+end
+
 local normalize_shape = function(d, w)
   if w then
     if d:size() == 1 and w:dim(2) ~= 1 then
@@ -35,7 +42,7 @@ local sampling_funcs = {
       arg[i] = april_assert(outcomes[v.arg[i]],
                             "Undefined value of '%s'", v.arg[i])
     end
-    local d = stats.dist[v.dist](table.unpack(arg))
+    local d = get_dist(v.dist)(table.unpack(arg))
     v.obj = d
     return function(rng, w)
       local w = normalize_shape(d, w)
@@ -102,7 +109,7 @@ end
 
 function priors_methods:follows(target, dist, ...)
   assert(type(dist) == "string", "Expected a string with the distribution name")
-  april_assert(stats.dist[dist], "Unknown distribution %s\n", dist)
+  april_assert(get_dist(dist), "Unknown distribution %s\n", dist)
   april_assert(not self.tree[target], "Redifition of target '%s' dist", target)
   table.insert(self.order, target)
   self.tree[target] = make_dist(dist, { ... })
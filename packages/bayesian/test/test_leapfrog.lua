@@ -0,0 +1,110 @@
+local check = utest.check
+local T = utest.test
+local M = matrix
+
+local function make_positions(rnd)
+  return { M(10,20):uniformf(-1,1,rnd), M(20):uniformf(-1,1,rnd) }
+end
+
+local function flatten(tbl)
+  local t = {}
+  for i,m in ipairs(tbl) do t[i] = m:rewrap(m:size()) end
+  return M.join(1, t)
+end
+
+local function clone(tbl)
+  local t = {}
+  for i,m in ipairs(tbl) do t[i] = m:clone() end
+  return t
+end
+
+T("LeapfrogStepTest", function()
+    local rnd = random(1234)
+    local pos = make_positions(rnd)
+    local grads = make_positions(rnd)
+    local pos0 = clone(pos)
+    local mass = 2.0
+    local lf = bayesian.leapfrog(pos, mass)
+    check.eq(lf:size(), 220)
+    check.eq(lf:kinetic_energy(), 0.0)
+    local vel = flatten(grads):scal(-0.5)
+    local k = lf:step(grads, -0.5, 0.1)
+    check.number_eq(k, 0.5*vel:dot(vel)/mass)
+    check.eq(lf:momentum(), vel)
+    for i=1,#pos do
+      local v = lf:momentum():slice({ i==1 and 1 or 201 }, { pos[i]:size() })
+      check.eq(pos[i], pos0[i]:clone():axpy(0.1/mass, v:rewrap(table.unpack(pos[i]:dim()))))
+    end
+    check.number_eq(lf:update_momentum(grads, 0.5), 0.0)
+    check.number_eq(lf:kinetic_energy(), 0.0)
+  end)
+
+T("LeapfrogSaveRestoreTest", function()
+    local rnd = random(1234)
+    local pos = make_positions(rnd)
+    local pos0 = clone(pos)
+    local lf = bayesian.leapfrog(pos)
+    local k0 = lf:sample_momentum(random(5678))
+    local vel0 = lf:momentum():clone()
+    lf:save()
+    lf:update_position(0.5)
+    lf:sample_momentum(random(9012))
+    lf:restore()
+    for i=1,#pos do check.eq(pos[i], pos0[i]) end
+    check.TRUE(lf:momentum() ~= vel0)
+    lf:restore(true)
+    check.eq(lf:momentum(), vel0)
+    check.number_eq(lf:kinetic_energy(), k0)
+  end)
+
+T("LeapfrogSampleMomentumTest", function()
+    local pos = M(200000):zeros()
+    local lf = bayesian.leapfrog(pos)
+    local k = lf:sample_momentum(random(1234))
+    local vel = lf:momentum():clone()
+    local var,mu = stats.var(vel)
+    check.lt(math.abs(mu), 0.01)
+    check.lt(math.abs(var - 1.0), 0.02)
+    check.number_eq(k, 0.5*vel:dot(vel))
+    -- the same seed gives the same sample
+    lf:sample_momentum(random(1234))
+    check.eq(lf:momentum(), vel)
+    -- partial refreshment keeps the marginal distribution
+    lf:sample_momentum(random(5678), -0.5)
+    local var,mu = stats.var(lf:momentum())
+    check.lt(math.abs(mu), 0.01)
+    check.lt(math.abs(var - 1.0), 0.02)
+    check.lt(math.abs(lf:momentum():dot(vel)/vel:size() + 0.5), 0.01)
+  end)
+
+T("LeapfrogSharedMomentumTest", function()
+    local pos = M(5,4):zeros()
+    local vel = M(20):linspace()
+    local lf = bayesian.leapfrog(pos, 4.0, vel)
+    check.number_eq(lf:kinetic_energy(), 0.5*vel:dot(vel)/4.0)
+    lf:update_position(2.0)
+    check.eq(pos, vel:clone():scal(0.5):rewrap(5,4))
+    lf:update_momentum(pos, 1.0)
+    check.eq(vel, M(20):linspace():scal(1.5))
+  end)
+
+T("LeapfrogNonContiguousTest", function()
+    local rnd = random(1234)
+    local pos = M(10,20):uniformf(-1,1,rnd)
+    local grads = M(20,10):uniformf(-1,1,rnd)
+    local pos_t = pos:clone():transpose()
+    local grads_t = grads:transpose()
+    local pos1 = pos:transpose():clone()
+    local lf1 = bayesian.leapfrog(pos1)
+    local lf2 = bayesian.leapfrog(pos_t)
+    lf1:save() lf2:save()
+    check.number_eq(lf1:step(grads_t:clone(), -0.5, 0.1),
+                    lf2:step(grads_t, -0.5, 0.1))
+    check.number_eq(lf1:update_momentum(grads_t:clone(), 0.1),
+                    lf2:update_momentum(grads_t, 0.1))
+    lf1:update_position(0.1) lf2:update_position(0.1)
+    check.eq(lf1:momentum(), lf2:momentum())
+    check.eq(pos_t, pos1)
+    lf2:restore()
+    check.eq(pos_t, pos:transpose())
+  end)
@@ -0,0 +1,103 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+//BIND_HEADER_C
+#include "bind_matrix.h"
+#include "bind_matrix_int32.h"
+#include "bind_mtrand.h"
+//BIND_END
+
+//BIND_HEADER_H
+#include "kmeans_matrix.h"
+
+using namespace Clustering;
+//BIND_END
+
+//BIND_FUNCTION clustering.kmeans.matrix.engine.find_clusters
+{
+  LUABIND_CHECK_ARGN(>=,3);
+  LUABIND_CHECK_ARGN(<=,4);
+  MatrixFloat *X, *C;
+  MatrixInt32 *T;
+  bool verbose;
+  LUABIND_GET_PARAMETER(1, MatrixFloat, X);
+  LUABIND_GET_PARAMETER(2, MatrixFloat, C);
+  LUABIND_GET_PARAMETER(3, MatrixInt32, T);
+  LUABIND_GET_OPTIONAL_PARAMETER(4, bool, verbose, false);
+  float score = KMeansMatrix::findClusters(X, C, T, verbose);
+  LUABIND_RETURN(float, score);
+  LUABIND_RETURN(MatrixInt32, T);
+}
+//BIND_END
+
+//BIND_FUNCTION clustering.kmeans.matrix.engine.basic
+{
+  LUABIND_CHECK_ARGN(>=,4);
+  LUABIND_CHECK_ARGN(<=,5);
+  MatrixFloat *X, *C;
+  int max_iter;
+  float threshold;
+  bool verbose;
+  LUABIND_GET_PARAMETER(1, MatrixFloat, X);
+  LUABIND_GET_PARAMETER(2, MatrixFloat, C);
+  LUABIND_GET_PARAMETER(3, int, max_iter);
+  LUABIND_GET_PARAMETER(4, float, threshold);
+  LUABIND_GET_OPTIONAL_PARAMETER(5, bool, verbose, false);
+  float score = KMeansMatrix::basic(X, C, max_iter, threshold, verbose);
+  LUABIND_RETURN(float, score);
+  LUABIND_RETURN(MatrixFloat, C);
+}
+//BIND_END
+
+//BIND_FUNCTION clustering.kmeans.matrix.engine.kmeans_pp
+{
+  LUABIND_CHECK_ARGN(==,3);
+  MatrixFloat *X, *C;
+  MTRand *rnd;
+  LUABIND_GET_PARAMETER(1, MatrixFloat, X);
+  LUABIND_GET_PARAMETER(2, MatrixFloat, C);
+  LUABIND_GET_PARAMETER(3, MTRand, rnd);
+  KMeansMatrix::kmeansPlusPlus(X, C, rnd);
+  LUABIND_RETURN(MatrixFloat, C);
+}
+//BIND_END
+
+//BIND_FUNCTION clustering.kmeans.matrix.engine.mini_batch
+{
+  LUABIND_CHECK_ARGN(>=,6);
+  LUABIND_CHECK_ARGN(<=,7);
+  MatrixFloat *X, *C;
+  MTRand *rnd;
+  int batch_size, max_iter;
+  float threshold;
+  bool verbose;
+  LUABIND_GET_PARAMETER(1, MatrixFloat, X);
+  LUABIND_GET_PARAMETER(2, MatrixFloat, C);
+  LUABIND_GET_PARAMETER(3, MTRand, rnd);
+  LUABIND_GET_PARAMETER(4, int, batch_size);
+  LUABIND_GET_PARAMETER(5, int, max_iter);
+  LUABIND_GET_PARAMETER(6, float, threshold);
+  LUABIND_GET_OPTIONAL_PARAMETER(7, bool, verbose, false);
+  float score = KMeansMatrix::miniBatch(X, C, rnd, batch_size, max_iter,
+                                        threshold, verbose);
+  LUABIND_RETURN(float, score);
+  LUABIND_RETURN(MatrixFloat, C);
+}
+//BIND_END
@@ -0,0 +1,472 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "error_print.h"
+#include "kmeans_matrix.h"
+#include "matrix_ext_blas.h"
+#include "smart_ptr.h"
+#include "vector.h"
+
+using Basics::MatrixFloat;
+using Basics::MatrixInt32;
+using Basics::MTRand;
+using AprilUtils::SharedPtr;
+using AprilUtils::vector;
+
+namespace Clustering {
+
+  namespace KMeansMatrix {
+
+    namespace {
+
+      /// number of rows processed by every GEMM call
+      const int BSIZE = 1024;
+
+      const double INF = std::numeric_limits<double>::infinity();
+
+      /// Checks sizes and returns a contiguous version of the given matrix,
+      /// which is the given one when possible.
+      MatrixFloat *getContiguous(MatrixFloat *m) {
+        if (m->getIsContiguous()) return m;
+        MatrixFloat *result = new MatrixFloat(m->getNumDim(), m->getDimPtr());
+        AprilMath::MatrixExt::BLAS::matCopy(result, m);
+        return result;
+      }
+
+      void checkSizes(const MatrixFloat *X, const MatrixFloat *C) {
+        if (X->getNumDim() != 2) {
+          ERROR_EXIT(128, "Data matrix must be bi-dimensional\n");
+        }
+        if (C->getNumDim() != 2) {
+          ERROR_EXIT(128, "Centroids matrix must be bi-dimensional\n");
+        }
+        if (X->getDimSize(1) != C->getDimSize(1)) {
+          ERROR_EXIT2(128, "Different columns found between data and "
+                      "centroids: %d ~= %d\n",
+                      X->getDimSize(1), C->getDimSize(1));
+        }
+        if (C->getDimSize(0) < 1) {
+          ERROR_EXIT(128, "At least one centroid is needed\n");
+        }
+      }
+
+      double squaredDistance(const float *a, const float *b, int D) {
+        double result = 0.0;
+        for (int j=0; j<D; ++j) {
+          const double diff = static_cast<double>(a[j]) - b[j];
+          result += diff*diff;
+        }
+        return result;
+      }
+
+      void squaredNorms(const float *m, int N, int D, double *result) {
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(N > 1024)
+#endif
+        for (int i=0; i<N; ++i) {
+          const float *row = m + static_cast<size_t>(i)*D;
+          double acc = 0.0;
+          for (int j=0; j<D; ++j) acc += static_cast<double>(row[j])*row[j];
+          result[i] = acc;
+        }
+      }
+
+      /**
+       * Nearest centroid search for a list of samples. Samples are gathered
+       * in blocks of BSIZE rows and their distances to all centroids are
+       * computed as |x|^2 - 2 x C' + |c|^2, being the cross product a GEMM.
+       * Auxiliary matrices are allocated once, out of parallel regions.
+       */
+      class NearestSearch {
+        const float *x;
+        const double *xsq;
+        int D, K;
+        SharedPtr<MatrixFloat> Xb, Mb;
+      public:
+        NearestSearch(const float *x, const double *xsq, int N, int D, int K) :
+          x(x), xsq(xsq), D(D), K(K) {
+          const int rows = (N < BSIZE) ? N : BSIZE;
+          int dims[2] = { rows, D };
+          Xb = new MatrixFloat(2, dims);
+          dims[1] = K;
+          Mb = new MatrixFloat(2, dims);
+        }
+
+        /// For every idx[i], writes the closest centroid into best[i], its
+        /// squared distance into best_d2[i] and the squared distance to the
+        /// second closest one into second_d2[i] (infinity when K=1). The
+        /// best squared distance is recomputed exactly.
+        void search(const int *idx, int n, MatrixFloat *C, const double *csq,
+                    int32_t *best, double *best_d2, double *second_d2) {
+          const float *c = C->getRawDataAccess()->getPPALForRead() +
+            C->getOffset();
+          for (int b=0; b<n; b+=BSIZE) {
+            const int bsize = (n-b < BSIZE) ? (n-b) : BSIZE;
+            SharedPtr<MatrixFloat> Xblock(Xb), Mblock(Mb);
+            if (bsize != Xb->getDimSize(0)) {
+              int dims[2] = { bsize, D };
+              Xblock = new MatrixFloat(2, dims, Xb->getRawDataAccess());
+              dims[1] = K;
+              Mblock = new MatrixFloat(2, dims, Mb->getRawDataAccess());
+            }
+            float *xb = Xb->getRawDataAccess()->getPPALForWrite();
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(bsize*D > 65536)
+#endif
+            for (int r=0; r<bsize; ++r) {
+              memcpy(xb + static_cast<size_t>(r)*D,
+                     x + static_cast<size_t>(idx[b+r])*D, D*sizeof(float));
+            }
+            AprilMath::MatrixExt::BLAS::matGemm(Mblock.get(),
+                                                CblasNoTrans, CblasTrans,
+                                                -2.0f, Xblock.get(), C,
+                                                0.0f);
+            const float *mb = Mb->getRawDataAccess()->getPPALForRead();
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(bsize*K > 65536)
+#endif
+            for (int r=0; r<bsize; ++r) {
+              const int i = idx[b+r];
+              const float *row = mb + static_cast<size_t>(r)*K;
+              double d1 = INF, d2 = INF;
+              int32_t k1 = 0;
+              for (int k=0; k<K; ++k) {
+                const double d = xsq[i] + row[k] + csq[k];
+                if (d < d1) { d2 = d1; d1 = d; k1 = k; }
+                else if (d < d2) d2 = d;
+              }
+              best[b+r] = k1;
+              best_d2[b+r] = squaredDistance(x + static_cast<size_t>(i)*D,
+                                             c + static_cast<size_t>(k1)*D,
+                                             D);
+              second_d2[b+r] = (d2 > 0.0) ? d2 : 0.0;
+            }
+          }
+        }
+      };
+
+      /// Mean squared distance of all samples to their closest centroid,
+      /// assignments are written into T when given.
+      double assignAll(const float *x, int N, int D, MatrixFloat *C,
+                       int32_t *T, bool verbose) {
+        const int K = C->getDimSize(0);
+        vector<double> xsq(N), csq(K), d2(N), second(N);
+        vector<int> idx(N);
+        vector<int32_t> best(N);
+        squaredNorms(x, N, D, xsq.begin());
+        squaredNorms(C->getRawDataAccess()->getPPALForRead() + C->getOffset(),
+                     K, D, csq.begin());
+        for (int i=0; i<N; ++i) idx[i] = i;
+        NearestSearch nearest(x, xsq.begin(), N, D, K);
+        nearest.search(idx.begin(), N, C, csq.begin(),
+                       best.begin(), d2.begin(), second.begin());
+        double score = 0.0;
+        vector<double> kscore(K);
+        vector<int> kcount(K);
+        for (int k=0; k<K; ++k) { kscore[k] = 0.0; kcount[k] = 0; }
+        for (int i=0; i<N; ++i) {
+          score += d2[i];
+          kscore[best[i]] += d2[i];
+          ++kcount[best[i]];
+          if (T != 0) T[i] = best[i];
+        }
+        if (verbose) {
+          for (int k=0; k<K; ++k) {
+            printf("# Cluster %d, %d/%d (%0.3f%%), samples, dt: %0.9f\n",
+                   k+1, kcount[k], N, kcount[k]*100.0/N,
+                   (kcount[k] > 0) ? kscore[k]/kcount[k] : 0.0);
+          }
+        }
+        return score/N;
+      }
+
+    } // anonymous namespace
+
+    float findClusters(MatrixFloat *X, MatrixFloat *C, MatrixInt32 *T,
+                       bool verbose) {
+      checkSizes(X, C);
+      const int N = X->getDimSize(0), D = X->getDimSize(1);
+      if (T->getNumDim() != 2 || T->getDimSize(0) != N ||
+          T->getDimSize(1) != 1) {
+        ERROR_EXIT1(128, "The tags matrix must be bi-dimensional "
+                    "and with size %dx1\n", N);
+      }
+      SharedPtr<MatrixFloat> Xc(getContiguous(X)), Cc(getContiguous(C));
+      const float *x = Xc->getRawDataAccess()->getPPALForRead() +
+        Xc->getOffset();
+      vector<int32_t> tags(N);
+      double score = assignAll(x, N, D, Cc.get(), tags.begin(), verbose);
+      int32_t *t = T->getRawDataAccess()->getPPALForWrite() + T->getOffset();
+      const int stride = T->getStrideSize(0);
+      for (int i=0; i<N; ++i) t[static_cast<size_t>(i)*stride] = tags[i] + 1;
+      return static_cast<float>(score);
+    }
+
+    float basic(MatrixFloat *X, MatrixFloat *C, int max_iter, float threshold,
+                bool verbose) {
+      checkSizes(X, C);
+      const int N = X->getDimSize(0), D = X->getDimSize(1);
+      const int K = C->getDimSize(0);
+      SharedPtr<MatrixFloat> Xc(getContiguous(X)), Cc(getContiguous(C));
+      const float *x = Xc->getRawDataAccess()->getPPALForRead() +
+        Xc->getOffset();
+      float *c = Cc->getRawDataAccess()->getPPALForReadAndWrite() +
+        Cc->getOffset();
+      // per sample state: assignment, exact distance (Hamerly's upper bound
+      // after tightening) and lower bound to the second closest centroid
+      vector<int32_t> assign(N);
+      vector<double> upper(N), lower(N), xsq(N);
+      // per centroid state
+      vector<double> csq(K), half_min(K), shift(K);
+      vector<double> sums(static_cast<size_t>(K)*D);
+      vector<int> count(K), first(K+1), next(K), order(N);
+      // candidates to a full search
+      vector<char> is_candidate(N);
+      vector<int> candidates(N);
+      vector<int32_t> best(N);
+      vector<double> best_d2(N), second_d2(N);
+      squaredNorms(x, N, D, xsq.begin());
+      for (int i=0; i<N; ++i) { assign[i] = -1; lower[i] = 0.0; }
+      NearestSearch nearest(x, xsq.begin(), N, D, K);
+      double score, discrepancy;
+      int iter = 0;
+      do {
+        // STEP 1: centroid norms and half distance to the closest centroid
+        squaredNorms(c, K, D, csq.begin());
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(K > 16)
+#endif
+        for (int k=0; k<K; ++k) {
+          double m = INF;
+          for (int j=0; j<K; ++j) {
+            if (j == k) continue;
+            const double d = squaredDistance(c + static_cast<size_t>(k)*D,
+                                             c + static_cast<size_t>(j)*D, D);
+            if (d < m) m = d;
+          }
+          half_min[k] = 0.5*sqrt(m);
+        }
+        // STEP 2: tighten upper bounds and look for samples which need all K
+        // distances
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(N > 1024)
+#endif
+        for (int i=0; i<N; ++i) {
+          const int32_t a = assign[i];
+          if (a < 0) { is_candidate[i] = 1; continue; }
+          upper[i] = sqrt(squaredDistance(x + static_cast<size_t>(i)*D,
+                                          c + static_cast<size_t>(a)*D, D));
+          const double m = (half_min[a] > lower[i]) ? half_min[a] : lower[i];
+          is_candidate[i] = (upper[i] > m) ? 1 : 0;
+        }
+        int num_candidates = 0;
+        for (int i=0; i<N; ++i) {
+          if (is_candidate[i]) candidates[num_candidates++] = i;
+        }
+        // STEP 3: full search for candidates
+        nearest.search(candidates.begin(), num_candidates, Cc.get(),
+                       csq.begin(), best.begin(), best_d2.begin(),
+                       second_d2.begin());
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(num_candidates > 1024)
+#endif
+        for (int r=0; r<num_candidates; ++r) {
+          const int i = candidates[r];
+          assign[i] = best[r];
+          upper[i]  = sqrt(best_d2[r]);
+          lower[i]  = sqrt(second_d2[r]);
+        }
+        // STEP 4: distortion and counting sort of samples by centroid
+        score = 0.0;
+        for (int k=0; k<K; ++k) count[k] = 0;
+        for (int i=0; i<N; ++i) {
+          score += upper[i]*upper[i];
+          ++count[assign[i]];
+        }
+        first[0] = 0;
+        for (int k=0; k<K; ++k) first[k+1] = first[k] + count[k];
+        for (int k=0; k<K; ++k) next[k] = first[k];
+        for (int i=0; i<N; ++i) order[next[assign[i]]++] = i;
+        // STEP 5: new centroids, their shift and the discrepancy
+        discrepancy = 0.0;
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic) reduction(+:discrepancy) if(K > 1 && N > 1024)
+#endif
+        for (int k=0; k<K; ++k) {
+          shift[k] = 0.0;
+          if (count[k] == 0) continue;
+          double *sum = sums.begin() + static_cast<size_t>(k)*D;
+          for (int j=0; j<D; ++j) sum[j] = 0.0;
+          for (int r=first[k]; r<first[k+1]; ++r) {
+            const float *row = x + static_cast<size_t>(order[r])*D;
+            for (int j=0; j<D; ++j) sum[j] += row[j];
+          }
+          float *ck = c + static_cast<size_t>(k)*D;
+          double sq = 0.0, l1 = 0.0;
+          for (int j=0; j<D; ++j) {
+            const float v = static_cast<float>(sum[j] / count[k]);
+            const double diff = static_cast<double>(v) - ck[j];
+            sq += diff*diff;
+            l1 += fabs(diff);
+            ck[j] = v;
+          }
+          shift[k] = sqrt(sq);
+          discrepancy += l1;
+        }
+        // STEP 6: lower bounds update
+        int max_k = 0;
+        for (int k=1; k<K; ++k) if (shift[k] > shift[max_k]) max_k = k;
+        double max_shift = shift[max_k], second_shift = 0.0;
+        for (int k=0; k<K; ++k) {
+          if (k != max_k && shift[k] > second_shift) second_shift = shift[k];
+        }
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(N > 1024)
+#endif
+        for (int i=0; i<N; ++i) {
+          lower[i] -= (assign[i] == max_k) ? second_shift : max_shift;
+        }
+        ++iter;
+        if (verbose) {
+          printf("# Iteration %d. Centroids Discrepancy: %g\n",
+                 iter, discrepancy);
+          if (iter > 1) {
+            printf("# Pruned samples: %d/%d\n", N - num_candidates, N);
+          }
+          fflush(stdout);
+        }
+      } while(iter != max_iter && discrepancy >= threshold);
+      if (verbose) {
+        for (int k=0; k<K; ++k) {
+          printf("# Cluster %d: %d/%d samples ( %.3f%% )\n",
+                 k+1, count[k], N, count[k]*100.0/N);
+        }
+      }
+      if (Cc.get() != C) AprilMath::MatrixExt::BLAS::matCopy(C, Cc.get());
+      return static_cast<float>(score/N);
+    }
+
+    void kmeansPlusPlus(MatrixFloat *X, MatrixFloat *C, MTRand *rnd) {
+      checkSizes(X, C);
+      const int N = X->getDimSize(0), D = X->getDimSize(1);
+      const int K = C->getDimSize(0);
+      SharedPtr<MatrixFloat> Xc(getContiguous(X)), Cc(getContiguous(C));
+      const float *x = Xc->getRawDataAccess()->getPPALForRead() +
+        Xc->getOffset();
+      float *c = Cc->getRawDataAccess()->getPPALForWrite() + Cc->getOffset();
+      vector<double> d2(N);
+      int chosen = static_cast<int>(rnd->randInt(N-1));
+      for (int k=0; k<K; ++k) {
+        const float *row = x + static_cast<size_t>(chosen)*D;
+        float *ck = c + static_cast<size_t>(k)*D;
+        memcpy(ck, row, D*sizeof(float));
+        if (k == K-1) break;
+        // update distances to the closest chosen centroid
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(N > 1024)
+#endif
+        for (int i=0; i<N; ++i) {
+          const double d = squaredDistance(x + static_cast<size_t>(i)*D,
+                                           ck, D);
+          if (k == 0 || d < d2[i]) d2[i] = d;
+        }
+        double total = 0.0;
+        for (int i=0; i<N; ++i) total += d2[i];
+        if (total > 0.0) {
+          const double r = rnd->rand(total);
+          double acc = 0.0;
+          chosen = N-1;
+          for (int i=0; i<N; ++i) {
+            acc += d2[i];
+            if (acc >= r && d2[i] > 0.0) { chosen = i; break; }
+          }
+        }
+        else {
+          chosen = static_cast<int>(rnd->randInt(N-1));
+        }
+      }
+      if (Cc.get() != C) AprilMath::MatrixExt::BLAS::matCopy(C, Cc.get());
+    }
+
+    float miniBatch(MatrixFloat *X, MatrixFloat *C, MTRand *rnd,
+                    int batch_size, int max_iter, float threshold,
+                    bool verbose) {
+      checkSizes(X, C);
+      if (batch_size < 1) {
+        ERROR_EXIT(128, "Mini-batch size must be greater than zero\n");
+      }
+      const int N = X->getDimSize(0), D = X->getDimSize(1);
+      const int K = C->getDimSize(0);
+      SharedPtr<MatrixFloat> Xc(getContiguous(X)), Cc(getContiguous(C));
+      const float *x = Xc->getRawDataAccess()->getPPALForRead() +
+        Xc->getOffset();
+      float *c = Cc->getRawDataAccess()->getPPALForReadAndWrite() +
+        Cc->getOffset();
+      vector<double> xsq(N), csq(K), best_d2(batch_size), second_d2(batch_size);
+      vector<double> centroids(static_cast<size_t>(K)*D);
+      vector<int> count(K), batch(batch_size);
+      vector<int32_t> best(batch_size);
+      squaredNorms(x, N, D, xsq.begin());
+      for (size_t j=0; j<centroids.size(); ++j) centroids[j] = c[j];
+      for (int k=0; k<K; ++k) count[k] = 0;
+      NearestSearch nearest(x, xsq.begin(), N, D, K);
+      double discrepancy;
+      int iter = 0;
+      do {
+        for (int b=0; b<batch_size; ++b) {
+          batch[b] = static_cast<int>(rnd->randInt(N-1));
+        }
+        squaredNorms(c, K, D, csq.begin());
+        nearest.search(batch.begin(), batch_size, Cc.get(), csq.begin(),
+                       best.begin(), best_d2.begin(), second_d2.begin());
+        // gradient steps, in sample order to be reproducible
+        discrepancy = 0.0;
+        for (int b=0; b<batch_size; ++b) {
+          const int k = best[b];
+          const double eta = 1.0 / (++count[k]);
+          const float *row = x + static_cast<size_t>(batch[b])*D;
+          double *ck = centroids.begin() + static_cast<size_t>(k)*D;
+          for (int j=0; j<D; ++j) ck[j] += eta * (row[j] - ck[j]);
+        }
+        for (size_t j=0; j<centroids.size(); ++j) {
+          const float v = static_cast<float>(centroids[j]);
+          discrepancy += fabs(static_cast<double>(v) - c[j]);
+          c[j] = v;
+        }
+        ++iter;
+        if (verbose) {
+          printf("# Iteration %d. Centroids Discrepancy: %g\n",
+                 iter, discrepancy);
+          fflush(stdout);
+        }
+      } while(iter != max_iter && discrepancy >= threshold);
+      double score = assignAll(x, N, D, Cc.get(), 0, verbose);
+      if (Cc.get() != C) AprilMath::MatrixExt::BLAS::matCopy(C, Cc.get());
+      return static_cast<float>(score);
+    }
+
+  } // namespace KMeansMatrix
+
+} // namespace Clustering
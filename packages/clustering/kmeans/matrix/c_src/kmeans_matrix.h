@@ -0,0 +1,76 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef KMEANS_MATRIX_H
+#define KMEANS_MATRIX_H
+
+#include "matrixFloat.h"
+#include "matrixInt32.h"
+#include "MersenneTwister.h"
+
+namespace Clustering {
+
+  /**
+   * @brief Native K-means over the rows of a bi-dimensional MatrixFloat.
+   *
+   * Lloyd iterations use Hamerly's bounds: every sample keeps an upper bound
+   * to its centroid and one lower bound to the rest of centroids, so only
+   * samples whose bounds overlap compute all K distances. These distances
+   * are computed by blocks with GEMM, and the rest of the work is
+   * parallelized over samples or centroids with OpenMP. Centroid sums are
+   * accumulated in double precision and in sample order, so results don't
+   * depend on the number of threads.
+   *
+   * All functions return the distortion, that is, the mean squared euclidean
+   * distance between samples and their closest centroid, and centroids are
+   * updated in place.
+   */
+  namespace KMeansMatrix {
+
+    /// Assigns every row of X to its closest row of C, writing 1-based
+    /// centroid indices into T (a Nx1 MatrixInt32).
+    float findClusters(Basics::MatrixFloat *X, Basics::MatrixFloat *C,
+                       Basics::MatrixInt32 *T, bool verbose=false);
+
+    /// Lloyd's algorithm until max_iter iterations or until the L1 change of
+    /// centroids is smaller than threshold. The distortion is computed with
+    /// the centroids of the last iteration before its update.
+    float basic(Basics::MatrixFloat *X, Basics::MatrixFloat *C,
+                int max_iter, float threshold, bool verbose=false);
+
+    /// k-means++ seeding: every row of C is a sample of X drawn with
+    /// probability proportional to its squared distance to the closest
+    /// centroid already chosen.
+    void kmeansPlusPlus(Basics::MatrixFloat *X, Basics::MatrixFloat *C,
+                        Basics::MTRand *rnd);
+
+    /// Mini-batch K-means (Sculley, 2010): every iteration assigns
+    /// batch_size random samples and moves their centroids with a
+    /// per-centroid learning rate of 1/count. The returned distortion needs
+    /// one final pass over all data.
+    float miniBatch(Basics::MatrixFloat *X, Basics::MatrixFloat *C,
+                    Basics::MTRand *rnd, int batch_size,
+                    int max_iter, float threshold, bool verbose=false);
+
+  } // namespace KMeansMatrix
+
+} // namespace Clustering
+
+#endif // KMEANS_MATRIX_H
@@ -1,7 +1,21 @@
 --
 local funcs = get_table_from_dotted_string("clustering.kmeans.matrix",true)
 
-local BSIZE=1024
+-- native engine, see c_src/kmeans_matrix.h
+local engine = funcs.engine
+
+local function check_matrices(X,C)
+  assert(X and class.is_a(X,matrix), "A matrix needed as 1st argument")
+  assert(C and class.is_a(C,matrix), "A matrix needed as 2nd argument")
+  local Xdim = X:dim()
+  local Cdim = C:dim()
+  assert(#Xdim == 2, "Data matrix must be bi-dimensional")
+  assert(#Cdim == 2, "Centroids matrix must be bi-dimensional")
+  april_assert(Cdim[2] == Xdim[2],
+	       "Different columns found between data and centroids: %d ~= %d\n",
+	       Xdim[2], Cdim[2])
+  return Xdim[1],Xdim[2],Cdim[1]
+end
 
 -------------------
 -- FIND CLUSTERS --
@@ -12,82 +26,22 @@ local BSIZE=1024
 --@param X samples, NxD matrix (N rows D columns)
 --@param C centroids, KxD matrix
 --@param T vector de tags de talla N, si este punter val 0 no es fa res
+--@return the mean squared distance between samples and centroids, and T
 function funcs.find_clusters(X,C,T,verbose)
-  assert(X and class.is_a(X,matrix), "A matrix needed as 1st argument")
-  assert(C and class.is_a(C,matrix), "A matrix needed as 2nd argument")
-  local Xdim = X:dim()
-  local Cdim = C:dim()
-  assert(#Xdim == 2, "Data matrix must be bi-dimensional")
-  assert(#Cdim == 2, "Centroids matrix must be bi-dimensional")
-  local N = Xdim[1] -- number of samples
-  local D = Xdim[2] -- number of features (dimensions)
-  local K = Cdim[1] -- number of clusters
-  april_assert(Cdim[2] == D,
-	       "Different columns found between data and centroids: %d ~= %d\n",
-	       D, Cdim[2])
+  local N = check_matrices(X,C)
   local T = T or matrixInt32(N,1)
-  april_assert(#T:dim() == 2 and T:dim(1) == N and T:dim(2) == 1 and class.is_a(T,matrixInt32),
+  april_assert(class.is_a(T,matrixInt32) and #T:dim() == 2 and
+                 T:dim(1) == N and T:dim(2) == 1,
 	       "The tags matrix must be bi-dimensional matrixInt32 and with size %dx1\n",
 	       N)
-  --
-  local auxXblock,mins
-  local Mnew       = matrix
-  local M2Y        = Mnew(BSIZE,K)
-  local CScores    = Mnew(K):zeros()
-  local CSqScores  = Mnew(K):zeros()
-  local Ccont      = matrixInt32(K):zeros()
-  local score      = 0.0
-  -- compute Ysquare
-  local Ysq = C:clone():pow(2):sum(2) -- vector of size K
-  -- traverse in BSIZE blocks
-  for b=1,N,BSIZE do
-    local block_size = math.min(BSIZE,N-b+1)
-    if block_size ~= BSIZE then mins,auxXblock = nil,nil end
-    local Xblock = X:slice({b,1},{block_size,D})
-    local M2Yblock = M2Y:slice({1,1},{block_size,K})
-    -- STEP 1: multiply Xblock by C to compute clusters distances
-    M2Yblock:gemm{ A=Xblock, B=C, trans_A=false, trans_B=true,
-		   alpha=-2.0, beta=0.0 }
-    -- STEP 2: sums Y**2
-    local M2Yrow
-    for i=1,block_size do
-      M2Yrow = M2Yblock:select(1,i,M2Yrow)
-      M2Yrow:axpy(1.0,Ysq)
-    end -- for i=1,block_size do
-    -- STEP 3: compute closest centroid
-    mins,argmins = M2Yblock:min(2,mins,T:slice({b,1},{block_size,1}))
-    -- STEP 4: accumulate score
-    auxXblock = auxXblock or Xblock:clone()
-    local scores = auxXblock:copy(Xblock):pow(2):sum(2):axpy(1.0,mins)
-    for i=1,K do
-      local v   = scores:get(i,1)
-      local pos = argmins:get(i,1)
-      local aux = CScores:get(pos)
-      CScores:set(pos, aux + v)
-      aux = CSqScores:get(pos)
-      CSqScores:set(pos, aux + v*v)
-      Ccont:set(pos, Ccont:get(pos) + 1)
-    end -- for i=1,K do
-    -- sum all scores
-    score = score + mins:sum()
-  end -- for b=1,N,BSIZE
-  for k=1,K do
-    local sc,c = CScores:get(k),Ccont:get(k)
-    local kdist = sc / c
-    score = score + sc
-    if verbose then
-      printf("# Cluster %d, %d/%d (%0.3f%%), samples, dt: %0.9f\n",
-	     k, c ,N, c*100.0/N, kdist)
-    end
-  end
-  score = score/N
-  return score,T
+  return engine.find_clusters(X, C, T, verbose and true or false)
 end
 
 ----------------------------
 -- __call BASIC ALGORITHM --
 ----------------------------
 
+-- Lloyd iterations pruned with Hamerly's bounds, the whole loop runs in C++
 function funcs.basic(X,C,params)
   local params = get_table_fields(
     {
@@ -95,103 +49,69 @@ function funcs.basic(X,C,params)
       max_iter = { mandatory=false, type_match="number", default=100 },
       verbose = { mandatory=false },
     }, params)
-  assert(X and class.is_a(X,matrix), "A matrix needed as 1st argument")
-  assert(C and class.is_a(C,matrix), "A matrix needed as 2nd argument")
-  local Xdim = X:dim()
-  local Cdim = C:dim()
-  assert(#Xdim == 2, "Data matrix must be bi-dimensional")
-  assert(#Cdim == 2, "Centroids matrix must be bi-dimensional")
-  local N = Xdim[1] -- number of samples
-  local D = Xdim[2] -- number of features (dimensions)
-  local K = Cdim[1] -- number of clusters
-  april_assert(Cdim[2] == D,
-	       "Different columns found between data and centroids: %d ~= %d\n",
-	       D, Cdim[2])
-  local max_iter    = params.max_iter
-  local threshold   = params.threshold
-  local Mnew        = matrix
-  local M2Y         = Mnew(BSIZE,K)
-  local Csum        = Mnew(K,D)
-  local Csq         = Mnew(K,D)
-  local Ccont       = Mnew(K)
-  local iter        = 0
-  local score
-  local discrepancy
-  repeat
-    local Csum_row,Csq_row,X_row,mins,argmins,auxXblock
-    -- compute Ysquare
-    local Ysq = C:clone():pow(2):sum(2) -- vector of size K
-    -- counters set to zero
-    Csum:zeros()
-    Csq:zeros()
-    Ccont:zeros()
-    score       = 0.0
-    discrepancy = 0.0
-    -- traverse in blocks of BSIZE
-    for b=1,N,BSIZE do
-      local block_size = math.min(BSIZE,N-b+1)
-      if block_size ~= BSIZE then mins,argmins,auxXblock = nil,nil,nil end
-      local Xblock = X:slice({b,1},{block_size,D})
-      local M2Yblock = M2Y:slice({1,1},{block_size,K})
-      -- STEP 1: multiply Xblock by C to compute clusters distances
-      M2Yblock:gemm{ A=Xblock, B=C, trans_A=false, trans_B=true,
-		     alpha=-2.0, beta=0.0 }
-      -- STEP 2: sums Y**2
-      local M2Yrow
-      for i=1,block_size do
-	M2Yrow = M2Yblock:select(1,i,M2Yrow)
-	M2Yrow:axpy(1.0,Ysq)
-      end -- for i=1,block_size do
-      -- STEP 3: compute closest centroid
-      mins,argmins = M2Yblock:min(2,mins,argmins)
-      -- STEP 4: accumulate score
-      auxXblock = auxXblock or matrix.as(Xblock)
-      auxXblock = auxXblock:copy(Xblock):pow(2)
-      local scores = auxXblock:pow(2):sum(2):axpy(1.0,mins)
-      score = score + mins:sum()
-      
-      for i=1,block_size do
-	local cpos = argmins:get(i,1)
-	Csum_row   = Csum:select(1,cpos,Csum_row)
-	Csq_row    = Csq:select(1,cpos,Csq_row)
-	X_row      = Xblock:select(1,i)
-	X_row2     = auxXblock:select(1,i)
-	Csum_row:axpy(1.0, X_row)
-	Csq_row:axpy(1.0, X_row2)
-	Ccont:set(cpos, Ccont:get(cpos) + 1)
-      end
-    end
-    -- STEP 5: compute discrepancy with previous iteration
-    for i=1,K do
-      local count = Ccont:get(i)
-      if count > 0 then
-	local rcount = 1/count
-	local csum_i,c_i = Csum(i,':'),C(i,':')
-	csum_i:scal(rcount)
-	Csq(i,':'):scal(rcount)
-	local diff = (csum_i - c_i):abs():sum()
-	discrepancy = discrepancy + diff
-	c_i:copy(csum_i)
-      end
-    end
-    --
-    iter = iter + 1
-    if params.verbose then
-      printf("# Iteration %d. Centroids Discrepancy: %g\n",
-	     iter,discrepancy)
-    end
-    io.stdout:flush()
-  until iter == params.max_iter or discrepancy < params.threshold
-  -- STEP 6: compute distortion
-  if params.verbose then
-    for i=1,K do
-      printf("# Cluster %d: %d/%d samples ( %.3f%% )\n",
-	     i,Ccont:get(i),N,Ccont:get(i)*100.0/N)
-    end
-  end
-  local norm2 = X:norm2()
-  score = (score + norm2*norm2) / N
-  return score,C
+  check_matrices(X,C)
+  return engine.basic(X, C, params.max_iter, params.threshold,
+                      params.verbose and true or false)
+end
+
+---------------------------------
+-- K-MEANS++ INITIALIZATION --
+---------------------------------
+
+--[[
+k-means++ initialization, see paper
+
+@inproceedings{arthur2007kmeans,
+  title={k-means++: The advantages of careful seeding},
+  author={Arthur, D. and Vassilvitskii, S.},
+  booktitle={Proceedings of the Eighteenth Annual ACM-SIAM Symposium on Discrete Algorithms},
+  pages={1027--1035},
+  year={2007}
+}
+
+matrix C does NOT contain centroids, it is used to return the initial
+centroids
+--]]
+function funcs.kmeans_pp(X,C,params)
+  local params = get_table_fields(
+    {
+      random = { mandatory=true, isa_match=random },
+    }, params)
+  check_matrices(X,C)
+  return engine.kmeans_pp(X, C, params.random)
+end
+
+-------------------------
+-- MINI-BATCH K-MEANS --
+-------------------------
+
+--[[
+mini-batch k-means, see paper
+
+@inproceedings{sculley2010web,
+  title={Web-scale k-means clustering},
+  author={Sculley, D.},
+  booktitle={Proceedings of the 19th International Conference on World Wide Web},
+  pages={1177--1178},
+  year={2010}
+}
+
+matrix C contains initial centroids, returns the distortion over all the
+data and the resulting centroids
+--]]
+function funcs.mini_batch(X,C,params)
+  local params = get_table_fields(
+    {
+      random = { mandatory=true, isa_match=random },
+      batch_size = { mandatory=false, type_match="number", default=1024 },
+      threshold = { mandatory=false, type_match="number", default=1e-5 },
+      max_iter = { mandatory=false, type_match="number", default=100 },
+      verbose = { mandatory=false },
+    }, params)
+  check_matrices(X,C)
+  return engine.mini_batch(X, C, params.random, params.batch_size,
+                           params.max_iter, params.threshold,
+                           params.verbose and true or false)
 end
 
 -----------------------------
@@ -306,6 +226,8 @@ local function metatable_call(self,params)
       centroids = { mandatory=false, isa_match=matrix, default=nil },
       threshold = { mandatory=false, type_match="number" },
       max_iter = { mandatory=false, type_match="number" },
+      init = { mandatory=false, type_match="string", default="refine" },
+      mini_batch = { mandatory=false, type_match="number", default=nil },
       verbose = { mandatory=false },
     }, params)
   -- sanity checks
@@ -321,21 +243,38 @@ local function metatable_call(self,params)
   local centroids = params.centroids
   local data = params.data
   local distortion
+  april_assert(params.init == "refine" or params.init == "kmeans++",
+	       "Initialization %s not supported\n", params.init)
+  assert(params.random or not params.mini_batch,
+	 "Field random is mandatory with mini_batch")
   if not centroids then
-    assert(random, "Field random is mandatory when not given centroids")
+    assert(params.random, "Field random is mandatory when not given centroids")
     centroids = matrix(params.K,data:dim(2))
-    distortion = funcs.refine(data, centroids, {
-				max_iter   = params.max_iter,
-				random     = params.random,
-				threshold  = params.threshold,
-				percentage = params.percentage,
-				subsamples = params.subsamples,
-				verbose    = params.verbose })
+    if params.init == "kmeans++" then
+      funcs.kmeans_pp(data, centroids, { random = params.random })
+    else
+      distortion = funcs.refine(data, centroids, {
+				  max_iter   = params.max_iter,
+				  random     = params.random,
+				  threshold  = params.threshold,
+				  percentage = params.percentage,
+				  subsamples = params.subsamples,
+				  verbose    = params.verbose })
+    end
+  end
+  if params.mini_batch then
+    distortion = funcs.mini_batch(data, centroids, {
+				    random     = params.random,
+				    batch_size = params.mini_batch,
+				    max_iter   = params.max_iter,
+				    threshold  = params.threshold,
+				    verbose    = params.verbose })
+  else
+    distortion = funcs.basic(data, centroids, {
+			       max_iter  = params.max_iter,
+			       threshold = params.threshold,
+			       verbose   = params.verbose })
   end
-  distortion = funcs.basic(data, centroids, {
-			     max_iter  = params.max_iter,
-			     threshold = params.threshold,
-			     verbose   = params.verbose })
   return distortion,centroids
 end
 
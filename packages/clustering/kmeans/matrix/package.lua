@@ -19,32 +19,33 @@
        file={
 	 "test/test.lua",
 	 "test/test_refine.lua",
+	 "test/test_engine.lua",
        },
      },
    },
    target{
      name = "provide",
      depends = "init",
-     --copy{ file= "c_src/*.h", dest_dir = "include" },
-     --provide_bind{ file = "binding/bind_kmeans_matrix.lua.cc", dest_dir = "include" }
+     copy{ file= "c_src/*.h", dest_dir = "include" },
+     provide_bind{ file = "binding/bind_kmeans_matrix.lua.cc", dest_dir = "include" }
    },
    target{
      name = "build",
      depends = "provide",
      use_timestamp = true,
-     -- object{ 
-     --   file = "c_src/*.cc",
-     --   include_dirs = "${include_dirs}",
-     --   dest_dir = "build",
-     -- },
+     object{ 
+       file = "c_src/*.cc",
+       include_dirs = "${include_dirs}",
+       dest_dir = "build",
+     },
      luac{
        orig_dir = "lua_src",
        dest_dir = "build",
      },
-     -- build_bind{
-     --    file = "binding/bind_kmeans_matrix.lua.cc",
-     --    dest_dir = "build",
-     -- }
+     build_bind{
+        file = "binding/bind_kmeans_matrix.lua.cc",
+        dest_dir = "build",
+     }
    },
    target{
      name = "document",
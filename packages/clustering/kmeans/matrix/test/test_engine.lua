@@ -0,0 +1,114 @@
+local T = utest.test
+local check = utest.check
+
+-- three well separated gaussian blobs
+local function blobs(N, rnd)
+  local centers = matrix(3,4,{ 0, 0, 0, 0,
+                               10, 10, 0, 0,
+                               0, 10, 10, -10 })
+  local X = matrix(N,4):linear()
+  for i=1,N do
+    local c = (i-1)%3 + 1
+    for j=1,4 do X:set(i, j, centers:get(c,j) + rnd:randNorm(0,1)) end
+  end
+  return X,centers
+end
+
+-- brute force distances, used as reference
+local function brute_assign(X,C)
+  local N,K = X:dim(1),C:dim(1)
+  local tags,score = {},0
+  for i=1,N do
+    local best,bestd = 0,math.huge
+    for k=1,K do
+      local d = (X(i,':') - C(k,':')):pow(2):sum()
+      if d < bestd then best,bestd = k,d end
+    end
+    tags[i],score = best,score + bestd
+  end
+  return tags,score/N
+end
+
+local function brute_lloyd(X,C,max_iter)
+  local K,D = C:dim(1),C:dim(2)
+  for iter=1,max_iter do
+    local tags = brute_assign(X,C)
+    local sums,counts = matrix(K,D):zeros(),{}
+    for i=1,#tags do
+      sums(tags[i],':'):axpy(1.0, X(i,':'))
+      counts[tags[i]] = (counts[tags[i]] or 0) + 1
+    end
+    for k=1,K do
+      if counts[k] then C(k,':'):copy(sums(k,':'):scal(1/counts[k])) end
+    end
+  end
+  return C
+end
+
+T("KMeansFindClustersTest", function()
+    local rnd = random(1234)
+    local X = matrix(200,5):uniformf(-1,1,rnd)
+    local C = X({1,7},':'):clone()
+    local score,tags = clustering.kmeans.matrix.find_clusters(X,C)
+    local ref_tags,ref_score = brute_assign(X,C)
+    check.number_eq(score, ref_score, 1e-4)
+    for i=1,#ref_tags do check.eq(tags:get(i,1), ref_tags[i]) end
+end)
+
+T("KMeansPrunedLloydTest", function()
+    local rnd = random(4321)
+    local X = matrix(3000,6):uniformf(-1,1,rnd)
+    local C = X({1,12},':'):clone()
+    local ref = brute_lloyd(X,C:clone(),5)
+    local score = clustering.kmeans.matrix.basic(X,C,{ max_iter=5 })
+    check.eq(C, ref)
+    local _,ref_score = brute_assign(X,ref)
+    -- distortion comes from the last assignment step, before the update
+    check.lt(math.abs(score - ref_score)/ref_score, 0.05)
+    -- non contiguous data and centroids
+    local Xt = X:transpose():clone():transpose()
+    local Ct = X({1,12},':'):transpose():clone():transpose()
+    local score2 = clustering.kmeans.matrix.basic(Xt,Ct,{ max_iter=5 })
+    check.number_eq(score, score2, 1e-6)
+    check.eq(C, Ct)
+end)
+
+T("KMeansPlusPlusTest", function()
+    local X,centers = blobs(300, random(5678))
+    local C = matrix(3,4)
+    clustering.kmeans.matrix.kmeans_pp(X,C,{ random=random(1) })
+    -- every centroid is a sample, and all come from different blobs
+    local tags = brute_assign(C,centers)
+    check.eq(#tags, 3)
+    check.neq(tags[1], tags[2])
+    check.neq(tags[1], tags[3])
+    check.neq(tags[2], tags[3])
+    local C2 = matrix(3,4)
+    clustering.kmeans.matrix.kmeans_pp(X,C2,{ random=random(1) })
+    check.eq(C, C2)
+    local score = clustering.kmeans.matrix{ data=X, K=3, random=random(1),
+                                            init="kmeans++" }
+    check.lt(score, 5.0)
+end)
+
+T("KMeansMiniBatchTest", function()
+    local X,centers = blobs(3000, random(9876))
+    local C = matrix(3,4)
+    clustering.kmeans.matrix.kmeans_pp(X,C,{ random=random(2) })
+    local C2 = C:clone()
+    local score = clustering.kmeans.matrix.mini_batch(X,C,{
+                                                        random=random(3),
+                                                        batch_size=100,
+                                                        max_iter=50,
+                                                      })
+    local full_score = clustering.kmeans.matrix.basic(X,C2)
+    check.number_eq(score, full_score, 0.02)
+    local tags = brute_assign(C,centers)
+    for k=1,3 do
+      check.lt((C(k,':') - centers(tags[k],':')):abs():max(), 0.5)
+    end
+    local score2,C3 = clustering.kmeans.matrix{ data=X, K=3, random=random(2),
+                                                init="kmeans++",
+                                                mini_batch=100, max_iter=50 }
+    check.number_eq(score, score2, 0.02)
+end)
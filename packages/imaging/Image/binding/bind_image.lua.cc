@@ -33,6 +33,8 @@ using AprilUtils::constString;
 #include "datasetFloat.h"
 #include "dataset.h"
 #include "bind_dataset.h"
+#include "image_augmentation_dataset.h"
+#include "sampling_map.h"
 
 using namespace Imaging;
 //BIND_END
@@ -461,3 +463,220 @@ using namespace Imaging;
 
 }
 //BIND_END
+
+//////////////////////////////////////////////////////////////////////////////
+
+//BIND_LUACLASSNAME SamplingMap image.sampling_map
+//BIND_CPP_CLASS SamplingMap
+
+//BIND_CONSTRUCTOR SamplingMap
+//DOC_BEGIN
+// Sampling maps are built with the class functions affine, shear_h,
+// rotate90cw and resize, which receive the source image size.
+//DOC_END
+{
+  LUABIND_ERROR("Use image.sampling_map.affine, shear_h, rotate90cw or resize");
+}
+//BIND_END
+
+//BIND_CLASS_METHOD SamplingMap affine
+{
+  LUABIND_CHECK_ARGN(==, 3);
+  Basics::AffineTransform2D *trans;
+  int width, height;
+  LUABIND_GET_PARAMETER(1, AffineTransform2D, trans);
+  LUABIND_GET_PARAMETER(2, int, width);
+  LUABIND_GET_PARAMETER(3, int, height);
+  LUABIND_RETURN(SamplingMap,
+                 SamplingMap::fromAffineTransform(trans, width, height));
+}
+//BIND_END
+
+//BIND_CLASS_METHOD SamplingMap shear_h
+{
+  LUABIND_CHECK_ARGN(>=, 3);
+  LUABIND_CHECK_ARGN(<=, 4);
+  float angle;
+  int width, height;
+  const char *units;
+  LUABIND_GET_PARAMETER(1, float, angle);
+  LUABIND_GET_PARAMETER(2, int, width);
+  LUABIND_GET_PARAMETER(3, int, height);
+  LUABIND_GET_OPTIONAL_PARAMETER(4, string, units, "rad");
+  constString csopt = constString(units);
+  if (csopt == "deg") angle = angle/180.0f*M_PI;
+  else if (csopt == "grad") angle = angle/200.0f*M_PI;
+  LUABIND_RETURN(SamplingMap, SamplingMap::fromShearH(angle, width, height));
+}
+//BIND_END
+
+//BIND_CLASS_METHOD SamplingMap rotate90cw
+{
+  LUABIND_CHECK_ARGN(==, 2);
+  int width, height;
+  LUABIND_GET_PARAMETER(1, int, width);
+  LUABIND_GET_PARAMETER(2, int, height);
+  LUABIND_RETURN(SamplingMap, SamplingMap::fromRotate90CW(width, height));
+}
+//BIND_END
+
+//BIND_CLASS_METHOD SamplingMap resize
+{
+  LUABIND_CHECK_ARGN(==, 4);
+  int width, height, dst_width, dst_height;
+  LUABIND_GET_PARAMETER(1, int, width);
+  LUABIND_GET_PARAMETER(2, int, height);
+  LUABIND_GET_PARAMETER(3, int, dst_width);
+  LUABIND_GET_PARAMETER(4, int, dst_height);
+  LUABIND_RETURN(SamplingMap, SamplingMap::fromResize(width, height,
+                                                      dst_width, dst_height));
+}
+//BIND_END
+
+//BIND_METHOD SamplingMap apply
+//DOC_BEGIN
+// Receives an Image and an optional default value (0 by default), or an
+// ImageRGB and optional r, g, b default values. The destination offsets
+// are returned after the new image, as in affine_transform.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(>=, 1);
+  if (lua_isImageFloatRGB(L, 1)) {
+    ImageFloatRGB *img;
+    float r, g, b;
+    LUABIND_GET_PARAMETER(1, ImageFloatRGB, img);
+    LUABIND_GET_OPTIONAL_PARAMETER(2, float, r, 0.0f);
+    LUABIND_GET_OPTIONAL_PARAMETER(3, float, g, r);
+    LUABIND_GET_OPTIONAL_PARAMETER(4, float, b, g);
+    if (img->width() != obj->getSrcWidth() ||
+        img->height() != obj->getSrcHeight()) {
+      LUABIND_FERROR2("Expected an image of size %dx%d\n",
+                      obj->getSrcWidth(), obj->getSrcHeight());
+    }
+    LUABIND_RETURN(ImageFloatRGB, obj->apply(img, FloatRGB(r, g, b)));
+  }
+  else {
+    ImageFloat *img;
+    float default_value;
+    LUABIND_GET_PARAMETER(1, ImageFloat, img);
+    LUABIND_GET_OPTIONAL_PARAMETER(2, float, default_value, 0.0f);
+    if (img->width() != obj->getSrcWidth() ||
+        img->height() != obj->getSrcHeight()) {
+      LUABIND_FERROR2("Expected an image of size %dx%d\n",
+                      obj->getSrcWidth(), obj->getSrcHeight());
+    }
+    LUABIND_RETURN(ImageFloat, obj->apply(img, default_value));
+  }
+  LUABIND_RETURN(int, obj->getOffsetX());
+  LUABIND_RETURN(int, obj->getOffsetY());
+}
+//BIND_END
+
+//BIND_METHOD SamplingMap src_size
+{
+  LUABIND_RETURN(int, obj->getSrcWidth());
+  LUABIND_RETURN(int, obj->getSrcHeight());
+}
+//BIND_END
+
+//BIND_METHOD SamplingMap dst_size
+{
+  LUABIND_RETURN(int, obj->getDstWidth());
+  LUABIND_RETURN(int, obj->getDstHeight());
+}
+//BIND_END
+
+//BIND_METHOD SamplingMap get_num_taps
+{
+  LUABIND_RETURN(int, obj->getNumTaps());
+}
+//BIND_END
+
+//////////////////////////////////////////////////////////////////////////////
+
+//BIND_LUACLASSNAME DataSetFloat dataset
+//BIND_LUACLASSNAME ImageAugmentationDataSet dataset.image_augmentation
+//BIND_CPP_CLASS    ImageAugmentationDataSet
+//BIND_SUBCLASS_OF  ImageAugmentationDataSet DataSetFloat
+
+//BIND_CONSTRUCTOR ImageAugmentationDataSet
+//DOC_BEGIN
+// Receives a table with the dataset of row-major images, their width and
+// height, an integer seed, and the optional ranges of the random transforms:
+// angle (radians), scale, shear, translation (pixels), elastic_alpha,
+// elastic_sigma and default_value. All the ranges are 0 by default.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  check_table_fields(L, 1, "dataset", "width", "height", "seed",
+                     "angle", "scale", "shear", "translation",
+                     "elastic_alpha", "elastic_sigma", "default_value",
+                     (const char *)0);
+  DataSetFloat *ds;
+  int width, height;
+  unsigned int seed;
+  ImageAugmentationDataSet::Params params;
+  LUABIND_GET_TABLE_PARAMETER(1, dataset, DataSetFloat, ds);
+  LUABIND_GET_TABLE_PARAMETER(1, width, int, width);
+  LUABIND_GET_TABLE_PARAMETER(1, height, int, height);
+  LUABIND_GET_TABLE_PARAMETER(1, seed, uint, seed);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, angle, float,
+                                       params.max_angle, 0.0f);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, scale, float,
+                                       params.max_scale, 0.0f);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, shear, float,
+                                       params.max_shear, 0.0f);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, translation, float,
+                                       params.max_translation, 0.0f);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, elastic_alpha, float,
+                                       params.elastic_alpha, 0.0f);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, elastic_sigma, float,
+                                       params.elastic_sigma, 4.0f);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, default_value, float,
+                                       params.default_value, 0.0f);
+  if (width*height != ds->patternSize()) {
+    LUABIND_FERROR3("Incorrect image size %dx%d for pattern size %d\n",
+                    width, height, ds->patternSize());
+  }
+  obj = new ImageAugmentationDataSet(ds, width, height, params, seed);
+  LUABIND_RETURN(ImageAugmentationDataSet, obj);
+}
+//BIND_END
+
+//BIND_METHOD ImageAugmentationDataSet set_epoch
+//DOC_BEGIN
+// Changes the epoch, which is combined with the seed to draw a new set of
+// transforms.
+//DOC_END
+{
+  unsigned int epoch;
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_GET_PARAMETER(1, uint, epoch);
+  obj->setEpoch(epoch);
+  LUABIND_RETURN(ImageAugmentationDataSet, obj);
+}
+//BIND_END
+
+//BIND_METHOD ImageAugmentationDataSet get_epoch
+{
+  LUABIND_RETURN(uint, obj->getEpoch());
+}
+//BIND_END
+
+//BIND_METHOD ImageAugmentationDataSet get_transform
+//DOC_BEGIN
+// Returns the AffineTransform2D of the given pattern in the current epoch,
+// which maps source pixels into destination pixels. The elastic distortion
+// is not included.
+//DOC_END
+{
+  int index;
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_GET_PARAMETER(1, int, index);
+  if (index < 1 || index > obj->numPatterns()) {
+    LUABIND_FERROR1("Index out of range %d\n", index);
+  }
+  LUABIND_RETURN(AffineTransform2D, obj->getTransform(index - 1));
+}
+//BIND_END
@@ -312,12 +312,13 @@ namespace Imaging {
       
         for (int i=1; i < width(); i++, ++dest_it, ++source_it) {
           *dest_it = izq*prev_source_value + der*(*source_it);
+          prev_source_value = *source_it;
         }
       
         *dest_it = izq*prev_source_value + der*default_value;
         ++dest_it;
 			
-        for (int i=x_int+width()+1; i<dims[1]; i++) {
+        for (int i=x_int+width()+1; i<dims[1]; i++, ++dest_it) {
           *dest_it=default_value;
         }
       
@@ -853,12 +854,19 @@ namespace Imaging {
     using AprilUtils::max;
     using AprilUtils::min;
 
-    float c[6];
+    // c contains the direct transform (src -> dst), used to compute the
+    // corners of the new image, and inverse the dst -> src transform used
+    // to sample the source image
+    AprilUtils::SharedPtr<Basics::MatrixFloat> direct_mat(trans);
+    if (!direct_mat->getIsContiguous()) {
+      direct_mat = direct_mat->clone();
+    }
     AprilUtils::SharedPtr<Basics::MatrixFloat> inverse_mat =
       AprilMath::MatrixExt::LAPACK::matInv(trans);
     if (!inverse_mat->getIsContiguous()) {
       inverse_mat = inverse_mat->clone();
     }
+    const float *c = direct_mat->getRawDataAccess()->getPPALForRead();
     const float *inverse = inverse_mat->getRawDataAccess()->getPPALForRead();
     /*
       printf("--transform-------\n");
@@ -871,22 +879,20 @@ namespace Imaging {
       printf("%1.3f %1.3f %1.3f\n", inverse[3], inverse[4], inverse[5]);
       printf("0     0     1    \n");
     */
-    // New image corners -> apply the inverse to points 0, 1, 2, 3
+    // New image corners -> apply the transform to points 0, 1, 2, 3
     //
     //  0 +-----+ 1
     //    |     |
     //  2 +-----+ 3
     //
-    int x0 = int(roundf(inverse[2]));
-    int y0 = int(roundf(inverse[5]));
-    int x1 = int(roundf((width()-1) *inverse[0] + inverse[2]));
-    int y1 = int(roundf((width()-1) *inverse[3] + inverse[5]));
-    int x2 = int(roundf((height()-1)*inverse[1] + inverse[2]));
-    int y2 = int(roundf((height()-1)*inverse[4] + inverse[5]));
-    int x3 = int(roundf((width()-1) *inverse[0] + (height()-1)*inverse[1] + inverse[2]));
-    int y3 = int(roundf((width()-1) *inverse[3] + (height()-1)*inverse[4] + inverse[5]));
-
-    inverse = 0;
+    int x0 = int(roundf(c[2]));
+    int y0 = int(roundf(c[5]));
+    int x1 = int(roundf((width()-1) *c[0] + c[2]));
+    int y1 = int(roundf((width()-1) *c[3] + c[5]));
+    int x2 = int(roundf((height()-1)*c[1] + c[2]));
+    int y2 = int(roundf((height()-1)*c[4] + c[5]));
+    int x3 = int(roundf((width()-1) *c[0] + (height()-1)*c[1] + c[2]));
+    int y3 = int(roundf((width()-1) *c[3] + (height()-1)*c[4] + c[5]));
   
     int xmax = int(roundf(max(x0, max(x1, max(x2, x3)))));
     int xmin = int(roundf(min(x0, min(x1, min(x2, x3)))));
@@ -912,8 +918,8 @@ namespace Imaging {
 
     for (int y=ymin; y<=ymax; y++) {
       for (int x=xmin; x<=xmax; x++) {
-        float srcx = c[0]*x+c[1]*y+c[2];
-        float srcy = c[3]*x+c[4]*y+c[5];
+        float srcx = inverse[0]*x+inverse[1]*y+inverse[2];
+        float srcy = inverse[3]*x+inverse[4]*y+inverse[5];
         T value = getpixel_bilinear(srcx, srcy, default_value);
         //printf("dst=(%d,%d) --- src = (%f, %f) value=%f\n", x, y, srcx, srcy, value);
         result_it(y-ymin,x-xmin) = value;
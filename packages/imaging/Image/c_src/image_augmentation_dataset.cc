@@ -0,0 +1,254 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#include "error_print.h"
+#include "image_augmentation_dataset.h"
+#include "omp_utils.h"
+#include "unused_variable.h"
+
+namespace Imaging {
+
+  namespace {
+    /// Finalization step of MurmurHash3, used to mix pattern seeds.
+    uint32_t mix32(uint32_t h) {
+      h ^= h >> 16;
+      h *= 0x85ebca6bu;
+      h ^= h >> 13;
+      h *= 0xc2b2ae35u;
+      h ^= h >> 16;
+      return h;
+    }
+
+    /// Uniform real number in [-r,r].
+    float symmetricRand(Basics::MTRand &rnd, float r) {
+      return static_cast<float>((2.0*rnd.rand() - 1.0)*r);
+    }
+
+    float getpixel(const float *img, int w, int h, int x, int y,
+                   float default_value) {
+      if (x>=0 && y>=0 && x<w && y<h) return img[y*w + x];
+      else return default_value;
+    }
+
+    // the same computation as Image<T>::getpixel_bilinear
+    float bilinear(const float *img, int w, int h, float x, float y,
+                   float default_value) {
+      float fx = fabsf(x - static_cast<float>(trunc(x)));
+      float fy = fabsf(y - static_cast<float>(trunc(y)));
+      float dx = (x >= 0.0f ? 1.0f : -1.0f);
+      float dy = (y >= 0.0f ? 1.0f : -1.0f);
+      float h1 = (1-fx)*getpixel(img, w, h, int(x), int(y), default_value) +
+        fx*getpixel(img, w, h, int(x+dx), int(y), default_value);
+      float h2 = (1-fx)*getpixel(img, w, h, int(x), int(y+dy), default_value) +
+        fx*getpixel(img, w, h, int(x+dx), int(y+dy), default_value);
+      return (1-fy)*h1 + fy*h2;
+    }
+  }
+
+  ImageAugmentationDataSet::
+  ImageAugmentationDataSet(Basics::DataSetFloat *ds, int width, int height,
+                           const Params &params, uint32_t seed) :
+    Basics::DataSetFloat(),
+    ds(ds), width(width), height(height), params(params),
+    seed(seed), epoch(0) {
+    if (width <= 0 || height <= 0 || width*height != ds->patternSize()) {
+      ERROR_EXIT3(128, "Incorrect image size %dx%d for pattern size %d\n",
+                  width, height, ds->patternSize());
+    }
+    if (params.elastic_alpha > 0.0f) {
+      if (!(params.elastic_sigma > 0.0f)) {
+        ERROR_EXIT(128, "Elastic sigma must be > 0\n");
+      }
+      const float sigma = params.elastic_sigma;
+      const int radius = static_cast<int>(ceilf(3.0f*sigma));
+      kernel.resize(2*radius + 1);
+      float sum = 0.0f;
+      for (int i=-radius; i<=radius; ++i) {
+        kernel[i+radius] = expf(-0.5f*i*i/(sigma*sigma));
+        sum += kernel[i+radius];
+      }
+      for (unsigned int i=0; i<kernel.size(); ++i) kernel[i] /= sum;
+    }
+    IncRef(ds);
+  }
+
+  ImageAugmentationDataSet::~ImageAugmentationDataSet() {
+    DecRef(ds);
+  }
+
+  uint32_t ImageAugmentationDataSet::patternSeed(int index) const {
+    uint32_t h = mix32(seed ^ 0x9e3779b9u);
+    h = mix32(h ^ (epoch * 0x9e3779b9u));
+    return mix32(h ^ static_cast<uint32_t>(index));
+  }
+
+  // Separable convolution with the gaussian kernel, pixels outside the
+  // image are zero.
+  void ImageAugmentationDataSet::smooth(float *field, float *tmp) const {
+    const int radius = static_cast<int>(kernel.size()/2);
+    const float *k = kernel.begin() + radius;
+    for (int y=0; y<height; ++y) {
+      const float *row = field + y*width;
+      for (int x=0; x<width; ++x) {
+        const int i0 = -x > -radius ? -x : -radius;
+        const int i1 = width-1-x < radius ? width-1-x : radius;
+        float sum = 0.0f;
+        for (int i=i0; i<=i1; ++i) sum += k[i]*row[x+i];
+        tmp[y*width + x] = sum;
+      }
+    }
+    for (int y=0; y<height; ++y) {
+      const int i0 = -y > -radius ? -y : -radius;
+      const int i1 = height-1-y < radius ? height-1-y : radius;
+      float *row = field + y*width;
+      for (int x=0; x<width; ++x) row[x] = 0.0f;
+      for (int i=i0; i<=i1; ++i) {
+        const float *tmp_row = tmp + (y+i)*width;
+        const float w = k[i];
+        for (int x=0; x<width; ++x) row[x] += w*tmp_row[x];
+      }
+    }
+  }
+
+  // Draws the linear part m (row-major 2x2) and the translation t of the
+  // direct transform of a pattern, m is applied around the image center.
+  void ImageAugmentationDataSet::drawAffine(Basics::MTRand &rnd, int index,
+                                            float *m, float *t) const {
+    // all the random numbers are drawn in the same order, so enabling an
+    // option does not change the values of the others
+    const float angle = symmetricRand(rnd, params.max_angle);
+    const float sx = 1.0f + symmetricRand(rnd, params.max_scale);
+    const float sy = 1.0f + symmetricRand(rnd, params.max_scale);
+    const float sh = symmetricRand(rnd, params.max_shear);
+    t[0] = symmetricRand(rnd, params.max_translation);
+    t[1] = symmetricRand(rnd, params.max_translation);
+    // rotation * shear * scale
+    const float cs = cosf(angle), sn = sinf(angle);
+    m[0] = cs*sx; m[1] = (cs*sh - sn)*sy;
+    m[2] = sn*sx; m[3] = (sn*sh + cs)*sy;
+    if (fabsf(m[0]*m[3] - m[1]*m[2]) < 1e-6f) {
+      ERROR_EXIT1(128, "Singular augmentation transform at pattern %d\n",
+                  index);
+    }
+  }
+
+  Basics::AffineTransform2D *
+  ImageAugmentationDataSet::getTransform(int index) const {
+    Basics::MTRand rnd(patternSeed(index));
+    float m[4], t[2];
+    drawAffine(rnd, index, m, t);
+    const float cx = 0.5f*(width-1), cy = 0.5f*(height-1);
+    Basics::AffineTransform2D *trans = new Basics::AffineTransform2D();
+    (*trans)(0,0) = m[0];
+    (*trans)(0,1) = m[1];
+    (*trans)(0,2) = cx + t[0] - m[0]*cx - m[1]*cy;
+    (*trans)(1,0) = m[2];
+    (*trans)(1,1) = m[3];
+    (*trans)(1,2) = cy + t[1] - m[2]*cx - m[3]*cy;
+    return trans;
+  }
+
+  void ImageAugmentationDataSet::transform(int index, const float *src,
+                                           float *dst, float *aux) const {
+    Basics::MTRand rnd(patternSeed(index));
+    float m[4], t[2];
+    drawAffine(rnd, index, m, t);
+    const float tx = t[0], ty = t[1];
+    const float det = m[0]*m[3] - m[1]*m[2];
+    // inverse transform, it maps destination pixels into source positions
+    const float ia = m[3]/det, ib = -m[1]/det, ic = -m[2]/det, id = m[0]/det;
+    const float cx = 0.5f*(width-1), cy = 0.5f*(height-1);
+    const int pattern_size = width*height;
+    float *dx = 0, *dy = 0;
+    if (params.elastic_alpha > 0.0f) {
+      dx = aux;
+      dy = aux + pattern_size;
+      for (int i=0; i<pattern_size; ++i) dx[i] = symmetricRand(rnd, 1.0f);
+      for (int i=0; i<pattern_size; ++i) dy[i] = symmetricRand(rnd, 1.0f);
+      smooth(dx, aux + 2*pattern_size);
+      smooth(dy, aux + 2*pattern_size);
+    }
+    for (int y=0; y<height; ++y) {
+      const float v = y - cy - ty;
+      for (int x=0; x<width; ++x) {
+        const float u = x - cx - tx;
+        float srcx = ia*u + ib*v + cx;
+        float srcy = ic*u + id*v + cy;
+        if (dx != 0) {
+          srcx += params.elastic_alpha * dx[y*width + x];
+          srcy += params.elastic_alpha * dy[y*width + x];
+        }
+        dst[y*width + x] = bilinear(src, width, height, srcx, srcy,
+                                    params.default_value);
+      }
+    }
+  }
+
+  int ImageAugmentationDataSet::getPattern(int index, float *pat) {
+    const int pattern_size = patternSize();
+    if (scratch.size() < 4u*pattern_size) scratch.resize(4*pattern_size);
+    float *src = scratch.begin();
+    ds->getPattern(index, src);
+    transform(index, src, pat, src + pattern_size);
+    return pattern_size;
+  }
+
+  int ImageAugmentationDataSet::putPattern(int index, const float *pat) {
+    UNUSED_VARIABLE(index);
+    UNUSED_VARIABLE(pat);
+    ERROR_EXIT(1,"Method putPattern forbidden for ImageAugmentationDataSet!!!\n");
+    return 0;
+  }
+
+  void ImageAugmentationDataSet::getPatternBunch(const int *indexes,
+                                                 unsigned int bunch_size,
+                                                 float *dest) {
+    const int pattern_size = patternSize();
+    // the underlying dataset is read serially, it could be not thread-safe
+    for (unsigned int i=0; i<bunch_size; ++i) {
+      ds->getPattern(indexes[i], dest + i*pattern_size);
+    }
+#ifndef NO_OMP
+    const int num_threads = OMPUtils::get_num_threads();
+#else
+    const int num_threads = 1;
+#endif
+    if (scratch.size() < 4u*pattern_size*num_threads) {
+      scratch.resize(4*pattern_size*num_threads);
+    }
+    const int n = static_cast<int>(bunch_size);
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) if(n > 1)
+#endif
+    for (int i=0; i<n; ++i) {
+#ifndef NO_OMP
+      const int thread = omp_get_thread_num();
+#else
+      const int thread = 0;
+#endif
+      float *src = scratch.begin() + 4*pattern_size*thread;
+      float *pat = dest + i*pattern_size;
+      for (int j=0; j<pattern_size; ++j) src[j] = pat[j];
+      transform(indexes[i], src, pat, src + pattern_size);
+    }
+  }
+
+} // namespace Imaging
@@ -0,0 +1,110 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef IMAGE_AUGMENTATION_DATASET_H
+#define IMAGE_AUGMENTATION_DATASET_H
+
+#include <stdint.h>
+#include "affine_transform.h"
+#include "datasetFloat.h"
+#include "disallow_class_methods.h"
+#include "MersenneTwister.h"
+#include "vector.h"
+
+namespace Imaging {
+
+  /**
+   * @brief A DataSet which applies random geometric transforms to images.
+   *
+   * Every pattern of the underlying DataSet is a row-major image of
+   * width x height pixels. Patterns are transformed on demand by a random
+   * affine transform (rotation, scale, shear and translation around the
+   * image center), optionally followed by an elastic distortion (a random
+   * displacement field smoothed with a gaussian filter), and resampled with
+   * the bilinear interpolation of Image<T>::getpixel_bilinear. The output
+   * pattern has the same size as the input one.
+   *
+   * The random generator of every pattern is seeded from the given seed,
+   * the current epoch and the pattern index, so a pattern is always
+   * transformed in the same way for a given epoch, independently of the
+   * access order. Calling setEpoch() produces a new set of transforms.
+   *
+   * getPatternBunch() reads the source patterns serially and transforms them
+   * in parallel using OMP.
+   */
+  class ImageAugmentationDataSet : public Basics::DataSetFloat {
+    APRIL_DISALLOW_COPY_AND_ASSIGN(ImageAugmentationDataSet);
+  public:
+    /// Ranges of the random transforms, zero disables every one of them.
+    struct Params {
+      float max_angle;       ///< Rotation in [-max_angle,max_angle] radians.
+      float max_scale;       ///< Scale factors in [1-max_scale,1+max_scale].
+      float max_shear;       ///< Horizontal shear in [-max_shear,max_shear].
+      float max_translation; ///< Translation in pixels in both axes.
+      float elastic_alpha;   ///< Scale of the elastic displacements.
+      float elastic_sigma;   ///< Standard deviation of the smoothing filter.
+      float default_value;   ///< Color of pixels sampled outside the image.
+      Params() : max_angle(0.0f), max_scale(0.0f), max_shear(0.0f),
+                 max_translation(0.0f), elastic_alpha(0.0f),
+                 elastic_sigma(4.0f), default_value(0.0f) { }
+    };
+
+    ImageAugmentationDataSet(Basics::DataSetFloat *ds, int width, int height,
+                             const Params &params, uint32_t seed);
+    virtual ~ImageAugmentationDataSet();
+    int numPatterns() { return ds->numPatterns(); }
+    int patternSize() { return ds->patternSize(); }
+    int getPattern(int index, float *pat);
+    int putPattern(int index, const float *pat);
+    void getPatternBunch(const int *indexes, unsigned int bunch_size,
+                         float *dest);
+
+    void setEpoch(uint32_t epoch) { this->epoch = epoch; }
+    uint32_t getEpoch() const { return epoch; }
+
+    /**
+     * @brief Returns the random affine transform of a pattern in the current
+     * epoch, mapping source pixels into destination pixels.
+     *
+     * The elastic distortion is not included.
+     */
+    Basics::AffineTransform2D *getTransform(int index) const;
+
+  private:
+    /// The underlying DataSet.
+    Basics::DataSetFloat *ds;
+    int width, height;
+    Params params;
+    uint32_t seed, epoch;
+    /// Gaussian kernel of the elastic distortion.
+    AprilUtils::vector<float> kernel;
+    /// Scratch memory, 4 patterns for every thread.
+    AprilUtils::vector<float> scratch;
+
+    uint32_t patternSeed(int index) const;
+    void drawAffine(Basics::MTRand &rnd, int index, float *m, float *t) const;
+    /// Transforms src into dst, aux must have room for 3 patterns.
+    void transform(int index, const float *src, float *dst, float *aux) const;
+    void smooth(float *field, float *tmp) const;
+  };
+
+} // namespace Imaging
+
+#endif // IMAGE_AUGMENTATION_DATASET_H
@@ -0,0 +1,248 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#include "matrix_ext_lapack.h"
+#include "maxmin.h"
+#include "sampling_map.h"
+
+namespace Imaging {
+
+  SamplingMap::SamplingMap(int src_width, int src_height,
+                           int dst_width, int dst_height) :
+    Referenced(),
+    src_width(src_width), src_height(src_height),
+    dst_width(dst_width), dst_height(dst_height),
+    offset_x(0), offset_y(0) {
+    if (src_width <= 0 || src_height <= 0 ||
+        dst_width <= 0 || dst_height <= 0) {
+      ERROR_EXIT4(128, "Incorrect sampling map size %dx%d -> %dx%d\n",
+                  src_width, src_height, dst_width, dst_height);
+    }
+    first.reserve(dst_width*dst_height + 1);
+    default_weight.reserve(dst_width*dst_height);
+  }
+
+  void SamplingMap::beginPixel() {
+    first.push_back(static_cast<int>(index.size()));
+    default_weight.push_back(0.0f);
+  }
+
+  void SamplingMap::addTap(int x, int y, float w) {
+    if (w == 0.0f) return;
+    if (x < 0 || y < 0 || x >= src_width || y >= src_height) {
+      default_weight.back() += w;
+      return;
+    }
+    const int idx = y*src_width + x;
+    // merge with a previous tap of the same pixel, the number of taps per
+    // pixel is small
+    for (int i=first.back(); i<static_cast<int>(index.size()); ++i) {
+      if (index[i] == idx) {
+        weight[i] += w;
+        return;
+      }
+    }
+    index.push_back(idx);
+    weight.push_back(w);
+  }
+
+  void SamplingMap::addBilinear(float x, float y, float w) {
+    float fx = fabsf(x - static_cast<float>(trunc(x)));
+    float fy = fabsf(y - static_cast<float>(trunc(y)));
+    float dx = (x >= 0.0f ? 1.0f : -1.0f);
+    float dy = (y >= 0.0f ? 1.0f : -1.0f);
+    addTap(int(x),    int(y),    w*(1-fy)*(1-fx));
+    addTap(int(x+dx), int(y),    w*(1-fy)*fx);
+    addTap(int(x),    int(y+dy), w*fy*(1-fx));
+    addTap(int(x+dx), int(y+dy), w*fy*fx);
+  }
+
+  void SamplingMap::finish() {
+    first.push_back(static_cast<int>(index.size()));
+  }
+
+  SamplingMap *SamplingMap::fromAffineTransform(Basics::AffineTransform2D *trans,
+                                                int src_width, int src_height) {
+    using AprilUtils::max;
+    using AprilUtils::min;
+    AprilUtils::SharedPtr<Basics::MatrixFloat> direct_mat(trans);
+    if (!direct_mat->getIsContiguous()) {
+      direct_mat = direct_mat->clone();
+    }
+    AprilUtils::SharedPtr<Basics::MatrixFloat> inverse_mat =
+      AprilMath::MatrixExt::LAPACK::matInv(trans);
+    if (!inverse_mat->getIsContiguous()) {
+      inverse_mat = inverse_mat->clone();
+    }
+    const float *c = direct_mat->getRawDataAccess()->getPPALForRead();
+    const float *inverse = inverse_mat->getRawDataAccess()->getPPALForRead();
+    // the same destination geometry as Image<T>::affine_transform
+    int x0 = int(roundf(c[2]));
+    int y0 = int(roundf(c[5]));
+    int x1 = int(roundf((src_width-1) *c[0] + c[2]));
+    int y1 = int(roundf((src_width-1) *c[3] + c[5]));
+    int x2 = int(roundf((src_height-1)*c[1] + c[2]));
+    int y2 = int(roundf((src_height-1)*c[4] + c[5]));
+    int x3 = int(roundf((src_width-1) *c[0] + (src_height-1)*c[1] + c[2]));
+    int y3 = int(roundf((src_width-1) *c[3] + (src_height-1)*c[4] + c[5]));
+    int xmax = max(x0, max(x1, max(x2, x3)));
+    int xmin = min(x0, min(x1, min(x2, x3)));
+    int ymax = max(y0, max(y1, max(y2, y3)));
+    int ymin = min(y0, min(y1, min(y2, y3)));
+    SamplingMap *map = new SamplingMap(src_width, src_height,
+                                       xmax-xmin+1, ymax-ymin+1);
+    map->offset_x = xmin;
+    map->offset_y = ymin;
+    map->index.reserve(4*map->dst_width*map->dst_height);
+    map->weight.reserve(4*map->dst_width*map->dst_height);
+    for (int y=ymin; y<=ymax; y++) {
+      for (int x=xmin; x<=xmax; x++) {
+        float srcx = inverse[0]*x+inverse[1]*y+inverse[2];
+        float srcy = inverse[3]*x+inverse[4]*y+inverse[5];
+        map->beginPixel();
+        map->addBilinear(srcx, srcy, 1.0f);
+      }
+    }
+    map->finish();
+    return map;
+  }
+
+  SamplingMap *SamplingMap::fromShearH(double angle, int src_width,
+                                       int src_height) {
+    const bool positive = angle > 0;
+    if (!positive) angle = -angle;
+    const int w = src_width, h = src_height;
+    const int dst_width = w + int(h*tan(angle)) + 1;
+    SamplingMap *map = new SamplingMap(src_width, src_height, dst_width, h);
+    map->index.reserve(2*dst_width*h);
+    map->weight.reserve(2*dst_width*h);
+    // the same computation as Image<T>::shear_h, negative angles shear the
+    // image starting from its bottom row
+    for (int y=0; y<h; ++y) {
+      const int line = positive ? y : h-1-y;
+      float x = line*tan(angle);
+      float izq = x-int(x);
+      float der = 1.0-izq;
+      int x_int = int(x);
+      for (int i=0; i<dst_width; ++i) {
+        map->beginPixel();
+        const int s = i - x_int;
+        if (s < 0 || s > w) {
+          map->addTap(-1, y, 1.0f);
+        }
+        else {
+          map->addTap(s - 1, y, izq);
+          map->addTap(s, y, der);
+        }
+      }
+    }
+    map->finish();
+    return map;
+  }
+
+  SamplingMap *SamplingMap::fromRotate90CW(int src_width, int src_height) {
+    SamplingMap *map = new SamplingMap(src_width, src_height,
+                                       src_height, src_width);
+    map->index.reserve(src_width*src_height);
+    map->weight.reserve(src_width*src_height);
+    // destination pixel (x,y) comes from source pixel (y, height-1-x)
+    for (int y=0; y<map->dst_height; ++y) {
+      for (int x=0; x<map->dst_width; ++x) {
+        map->beginPixel();
+        map->addTap(y, src_height - 1 - x, 1.0f);
+      }
+    }
+    map->finish();
+    return map;
+  }
+
+  SamplingMap *SamplingMap::fromResize(int src_width, int src_height,
+                                       int dst_width, int dst_height) {
+    SamplingMap *map = new SamplingMap(src_width, src_height,
+                                       dst_width, dst_height);
+    // the same samples as Image<T>::resize, the area normalization is
+    // folded into the weights
+    for (int y=0; y<dst_height; y++) {
+      for (int x=0; x<dst_width; x++) {
+        float x0 = (float(x)/float(dst_width)) * (src_width-1);
+        float x1 = (float(x+1)/float(dst_width)) * (src_width-1);
+        float y0 = (float(y)/float(dst_height)) * (src_height-1);
+        float y1 = (float(y+1)/float(dst_height)) * (src_height-1);
+        int ix0 = int(x0);
+        int ix1 = int(x1);
+        int iy0 = int(y0);
+        int iy1 = int(y1);
+        float inv_area = 1.0f/((x1-x0)*(y1-y0));
+        map->beginPixel();
+        if (iy0 == iy1) {
+          float yinterp = 0.5f*(y0+y1);
+          float row_w = (y1-y0)*inv_area;
+          if (ix0 == ix1) {
+            map->addBilinear(0.5f*(x0+x1), yinterp, row_w*(x1-x0));
+          }
+          else {
+            map->addBilinear(0.5f*(float(ix0+1)+x0), yinterp,
+                             row_w*(float(ix0+1)-x0));
+            map->addBilinear(0.5f*(x1+floorf(x1)), yinterp,
+                             row_w*(x1-floorf(x1)));
+            for (int col=ix0+1; col < ix1; col++) {
+              map->addBilinear(col+0.5f, yinterp, row_w);
+            }
+          }
+        }
+        else {
+          for (int row = iy0; row <= iy1; row++) {
+            float row_fraction, yinterp;
+            if (row == iy0) {
+              row_fraction = float(iy0+1)-y0;
+              yinterp = 0.5f*(float(iy0+1)+y0);
+            }
+            else if (row == iy1) {
+              row_fraction = y1-floorf(y1);
+              yinterp = 0.5f*(float(y1+floorf(y1)));
+            }
+            else {
+              row_fraction=1.0f;
+              yinterp = row+0.5f;
+            }
+            float row_w = row_fraction*inv_area;
+            if (ix0 == ix1) {
+              // Image<T>::resize samples at the integer row in this case
+              map->addBilinear(0.5f*(x0+x1), row, row_w*(x1-x0));
+            }
+            else {
+              map->addBilinear(0.5f*(float(ix0+1)+x0), yinterp,
+                               row_w*(float(ix0+1)-x0));
+              map->addBilinear(0.5f*(x1+floorf(x1)), yinterp,
+                               row_w*(x1-floorf(x1)));
+              for (int col=ix0+1; col < ix1; col++) {
+                map->addBilinear(col+0.5f, yinterp, row_w);
+              }
+            }
+          }
+        }
+      }
+    }
+    map->finish();
+    return map;
+  }
+
+} // namespace Imaging
@@ -0,0 +1,153 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef SAMPLING_MAP_H
+#define SAMPLING_MAP_H
+
+#include "affine_transform.h"
+#include "error_print.h"
+#include "image.h"
+#include "smart_ptr.h"
+#include "referenced.h"
+#include "vector.h"
+
+namespace Imaging {
+
+  /**
+   * @brief Precomputed sampling map of a geometric image transform.
+   *
+   * Every destination pixel is a weighted sum of source pixels (taps) plus
+   * a default weight which accounts for samples falling outside the source
+   * image. Source indices and interpolation weights are computed once, in
+   * the factory methods, from the transform geometry and the source size,
+   * so the map can be applied to any number of images of that size without
+   * repeating the coordinate math.
+   *
+   * The factories reproduce the sampling of Image<T>::affine_transform,
+   * Image<T>::shear_h, Image<T>::rotate90_cw and Image<T>::resize. Taps of
+   * the same destination pixel which refer to the same source pixel are
+   * merged.
+   *
+   * apply() gathers the taps with flat index/weight arrays, splitting the
+   * destination rows in bands processed in parallel with OMP.
+   */
+  class SamplingMap : public Referenced {
+  public:
+    /// The transform maps source coordinates into destination coordinates.
+    static SamplingMap *fromAffineTransform(Basics::AffineTransform2D *trans,
+                                            int src_width, int src_height);
+    static SamplingMap *fromShearH(double angle, int src_width, int src_height);
+    static SamplingMap *fromRotate90CW(int src_width, int src_height);
+    static SamplingMap *fromResize(int src_width, int src_height,
+                                   int dst_width, int dst_height);
+
+    virtual ~SamplingMap() { }
+
+    int getSrcWidth() const { return src_width; }
+    int getSrcHeight() const { return src_height; }
+    int getDstWidth() const { return dst_width; }
+    int getDstHeight() const { return dst_height; }
+    /// Position of the destination origin, as given by affine_transform.
+    int getOffsetX() const { return offset_x; }
+    int getOffsetY() const { return offset_y; }
+    int getNumTaps() const { return static_cast<int>(index.size()); }
+
+    /// Returns a new image with the map applied to src.
+    template<typename T>
+    Image<T> *apply(const Image<T> *src, T default_value) const {
+      int dims[2] = { dst_height, dst_width };
+      Image<T> *dst = new Image<T>(new Basics::Matrix<T>(2, dims));
+      applyInto(src, dst, default_value);
+      return dst;
+    }
+
+    /// Applies the map to src writing the result into an existing image.
+    template<typename T>
+    void applyInto(const Image<T> *src, Image<T> *dst, T default_value) const;
+
+  private:
+    int src_width, src_height, dst_width, dst_height;
+    int offset_x, offset_y;
+    /// first[p] is the position of the first tap of destination pixel p
+    AprilUtils::vector<int> first;
+    /// source pixel of every tap, as y*src_width + x
+    AprilUtils::vector<int> index;
+    AprilUtils::vector<float> weight;
+    /// weight of the default value at every destination pixel
+    AprilUtils::vector<float> default_weight;
+
+    SamplingMap(int src_width, int src_height, int dst_width, int dst_height);
+
+    // construction helpers, pixels are built in row-major order
+    void beginPixel();
+    void addTap(int x, int y, float w);
+    /// The same samples as Image<T>::getpixel_bilinear.
+    void addBilinear(float x, float y, float w);
+    /// Closes the tap list of the last pixel.
+    void finish();
+  };
+
+  template<typename T>
+  void SamplingMap::applyInto(const Image<T> *src, Image<T> *dst,
+                              T default_value) const {
+    if (src->width() != src_width || src->height() != src_height) {
+      ERROR_EXIT4(128, "Incorrect source image size, expected %dx%d, "
+                  "found %dx%d\n", src_width, src_height,
+                  src->width(), src->height());
+    }
+    if (dst->width() != dst_width || dst->height() != dst_height) {
+      ERROR_EXIT4(128, "Incorrect destination image size, expected %dx%d, "
+                  "found %dx%d\n", dst_width, dst_height,
+                  dst->width(), dst->height());
+    }
+    if (!dst->getMatrix()->getIsContiguous()) {
+      ERROR_EXIT(128, "Destination image must be contiguous\n");
+    }
+    AprilUtils::SharedPtr< Basics::Matrix<T> >
+      src_mat(const_cast<Basics::Matrix<T>*>(src->getMatrix()));
+    if (!src_mat->getIsContiguous()) src_mat = src_mat->clone();
+    const T *src_data = src_mat->getRawDataAccess()->getPPALForRead() +
+      src_mat->getOffset();
+    Basics::Matrix<T> *dst_mat = dst->getMatrix();
+    T *dst_data = dst_mat->getRawDataAccess()->getPPALForWrite() +
+      dst_mat->getOffset();
+    const int *first_ptr = first.begin();
+    const int *index_ptr = index.begin();
+    const float *weight_ptr = weight.begin();
+    const float *default_ptr = default_weight.begin();
+    const int height = dst_height, width = dst_width;
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(height > 1 && index.size() > 16384u)
+#endif
+    for (int y=0; y<height; ++y) {
+      for (int p=y*width; p<(y+1)*width; ++p) {
+        T sum = T();
+        for (int i=first_ptr[p]; i<first_ptr[p+1]; ++i) {
+          sum += weight_ptr[i] * src_data[index_ptr[i]];
+        }
+        if (default_ptr[p] != 0.0f) sum += default_ptr[p] * default_value;
+        dst_data[p] = sum;
+      }
+    }
+  }
+
+} // namespace Imaging
+
+#endif // SAMPLING_MAP_H
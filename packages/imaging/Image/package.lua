@@ -21,6 +21,15 @@
      provide_bind{ file = "binding/bind_image.lua.cc", dest_dir = "include" },
      provide_bind{ file = "binding/bind_image_RGB.lua.cc", dest_dir = "include" },
    },
+   target{
+     name = "test",
+     lua_unit_test{
+       file={
+         "test/test_sampling_map.lua",
+         "test/test_image_augmentation.lua",
+       },
+     },
+   },
    target{
      name = "build",
      depends = "provide",
@@ -43,6 +52,18 @@
        dest_dir = "build",
        --debug = "yes",
      },
+     object{ 
+       file = "c_src/sampling_map.cc",
+       include_dirs = "${include_dirs}",
+       dest_dir = "build",
+       --debug = "yes",
+     },
+     object{ 
+       file = "c_src/image_augmentation_dataset.cc",
+       include_dirs = "${include_dirs}",
+       dest_dir = "build",
+       --debug = "yes",
+     },
      luac{
        orig_dir = "lua_src",
        dest_dir = "build",
@@ -0,0 +1,72 @@
+local check = utest.check
+local T = utest.test
+--
+local rnd = random(1234)
+local m = matrix(50, 16*16):uniformf(0,1,rnd)
+local ds = dataset.matrix(m)
+
+local function pattern_matrix(p)
+  return matrix(16, 16, p)
+end
+
+T("IdentityTest", function()
+    -- without ranges the images are not modified
+    local aug = dataset.image_augmentation{ dataset=ds, width=16, height=16,
+                                            seed=1 }
+    check.eq(pattern_matrix(aug:getPattern(5)),
+             pattern_matrix(ds:getPattern(5)))
+end)
+
+T("AffineTest", function()
+    -- the result is the transform of the pattern given by get_transform,
+    -- placed at the offsets returned by affine_transform
+    local aug = dataset.image_augmentation{ dataset=ds, width=16, height=16,
+                                            seed=7, angle=0.2, scale=0.1,
+                                            shear=0.2, translation=2,
+                                            default_value=0.5 }
+    for _,k in ipairs{ 1, 5, 33, 50 } do
+      local img = Image(pattern_matrix(ds:getPattern(k)))
+      local trans = aug:get_transform(k)
+      local a = pattern_matrix(aug:getPattern(k))
+      local b, bx, by = img:affine_transform(trans, 0.5)
+      local map = image.sampling_map.affine(trans, 16, 16)
+      local c, cx, cy = map:apply(img, 0.5)
+      check.eq(c:matrix(), b:matrix())
+      check.eq(cx, bx)
+      check.eq(cy, by)
+      local bw, bh = b:geometry()
+      local bm = b:matrix()
+      local n = 0
+      for y=1,16 do
+        for x=1,16 do
+          local xx, yy = x - bx, y - by
+          if xx >= 1 and xx <= bw and yy >= 1 and yy <= bh then
+            check.number_eq(a:get(y,x), bm:get(yy,xx), 1e-04)
+            n = n + 1
+          end
+        end
+      end
+      check.TRUE(n > 0)
+    end
+end)
+
+T("ElasticTest", function()
+    local aug = dataset.image_augmentation{ dataset=ds, width=16, height=16,
+                                            seed=7, angle=0.2, scale=0.1,
+                                            shear=0.2, translation=2,
+                                            elastic_alpha=2,
+                                            elastic_sigma=3 }
+    local a = aug:getPattern(5)
+    check.TRUE(not pattern_matrix(a):equals(pattern_matrix(ds:getPattern(5))))
+    -- deterministic for a given pattern and epoch
+    check.eq(pattern_matrix(aug:getPattern(5)), pattern_matrix(a))
+    aug:set_epoch(1)
+    check.TRUE(not pattern_matrix(aug:getPattern(5)):equals(pattern_matrix(a)))
+    aug:set_epoch(0)
+    -- bunches are computed in parallel with the same result
+    local idx = { 5, 17, 3, 50, 5 }
+    local bunch = dataset.token.wrapper(aug):getPatternBunch(idx)
+    for j,k in ipairs(idx) do
+      check.eq(bunch[j], matrix(16*16, aug:getPattern(k)))
+    end
+end)
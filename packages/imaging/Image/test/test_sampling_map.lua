@@ -0,0 +1,39 @@
+local check = utest.check
+local T = utest.test
+--
+-- sampling maps must reproduce the per-call geometric transforms
+local rnd = random(1234)
+local img = Image(matrix(61,97):uniformf(0,1,rnd))
+
+local function check_image(a, b)
+  check.eq(a:matrix(), b:matrix())
+end
+
+T("ResizeMapTest", function()
+    for _,s in ipairs{ {40,30}, {200,150}, {13,200} } do
+      local map = image.sampling_map.resize(97, 61, s[1], s[2])
+      check_image(map:apply(img), img:resize(s[1], s[2]))
+    end
+end)
+
+T("ShearMapTest", function()
+    for _,angle in ipairs{ 0.3, -0.3 } do
+      local map = image.sampling_map.shear_h(angle, 97, 61)
+      check_image(map:apply(img, 0.5), img:shear_h(angle, "rad", 0.5))
+    end
+end)
+
+T("Rotate90MapTest", function()
+    check_image(image.sampling_map.rotate90cw(97, 61):apply(img),
+                img:rotate90cw(1))
+end)
+
+T("AffineMapTest", function()
+    local trans = AffineTransform2D():scale(0.25,0.5):rotate(0.7):translate(4,-7)
+    local map = image.sampling_map.affine(trans, 97, 61)
+    local a, ax, ay = map:apply(img, 0.2)
+    local b, bx, by = img:affine_transform(trans, 0.2)
+    check_image(a, b)
+    check.eq(ax, bx)
+    check.eq(ay, by)
+end)
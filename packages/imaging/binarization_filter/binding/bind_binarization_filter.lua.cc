@@ -63,8 +63,7 @@ using namespace Imaging;
 //BIND_METHOD ImageFloat binarize_sauvola
 {
   int radius;
-  int r;
-  float k, minThreshold, maxThreshold;
+  float k, r;
   LUABIND_CHECK_ARGN(>=, 1);
   LUABIND_GET_PARAMETER(1, int, radius);
   LUABIND_GET_OPTIONAL_PARAMETER(2,float, k, 0.5);
@@ -20,272 +20,262 @@
  */
 #include <cmath>
 #include "binarization.h"
+#include "unique_ptr.h"
 
 namespace Imaging {
 
-  ImageFloat *binarize_niblack(const ImageFloat *src, int windowRadius, float k, float minThreshold, float maxThreshold)
-  {
-    april_assert(src->width()  > 0 && "Zero-sized image!");
-    april_assert(src->height() > 0 && "Zero-sized image!");
+  namespace {
+    
+    /// Read-only access to the pixels of an image through row pointers.
+    class ConstRowAccess {
+      const float *data;
+      int row_stride, col_stride;
+    public:
+      ConstRowAccess(const ImageFloat *img) {
+        const Basics::MatrixFloat *m = img->getMatrix();
+        data = m->getRawDataAccess()->getPPALForRead() + m->getOffset();
+        row_stride = m->getStrideSize(0);
+        col_stride = m->getStrideSize(1);
+      }
+      const float *row(int y) const { return data + y*row_stride; }
+      int stride() const { return col_stride; }
+    };
+    
+    /// Write access to the pixels of an image through row pointers.
+    class RowAccess {
+      float *data;
+      int row_stride, col_stride;
+    public:
+      RowAccess(ImageFloat *img) {
+        Basics::MatrixFloat *m = img->getMatrix();
+        data = m->getRawDataAccess()->getPPALForReadAndWrite() + m->getOffset();
+        row_stride = m->getStrideSize(0);
+        col_stride = m->getStrideSize(1);
+      }
+      float *row(int y) const { return data + y*row_stride; }
+      int stride() const { return col_stride; }
+    };
+
+    /// Row-major integral images of values and squared values, M(x,y) is the
+    /// sum of the pixels in the rectangle (0,0)-(x,y)
+    struct IntegralImages {
+      int width;
+      AprilUtils::UniquePtr<double[]> M, M2;
+      
+      IntegralImages(const ImageFloat *src) : width(src->width()),
+                                              M(new double[src->width()*src->height()]),
+                                              M2(new double[src->width()*src->height()]) {
+        ConstRowAccess src_rows(src);
+        const int stride = src_rows.stride();
+        for (int y = 0; y < src->height(); ++y) {
+          const float *src_row = src_rows.row(y);
+          double *row   = M.get()  + y*width;
+          double *row2  = M2.get() + y*width;
+          const double *prev  = row  - width;
+          const double *prev2 = row2 - width;
+          for (int x = 0; x < width; ++x) {
+            const float v = src_row[x*stride];
+            row[x]  = v;
+            row2[x] = v*v;
+            if (x && y) {
+              row[x]  += row[x-1]  + prev[x]  - prev[x-1];
+              row2[x] += row2[x-1] + prev2[x] - prev2[x-1];
+            }
+            else if (x) {
+              row[x]  += row[x-1];
+              row2[x] += row2[x-1];
+            }
+            else if (y) {
+              row[x]  += prev[x];
+              row2[x] += prev2[x];
+            }
+          }
+        }
+      }
+    };
+
+    /// Shared loop of Niblack and Sauvola local thresholds. The threshold is
+    /// computed by the functor from the local mean and standard deviation.
+    template<typename ThresholdFunctor>
+    void binarize_local_into(const ImageFloat *src, ImageFloat *dst,
+                             int windowRadius, const ThresholdFunctor &thfn) {
+      april_assert(src->width()  == dst->width()  && "Incorrect dst width");
+      april_assert(src->height() == dst->height() && "Incorrect dst height");
+      IntegralImages ii(src);
+      ConstRowAccess src_rows(src);
+      RowAccess dst_rows(dst);
+      const int width = src->width(), height = src->height();
+      const int env = windowRadius;
+      for (int y = 0; y < height; ++y) {
+        const float *src_row = src_rows.row(y);
+        float *dst_row = dst_rows.row(y);
+        // We take the limits of the enviroment
+        const int limSup = (y - env < 0) ? 0 : y - env;
+        const int limInf = (y + env >= height) ? height - 1 : y + env;
+        const double *Msup  = ii.M.get()  + limSup*width;
+        const double *Minf  = ii.M.get()  + limInf*width;
+        const double *M2sup = ii.M2.get() + limSup*width;
+        const double *M2inf = ii.M2.get() + limInf*width;
+        for (int x = 0; x < width; ++x) {
+          const int limLeft  = (x - env < 0) ? 0 : x - env;
+          const int limRight = (x + env >= width) ? width - 1 : x + env;
+          const int area = (limInf-limSup+1)*(limRight-limLeft+1);
+          //Calculate the mean
+          double mean  = double(Msup[limLeft] + Minf[limRight] -
+                                Minf[limLeft] - Msup[limRight])/area;
+          double mean2 = double(M2sup[limLeft] + M2inf[limRight] -
+                                M2inf[limLeft] - M2sup[limRight])/area;
+          //Compute the Standar Deviacion square(Mean^2-mean2)
+          double sd = sqrt(mean2-mean*mean);
+          float T = thfn(mean, sd);
+          dst_row[x*dst_rows.stride()] =
+            src_row[x*src_rows.stride()] < T ? 0.0f : 1.0f;
+        }
+      }
+    }
+    
+    struct NiblackThreshold {
+      float k;
+      NiblackThreshold(float k) : k(k) {}
+      float operator()(double mean, double sd) const {
+        //Apply the Threshold T=mean-0.2sd
+        return mean - k*sd;
+      }
+    };
 
-    ImageFloat *result       = new ImageFloat(src->width(), src->height());
-    ImageFloat *sum          = new ImageFloat(src->width(), src->height());
-    ImageFloat *sumOfSquares = new ImageFloat(src->width(), src->height());
+    struct SauvolaThreshold {
+      float k, r;
+      SauvolaThreshold(float k, float r) : k(k), r(r) {}
+      float operator()(double mean, double sd) const {
+        return mean *(1+k*(sd/(r-1)));
+      }
+    };
+    
+  } // anonymous namespace
 
+  void binarize_niblack_into(const ImageFloat *src, ImageFloat *dst,
+                             int windowRadius, float k,
+                             float minThreshold, float maxThreshold) {
+    april_assert(src->width()  > 0 && "Zero-sized image!");
+    april_assert(src->height() > 0 && "Zero-sized image!");
+    april_assert(src->width()  == dst->width()  && "Incorrect dst width");
+    april_assert(src->height() == dst->height() && "Incorrect dst height");
+    const int width = src->width(), height = src->height();
+    
     // each pixel in the "sum" image contains the sum of the pixels to the left
     // and above it, same for sumOfSquares
-
-    // init to the upper-left corner pixel
-    (*sum)(0,0) = (*src)(0,0);
-    (*sumOfSquares)(0,0) = (*src)(0,0) * (*src)(0,0);
-
-    // First row
-    for (int x=1; x < src->width(); x++) {
-      float current_pixel = (*src)(x,0);
-      (*sum)(x,0) = (*sum)(x-1, 0) + current_pixel;
-      (*sumOfSquares)(x,0) = (*sumOfSquares)(x-1, 0) + current_pixel * current_pixel;
-    }
-
-    // Rest of rows
-    for (int y=1; y < src->height(); y++)
-      for (int x=0; x < src->width(); x++) {
-        float s  = (*sum)(x,y-1);
-        float s2 = (*sumOfSquares)(x,y-1);
-        if (x>0) {
-          s  += (*sum)(x-1,y) - (*sum)(x-1,y-1);
-          s2 += (*sumOfSquares)(x-1, y) - (*sumOfSquares)(x-1,y-1);
+    AprilUtils::UniquePtr<float[]> sum(new float[width*height]);
+    AprilUtils::UniquePtr<float[]> sumOfSquares(new float[width*height]);
+    ConstRowAccess src_rows(src);
+    RowAccess dst_rows(dst);
+    const int src_stride = src_rows.stride(), dst_stride = dst_rows.stride();
+    for (int y = 0; y < height; ++y) {
+      const float *src_row = src_rows.row(y);
+      float *row  = sum.get() + y*width;
+      float *row2 = sumOfSquares.get() + y*width;
+      for (int x = 0; x < width; ++x) {
+        float s = 0.0f, s2 = 0.0f;
+        if (y > 0) {
+          s  = row[x - width];
+          s2 = row2[x - width];
+          if (x > 0) {
+            s  += row[x-1]  - row[x-1 - width];
+            s2 += row2[x-1] - row2[x-1 - width];
+          }
         }
-      
-        float current_pixel = (*src)(x,y);
-        (*sum)(x,y) = s + current_pixel;
-        (*sumOfSquares)(x,y) = s + current_pixel * current_pixel;
+        else if (x > 0) {
+          s  = row[x-1];
+          s2 = row2[x-1];
+        }
+        const float current_pixel = src_row[x*src_stride];
+        row[x]  = s  + current_pixel;
+        row2[x] = s2 + current_pixel * current_pixel;
       }
- 
-
+    }
+    
     // Apply Niblack filter using sum and sumOfSquares for fast mean/std.dev. computation
-    int windowSize = 2*windowRadius+1;
-    int totalWindowPixels = windowSize*windowSize;
-    for (int y=0; y < src->height(); y++)
-      for (int x=0; x < src->width(); x++) {
-        float val = (*src)(x,y);
+    const int windowSize = 2*windowRadius+1;
+    const int totalWindowPixels = windowSize*windowSize;
+    for (int y = 0; y < height; ++y) {
+      const float *src_row = src_rows.row(y);
+      float *dst_row = dst_rows.row(y);
+      const int windowUpper = (y-windowRadius < 0 ? 0 : y-windowRadius);
+      const int windowLower = (y+windowRadius > height - 1 ? height-1 : y+windowRadius);
+      const float *lower  = sum.get() + windowLower*width;
+      const float *lower2 = sumOfSquares.get() + windowLower*width;
+      const float *upper  = sum.get() + (windowUpper-1)*width;
+      const float *upper2 = sumOfSquares.get() + (windowUpper-1)*width;
+      for (int x = 0; x < width; ++x) {
+        const float val = src_row[x*src_stride];
+        float &out = dst_row[x*dst_stride];
         if (val < minThreshold) {
-          (*result)(x,y) = 0;
+          out = 0;
         }
         else if (val > maxThreshold) {
-          (*result)(x,y) = 1;
+          out = 1;
         }
         else {
-          int windowUpper, windowLower, windowLeft, windowRight;
-        
-          windowUpper = (y-windowRadius < 0 ? 0 : y-windowRadius);
-          windowLeft  = (x-windowRadius < 0 ? 0 : x-windowRadius);
-          windowLower = (y+windowRadius > src->height() - 1 ? src->height()-1 : y+windowRadius);
-          windowRight = (x+windowRadius > src->width()  - 1 ? src->width() -1 : x+windowRadius);
-
+          const int windowLeft  = (x-windowRadius < 0 ? 0 : x-windowRadius);
+          const int windowRight = (x+windowRadius > width - 1 ? width-1 : x+windowRadius);
           // assume pixels outside the image are white (value = 1)
-          int windowPixels = (windowRight-windowLeft+1) * (windowLower-windowUpper+1);
-          float s = totalWindowPixels - windowPixels;
+          const int windowPixels = (windowRight-windowLeft+1) * (windowLower-windowUpper+1);
+          float s  = totalWindowPixels - windowPixels;
           float s2 = s; // 1 squared is 1, too
-
-          s  += (*sum)(windowRight, windowLower);
-          s2 += (*sumOfSquares)(windowRight, windowLower);
-
+          s  += lower[windowRight];
+          s2 += lower2[windowRight];
           if (windowLeft > 0) {
-            s  -= (*sum)(windowLeft-1, windowLower);
-            s2 -= (*sumOfSquares)(windowLeft-1, windowLower);
+            s  -= lower[windowLeft-1];
+            s2 -= lower2[windowLeft-1];
           }
-
           if (windowUpper > 0) {
-            s  -= (*sum)(windowRight, windowUpper-1);
-            s2 -= (*sumOfSquares)(windowRight, windowUpper-1);
+            s  -= upper[windowRight];
+            s2 -= upper2[windowRight];
           }
-        
           if (windowLeft > 0 && windowUpper > 0) {
-            s  += (*sum)(windowLeft-1, windowUpper-1);
-            s2 += (*sumOfSquares)(windowLeft-1, windowUpper-1);
+            s  += upper[windowLeft-1];
+            s2 += upper2[windowLeft-1];
           }
-
-          float mean = s/totalWindowPixels;
-          float std_dev = sqrt(s2/totalWindowPixels - mean*mean);
-          float threshold = mean + k*std_dev;
-
-          (*result)(x,y) = val < threshold ? 0 : 1;
+          const float mean = s/totalWindowPixels;
+          const float std_dev = sqrt(s2/totalWindowPixels - mean*mean);
+          const float threshold = mean + k*std_dev;
+          out = val < threshold ? 0 : 1;
         }
       }
-  
-    return result;
+    }
   }
 
+  ImageFloat *binarize_niblack(const ImageFloat *src, int windowRadius, float k, float minThreshold, float maxThreshold)
+  {
+    ImageFloat *result = new ImageFloat(src->width(), src->height());
+    binarize_niblack_into(src, result, windowRadius, k, minThreshold, maxThreshold);
+    return result;
+  }
 
-
+  void binarize_niblack_simple_into(const ImageFloat *src, ImageFloat *dst,
+                                    int windowRadius, float k) {
+    april_assert(src->width()  > 0 && "Zero-sized image!");
+    april_assert(src->height() > 0 && "Zero-sized image!");
+    binarize_local_into(src, dst, windowRadius, NiblackThreshold(k));
+  }
 
   ImageFloat *binarize_niblack_simple(const ImageFloat *src, int windowRadius, float k)
   {
-    april_assert(src->width()  > 0 && "Zero-sized image!");
-    april_assert(src->height() > 0 && "Zero-sized image!");
-    // Image Integral Matrix
     ImageFloat *result = new ImageFloat(src->width(), src->height());
-    double **M = new double*[src->width()];
-    for(int i = 0; i < src->width(); ++i)
-      M[i] = new double[src->height()];
-    // Square Image Integral
-    double **M2 = new double*[src->width()];
-    for(int i = 0; i < src->width(); ++i)
-      M2[i] = new double[src->height()];
-
-    int env=windowRadius;
-    for(int y = 0; y < src->height(); y++)      
-      for (int x = 0; x < src->width(); x++){
-        M[x][y]=(*src)(x,y);
-        M2[x][y]=(*src)(x,y)*(*src)(x,y);
-        if(x && y){
-          M[x][y]+=M[x-1][y]+M[x][y-1]-M[x-1][y-1];
-          M2[x][y]+=M2[x-1][y]+M2[x][y-1]-M2[x-1][y-1];
-        }
-        else if(x && !y){
-          M[x][y]+=M[x-1][y];
-          M2[x][y]+=M2[x-1][y];
-        }
-        else if(!x && y){
-          M[x][y]+=M[x][y-1];
-          M2[x][y]+=M2[x][y-1];
-        }
-
-      }
-
-    for(int y = 0; y < src->height(); y++){
-      for (int x = 0; x < src->width(); x++){
-        int limInf , limSup , limRight,limLeft = 0;
-        int area = 1;
-
-        // We take the limits of the enviroment
-        if(x-env < 0){
-          limLeft = 0;
-        }
-        else limLeft=x-env;
-
-        if(x+env >= src->width()){
-          limRight = src->width()-1;
-        }
-        else limRight=x+env;
-
-        if(y-env < 0){
-          limSup = 0;
-        }
-        else limSup=y-env;
-
-        if(y+env >= src->height()){
-          limInf = src->height()-1;
-        }
-        else limInf=y+env;       
-
-        area = (limInf-limSup+1)*(limRight-limLeft+1);
-
-        //Calculate the mean
-        double mean = double(M[limLeft][limSup]+ M[limRight][limInf] - M[limLeft][limInf] -M[limRight][limSup])/area;
-        double mean2 = double(M2[limLeft][limSup]+ M2[limRight][limInf] - M2[limLeft][limInf] -M2[limRight][limSup])/area;
-        //Compute the Standar Deviacion square(Mean^2-mean2)
-        double sd = sqrt(mean2-mean*mean);
-
-        //Apply the Threshold T=mean-0.2sd
-        float T = mean - k*sd;
-        (*result)(x,y) = (*src)(x,y) < T ? 0 : 1;
-      }
-    }
-
-    for(int i = 0; i < src->width();++i){
-      delete []M[i];
-      delete []M2[i];
-
-    }
-    delete []M;
-    delete []M2;
-
+    binarize_niblack_simple_into(src, result, windowRadius, k);
     return result;
   }
 
-  ImageFloat *binarize_sauvola(const ImageFloat *src, int windowRadius, float k, float r)
-  {
+  void binarize_sauvola_into(const ImageFloat *src, ImageFloat *dst,
+                             int windowRadius, float k, float r) {
     april_assert(src->width()  > 0 && "Zero-sized image!");
     april_assert(src->height() > 0 && "Zero-sized image!");
-    // Image Integral Matrix
-    ImageFloat *result = new ImageFloat(src->width(), src->height());
-    double **M = new double*[src->width()];
-    for(int i = 0; i < src->width(); ++i)
-      M[i] = new double[src->height()];
-    // Square Image Integral
-    double **M2 = new double*[src->width()];
-    for(int i = 0; i < src->width(); ++i)
-      M2[i] = new double[src->height()];
-
-    int env=windowRadius;
-    for(int y = 0; y < src->height(); y++)      
-      for (int x = 0; x < src->width(); x++){
-        M[x][y]=(*src)(x,y);
-        M2[x][y]=(*src)(x,y)*(*src)(x,y);
-        if(x && y){
-          M[x][y]+=M[x-1][y]+M[x][y-1]-M[x-1][y-1];
-          M2[x][y]+=M2[x-1][y]+M2[x][y-1]-M2[x-1][y-1];
-        }
-        else if(x && !y){
-          M[x][y]+=M[x-1][y];
-          M2[x][y]+=M2[x-1][y];
-        }
-        else if(!x && y){
-          M[x][y]+=M[x][y-1];
-          M2[x][y]+=M2[x][y-1];
-        }
-
-      }
-
-    for(int y = 0; y < src->height(); y++){
-      for (int x = 0; x < src->width(); x++){
-        int limInf , limSup , limRight,limLeft = 0;
-        int area = 1;
-
-        // We take the limits of the enviroment
-        if(x-env < 0){
-          limLeft = 0;
-        }
-        else limLeft=x-env;
-
-        if(x+env >= src->width()){
-          limRight = src->width()-1;
-        }
-        else limRight=x+env;
-
-        if(y-env < 0){
-          limSup = 0;
-        }
-        else limSup=y-env;
-
-        if(y+env >= src->height()){
-          limInf = src->height()-1;
-        }
-        else limInf=y+env;       
-
-        area = (limInf-limSup+1)*(limRight-limLeft+1);
-
-        //Calculate the mean
-        double mean = double(M[limLeft][limSup]+ M[limRight][limInf] - M[limLeft][limInf] -M[limRight][limSup])/area;
-        double mean2 = double(M2[limLeft][limSup]+ M2[limRight][limInf] - M2[limLeft][limInf] -M2[limRight][limSup])/area;
-        //Compute the Standar Deviacion square(Mean^2-mean2)
-        double sd = sqrt(mean2-mean*mean);
-
-        //Apply the Threshold T=mean-0.2sd
-        float T = mean *(1+k*(sd/(r-1)));
-        (*result)(x,y) = (*src)(x,y) < T ? 0 : 1;
-      }
-    }
-
-    for(int i = 0; i < src->width();++i){
-      delete []M[i];
-      delete []M2[i];
-
-    }
-    delete []M;
-    delete []M2;
+    binarize_local_into(src, dst, windowRadius, SauvolaThreshold(k, r));
+  }
 
+  ImageFloat *binarize_sauvola(const ImageFloat *src, int windowRadius, float k, float r)
+  {
+    ImageFloat *result = new ImageFloat(src->width(), src->height());
+    binarize_sauvola_into(src, result, windowRadius, k, r);
     return result;
   }
 
@@ -41,6 +41,19 @@ namespace Imaging {
   /// Simple Image Thresholding
   ImageFloat *binarize_threshold(const ImageFloat *src, double threshold);
 
+  /// Niblack normalization into a preallocated dst image of the same size
+  void binarize_niblack_into(const ImageFloat *src, ImageFloat *dst,
+                             int windowRadius, float k,
+                             float minThreshold, float maxThreshold);
+
+  /// Simple Niblack into a preallocated dst image of the same size
+  void binarize_niblack_simple_into(const ImageFloat *src, ImageFloat *dst,
+                                    int windowRadius, float k);
+
+  /// Sauvola into a preallocated dst image of the same size
+  void binarize_sauvola_into(const ImageFloat *src, ImageFloat *dst,
+                             int windowRadius, float k, float r);
+
 } // namespace Imaging
 
 #endif
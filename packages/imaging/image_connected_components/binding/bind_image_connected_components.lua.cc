@@ -59,14 +59,29 @@ using namespace Imaging;
 
 //BIND_CONSTRUCTOR ImageConnectedComponents
 //DOC_BEGIN
+// Receives an image, an optional black threshold (0.7 by default) and an
+// optional connectivity: 4, 8 or 24 (by default), where 24 connects black
+// pixels separated by one white pixel and labels white pixels touching them.
 //DOC_END
 {
-  LUABIND_CHECK_ARGN(==,1);
+  LUABIND_CHECK_ARGN(>=,1);
+  LUABIND_CHECK_ARGN(<=,3);
   ImageFloat *img;
+  float threshold;
+  int connectivity;
   LUABIND_GET_PARAMETER(1, ImageFloat, img);
-
-  ImageConnectedComponents *obj = new ImageConnectedComponents(img);
-  obj->getColoredImage();
+  LUABIND_GET_OPTIONAL_PARAMETER(2, float, threshold, 0.7f);
+  LUABIND_GET_OPTIONAL_PARAMETER(3, int, connectivity,
+                                 ImageConnectedComponents::HALO_CONNECTED);
+  if (connectivity != ImageConnectedComponents::FOUR_CONNECTED &&
+      connectivity != ImageConnectedComponents::EIGHT_CONNECTED &&
+      connectivity != ImageConnectedComponents::HALO_CONNECTED) {
+    LUABIND_FERROR1("Incorrect connectivity %d, expected 4, 8 or 24\n",
+                    connectivity);
+  }
+  ImageConnectedComponents *obj =
+    new ImageConnectedComponents(img, threshold,
+                                 static_cast<ImageConnectedComponents::Connectivity>(connectivity));
   LUABIND_RETURN(ImageConnectedComponents, obj);
 }
 //BIND_END
@@ -103,6 +118,18 @@ using namespace Imaging;
 }
 //BIND_END
 
+//BIND_METHOD ImageConnectedComponents get_component_sizes
+{
+  LUABIND_CHECK_ARGN(==, 0);
+  lua_createtable(L, obj->size, 0);
+  for (int i = 0; i < obj->size; ++i) {
+    lua_pushint(L, obj->getComponentSize(i));
+    lua_rawseti(L, -2, i+1);
+  }
+  LUABIND_RETURN_FROM_STACK(-1);
+}
+//BIND_END
+
 //BIND_METHOD ImageConnectedComponents get_bounding_boxes
 {
   LUABIND_CHECK_ARGN(==, 0);
@@ -21,6 +21,7 @@
  */
 
 #include "image_connected_components.h"
+#include "omp_utils.h"
 
 using namespace AprilUtils;
 using namespace Basics;
@@ -52,66 +53,190 @@ namespace Imaging {
     return y*img->width() + x;
   }
 
-  inline void to_coords(const ImageFloat *img, int index, int &x, int &y) {
-    y = index/img->width();
-    x = index%img->width();
+  /// Minimum number of rows of the strips labeled by every OMP thread.
+#define CC_MIN_STRIP_HEIGHT 32
+
+  int ImageConnectedComponents::findRoot(vector<int> &parent, int r) {
+    int root = r;
+    while (parent[root] != root) root = parent[root];
+    // path compression
+    while (parent[r] != root) {
+      int next  = parent[r];
+      parent[r] = root;
+      r = next;
+    }
+    return root;
+  }
+
+  // The root of every set is its first run in raster order, so it is linked
+  // to the smallest root
+  void ImageConnectedComponents::joinRuns(vector<int> &parent, int r1, int r2) {
+    int a = findRoot(parent, r1);
+    int b = findRoot(parent, r2);
+    if (a < b) parent[b] = a;
+    else if (b < a) parent[a] = b;
   }
 
-  void ImageConnectedComponents::dfs_component(int x, int y, int current_component, int &current_pixel){
-   
-    const int dir = 8;
-    int directions[dir][2] = { {-1, -1}, {0, -1}, {1, -1},
-                               {-1, 0}, {1, 0},
-                               {-1, 1}, {0, 1}, {1, 1}};
-   
-    for (int i = 0; i < dir; ++i) {
-      int newx = x + directions[i][0];
-      int newy = y + directions[i][1];
-      int new_index = to_index(img, newx, newy);
-      if (newx < 0 || newx >= img->width() || newy < 0 || newy >= img->height() || pixelComponents[new_index])
-        continue;      
-      if ((*img)(newx, newy) < threshold) {// If it is black
-        components[current_pixel++] = new_index; 
+  // Joins the runs of row ya with the runs of row yb (ya <= yb) which are
+  // connected following the given connectivity
+  void ImageConnectedComponents::connectRows(vector<int> &parent, int ya, int yb) {
+    // maximum horizontal distance between connected runs
+    const int reach = (connectivity == FOUR_CONNECTED) ? 0 :
+      ( (connectivity == EIGHT_CONNECTED) ? 1 : 2 );
+    if (ya == yb) {
+      for (int r = rowRuns[ya]; r + 1 < rowRuns[ya+1]; ++r) {
+        if (runs[r+1].x1 - runs[r].x2 <= reach) joinRuns(parent, r, r+1);
       }
-      if ((*img)(x, y) < threshold || (*img)(newx, newy) < threshold) {
-        pixelComponents[new_index]  = current_component;
-        dfs_component(newx, newy, current_component, current_pixel); 
+    }
+    else {
+      int k = rowRuns[ya];
+      const int kend = rowRuns[ya+1];
+      for (int j = rowRuns[yb]; j < rowRuns[yb+1]; ++j) {
+        while (k < kend && runs[k].x2 + reach < runs[j].x1) ++k;
+        for (int m = k; m < kend && runs[m].x1 <= runs[j].x2 + reach; ++m) {
+          joinRuns(parent, m, j);
+        }
       }
-    }  
-
+    }
+  }
+  
+  void ImageConnectedComponents::extractRuns() {
+    const int width = img->width(), height = img->height();
+    rowRuns.resize(height + 1);
+    rowRuns[0] = 0;
+    // 1. count the runs of every row
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(OMPUtils::get_num_threads() > 1 && height > CC_MIN_STRIP_HEIGHT)
+#endif
+    for (int y = 0; y < height; ++y) {
+      int count = 0;
+      bool prev_black = false;
+      for (int x = 0; x < width; ++x) {
+        bool black = (*img)(x,y) < threshold;
+        if (black && !prev_black) ++count;
+        prev_black = black;
+      }
+      rowRuns[y+1] = count;
+    }
+    for (int y = 0; y < height; ++y) rowRuns[y+1] += rowRuns[y];
+    // 2. store the runs in raster order
+    runs.resize(rowRuns[height]);
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(OMPUtils::get_num_threads() > 1 && height > CC_MIN_STRIP_HEIGHT)
+#endif
+    for (int y = 0; y < height; ++y) {
+      int r = rowRuns[y];
+      int x = 0;
+      while (x < width) {
+        if ((*img)(x,y) < threshold) {
+          runs[r].y  = y;
+          runs[r].x1 = x;
+          while (x + 1 < width && (*img)(x+1,y) < threshold) ++x;
+          runs[r].x2 = x;
+          ++r;
+        }
+        ++x;
+      }
+    }
   }
 
-  ImageConnectedComponents::ImageConnectedComponents(const ImageFloat *img, float threshold):threshold(threshold) {
-    // 1. Create a Integer Matrix of the same size of the original image
-    this->img = img;
-    pixelComponents = vector<int>(img->width()*img->height(), 0);
-
-    // 2. Count the number of black pixels
-    int black_pixels = img->count_black_pixels(threshold);
-
-    // 3. Create a component of the size black pixels
-    components = vector<int>(black_pixels);
-    indexComponents = vector<int>();
-
-
-    int current_component = 0;
-    int current_pixel     = 0;
-    // 4. Compute the connected components.
-    for (int y = 0; y < img->height(); ++y) {
-      for (int x = 0; x < img->width(); ++x) {
-        int index = to_index(img, x, y);
-        if ((*img)(x,y) < threshold && !pixelComponents[index]) {
-          pixelComponents[index] = ++current_component;
-          components[current_pixel++] = index;
-          //DFS over the pixel
-          dfs_component(x, y, current_component, current_pixel);
-          indexComponents.push_back(current_pixel);
+  void ImageConnectedComponents::fillPixelComponents() {
+    const int width = img->width(), height = img->height();
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(OMPUtils::get_num_threads() > 1 && height > CC_MIN_STRIP_HEIGHT)
+#endif
+    for (int y = 0; y < height; ++y) {
+      int *row = pixelComponents.begin() + y*width;
+      for (int r = rowRuns[y]; r < rowRuns[y+1]; ++r) {
+        for (int x = runs[r].x1; x <= runs[r].x2; ++x) row[x] = runComponents[r] + 1;
+      }
+      if (connectivity == HALO_CONNECTED) {
+        // white pixels touching a component belong to it, all the black
+        // pixels around a white pixel belong to the same component
+        for (int yy = max(0, y-1); yy <= min(height-1, y+1); ++yy) {
+          for (int r = rowRuns[yy]; r < rowRuns[yy+1]; ++r) {
+            const int from = max(0, runs[r].x1 - 1);
+            const int to   = min(width - 1, runs[r].x2 + 1);
+            for (int x = from; x <= to; ++x) {
+              if (!row[x]) row[x] = runComponents[r] + 1;
+            }
+          }
+        }
+      }
+    }
+  }
+  
+  ImageConnectedComponents::ImageConnectedComponents(const ImageFloat *img,
+                                                     float threshold,
+                                                     Connectivity connectivity) :
+    threshold(threshold), connectivity(connectivity),
+    img(const_cast<ImageFloat*>(img)) {
+    const int width = img->width(), height = img->height();
+    // maximum vertical distance between connected rows
+    const int depth = (connectivity == HALO_CONNECTED) ? 2 : 1;
+    pixelComponents = vector<int>(width*height, 0);
+    
+    // 1. Extract the runs of black pixels
+    extractRuns();
+    const int num_runs = static_cast<int>(runs.size());
+    vector<int> parent(num_runs);
+    for (int r = 0; r < num_runs; ++r) parent[r] = r;
+
+    // 2. First pass, every strip of rows is labeled independently
+    int num_strips = 1;
+#ifndef NO_OMP
+    num_strips = max(1, min(OMPUtils::get_num_threads(),
+                            height / CC_MIN_STRIP_HEIGHT));
+#endif
+    const int strip_height = (height + num_strips - 1) / num_strips;
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(num_strips > 1)
+#endif
+    for (int s = 0; s < num_strips; ++s) {
+      const int y0 = s*strip_height;
+      const int y1 = min(height, y0 + strip_height);
+      for (int y = y0; y < y1; ++y) {
+        if (connectivity == HALO_CONNECTED) connectRows(parent, y, y);
+        for (int d = 1; d <= depth && y - d >= y0; ++d) {
+          connectRows(parent, y - d, y);
+        }
+      }
+    }
+    // merge labels at strip borders
+    for (int s = 1; s < num_strips; ++s) {
+      const int border = s*strip_height;
+      for (int y = border; y < min(height, border + depth); ++y) {
+        for (int d = 1; d <= depth; ++d) {
+          if (y - d >= 0 && y - d < border) connectRows(parent, y - d, y);
         }
       }
     }
 
-    size = current_component;
+    // 3. Second pass, final labels following the raster order, bounding boxes
+    // and pixel counts
+    size = 0;
+    runComponents.resize(num_runs);
+    for (int r = 0; r < num_runs; ++r) {
+      const int root = findRoot(parent, r);
+      if (root == r) {
+        runComponents[r] = size++;
+        boundingBoxes.push_back(bounding_box(width, height, 0, 0));
+        componentSizes.push_back(0);
+      }
+      else {
+        runComponents[r] = runComponents[root];
+      }
+      const Run &run = runs[r];
+      bounding_box &bb = boundingBoxes[runComponents[r]];
+      bb.x1 = min(bb.x1, run.x1);
+      bb.y1 = min(bb.y1, run.y);
+      bb.x2 = max(bb.x2, run.x2);
+      bb.y2 = max(bb.y2, run.y);
+      componentSizes[runComponents[r]] += run.x2 - run.x1 + 1;
+    }
 
+    // 4. Fill the matrix of components
+    fillPixelComponents();
   }
 
   MatrixInt32 * ImageConnectedComponents::getPixelMatrix(){
@@ -121,7 +246,7 @@ namespace Imaging {
     MatrixInt32 *m = new MatrixInt32(2,dims);
     for (int y = 0; y < img->height(); ++y) {
       for (int x = 0; x < img->width(); ++x) {
-        int index = to_index(img, x, y);
+        int index = to_index(img.get(), x, y);
         int value = pixelComponents[index];
         (*m)(y,x) = value;
       }
@@ -137,17 +262,11 @@ namespace Imaging {
     AprilMath::MatrixExt::Initializers::matFill(m, FloatRGB(1, 1, 1));
     ImageFloatRGB *result = new ImageFloatRGB(m);
 
-    int first = 0;
-    for (int cc = 0; cc < size; ++cc) {
-      //    printf("Component %d %d\n", cc, indexComponents[cc]); 
-      for (int i = first; i < indexComponents[cc]; ++i) {
-        float *color = getIndexColor(cc);
-        int index = components[i];
-        int x, y;
-        to_coords(img, index, x, y);
-        (*m)(y,x) = FloatRGB(color[0], color[1], color[2]);
+    for (unsigned int r = 0; r < runs.size(); ++r) {
+      float *color = getIndexColor(runComponents[r]);
+      for (int x = runs[r].x1; x <= runs[r].x2; ++x) {
+        (*m)(runs[r].y,x) = FloatRGB(color[0], color[1], color[2]);
       }
-      first = indexComponents[cc];
     }
 
     return result;
@@ -158,8 +277,8 @@ namespace Imaging {
     april_assert(x1 <= img->width() && x1 > 0 && y1 <= img->height() && y1 > 0 && "X1, Y1 point out of bounds");
     april_assert(x2 <= img->width() && x2 > 0 && y2 <= img->height() && y2 > 0 && "X2, Y2 point out of bounds");
 
-    int index1 = to_index(img, x1, y1);
-    int index2 = to_index(img, x2, y2);
+    int index1 = to_index(img.get(), x1, y1);
+    int index2 = to_index(img.get(), x2, y2);
 
     if (!pixelComponents[index1] && !pixelComponents[index2]) {
       fprintf(stderr, "Warning! One of the point is not in a component\n");
@@ -170,32 +289,18 @@ namespace Imaging {
   }
 
   int ImageConnectedComponents::getComponent(int x, int y) {
-    int index = to_index(img, x, y);
+    int index = to_index(img.get(), x, y);
     return pixelComponents[index] -1;
   }
 
   bounding_box ImageConnectedComponents::getComponentBoundingBox(int component) {
     assert(component >= 0 && component < size && "The component is not corrected"); 
-  
-    int from = component ? indexComponents[component-1] : 0;
-    int to = indexComponents[component];
-
-    int x1 = img->width();
-    int y1 = img->height();
-    int x2 = 0;
-    int y2 = 0;
-    for (int i = from; i < to; ++i) {
-      int x, y;
-      int pointIndex = components[i];
-      to_coords(img, pointIndex, x, y);
-      x1 = min(x1, x);
-      y1 = min(y1, y);
-
-      x2 = max(x2, x);
-      y2 = max(y2, y);
-    }
+    return boundingBoxes[component];
+  }
 
-    return bounding_box(x1,y1, x2, y2);
+  int ImageConnectedComponents::getComponentSize(int component) {
+    assert(component >= 0 && component < size && "The component is not corrected"); 
+    return componentSizes[component];
   }
 
   vector<bounding_box> * ImageConnectedComponents::getBoundingBoxes() {
@@ -24,6 +24,7 @@
 
 #include "matrixInt32.h"
 #include "utilImageFloat.h"
+#include "smart_ptr.h"
 #include "vector.h"
 
 namespace Imaging {
@@ -37,27 +38,63 @@ namespace Imaging {
       x1(x1),y1(y1),x2(x2),y2(y2){}
   };
 
+  /**
+   * @brief Connected components of the black pixels of an image.
+   *
+   * Components are labeled with a two-pass union-find over runs of black
+   * pixels. The image is divided in horizontal strips which are labeled in
+   * parallel, and labels are merged afterwards at strip borders. Bounding
+   * boxes and pixel counts are computed in the same pass. Components are
+   * numbered following the raster order of their first black pixel.
+   */
   class ImageConnectedComponents: public Referenced{
-
-    // Matrix of the size of the image that is used to 
+  public:
+    /// Neighborhood used to connect black pixels.
+    enum Connectivity {
+      FOUR_CONNECTED  = 4,  ///< Horizontal and vertical neighbors.
+      EIGHT_CONNECTED = 8,  ///< 3x3 neighborhood.
+      /// 5x5 neighborhood: black pixels separated by one white pixel are
+      /// connected, and white pixels touching a component receive its label
+      /// in the pixel matrix (the original behavior of this class).
+      HALO_CONNECTED  = 24
+    };
+    
+  private:
+    /// A run of consecutive black pixels in a row.
+    struct Run {
+      int y, x1, x2;
+    };
+    
+    // Matrix of the size of the image with the component of every pixel
+    // (starting at 1, 0 for background)
     AprilUtils::vector <int> pixelComponents;
 
-    // Vector that stores the black pixels sorted by components 
-    AprilUtils::vector <int> components;
-
-    // index that delimites the CCs in components
-    AprilUtils::vector <int> indexComponents;
-
+    // runs sorted in raster order and index of the first run of every row
+    AprilUtils::vector <Run> runs;
+    AprilUtils::vector <int> rowRuns;
+    // component of every run (starting at 0)
+    AprilUtils::vector <int> runComponents;
+    
+    AprilUtils::vector <bounding_box> boundingBoxes;
+    AprilUtils::vector <int> componentSizes;
+    
     //black threshold
     float threshold;
-    const ImageFloat *img;
+    Connectivity connectivity;
+    // the image is referenced, pixel queries need it after construction
+    AprilUtils::SharedPtr<ImageFloat> img;
   public:
     int size;
-    ImageConnectedComponents(const ImageFloat *img, float threshold = 0.7);
+    ImageConnectedComponents(const ImageFloat *img, float threshold = 0.7,
+                             Connectivity connectivity = HALO_CONNECTED);
     ~ImageConnectedComponents(){};
 
   private:
-    void dfs_component(int x, int y, int current_component, int &current_pixel);
+    int findRoot(AprilUtils::vector<int> &parent, int r);
+    void joinRuns(AprilUtils::vector<int> &parent, int r1, int r2);
+    void connectRows(AprilUtils::vector<int> &parent, int ya, int yb);
+    void extractRuns();
+    void fillPixelComponents();
 
   public:
     Basics::MatrixInt32 *getPixelMatrix();
@@ -66,6 +103,8 @@ namespace Imaging {
     int getComponent(int x, int y);
     ImageFloatRGB  *getColoredImage();
     bounding_box getComponentBoundingBox(int component);
+    /// Number of black pixels of the given component.
+    int getComponentSize(int component);
     AprilUtils::vector<bounding_box> *getBoundingBoxes();    
 
   };
@@ -19,6 +19,14 @@ package{ name = "image_connected_components",
      copy{ file= "c_src/*.h", dest_dir = "include" },
      provide_bind{ file = "binding/bind_image_connected_components.lua.cc", dest_dir = "include" },
    },
+   target{
+     name = "test",
+     lua_unit_test{
+       file={
+         "test/testCC.lua",
+       },
+     },
+   },
    target{
      name = "build",
      depends = "provide",
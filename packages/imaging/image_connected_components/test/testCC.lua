@@ -1,34 +1,106 @@
--- Create a simple matrix
---
+local check = utest.check
+local T = utest.test
 
-m = matrix(5, 6, { 0, 1, 1, 1, 1, 1, 
-                   0, 0, 1, 1, 0, 0, 
-                   0, 1, 1, 1, 1, 0,
-                   1, 0, 1, 1, 1, 1, 
-                   1, 1, 1, 1, 0, 1})
-
--- Create the image
-local myImg = Image(m)
-
-local n_comps = image.test_connected_components(myImg)
-
-print (myImg:geometry())
-print(n_comps)
-local comps = image.connected_components(myImg)
-
-local index_matrix = comps:get_pixel_matrix()
-
-local color_matrix = comps:get_colored_image()
-
-
-ImageIO.write(color_matrix, "matrix.png", "png")
-print (m)
-print (index_matrix)
+-- labeling by graph traversal, the same rules of the former recursive DFS:
+-- black pixels are connected through their 4 or 8 neighbors, and with
+-- connectivity 24 any pixel touching a black one receives its label
+local function reference(m, threshold, connectivity)
+  local h,w = m:dim(1), m:dim(2)
+  local function black(x,y) return m:get(y+1,x+1) < threshold end
+  local dirs
+  if connectivity == 4 then
+    dirs = { {1,0}, {-1,0}, {0,1}, {0,-1} }
+  else
+    dirs = { {-1,-1}, {0,-1}, {1,-1}, {-1,0}, {1,0}, {-1,1}, {0,1}, {1,1} }
+  end
+  local labels = matrixInt32(h,w):zeros()
+  local sizes,bbs = {},{}
+  for y=0,h-1 do
+    for x=0,w-1 do
+      if black(x,y) and labels:get(y+1,x+1) == 0 then
+        local c = #sizes + 1
+        sizes[c],bbs[c] = 0,{ x, y, x, y }
+        local function add(px,py)
+          labels:set(py+1,px+1,c)
+          if black(px,py) then
+            local bb = bbs[c]
+            sizes[c] = sizes[c] + 1
+            bb[1],bb[2] = math.min(bb[1],px), math.min(bb[2],py)
+            bb[3],bb[4] = math.max(bb[3],px), math.max(bb[4],py)
+          end
+        end
+        local stack = { {x,y} }
+        add(x,y)
+        while #stack > 0 do
+          local px,py = table.unpack(table.remove(stack))
+          for _,d in ipairs(dirs) do
+            local nx,ny = px+d[1], py+d[2]
+            if nx >= 0 and nx < w and ny >= 0 and ny < h and
+            labels:get(ny+1,nx+1) == 0 and
+              (black(nx,ny) or (connectivity == 24 and black(px,py))) then
+              add(nx,ny)
+              table.insert(stack, {nx,ny})
+            end
+          end
+        end
+      end
+    end
+  end
+  return labels,sizes,bbs
+end
 
-print ("Bounding boxes")
+local function check_labeling(m, connectivity)
+  local comps = image.connected_components(Image(m), 0.7, connectivity)
+  local labels,sizes,bbs = reference(m, 0.7, connectivity)
+  check.eq(comps:get_size(), #sizes)
+  check.eq(comps:get_pixel_matrix(), labels)
+  local c_sizes = comps:get_component_sizes()
+  local c_bbs = comps:get_bounding_boxes()
+  check.eq(#c_sizes, #sizes)
+  check.eq(#c_bbs, #bbs)
+  for i=1,#sizes do
+    check.eq(c_sizes[i], sizes[i])
+    for j=1,4 do check.eq(c_bbs[i][j], bbs[i][j]) end
+  end
+  return comps
+end
 
-bbs = comps:get_bounding_boxes()
-for i,v in ipairs(bbs) do
+T("SmallImageTest", function()
+    local m = matrix(5, 6, { 0, 1, 1, 1, 1, 1,
+                             0, 0, 1, 1, 0, 0,
+                             0, 1, 1, 1, 1, 0,
+                             1, 0, 1, 1, 1, 1,
+                             1, 1, 1, 1, 0, 1 })
+    check.eq(image.test_connected_components(Image(m)),
+             image.connected_components(Image(m)):get_size())
+    check.eq(check_labeling(m, 4):get_size(), 4)
+    local comps = check_labeling(m, 8)
+    check.eq(comps:get_size(), 3)
+    check.eq(comps:get_component_sizes()[1], 5)
+    local bb = comps:get_bounding_boxes()[1]
+    check.eq(bb[1], 0) check.eq(bb[2], 0) check.eq(bb[3], 1) check.eq(bb[4], 3)
+    check_labeling(m, 24)
+end)
 
-  print (v[1], v[2], v[3], v[4])
-end
+T("StripBordersTest", function()
+    -- tall images are split in strips labeled by different threads
+    local rnd = random(1234)
+    local prev_threads = util.omp_get_num_threads()
+    util.omp_set_num_threads(4)
+    for _,density in ipairs{ 0.3, 0.45, 0.6 } do
+      local m = matrix(160, 57):uniformf(0, 1, rnd)
+      m:map(function(x) return x < density and 0 or 1 end)
+      -- lines which cross all the strip borders
+      m:select(2, 10):zeros()
+      for y=1,160 do m:set(y, 30 + y % 2, 0) end
+      for _,connectivity in ipairs{ 4, 8, 24 } do
+        local comps = check_labeling(m, connectivity)
+        -- the result doesn't depend on the number of strips
+        util.omp_set_num_threads(1)
+        local comps1 = image.connected_components(Image(m), 0.7, connectivity)
+        check.eq(comps1:get_pixel_matrix(), comps:get_pixel_matrix())
+        util.omp_set_num_threads(4)
+      end
+    end
+    util.omp_set_num_threads(prev_threads)
+end)
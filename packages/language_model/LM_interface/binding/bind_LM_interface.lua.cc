@@ -23,6 +23,7 @@
 #include "bind_dataset.h"
 #include "bind_function_interface.h"
 #include "bind_LM_interface.h"
+#include "bind_april_io.h"
 #include "LM_interface.h"
 
 using namespace AprilUtils;
@@ -36,6 +37,7 @@ using namespace Functions;
 #include "feature_based_LM.h"
 #include "bunch_hashed_LM.h"
 #include "skip_function.h"
+#include "nbest_rescorer.h"
 using namespace LanguageModels;
 using namespace LanguageModels::QueryFilters;
 
@@ -561,6 +563,80 @@ public:
 
 //////////////////////////////////////////////////////////////////////////////
 
+//BIND_LUACLASSNAME NBestRescorer language_models.nbest_rescorer
+//BIND_CPP_CLASS    NBestRescorer
+
+//BIND_CONSTRUCTOR NBestRescorer
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  check_table_fields(L, 1,
+                     "model",
+                     "vocabulary", // table of words, id is the position
+                     "unk_word",
+                     "end_word",
+                     "use_bcc",
+                     "use_ecc",
+                     (const char *)0);
+  LMModelUInt32LogFloat *model;
+  const char *unk_word, *end_word;
+  bool use_bcc, use_ecc;
+  LUABIND_GET_TABLE_PARAMETER(1, model, LMModelUInt32LogFloat, model);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, unk_word, string, unk_word, "<unk>");
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, end_word, string, end_word, "</s>");
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, use_bcc, bool, use_bcc, true);
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, use_ecc, bool, use_ecc, true);
+  int vocabulary_size;
+  lua_getfield(L, 1, "vocabulary");
+  if (!lua_istable(L, -1)) LUABIND_ERROR("Needs a vocabulary table\n");
+  LUABIND_TABLE_GETN(-1, vocabulary_size);
+  const char **vocabulary_vector = new const char *[vocabulary_size];
+  LUABIND_TABLE_TO_VECTOR(-1, string, vocabulary_vector, vocabulary_size);
+  obj = new NBestRescorer(model, static_cast<unsigned int>(vocabulary_size),
+                          vocabulary_vector, unk_word, end_word,
+                          use_bcc, use_ecc);
+  lua_pop(L, 1);
+  delete[] vocabulary_vector;
+  LUABIND_RETURN(NBestRescorer, obj);
+}
+//BIND_END
+
+//BIND_METHOD NBestRescorer rescore
+// receives an input stream, an output stream, the output format ("scores"
+// or "nbest") and the number of sentences of every batch; returns the number
+// of hypotheses and sentences
+{
+  SharedPtr<AprilIO::StreamInterface> input, output;
+  const char *format_str;
+  unsigned int batch_size;
+  LUABIND_CHECK_ARGN(>=, 2);
+  LUABIND_CHECK_ARGN(<=, 4);
+  LUABIND_GET_PARAMETER(1, AuxStreamInterface<AprilIO::StreamInterface>, input);
+  LUABIND_GET_PARAMETER(2, AuxStreamInterface<AprilIO::StreamInterface>, output);
+  LUABIND_GET_OPTIONAL_PARAMETER(3, string, format_str, "scores");
+  LUABIND_GET_OPTIONAL_PARAMETER(4, uint, batch_size,
+                                 NBestRescorer::DEFAULT_BATCH_SIZE);
+  if (input.empty() || output.empty()) {
+    LUABIND_ERROR("Needs input and output streams\n");
+  }
+  NBestRescorer::OutputFormat format = NBestRescorer::SCORES_FORMAT;
+  if (!strcmp(format_str, "nbest")) format = NBestRescorer::NBEST_FORMAT;
+  else if (strcmp(format_str, "scores")) {
+    LUABIND_FERROR1("Unknown output format %s\n", format_str);
+  }
+  unsigned int num_hyps = obj->rescore(input.get(), output.get(), format,
+                                       batch_size);
+  LUABIND_RETURN(uint, num_hyps);
+  LUABIND_RETURN(uint, obj->getNumSentences());
+}
+//BIND_END
+
+//BIND_METHOD NBestRescorer get_num_queries
+{
+  LUABIND_RETURN(uint, obj->getNumQueries());
+}
+//BIND_END
+
 //BIND_LUACLASSNAME FunctionInterface functions
 
 //BIND_LUACLASSNAME DiceSkipFunction functions.dice_skip
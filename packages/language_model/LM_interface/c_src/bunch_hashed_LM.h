@@ -78,7 +78,11 @@ namespace LanguageModels {
     virtual void insertQuery(Key key, WordType word, Burden burden,
                              Score threshold) {
       UNUSED_VARIABLE(threshold);
+      int old_size = context_key_hash.size();
       WordResultHash &ctxt = context_key_hash[key];
+      // clearQueries() doesn't destroy the buckets of context_key_hash, a new
+      // key may reuse the words of an old one
+      if (context_key_hash.size() != old_size) ctxt.clear();
       KeyScoreMultipleBurdenTuple &ctxt_word = ctxt[word];
       ctxt_word.burden_vector.push_back(burden);
     }
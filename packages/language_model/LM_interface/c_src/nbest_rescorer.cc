@@ -0,0 +1,349 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "error_print.h"
+#include "nbest_rescorer.h"
+#include "omp_utils.h"
+
+using AprilIO::CStringStream;
+using AprilIO::StreamInterface;
+using AprilUtils::constString;
+using AprilUtils::log_float;
+using AprilUtils::vector;
+
+namespace LanguageModels {
+
+  static const char NBEST_SEPARATOR[] = "|||";
+  static const size_t NBEST_SEPARATOR_LEN = 3;
+  static const uint32_t NO_NODE = static_cast<uint32_t>(-1);
+  
+  static bool isBlank(char c) {
+    return c == ' ' || c == '\t';
+  }
+
+  /// Reads a line removing the trailing end-of-line, returns false at EOF
+  static bool readLine(StreamInterface *input, CStringStream *line) {
+    line->clear();
+    if (input->get(line, "\n", true) == 0) return false;
+    size_t len = line->size();
+    while (len > 0 && ((*line)[len-1] == '\n' || (*line)[len-1] == '\r')) {
+      --len;
+    }
+    (*line)[len] = '\0';
+    return true;
+  }
+
+  /// Returns the sentence number of a n-best line, or -1 when malformed
+  static int parseSentenceNumber(const char *line) {
+    const char *sep = strstr(line, NBEST_SEPARATOR);
+    if (sep == 0) return -1;
+    char *end;
+    long n = strtol(line, &end, 10);
+    if (end == line) return -1;
+    while (isBlank(*end)) ++end;
+    if (end != sep) return -1;
+    return static_cast<int>(n);
+  }
+
+  static void appendString(vector<char> &dest, const char *str, size_t len) {
+    for (size_t i=0; i<len; ++i) dest.push_back(str[i]);
+  }
+
+  NBestRescorer::NBestRescorer(LMModelUInt32LogFloat *model,
+                               unsigned int vocabulary_size,
+                               const char *vocabulary[],
+                               const char *unk_word, const char *end_word,
+                               bool use_bcc, bool use_ecc) :
+    Referenced(), model(model), lmi(model->getInterface()),
+    use_bcc(use_bcc), use_ecc(use_ecc), num_sentences(0), num_queries(0) {
+    if (!model->isDeterministic()) {
+      ERROR_EXIT(128, "NBestRescorer needs a deterministic LM\n");
+    }
+    for (unsigned int i=0; i<vocabulary_size; ++i) {
+      size_t len = strlen(vocabulary[i]);
+      char *w = new char[len+1];
+      memcpy(w, vocabulary[i], len+1);
+      words.push_back(w);
+      word2id[constString(w, len)] = i+1;
+    }
+    unk_id = lookupWord(unk_word, strlen(unk_word));
+    end_id = lookupWord(end_word, strlen(end_word));
+    if (use_ecc && end_id == 0) {
+      ERROR_EXIT1(128, "Not found %s in vocabulary\n", end_word);
+    }
+    uint32_t key;
+    if (!use_bcc && !lmi->getZeroKey(key)) {
+      ERROR_EXIT(128, "The LM has no zero key, it needs use_bcc=true\n");
+    }
+  }
+
+  NBestRescorer::~NBestRescorer() {
+    for (unsigned int i=0; i<words.size(); ++i) delete[] words[i];
+  }
+
+  WordType NBestRescorer::lookupWord(const char *word, size_t len) const {
+    const uint32_t *id = word2id.find(constString(word, len));
+    return (id == 0) ? 0u : *id;
+  }
+
+  bool NBestRescorer::readSentence(StreamInterface *input,
+                                   CStringStream *line, bool &pending,
+                                   Sentence &sentence) {
+    sentence.text.clear();
+    sentence.hyps.clear();
+    if (!pending && !readLine(input, line)) return false;
+    pending = false;
+    // empty lines are ignored, also before the first line of a sentence
+    while (*line->c_str() == '\0') {
+      if (!readLine(input, line)) return false;
+    }
+    sentence.n = parseSentenceNumber(line->c_str());
+    do {
+      const char *str = line->c_str();
+      if (*str == '\0') continue; // empty lines are ignored
+      int n = parseSentenceNumber(str);
+      if (n < 0) ERROR_EXIT1(256, "Incorrect n-best line: %s\n", str);
+      if (n != sentence.n) {
+        pending = true;
+        break;
+      }
+      Hypothesis hyp;
+      hyp.text_pos = static_cast<uint32_t>(sentence.text.size());
+      hyp.feats_end = 0;
+      hyp.node = 0;
+      appendString(sentence.text, str, strlen(str) + 1);
+      sentence.hyps.push_back(hyp);
+    } while(readLine(input, line));
+    return !sentence.hyps.empty();
+  }
+
+  void NBestRescorer::buildTrie(Sentence &sentence) const {
+    sentence.nodes.clear();
+    TrieNode root;
+    root.parent = NO_NODE;
+    root.word = 0;
+    root.depth = 0;
+    root.key = 0;
+    root.score = 0.0;
+    root.final_score = 0.0;
+    root.is_final = false;
+    sentence.nodes.push_back(root);
+    AprilUtils::hash<AprilUtils::uint_pair, uint32_t> children;
+    uint32_t max_depth = 0;
+    for (unsigned int i=0; i<sentence.hyps.size(); ++i) {
+      Hypothesis &hyp = sentence.hyps[i];
+      const char *line = sentence.text.begin() + hyp.text_pos;
+      // fields: n ||| words ||| features ||| score
+      const char *words_begin = strstr(line, NBEST_SEPARATOR);
+      words_begin += NBEST_SEPARATOR_LEN;
+      const char *words_end = strstr(words_begin, NBEST_SEPARATOR);
+      if (words_end == 0) {
+        ERROR_EXIT1(256, "Incorrect n-best line: %s\n", line);
+      }
+      const char *feats_end = strstr(words_end + NBEST_SEPARATOR_LEN,
+                                     NBEST_SEPARATOR);
+      if (feats_end == 0) feats_end = line + strlen(line);
+      while (feats_end > words_end && isBlank(feats_end[-1])) --feats_end;
+      hyp.feats_end = static_cast<uint32_t>(feats_end - line);
+      // tokenization and trie insertion
+      uint32_t node = 0;
+      const char *ptr = words_begin;
+      while (ptr < words_end) {
+        while (ptr < words_end && isBlank(*ptr)) ++ptr;
+        if (ptr == words_end) break;
+        const char *token = ptr;
+        while (ptr < words_end && !isBlank(*ptr)) ++ptr;
+        WordType w = lookupWord(token, static_cast<size_t>(ptr - token));
+        if (w == 0) w = unk_id;
+        // out-of-vocabulary words are ignored when there is no unk_word
+        if (w == 0) continue;
+        uint32_t &child = children[AprilUtils::uint_pair(node, w)];
+        if (child == 0) {
+          TrieNode new_node;
+          new_node.parent = node;
+          new_node.word = w;
+          new_node.depth = sentence.nodes[node].depth + 1;
+          new_node.key = 0;
+          new_node.score = 0.0;
+          new_node.final_score = 0.0;
+          new_node.is_final = false;
+          child = static_cast<uint32_t>(sentence.nodes.size());
+          sentence.nodes.push_back(new_node);
+          if (new_node.depth > max_depth) max_depth = new_node.depth;
+        }
+        node = child;
+      }
+      sentence.nodes[node].is_final = true;
+      hyp.node = node;
+    }
+    // counting sort of nodes by depth
+    sentence.depth_first.resize(max_depth + 2);
+    for (uint32_t d=0; d<max_depth+2; ++d) sentence.depth_first[d] = 0;
+    for (unsigned int i=0; i<sentence.nodes.size(); ++i) {
+      ++sentence.depth_first[sentence.nodes[i].depth + 1];
+    }
+    for (uint32_t d=1; d<max_depth+2; ++d) {
+      sentence.depth_first[d] += sentence.depth_first[d-1];
+    }
+    sentence.by_depth.resize(sentence.nodes.size());
+    vector<uint32_t> pos(sentence.depth_first);
+    for (unsigned int i=0; i<sentence.nodes.size(); ++i) {
+      sentence.by_depth[pos[sentence.nodes[i].depth]++] = i;
+    }
+  }
+
+  void NBestRescorer::queryBatch(vector<Sentence> &batch, unsigned int n) {
+    // global node identifiers are used as burden id_key
+    vector<uint32_t> first_node(n + 1);
+    uint32_t max_depth = 0;
+    first_node[0] = 0;
+    for (unsigned int s=0; s<n; ++s) {
+      first_node[s+1] = first_node[s] + batch[s].nodes.size();
+      uint32_t depth = batch[s].depth_first.size() - 2;
+      if (depth > max_depth) max_depth = depth;
+    }
+    vector<uint32_t> node_sentence(first_node[n]);
+    for (unsigned int s=0; s<n; ++s) {
+      for (uint32_t i=first_node[s]; i<first_node[s+1]; ++i) node_sentence[i] = s;
+      TrieNode &root = batch[s].nodes[0];
+      if (use_bcc) root.key = lmi->getInitialKey();
+      else lmi->getZeroKey(root.key);
+    }
+    // one LM bunch per trie level, plus the end context cue
+    const uint32_t last_level = use_ecc ? max_depth + 1 : max_depth;
+    for (uint32_t level=1; level<=last_level; ++level) {
+      const bool is_ecc_level = (level == max_depth + 1);
+      lmi->clearQueries();
+      for (unsigned int s=0; s<n; ++s) {
+        Sentence &sentence = batch[s];
+        if (!is_ecc_level && level+1 < sentence.depth_first.size()) {
+          for (uint32_t j=sentence.depth_first[level];
+               j<sentence.depth_first[level+1]; ++j) {
+            const uint32_t i = sentence.by_depth[j];
+            const TrieNode &node = sentence.nodes[i];
+            lmi->insertQuery(sentence.nodes[node.parent].key, node.word,
+                             Burden(first_node[s] + i, 0),
+                             log_float::zero());
+            ++num_queries;
+          }
+        }
+        if (use_ecc) {
+          // final nodes of the previous level receive the end context cue,
+          // their keys are known since the previous bunch
+          const uint32_t depth = level - 1;
+          if (depth+1 < sentence.depth_first.size()) {
+            for (uint32_t j=sentence.depth_first[depth];
+                 j<sentence.depth_first[depth+1]; ++j) {
+              const uint32_t i = sentence.by_depth[j];
+              const TrieNode &node = sentence.nodes[i];
+              if (!node.is_final) continue;
+              lmi->insertQuery(node.key, end_id, Burden(first_node[s] + i, 1),
+                               log_float::zero());
+              ++num_queries;
+            }
+          }
+        }
+      }
+      const vector<KeyScoreBurdenTuple> &result = lmi->getQueries();
+      for (unsigned int r=0; r<result.size(); ++r) {
+        const KeyScoreBurdenTuple &tuple = result[r];
+        const uint32_t global = static_cast<uint32_t>(tuple.burden.id_key);
+        const unsigned int s = node_sentence[global];
+        TrieNode &node = batch[s].nodes[global - first_node[s]];
+        // the same conversion done by the Lua binding of get_queries
+        const double score = static_cast<float>(tuple.key_score.score.log());
+        if (tuple.burden.id_word == 0) {
+          node.key = tuple.key_score.key;
+          node.score = batch[s].nodes[node.parent].score + score;
+        }
+        else {
+          node.final_score = score;
+        }
+      }
+    }
+  }
+
+  void NBestRescorer::formatOutput(Sentence &sentence,
+                                   OutputFormat format) const {
+    sentence.output.clear();
+    char buffer[64];
+    for (unsigned int i=0; i<sentence.hyps.size(); ++i) {
+      const Hypothesis &hyp = sentence.hyps[i];
+      const TrieNode &node = sentence.nodes[hyp.node];
+      const double score = node.score + node.final_score;
+      int len = snprintf(buffer, sizeof(buffer), "%.14g", score);
+      if (format == SCORES_FORMAT) {
+        appendString(sentence.output, buffer, len);
+      }
+      else {
+        const char *line = sentence.text.begin() + hyp.text_pos;
+        appendString(sentence.output, line, hyp.feats_end);
+        sentence.output.push_back(' ');
+        appendString(sentence.output, buffer, len);
+        const char *rest = line + hyp.feats_end;
+        appendString(sentence.output, rest, strlen(rest));
+      }
+      sentence.output.push_back('\n');
+    }
+  }
+
+  unsigned int NBestRescorer::rescore(StreamInterface *input,
+                                      StreamInterface *output,
+                                      OutputFormat format,
+                                      unsigned int batch_size) {
+    if (batch_size == 0) ERROR_EXIT(128, "Batch size must be > 0\n");
+    AprilUtils::SharedPtr<CStringStream> line(new CStringStream());
+    vector<Sentence> batch(batch_size);
+    bool pending = false, eof = false;
+    unsigned int num_hyps = 0;
+    num_sentences = 0;
+    num_queries = 0;
+    while (!eof) {
+      unsigned int n = 0;
+      while (n < batch_size && !eof) {
+        if (readSentence(input, line.get(), pending, batch[n])) ++n;
+        else eof = true;
+      }
+      if (n == 0) break;
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic, 1) if(OMPUtils::get_num_threads() > 1 && n > 1)
+#endif
+      for (int s=0; s<static_cast<int>(n); ++s) buildTrie(batch[s]);
+      queryBatch(batch, n);
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic, 1) if(OMPUtils::get_num_threads() > 1 && n > 1)
+#endif
+      for (int s=0; s<static_cast<int>(n); ++s) formatOutput(batch[s], format);
+      for (unsigned int s=0; s<n; ++s) {
+        if (output->put(batch[s].output.begin(), batch[s].output.size()) !=
+            batch[s].output.size()) {
+          ERROR_EXIT(256, "Unable to write the output stream\n");
+        }
+        num_hyps += batch[s].hyps.size();
+      }
+      num_sentences += n;
+    }
+    return num_hyps;
+  }
+
+} // namespace LanguageModels
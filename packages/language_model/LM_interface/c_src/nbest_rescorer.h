@@ -0,0 +1,159 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef NBEST_RESCORER_H
+#define NBEST_RESCORER_H
+
+#include "aux_hash_table.h"
+#include "c_string.h"
+#include "constString.h"
+#include "hash_table.h"
+#include "LM_interface.h"
+#include "referenced.h"
+#include "smart_ptr.h"
+#include "stream.h"
+#include "vector.h"
+
+namespace LanguageModels {
+
+  /**
+   * @brief Computes LM scores of n-best lists by using LM bunch mode.
+   *
+   * N-best files contain one hypothesis per line with the format
+   * <tt>n ||| words ||| features ||| score</tt>, where all the hypotheses
+   * of the same sentence share the number @c n and are consecutive.
+   *
+   * The rescorer streams the input in batches of sentences. The hypotheses
+   * of every sentence are inserted into a prefix trie, so shared prefixes
+   * are queried only once, and the tries of the whole batch are queried
+   * level by level using LMInterface::insertQuery() and
+   * LMInterface::getQueries(), producing one LM bunch per trie level.
+   * Parsing, tokenization, trie construction and output formatting of
+   * independent sentences are done in parallel using OMP. LM queries are
+   * done by the calling thread, because LM interfaces are not thread-safe.
+   *
+   * @note Only deterministic LMs are allowed.
+   */
+  class NBestRescorer : public Referenced {
+  public:
+    typedef LMInterfaceUInt32LogFloat::Burden Burden;
+    typedef LMInterfaceUInt32LogFloat::KeyScoreBurdenTuple KeyScoreBurdenTuple;
+
+    enum OutputFormat {
+      /// One LM score per line, in the same order as the input hypotheses.
+      SCORES_FORMAT,
+      /// The input n-best with the LM score appended to the features field.
+      NBEST_FORMAT
+    };
+
+    static const unsigned int DEFAULT_BATCH_SIZE = 256;
+
+    /**
+     * @param model - A deterministic LM.
+     *
+     * @param vocabulary_size - Size of the vocabulary.
+     *
+     * @param vocabulary - Words of the vocabulary, the word at position i
+     * has the identifier i+1.
+     *
+     * @param unk_word - Word used for out-of-vocabulary tokens. When it is
+     * not in the vocabulary, out-of-vocabulary tokens are ignored.
+     *
+     * @param end_word - Word used as sentence end context cue.
+     *
+     * @param use_bcc - Starts every hypothesis at the initial key, otherwise
+     * it starts at the zero key.
+     *
+     * @param use_ecc - Adds the score of end_word at the end of every
+     * hypothesis.
+     */
+    NBestRescorer(LMModelUInt32LogFloat *model,
+                  unsigned int vocabulary_size, const char *vocabulary[],
+                  const char *unk_word, const char *end_word,
+                  bool use_bcc, bool use_ecc);
+    virtual ~NBestRescorer();
+
+    /**
+     * @brief Rescores the whole input stream writing into output stream.
+     *
+     * @return The number of processed hypotheses.
+     */
+    unsigned int rescore(AprilIO::StreamInterface *input,
+                         AprilIO::StreamInterface *output,
+                         OutputFormat format,
+                         unsigned int batch_size = DEFAULT_BATCH_SIZE);
+
+    /// Number of sentences processed by the last rescore() call.
+    unsigned int getNumSentences() const { return num_sentences; }
+    /// Number of LM queries done by the last rescore() call.
+    unsigned int getNumQueries() const { return num_queries; }
+
+  private:
+    typedef AprilUtils::hash<AprilUtils::constString, uint32_t> VocabHash;
+
+    /// A trie node, node 0 is the root of every sentence trie.
+    struct TrieNode {
+      uint32_t parent;
+      WordType word;
+      uint32_t depth;
+      uint32_t key;
+      double score;
+      /// Score of the end context cue, only for final nodes.
+      double final_score;
+      bool is_final;
+    };
+
+    /// A hypothesis line, text is owned by the Sentence.
+    struct Hypothesis {
+      uint32_t text_pos;     ///< Position of the line in the text buffer.
+      uint32_t feats_end;    ///< Position where the LM score is inserted.
+      uint32_t node;         ///< Trie node of the last word.
+    };
+
+    struct Sentence {
+      AprilUtils::vector<char> text;
+      AprilUtils::vector<Hypothesis> hyps;
+      AprilUtils::vector<TrieNode> nodes;
+      /// Trie nodes sorted by depth, using depth_first[d] as begin of depth d.
+      AprilUtils::vector<uint32_t> by_depth, depth_first;
+      AprilUtils::vector<char> output;
+      int n;
+    };
+
+    AprilUtils::SharedPtr<LMModelUInt32LogFloat> model;
+    AprilUtils::SharedPtr<LMInterfaceUInt32LogFloat> lmi;
+    AprilUtils::vector<char*> words;
+    VocabHash word2id;
+    WordType unk_id, end_id;
+    bool use_bcc, use_ecc;
+    unsigned int num_sentences, num_queries;
+
+    WordType lookupWord(const char *word, size_t len) const;
+    bool readSentence(AprilIO::StreamInterface *input,
+                      AprilIO::CStringStream *line, bool &pending,
+                      Sentence &sentence);
+    void buildTrie(Sentence &sentence) const;
+    void queryBatch(AprilUtils::vector<Sentence> &batch, unsigned int n);
+    void formatOutput(Sentence &sentence, OutputFormat format) const;
+  };
+
+} // namespace LanguageModels
+
+#endif // NBEST_RESCORER_H
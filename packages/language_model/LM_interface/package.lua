@@ -1,6 +1,6 @@
  package{ name = "language_models",
 	  version = "1.0",
-	  depends = { "util", "dataset" }, --, "symbol_scores" },
+	  depends = { "util", "dataset", "aprilio" }, --, "symbol_scores" },
 	  keywords = { },
 	  description = "Interface for generic language models",
 	  target{
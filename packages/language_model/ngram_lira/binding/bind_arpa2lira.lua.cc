@@ -1,5 +1,7 @@
 //BIND_HEADER_H
 #include "arpa2lira.h"
+#include "arpa2lira_compiler.h"
+using LanguageModels::arpa2lira::Compiler;
 using LanguageModels::arpa2lira::Transition;
 using LanguageModels::arpa2lira::TransitionsType;
 using LanguageModels::arpa2lira::TransitionsIterator;
@@ -8,6 +10,9 @@ using LanguageModels::arpa2lira::VectorReferenced;
 //BIND_END
 
 //BIND_HEADER_C
+#include "bind_april_io.h"
+using AprilUtils::SharedPtr;
+using AprilIO::StreamInterface;
 using AprilUtils::vector;
 using AprilUtils::log_float;
 //BIND_END
@@ -174,3 +179,125 @@ using AprilUtils::log_float;
   LUABIND_RETURN(VectorReferenced, v);
 }
 //BIND_END
+
+////////////////////////////////////
+
+//BIND_LUACLASSNAME Compiler ngram.lira.arpa2lira.compiler
+//BIND_CPP_CLASS    Compiler
+
+//BIND_CONSTRUCTOR Compiler
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  check_table_fields(L, 1,
+                     "vocabulary", // table of words, id is the position
+                     "mode",       // "extend", "fixed" or "limit"
+                     "bccue",
+                     "eccue",
+                     "verbosity",
+                     (const char *)0);
+  const char *mode_str, *bccue, *eccue;
+  int verbosity;
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, mode, string, mode_str, "extend");
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, bccue, string, bccue, "<s>");
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, eccue, string, eccue, "</s>");
+  LUABIND_GET_TABLE_OPTIONAL_PARAMETER(1, verbosity, int, verbosity, 0);
+  Compiler::VocabularyMode mode = Compiler::EXTEND_VOCABULARY;
+  if (!strcmp(mode_str, "fixed")) mode = Compiler::FIXED_VOCABULARY;
+  else if (!strcmp(mode_str, "limit")) mode = Compiler::LIMIT_VOCABULARY;
+  else if (strcmp(mode_str, "extend")) {
+    LUABIND_FERROR1("Unknown vocabulary mode %s\n", mode_str);
+  }
+  int vocabulary_size = 0;
+  const char **vocabulary_vector = 0;
+  lua_getfield(L, 1, "vocabulary");
+  if (!lua_isnil(L, -1)) {
+    LUABIND_TABLE_GETN(-1, vocabulary_size);
+    vocabulary_vector = new const char *[vocabulary_size];
+    LUABIND_TABLE_TO_VECTOR(-1, string, vocabulary_vector, vocabulary_size);
+  }
+  else if (mode != Compiler::EXTEND_VOCABULARY) {
+    LUABIND_ERROR("fixed and limit modes require a vocabulary table\n");
+  }
+  lua_pop(L, 1);
+  obj = new Compiler(mode, static_cast<unsigned int>(vocabulary_size),
+                     vocabulary_vector, bccue, eccue, verbosity);
+  delete[] vocabulary_vector;
+  LUABIND_RETURN(Compiler, obj);
+}
+//BIND_END
+
+//BIND_METHOD Compiler read_arpa
+{
+  SharedPtr<StreamInterface> stream;
+  unsigned int batch_size;
+  LUABIND_CHECK_ARGN(>=, 1);
+  LUABIND_CHECK_ARGN(<=, 2);
+  LUABIND_GET_PARAMETER(1, AuxStreamInterface<StreamInterface>, stream);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, uint, batch_size,
+                                 Compiler::DEFAULT_BATCH_SIZE);
+  if (stream.empty()) LUABIND_ERROR("Needs a stream as argument\n");
+  obj->readArpa(stream.get(), batch_size);
+  LUABIND_RETURN(Compiler, obj);
+}
+//BIND_END
+
+//BIND_METHOD Compiler compile
+{
+  obj->compile();
+  LUABIND_RETURN(Compiler, obj);
+}
+//BIND_END
+
+//BIND_METHOD Compiler write_lira
+{
+  SharedPtr<StreamInterface> stream;
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_GET_PARAMETER(1, AuxStreamInterface<StreamInterface>, stream);
+  if (stream.empty()) LUABIND_ERROR("Needs a stream as argument\n");
+  obj->writeLira(stream.get());
+  LUABIND_RETURN(Compiler, obj);
+}
+//BIND_END
+
+//BIND_METHOD Compiler write_binary_lira
+{
+  const char *filename;
+  int fan_out_threshold;
+  LUABIND_CHECK_ARGN(>=, 1);
+  LUABIND_CHECK_ARGN(<=, 2);
+  LUABIND_GET_PARAMETER(1, string, filename);
+  LUABIND_GET_OPTIONAL_PARAMETER(2, int, fan_out_threshold, 10);
+  obj->writeBinaryLira(filename, fan_out_threshold);
+  LUABIND_RETURN(Compiler, obj);
+}
+//BIND_END
+
+//BIND_METHOD Compiler get_vocabulary
+{
+  lua_createtable(L, obj->getVocabularySize(), 0);
+  for (unsigned int i=1; i<=obj->getVocabularySize(); ++i) {
+    lua_pushstring(L, obj->getWord(i));
+    lua_rawseti(L, -2, i);
+  }
+  LUABIND_INCREASE_NUM_RETURNS(1);
+}
+//BIND_END
+
+//BIND_METHOD Compiler get_ngram_order
+{
+  LUABIND_RETURN(uint, obj->getNgramOrder());
+}
+//BIND_END
+
+//BIND_METHOD Compiler get_num_states
+{
+  LUABIND_RETURN(uint, obj->getNumStates());
+}
+//BIND_END
+
+//BIND_METHOD Compiler get_num_transitions
+{
+  LUABIND_RETURN(uint, obj->getNumTransitions());
+}
+//BIND_END
@@ -0,0 +1,684 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "arpa2lira_compiler.h"
+#include "c_string.h"
+#include "error_print.h"
+#include "ngram_lira.h"
+#include "omp_utils.h"
+#include "qsort.h"
+#include "shared_ptr.h"
+#include "unused_variable.h"
+
+using namespace AprilUtils;
+using namespace AprilIO;
+
+namespace LanguageModels {
+  namespace arpa2lira {
+
+    /// log(-infinity) representation, the same used by arpa2lira.lua
+    static const double LOG_ZERO = -1e12;
+    static const double LOG_ONE  = 0.0;
+    static const double LOG_10   = 2.302585092994045684;
+
+    static double arpaProb(double x) {
+      if (x <= -99.0) return LOG_ZERO;
+      return x*LOG_10;
+    }
+
+    static bool isBlank(char c) {
+      return c == ' ' || c == '\t';
+    }
+
+    static void writeOrDie(FILE *f, const void *data, size_t size) {
+      if (size > 0 && fwrite(data, 1, size, f) != size) {
+        ERROR_EXIT(128, "Error writing binary lira file\n");
+      }
+    }
+
+    /// Writes POD values of type T to a FILE through a fixed size buffer.
+    template<typename T>
+    class BinaryWriter {
+      static const unsigned int BUFFER_SIZE = 16384;
+      FILE *f;
+      vector<T> buffer;
+      unsigned int size;
+    public:
+      BinaryWriter(FILE *f) : f(f), buffer(BUFFER_SIZE), size(0) { }
+      ~BinaryWriter() { flush(); }
+      void put(const T &v) {
+        buffer[size++] = v;
+        if (size == BUFFER_SIZE) flush();
+      }
+      void flush() {
+        writeOrDie(f, buffer.begin(), sizeof(T)*size);
+        size = 0;
+      }
+    };
+    
+    /// Reads a line removing the trailing end-of-line, returns false at EOF
+    static bool readLine(StreamInterface *input, CStringStream *line) {
+      line->clear();
+      if (input->get(line, "\n", true) == 0) return false;
+      size_t len = line->size();
+      while (len > 0 && ((*line)[len-1] == '\n' || (*line)[len-1] == '\r')) {
+        --len;
+      }
+      (*line)[len] = '\0';
+      return true;
+    }
+    
+    /// Returns a pointer to the beginning of next token and its length
+    static const char *nextToken(const char *&ptr, size_t &len) {
+      while (isBlank(*ptr)) ++ptr;
+      if (*ptr == '\0') return 0;
+      const char *start = ptr;
+      while (*ptr != '\0' && !isBlank(*ptr)) ++ptr;
+      len = static_cast<size_t>(ptr - start);
+      return start;
+    }
+
+    Compiler::Compiler(VocabularyMode mode,
+                       unsigned int vocabulary_size, const char *vocabulary[],
+                       const char *bccue, const char *eccue,
+                       int verbosity) :
+      mode(mode), verbosity(verbosity),
+      trie(TrieKey(NO_STATE, NO_STATE)),
+      next_state_id(0), ngram_order(1), best_prob(LOG_ZERO),
+      num_states(0), num_transitions(0), compiled(false) {
+      for (unsigned int i=0; i<vocabulary_size; ++i) {
+        addWord(vocabulary[i], strlen(vocabulary[i]));
+      }
+      if (mode == EXTEND_VOCABULARY) {
+        bccue_id = addWord(bccue, strlen(bccue));
+        eccue_id = addWord(eccue, strlen(eccue));
+      }
+      else {
+        bccue_id = lookupWord(bccue, strlen(bccue));
+        eccue_id = lookupWord(eccue, strlen(eccue));
+        if (bccue_id == 0) ERROR_EXIT1(128, "Not found %s in vocabulary\n", bccue);
+        if (eccue_id == 0) ERROR_EXIT1(128, "Not found %s in vocabulary\n", eccue);
+      }
+      // 0-gram state and a unique final state
+      zerogram_state = newStateId();
+      considerState(zerogram_state);
+      final_state = newStateId();
+      considerState(final_state);
+      initial_state = zerogram_state;
+    }
+    
+    Compiler::~Compiler() {
+      for (unsigned int i=0; i<words.size(); ++i) delete[] words[i];
+    }
+
+    uint32_t Compiler::addWord(const char *word, size_t len) {
+      uint32_t id = lookupWord(word, len);
+      if (id == 0) {
+        char *w = new char[len+1];
+        memcpy(w, word, len);
+        w[len] = '\0';
+        words.push_back(w);
+        id = static_cast<uint32_t>(words.size());
+        word2id[constString(w, len)] = id;
+      }
+      return id;
+    }
+    
+    uint32_t Compiler::lookupWord(const char *word, size_t len) const {
+      const uint32_t *id = word2id.find(constString(word, len));
+      return (id == 0) ? 0u : *id;
+    }
+
+    uint32_t Compiler::newStateId() {
+      uint32_t id = next_state_id++;
+      exists.push_back(0);
+      max_tr_prob.push_back(LOG_ZERO);
+      backoff_dest.push_back(NO_STATE);
+      backoff_weight.push_back(LOG_ONE);
+      return id;
+    }
+    
+    void Compiler::considerState(uint32_t st) {
+      exists[st] = 1;
+    }
+    
+    uint32_t Compiler::findState(const uint32_t *ngram, int len) {
+      uint32_t st = zerogram_state;
+      for (int i=0; i<len; ++i) {
+        const TrieKey key(st, ngram[i]);
+        uint32_t *child = trie.find(key);
+        if (child == 0) {
+          st = newStateId();
+          trie.insert(key, st);
+        }
+        else st = *child;
+      }
+      return st;
+    }
+    
+    void Compiler::readArpa(StreamInterface *input, unsigned int batch_size) {
+      if (compiled) ERROR_EXIT(128, "The ARPA model has been already compiled\n");
+      SharedPtr<CStringStream> line( new CStringStream() );
+      // skip everything until \data\ .
+      bool found = false;
+      while (!found && readLine(input, line.get())) {
+        found = (strcmp(line->c_str(), "\\data\\") == 0);
+      }
+      if (!found) ERROR_EXIT(128, "Unable to locate \\data\\ in ARPA stream\n");
+      // read 'ngram N=M' lines
+      vector<unsigned int> ngram_counts;
+      unsigned int which_n, how_many;
+      while (readLine(input, line.get()) &&
+             sscanf(line->c_str(), "ngram %u=%u", &which_n, &how_many) == 2) {
+        if (which_n >= ngram_counts.size()) {
+          size_t old_size = ngram_counts.size();
+          ngram_counts.resize(which_n+1);
+          for (size_t i=old_size; i<ngram_counts.size(); ++i) ngram_counts[i]=0;
+        }
+        ngram_counts[which_n] = how_many;
+        if (which_n > ngram_order) ngram_order = which_n;
+      }
+      if (ngram_order > 1) initial_state = findState(&bccue_id, 1);
+      //
+      vector<char> buffer;
+      vector<size_t> line_offsets;
+      char sentinel[64];
+      for (unsigned int n=1; n<=ngram_order; ++n) {
+        sprintf(sentinel, "\\%u-grams:", n);
+        found = false;
+        while (!found && readLine(input, line.get())) {
+          found = (strcmp(line->c_str(), sentinel) == 0);
+        }
+        if (!found) ERROR_EXIT1(128, "Unable to locate %s in ARPA stream\n",
+                                sentinel);
+        if (verbosity > 0) {
+          printf("Reading %u-grams\n", n);
+          fflush(stdout);
+        }
+        unsigned int num_processed_lines = 0;
+        bool end_of_section = false;
+        while (!end_of_section) {
+          // fill a batch of lines, every line is finished by '\0'
+          buffer.clear();
+          line_offsets.clear();
+          while (line_offsets.size() < batch_size) {
+            if (!readLine(input, line.get()) || line->c_str()[0] == '\0') {
+              end_of_section = true;
+              break;
+            }
+            size_t len = strlen(line->c_str());
+            size_t pos = buffer.size();
+            line_offsets.push_back(pos);
+            buffer.resize(pos + len + 1);
+            memcpy(buffer.begin() + pos, line->c_str(), len + 1);
+          }
+          processBatch(buffer, line_offsets, n);
+          num_processed_lines += line_offsets.size();
+          if (verbosity > 0 && n < ngram_counts.size() && ngram_counts[n] > 0) {
+            printf("\r%3.0f%%",
+                   100.0*num_processed_lines/static_cast<double>(ngram_counts[n]));
+            fflush(stdout);
+          }
+        }
+        if (verbosity > 0) printf("\r100%%\n");
+      }
+    }
+
+    void Compiler::processBatch(const vector<char> &buffer,
+                                const vector<size_t> &line_offsets,
+                                unsigned int n) {
+      const int num_lines = static_cast<int>(line_offsets.size());
+      if (num_lines == 0) return;
+      vector<ParsedLine> parsed(num_lines);
+      vector<uint32_t> ngrams(num_lines * n);
+      // for words which are not in the vocabulary
+      vector<size_t> token_offsets(num_lines * n);
+      vector<size_t> token_lengths(num_lines * n);
+      vector<int> status(num_lines); // 0=ok, 1=format error, 2=unknown word
+      const char *base = buffer.begin();
+      // tokenization and translation of words into ids, vocabulary is
+      // read-only during this step
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(OMPUtils::get_num_threads() > 1 && num_lines > 1024)
+#endif
+      for (int i=0; i<num_lines; ++i) {
+        const char *ptr = base + line_offsets[i];
+        ParsedLine &p = parsed[i];
+        uint32_t *w = ngrams.begin() + i*n;
+        size_t len;
+        const char *tok;
+        status[i] = 0;
+        p.valid = true;
+        if ( (tok = nextToken(ptr, len)) == 0 ) {
+          status[i] = 1;
+          continue;
+        }
+        p.prob = arpaProb(strtod(tok, 0));
+        for (unsigned int j=0; j<n && status[i] == 0; ++j) {
+          if ( (tok = nextToken(ptr, len)) == 0 ) {
+            status[i] = 1;
+          }
+          else {
+            token_offsets[i*n + j] = static_cast<size_t>(tok - base);
+            token_lengths[i*n + j] = len;
+            w[j] = lookupWord(tok, len);
+            if (w[j] == 0) {
+              if (mode == LIMIT_VOCABULARY) p.valid = false;
+              else if (mode == FIXED_VOCABULARY) status[i] = 2;
+            }
+          }
+        }
+        if (status[i] != 0) continue;
+        p.has_bow = ( (tok = nextToken(ptr, len)) != 0 );
+        p.bow = (p.has_bow) ? arpaProb(strtod(tok, 0)) : LOG_ONE;
+      }
+      // automaton update, it is sequential because it follows the same order
+      // of the ARPA lines
+      const unsigned int nmax = ngram_order;
+      for (int i=0; i<num_lines; ++i) {
+        if (status[i] == 1) {
+          ERROR_EXIT1(128, "Incorrect ARPA line: %s\n", base + line_offsets[i]);
+        }
+        else if (status[i] == 2) {
+          ERROR_EXIT1(128, "arpa2lira found unknown word when using a fixed "
+                      "vocabulary in line: %s\n", base + line_offsets[i]);
+        }
+        const ParsedLine &p = parsed[i];
+        if (!p.valid) continue;
+        uint32_t *w = ngrams.begin() + i*n;
+        if (mode == EXTEND_VOCABULARY) {
+          for (unsigned int j=0; j<n; ++j) {
+            if (w[j] == 0) w[j] = addWord(base + token_offsets[i*n + j],
+                                          token_lengths[i*n + j]);
+          }
+        }
+        ///////////////////////////////////////////////////////////////////
+        // example: -0.544068 b a -0.3521825
+        // -0.544068  -> probability of going from b   to b_a
+        // -0.3521825 -> probability of going from b_a to a via backoff
+        ///////////////////////////////////////////////////////////////////
+        uint32_t orig_st = findState(w, n-1);
+        uint32_t word    = w[n-1];
+        uint32_t dest_st;
+        if (word == eccue_id) dest_st = final_state;
+        else {
+          const int from = (n < nmax) ? 0 : 1;
+          dest_st = findState(w + from, n - from);
+        }
+        // the backoff destination is the first lower order state which
+        // already exists
+        int bo_start = (n < nmax) ? 1 : 2;
+        uint32_t bo_dest_st;
+        do {
+          const int len = static_cast<int>(n) - bo_start;
+          bo_dest_st = (len > 0) ? findState(w + bo_start, len) : zerogram_state;
+          ++bo_start;
+        } while (!exists[bo_dest_st]);
+        //
+        considerState(orig_st);
+        considerState(dest_st);
+        if (dest_st == final_state && p.bow != LOG_ONE) {
+          ERROR_EXIT(128, "found a transition to final </s> with back-off weight\n");
+        }
+        FlatTransition tr;
+        tr.orig = orig_st;
+        tr.dest = dest_st;
+        tr.word = word;
+        tr.prob = static_cast<float>(p.prob);
+        transitions.push_back(tr);
+        if (p.prob > max_tr_prob[orig_st]) max_tr_prob[orig_st] = p.prob;
+        // processing n in increasing order, so, a backoff is only stored
+        // the first time, fixing the problem of non existing previous n-grams
+        if (backoff_dest[dest_st] == NO_STATE && p.bow > LOG_ZERO) {
+          backoff_dest[dest_st]   = bo_dest_st;
+          backoff_weight[dest_st] = p.bow;
+        }
+      }
+    }
+    
+    void Compiler::compile() {
+      if (compiled) return;
+      const int num_ids = static_cast<int>(next_state_id);
+      const bool use_omp = OMPUtils::get_num_threads() > 1 && num_ids > 4096;
+      UNUSED_VARIABLE(use_omp);
+      // upper bound of the best way to leave every state, taking into account
+      // backoff transitions, used by getBestProb()
+      upper_bound.resize(num_ids);
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(use_omp)
+#endif
+      for (int st=0; st<num_ids; ++st) {
+        upper_bound[st] = LOG_ZERO;
+        if (!exists[st]) continue;
+        double bound = max_tr_prob[st], backoff_sum = 0.0;
+        uint32_t down_st = static_cast<uint32_t>(st);
+        while (down_st != zerogram_state && backoff_dest[down_st] != NO_STATE) {
+          backoff_sum += backoff_weight[down_st];
+          down_st = backoff_dest[down_st];
+          if (backoff_sum + max_tr_prob[down_st] > bound) {
+            bound = backoff_sum + max_tr_prob[down_st];
+          }
+        }
+        upper_bound[st] = bound;
+      }
+      best_prob = LOG_ZERO;
+      for (int st=0; st<num_ids; ++st) {
+        if (exists[st] && upper_bound[st] > best_prob) best_prob = upper_bound[st];
+      }
+      // bucket transitions by origin state
+      fan_out.resize(num_ids);
+      first_transition.resize(num_ids + 1);
+      for (int st=0; st<num_ids; ++st) fan_out[st] = 0;
+      for (size_t i=0; i<transitions.size(); ++i) ++fan_out[transitions[i].orig];
+      first_transition[0] = 0;
+      for (int st=0; st<num_ids; ++st) {
+        first_transition[st+1] = first_transition[st] + fan_out[st];
+      }
+      {
+        vector<FlatTransition> sorted(transitions.size());
+        vector<uint32_t> pos(num_ids);
+        for (int st=0; st<num_ids; ++st) pos[st] = first_transition[st];
+        for (size_t i=0; i<transitions.size(); ++i) {
+          sorted[pos[transitions[i].orig]++] = transitions[i];
+        }
+        transitions.swap(sorted);
+      }
+      // states to be removed: states with 0 output transitions which are not
+      // the final state
+      vector<char> removed(num_ids);
+      for (int st=0; st<num_ids; ++st) {
+        removed[st] = exists[st] && fan_out[st] == 0 &&
+          static_cast<uint32_t>(st) != final_state;
+      }
+      // backoffs which go down to a removed state are moved down
+      for (int st=0; st<num_ids; ++st) {
+        if (!exists[st]) continue;
+        while (backoff_dest[st] != NO_STATE && removed[backoff_dest[st]]) {
+          const uint32_t bo_st = backoff_dest[st];
+          backoff_weight[st] += backoff_weight[bo_st];
+          backoff_dest[st]    = backoff_dest[bo_st];
+        }
+      }
+      for (int st=0; st<num_ids; ++st) {
+        if (removed[st] && backoff_dest[st] == NO_STATE) {
+          ERROR_EXIT1(128, "Removed state %d without backoff transition\n", st);
+        }
+      }
+      // transitions which arrive to removed states are redirected by its
+      // backoff, and transitions of every state are sorted by word id
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic,256) if(use_omp)
+#endif
+      for (int st=0; st<num_ids; ++st) {
+        const uint32_t first = first_transition[st], last = first_transition[st+1];
+        for (uint32_t i=first; i<last; ++i) {
+          FlatTransition &tr = transitions[i];
+          double prob = tr.prob;
+          while (removed[tr.dest]) {
+            prob   += backoff_weight[tr.dest];
+            tr.dest = backoff_dest[tr.dest];
+          }
+          tr.prob = static_cast<float>(prob);
+        }
+        if (last - first > 1) {
+          Sort(transitions.begin(), static_cast<int>(first),
+               static_cast<int>(last) - 1);
+        }
+      }
+      // states are numbered following their fan out, lower fan outs first
+      hash<uint32_t, uint32_t> fan_out2index;
+      num_states = num_transitions = 0;
+      for (int st=0; st<num_ids; ++st) {
+        if (!exists[st] || removed[st]) continue;
+        ++num_states;
+        num_transitions += fan_out[st];
+        if (fan_out2index.find(fan_out[st]) == 0) {
+          fan_out2index[fan_out[st]] = 0;
+          fan_out_list.push_back(fan_out[st]);
+        }
+      }
+      if (fan_out_list.size() > 0) {
+        Sort(fan_out_list.begin(), 0, static_cast<int>(fan_out_list.size()) - 1);
+      }
+      fan_out_count.resize(fan_out_list.size());
+      for (unsigned int i=0; i<fan_out_list.size(); ++i) {
+        fan_out2index[fan_out_list[i]] = i;
+        fan_out_count[i] = 0;
+      }
+      for (int st=0; st<num_ids; ++st) {
+        if (!exists[st] || removed[st]) continue;
+        ++fan_out_count[ fan_out2index[fan_out[st]] ];
+      }
+      vector<uint32_t> next_cod(fan_out_list.size());
+      uint32_t acc = 0;
+      for (unsigned int i=0; i<fan_out_list.size(); ++i) {
+        next_cod[i] = acc;
+        acc += fan_out_count[i];
+      }
+      state2cod.resize(num_ids);
+      cod2state.resize(num_states);
+      for (int st=0; st<num_ids; ++st) {
+        state2cod[st] = NO_STATE;
+        if (!exists[st] || removed[st]) continue;
+        const uint32_t cod = next_cod[ fan_out2index[fan_out[st]] ]++;
+        state2cod[st]  = cod;
+        cod2state[cod] = static_cast<uint32_t>(st);
+      }
+      for (unsigned int cod=0; cod<num_states; ++cod) {
+        const uint32_t bo_st = backoff_dest[cod2state[cod]];
+        if (bo_st != NO_STATE && state2cod[bo_st] == NO_STATE) {
+          ERROR_EXIT1(128, "Trying to go down by backoff to an unknown state %u\n",
+                      bo_st);
+        }
+      }
+      if (state2cod[initial_state] == NO_STATE) {
+        ERROR_EXIT(128, "Initial state has been removed, check bccue\n");
+      }
+      compiled = true;
+    }
+    
+    void Compiler::writeLira(StreamInterface *output) const {
+      if (!compiled) ERROR_EXIT(128, "Execute compile() method before\n");
+      output->printf("# number of words and words\n%u\n", words.size());
+      for (unsigned int i=0; i<words.size(); ++i) {
+        output->printf("%s\n", words[i]);
+      }
+      output->printf("# max order of n-gram\n%u\n# number of states\n%u\n"
+                     "# number of transitions\n%u\n"
+                     "# bound max trans prob\n%f\n",
+                     ngram_order, num_states, num_transitions, best_prob);
+      output->printf("# how many different number of transitions\n%u\n"
+                     "# \"x y\" means x states have y transitions\n",
+                     fan_out_list.size());
+      for (unsigned int i=0; i<fan_out_list.size(); ++i) {
+        output->printf("%u %u\n", fan_out_count[i], fan_out_list[i]);
+      }
+      output->printf("# initial state, final state and lowest state\n%u %u %u\n",
+                     state2cod[initial_state], state2cod[final_state],
+                     state2cod[zerogram_state]);
+      output->printf("# state backoff_st 'weight(state->backoff_st)' "
+                     "[max_transition_prob]\n");
+      output->printf("# backoff_st == -1 means there is no backoff\n");
+      for (unsigned int cod=0; cod<num_states; ++cod) {
+        const uint32_t st = cod2state[cod];
+        if (backoff_dest[st] != NO_STATE) {
+          output->printf("%u %u %f %f\n", cod, state2cod[backoff_dest[st]],
+                         backoff_weight[st], upper_bound[st]);
+        }
+        else {
+          output->printf("%u -1 -1 %f\n", cod, upper_bound[st]);
+        }
+      }
+      output->printf("# transitions\n# orig dest word prob\n");
+      for (unsigned int cod=0; cod<num_states; ++cod) {
+        const uint32_t st = cod2state[cod];
+        for (uint32_t i=first_transition[st]; i<first_transition[st+1]; ++i) {
+          const FlatTransition &tr = transitions[i];
+          output->printf("%u %u %u %g\n", cod, state2cod[tr.dest], tr.word,
+                         static_cast<double>(tr.prob));
+        }
+      }
+    }
+    
+    void Compiler::writeBinaryLira(const char *filename,
+                                   int fan_out_threshold) const {
+      if (!compiled) ERROR_EXIT(128, "Execute compile() method before\n");
+      typedef NgramLiraModel::Score Score;
+      const unsigned int num_fan_outs = fan_out_list.size();
+      // linear search table, the same built by NgramLiraModel text loader,
+      // plus the sentinel entry
+      vector<LinearSearchInfo> linear_search_table(num_fan_outs + 1);
+      memset(linear_search_table.begin(), 0,
+             sizeof(LinearSearchInfo)*linear_search_table.size());
+      unsigned int lss = 0, first_state_binary_search = 0, first_index = 0;
+      for (unsigned int i=0; i<num_fan_outs; ++i) {
+        if (static_cast<int>(fan_out_list[i]) <= fan_out_threshold) {
+          linear_search_table[lss].first_state = first_state_binary_search;
+          linear_search_table[lss].fan_out     = fan_out_list[i];
+          linear_search_table[lss].first_index = first_index;
+          first_state_binary_search += fan_out_count[i];
+          first_index += fan_out_list[i]*fan_out_count[i];
+          ++lss;
+        }
+      }
+      linear_search_table[lss].first_state = first_state_binary_search;
+      linear_search_table[lss].fan_out     =
+        (num_fan_outs > 0) ? fan_out_list[num_fan_outs-1] : 0u;
+      linear_search_table[lss].first_index = first_index;
+      const unsigned int size_first_transition =
+        num_states - first_state_binary_search;
+      //----------------------------------------------------------------------
+      // header, with the same layout written by NgramLiraModel::saveBinary
+      NgramLiraBinaryHeader header;
+      memset(static_cast<void*>(&header), 0, sizeof(NgramLiraBinaryHeader));
+      header.magic                     = 12345u;
+      header.ngram_value               = ngram_order;
+      header.vocabulary_size           = words.size();
+      header.initial_state             = state2cod[initial_state];
+      header.final_state               = state2cod[final_state];
+      header.lowest_state              = state2cod[zerogram_state];
+      header.num_states                = num_states;
+      header.num_transitions           = num_transitions;
+      header.different_number_of_trans = num_fan_outs;
+      header.linear_search_size        = lss;
+      header.fan_out_threshold         = fan_out_threshold;
+      header.first_state_binary_search = first_state_binary_search;
+      header.size_first_transition     = size_first_transition;
+      header.best_prob                 = Score(static_cast<float>(best_prob));
+      size_t filesize = sizeof(NgramLiraBinaryHeader);
+      header.offset_vocabulary_vector = filesize;
+      header.size_vocabulary_vector   = 0;
+      for (unsigned int i=0; i<words.size(); ++i) {
+        header.size_vocabulary_vector += strlen(words[i]) + 1;
+      }
+      filesize += header.size_vocabulary_vector;
+      header.offset_transition_words_table = filesize;
+      header.size_transition_words_table =
+        sizeof(WordType)*static_cast<size_t>(num_transitions);
+      filesize += header.size_transition_words_table;
+      header.offset_transition_table = filesize;
+      header.size_transition_table =
+        sizeof(NgramLiraTransition)*static_cast<size_t>(num_transitions);
+      filesize += header.size_transition_table;
+      header.offset_linear_search_table = filesize;
+      header.size_linear_search_table =
+        sizeof(LinearSearchInfo)*linear_search_table.size();
+      filesize += header.size_linear_search_table;
+      header.offset_first_transition = filesize;
+      header.size_first_transition_vector =
+        sizeof(unsigned int)*(size_first_transition + 1);
+      filesize += header.size_first_transition_vector;
+      header.offset_backoff_table = filesize;
+      header.size_backoff_table = sizeof(NgramBackoffInfo)*num_states;
+      filesize += header.size_backoff_table;
+      header.offset_max_out_prob = filesize;
+      header.size_max_out_prob = sizeof(Score)*num_states;
+      filesize += header.size_max_out_prob;
+      //----------------------------------------------------------------------
+      // every section is streamed from the compiler tables, so the peak
+      // memory is the write buffer, not a copy of the model
+      FILE *f = fopen(filename, "wb");
+      if (f == 0) ERROR_EXIT1(128, "Error creating file %s\n", filename);
+      writeOrDie(f, &header, sizeof(NgramLiraBinaryHeader));
+      for (unsigned int i=0; i<words.size(); ++i) {
+        writeOrDie(f, words[i], strlen(words[i]) + 1);
+      }
+      {
+        BinaryWriter<WordType> out(f);
+        for (unsigned int cod=0; cod<num_states; ++cod) {
+          const uint32_t st = cod2state[cod];
+          for (uint32_t i=first_transition[st]; i<first_transition[st+1]; ++i) {
+            out.put(transitions[i].word);
+          }
+        }
+      }
+      {
+        BinaryWriter<NgramLiraTransition> out(f);
+        NgramLiraTransition tr;
+        for (unsigned int cod=0; cod<num_states; ++cod) {
+          const uint32_t st = cod2state[cod];
+          for (uint32_t i=first_transition[st]; i<first_transition[st+1]; ++i) {
+            tr.state = state2cod[transitions[i].dest];
+            tr.prob  = Score(transitions[i].prob);
+            out.put(tr);
+          }
+        }
+      }
+      writeOrDie(f, linear_search_table.begin(),
+                 header.size_linear_search_table);
+      {
+        BinaryWriter<unsigned int> out(f);
+        unsigned int index = first_index;
+        for (unsigned int cod=first_state_binary_search; cod<num_states; ++cod) {
+          out.put(index);
+          index += fan_out[cod2state[cod]];
+        }
+        out.put(num_transitions);
+      }
+      {
+        BinaryWriter<NgramBackoffInfo> out(f);
+        for (unsigned int cod=0; cod<num_states; ++cod) {
+          const uint32_t st = cod2state[cod];
+          NgramBackoffInfo info;
+          if (backoff_dest[st] != NO_STATE) {
+            info.bo_dest_state = state2cod[backoff_dest[st]];
+            info.bo_prob = Score(static_cast<float>(backoff_weight[st]));
+          }
+          out.put(info);
+        }
+      }
+      {
+        BinaryWriter<Score> out(f);
+        for (unsigned int cod=0; cod<num_states; ++cod) {
+          out.put(Score(static_cast<float>(upper_bound[cod2state[cod]])));
+        }
+      }
+      if (static_cast<size_t>(ftell(f)) != filesize) {
+        ERROR_EXIT1(128, "Unexpected size writing %s\n", filename);
+      }
+      if (fclose(f) != 0) ERROR_EXIT1(128, "Error closing file %s\n", filename);
+    }
+    
+  } // namespace arpa2lira
+} // namespace LanguageModels
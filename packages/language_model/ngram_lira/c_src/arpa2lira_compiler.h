@@ -0,0 +1,171 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef ARPA2LIRA_COMPILER_H
+#define ARPA2LIRA_COMPILER_H
+
+#include <stdint.h>
+#include "aux_hash_table.h"
+#include "constString.h"
+#include "hash_table.h"
+#include "open_addressing_hash.h"
+#include "referenced.h"
+#include "stream.h"
+#include "vector.h"
+
+namespace LanguageModels {
+  namespace arpa2lira {
+    
+    /**
+     * @brief Native compiler of ARPA n-gram models into lira automata.
+     *
+     * It follows the same algorithm as the Lua arpa2lira function, but states
+     * are indexed by a compact (parent state, word) open addressing hash, all
+     * transitions are stored in a flat vector and every per-state information
+     * is stored in plain arrays indexed by state number. The lines of every
+     * n-gram order are read in batches, and each batch is tokenized and
+     * translated into word ids in parallel by OMP threads before the automaton
+     * is updated. Bounds computation, redirection of removed states and sorting
+     * of the transitions are also parallelized.
+     *
+     * @note The input can be any AprilIO stream, so gzipped ARPA files are
+     * supported when the stream is opened with gzio.
+     */
+    class Compiler : public Referenced {
+    public:
+      /// How to deal with words which are not in the given vocabulary.
+      enum VocabularyMode {
+        EXTEND_VOCABULARY, ///< Unknown words are added to the vocabulary.
+        FIXED_VOCABULARY,  ///< Unknown words produce an error.
+        LIMIT_VOCABULARY   ///< N-grams with unknown words are ignored.
+      };
+      
+      /// Default number of lines parsed in parallel.
+      static const unsigned int DEFAULT_BATCH_SIZE = 65536;
+      
+      /**
+       * @param mode - The VocabularyMode.
+       * @param vocabulary_size - Size of the given vocabulary.
+       * @param vocabulary - Words of the vocabulary, the word at position i
+       * receives the id i+1.
+       * @param bccue - Begin context cue.
+       * @param eccue - End context cue.
+       * @param verbosity - Progress is printed when verbosity > 0.
+       */
+      Compiler(VocabularyMode mode,
+               unsigned int vocabulary_size, const char *vocabulary[],
+               const char *bccue, const char *eccue,
+               int verbosity = 0);
+      virtual ~Compiler();
+      
+      /// Reads the ARPA model from the given stream and builds the automaton.
+      void readArpa(AprilIO::StreamInterface *input,
+                    unsigned int batch_size = DEFAULT_BATCH_SIZE);
+      /// Computes bounds, removes dead states and sorts states and transitions.
+      void compile();
+      /// Writes the compiled automaton in text lira format.
+      void writeLira(AprilIO::StreamInterface *output) const;
+      /**
+       * @brief Writes the compiled automaton in the mmap-able binary lira
+       * format.
+       *
+       * The file layout is the one of NgramLiraModel::saveBinary, but it is
+       * streamed from the compiler tables, without building the model.
+       */
+      void writeBinaryLira(const char *filename,
+                           int fan_out_threshold) const;
+      
+      unsigned int getVocabularySize() const { return words.size(); }
+      /// Returns the word with the given id (starting at 1).
+      const char *getWord(unsigned int id) const { return words[id-1]; }
+      unsigned int getNgramOrder() const { return ngram_order; }
+      unsigned int getNumStates() const { return num_states; }
+      unsigned int getNumTransitions() const { return num_transitions; }
+      
+    private:
+      static const uint32_t NO_STATE = 0xFFFFFFFFu;
+      
+      struct FlatTransition {
+        uint32_t orig, dest, word;
+        float prob;
+        bool operator<(const FlatTransition &other) const {
+          return word < other.word;
+        }
+      };
+      
+      /// Parsed data of one ARPA line, word positions point to the batch.
+      struct ParsedLine {
+        double prob, bow;
+        bool has_bow, valid;
+      };
+      
+      typedef AprilUtils::uint_pair TrieKey;
+      typedef AprilUtils::open_addr_hash<TrieKey, uint32_t> TrieHash;
+      typedef AprilUtils::hash<AprilUtils::constString, uint32_t> VocabHash;
+      
+      VocabularyMode mode;
+      int verbosity;
+      
+      // vocabulary, words are owned by this object
+      AprilUtils::vector<char*> words;
+      VocabHash word2id;
+      uint32_t bccue_id, eccue_id;
+      
+      // trie of n-grams: (parent state, word) => state
+      TrieHash trie;
+      uint32_t next_state_id;
+      uint32_t zerogram_state, final_state, initial_state;
+      unsigned int ngram_order;
+      
+      // per state information, indexed by trie id
+      AprilUtils::vector<char>     exists;
+      AprilUtils::vector<double>   max_tr_prob;
+      AprilUtils::vector<uint32_t> backoff_dest;
+      AprilUtils::vector<double>   backoff_weight;
+      AprilUtils::vector<double>   upper_bound;
+      double best_prob;
+      
+      // all transitions, sorted by (orig,word) after compile()
+      AprilUtils::vector<FlatTransition> transitions;
+      
+      // result of compile(): lira codes sorted by fan out
+      AprilUtils::vector<uint32_t> cod2state;
+      AprilUtils::vector<uint32_t> state2cod;
+      AprilUtils::vector<uint32_t> first_transition; // indexed by trie id
+      AprilUtils::vector<uint32_t> fan_out;          // indexed by trie id
+      AprilUtils::vector<uint32_t> fan_out_list;     // sorted fan outs
+      AprilUtils::vector<uint32_t> fan_out_count;    // states per fan out
+      unsigned int num_states, num_transitions;
+      bool compiled;
+      
+      uint32_t addWord(const char *word, size_t len);
+      uint32_t lookupWord(const char *word, size_t len) const;
+      uint32_t findState(const uint32_t *ngram, int len);
+      uint32_t newStateId();
+      void considerState(uint32_t st);
+      void processBatch(const AprilUtils::vector<char> &buffer,
+                        const AprilUtils::vector<size_t> &line_offsets,
+                        unsigned int n);
+    };
+    
+  } // namespace arpa2lira
+} // namespace LanguageModels
+
+#endif // ARPA2LIRA_COMPILER_H
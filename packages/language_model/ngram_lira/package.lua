@@ -17,6 +17,8 @@ package{ name = "ngram.lira",
      lua_unit_test{
        file={
 	 "test/test_ppl_ngramlira.lua",
+	 "test/test_arpa2lira_compiler.lua",
+	 "test/test_nbest_rescorer.lua",
        },
      },
    },
@@ -0,0 +1,98 @@
+local check = utest.check
+local T = utest.test
+
+local path = arg[0]:get_path()
+local vocab = lexClass.load(io.open(path .. "vocab"))
+
+local function compute_ppl(filename)
+  local model = language_models.load(filename, vocab, "<s>", "</s>")
+  return language_models.test_set_ppl{
+    lm = model,
+    vocab = vocab,
+    testset = path .. "frase",
+    debug_flag = -1,
+    use_bcc = true,
+    use_ecc = true
+  }
+end
+
+local function check_result(result)
+  check.lt( math.abs(result.ppl - 17.223860768396), 1e-03 )
+  check.lt( math.abs(result.ppl1 - 26.996595980386), 1e-03 )
+  check.lt( math.abs(result.logprob + 27.194871135223), 1e-03 )
+  check.eq( result.numsentences, 3 )
+  check.eq( result.numunks, 2 )
+  check.eq( result.numwords, 19 )
+end
+
+T("NativeArpa2LiraTextTest", function()
+    local tmpname = os.tmpname() .. ".lira"
+    local compiler = ngram.lira.arpa2lira{
+      input_filename  = path .. "dihana3gram.arpa",
+      output_filename = tmpname,
+      vocabulary      = vocab,
+      -- small batches to force several parallel parsing steps
+      batch_size      = 100,
+    }
+    check.eq( compiler:get_ngram_order(), 3 )
+    check.eq( #compiler:get_vocabulary(), 431 )
+    check_result(compute_ppl(tmpname))
+    os.remove(tmpname)
+end)
+
+T("NativeArpa2LiraBinaryTest", function()
+    local tmpname = os.tmpname() .. ".blira"
+    ngram.lira.arpa2lira{
+      input_filename  = path .. "dihana3gram.arpa",
+      output_filename = tmpname,
+      vocabulary      = vocab,
+    }
+    check_result(compute_ppl(tmpname))
+    os.remove(tmpname)
+end)
+
+T("NativeArpa2LiraBinaryLayoutTest", function()
+    -- the binary file written by the compiler has the same layout and
+    -- results than the one saved from the text lira model
+    local lira_name = os.tmpname() .. ".lira"
+    local blira_name = os.tmpname() .. ".blira"
+    local ref_name = os.tmpname() .. ".blira"
+    local compiler = ngram.lira.arpa2lira{
+      input_filename  = path .. "dihana3gram.arpa",
+      output_filename = lira_name,
+      vocabulary      = vocab,
+    }
+    compiler:write_binary_lira(blira_name, 4)
+    local words = vocab:getWordVocabulary()
+    local model = ngram.lira.model{
+      filename = lira_name,
+      vocabulary = words,
+      final_word = vocab:getWordId("</s>"),
+      fan_out_threshold = 4,
+    }
+    model:save_binary{ filename = ref_name, vocabulary = words }
+    local f1 = io.open(blira_name, "rb")
+    local f2 = io.open(ref_name, "rb")
+    check.eq( f1:seek("end"), f2:seek("end") )
+    f1:close() f2:close()
+    local r1 = compute_ppl(blira_name)
+    local r2 = compute_ppl(ref_name)
+    check.lt( math.abs(r1.ppl - r2.ppl), 1e-03 )
+    check.lt( math.abs(r1.logprob - r2.logprob), 1e-03 )
+    check_result(r1)
+    os.remove(lira_name)
+    os.remove(blira_name)
+    os.remove(ref_name)
+end)
+
+T("NativeArpa2LiraExtendVocabularyTest", function()
+    local compiler = ngram.lira.arpa2lira.compiler{}
+    compiler:read_arpa(aprilio.stream.file(path .. "dihana3gram.arpa", "r"))
+    compiler:compile()
+    local words = compiler:get_vocabulary()
+    check.eq( #words, 431 )
+    check.eq( words[1], "<s>" )
+    check.eq( words[2], "</s>" )
+    local ref = lexClass.load(io.open(path .. "vocab"))
+    for i=1,#words do check.TRUE( ref:getWordId(words[i]) ) end
+end)
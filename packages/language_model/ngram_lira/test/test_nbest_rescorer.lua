@@ -0,0 +1,111 @@
+local check = utest.check
+local T = utest.test
+
+local path = arg[0]:get_path()
+local vocab = lexClass.load(io.open(path .. "vocab"))
+local words = vocab:getWordVocabulary()
+local model = language_models.load(path .. "dihana3gram.lira.gz",
+                                   vocab, "<s>", "</s>")
+
+-- n-best list with two sentences built from the test sentences
+local sentences = {}
+for line in io.lines(path .. "frase") do table.insert(sentences, line) end
+local nbest_lines = {
+  { 0, sentences[1] }, { 0, sentences[2] }, { 0, sentences[3] },
+  { 1, sentences[3] }, { 1, "" }, { 1, sentences[1] .. " londres" },
+}
+local nbest = {}
+for i,v in ipairs(nbest_lines) do
+  nbest[i] = string.format("%d||| %s ||| %d -1.5 ||| -3.25", v[1], v[2], i)
+end
+nbest = table.concat(nbest, "\n") .. "\n"
+
+-- reference scores computed query by query
+local function reference_scores(lm, use_bcc, use_ecc)
+  local lmi = lm:get_interface()
+  local scores = {}
+  for i,v in ipairs(nbest_lines) do
+    local key = use_bcc and lmi:get_initial_key() or lmi:get_zero_key()
+    local score = 0
+    local wids = {}
+    for _,word in ipairs(string.tokenize(v[2])) do
+      -- the vocabulary has no <unk>, out-of-vocabulary words are ignored
+      table.insert(wids, vocab:getWordId(word))
+    end
+    if use_ecc then table.insert(wids, vocab:getWordId("</s>")) end
+    for _,w in ipairs(wids) do
+      lmi:clear_queries()
+      lmi:insert_query(key, w, { id_key = i })
+      local k,p = lmi:get_queries():get(1)
+      key, score = k, score + p
+    end
+    scores[i] = score
+  end
+  return scores
+end
+
+local function rescore(lm, format, batch_size, use_bcc, use_ecc, text)
+  local rescorer = language_models.nbest_rescorer{
+    model = lm, vocabulary = words, use_bcc = use_bcc, use_ecc = use_ecc,
+  }
+  local input  = aprilio.stream.input_lua_string(text or nbest)
+  local output = aprilio.stream.c_string()
+  local num_hyps, num_sentences = rescorer:rescore(input, output, format,
+                                                   batch_size)
+  check.eq(num_hyps, #nbest_lines)
+  check.eq(num_sentences, 2)
+  return output:value()
+end
+
+local function check_scores(out, ref)
+  local i = 0
+  for score in out:gmatch("[^\n]+") do
+    i = i + 1
+    check.lt(math.abs(tonumber(score) - ref[i]), 1e-04)
+  end
+  check.eq(i, #ref)
+end
+
+T("NBestRescorerScoresTest", function()
+    local ref = reference_scores(model, true, true)
+    check_scores(rescore(model, "scores", 1, true, true), ref)
+    check_scores(rescore(model, "scores", 256, true, true), ref)
+    local ref_no_ecc = reference_scores(model, true, false)
+    check_scores(rescore(model, "scores", 2, true, false), ref_no_ecc)
+end)
+
+T("NBestRescorerBlankLinesTest", function()
+    local ref = reference_scores(model, true, true)
+    -- blank lines at the beginning, between sentences and at the end
+    local lines = {}
+    for line in nbest:gmatch("[^\n]+") do table.insert(lines, line) end
+    local text = "\n\n" .. table.concat(lines, "\n", 1, 3) .. "\n\n" ..
+      table.concat(lines, "\n", 4, 5) .. "\n\n" .. lines[6] .. "\n\n"
+    check_scores(rescore(model, "scores", 256, true, true, text), ref)
+    check_scores(rescore(model, "scores", 1, true, true, text), ref)
+end)
+
+T("NBestRescorerBunchHashedTest", function()
+    local bunch_model = ngram.lira.bunch_hashed_model{
+      lira_model = model,
+      bunch_size = 4,
+    }
+    check.eq(rescore(bunch_model, "scores", 256, true, true),
+             rescore(model, "scores", 256, true, true))
+end)
+
+T("NBestRescorerNBestFormatTest", function()
+    local ref = reference_scores(model, true, true)
+    local i = 0
+    for line in rescore(model, "nbest", 256, true, true):gmatch("[^\n]+") do
+      i = i + 1
+      local n,feats,score = line:match("^(%d+)|||.*|||(.*)|||(.*)$")
+      check.eq(tonumber(n), nbest_lines[i][1])
+      local f = string.tokenize(feats)
+      check.eq(#f, 3)
+      check.eq(tonumber(f[1]), i)
+      check.lt(math.abs(tonumber(f[3]) - ref[i]), 1e-04)
+      check.eq(tonumber(score), -3.25)
+    end
+    check.eq(i, #nbest_lines)
+end)
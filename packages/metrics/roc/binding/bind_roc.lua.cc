@@ -0,0 +1,175 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+//BIND_HEADER_C
+#include "bind_matrix.h"
+#include "bind_matrix_double.h"
+//BIND_END
+
+//BIND_HEADER_H
+#include "roc_accumulator.h"
+
+using namespace Metrics;
+//BIND_END
+
+//BIND_LUACLASSNAME ROCAccumulator metrics.roc.accumulator
+//BIND_CPP_CLASS    ROCAccumulator
+
+//BIND_CONSTRUCTOR ROCAccumulator
+{
+  int argn = lua_gettop(L);
+  if (argn == 0) {
+    obj = new ROCAccumulator();
+  }
+  else {
+    unsigned int bins;
+    float min, max;
+    LUABIND_CHECK_ARGN(==,3);
+    LUABIND_GET_PARAMETER(1, uint, bins);
+    LUABIND_GET_PARAMETER(2, float, min);
+    LUABIND_GET_PARAMETER(3, float, max);
+    obj = new ROCAccumulator(bins, min, max);
+  }
+  LUABIND_RETURN(ROCAccumulator, obj);
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator add
+{
+  LUABIND_CHECK_ARGN(==,2);
+  MatrixFloat *outputs, *targets;
+  LUABIND_GET_PARAMETER(1, MatrixFloat, outputs);
+  LUABIND_GET_PARAMETER(2, MatrixFloat, targets);
+  obj->add(outputs, targets);
+  LUABIND_RETURN(ROCAccumulator, obj);
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator merge
+{
+  LUABIND_CHECK_ARGN(==,1);
+  ROCAccumulator *other;
+  LUABIND_GET_PARAMETER(1, ROCAccumulator, other);
+  obj->merge(other);
+  LUABIND_RETURN(ROCAccumulator, obj);
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator reset
+{
+  obj->reset();
+  LUABIND_RETURN(ROCAccumulator, obj);
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator is_approximate
+{
+  LUABIND_RETURN(bool, obj->isApproximate());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator histogram
+{
+  LUABIND_RETURN(uint, obj->getNumBins());
+  LUABIND_RETURN(float, obj->getMin());
+  LUABIND_RETURN(float, obj->getMax());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator num_positives
+{
+  LUABIND_RETURN(double, static_cast<double>(obj->getNumPositives()));
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator num_negatives
+{
+  LUABIND_RETURN(double, static_cast<double>(obj->getNumNegatives()));
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator compute_curve
+{
+  LUABIND_RETURN(MatrixFloat, obj->computeCurve());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator compute_pr_curve
+{
+  LUABIND_RETURN(MatrixFloat, obj->computePRCurve());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator compute_area
+{
+  LUABIND_RETURN(double, obj->computeArea());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator compute_average_precision
+{
+  LUABIND_RETURN(double, obj->computeAveragePrecision());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator area_error_bound
+{
+  LUABIND_RETURN(double, obj->getAreaErrorBound());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator compute_confusion
+{
+  LUABIND_CHECK_ARGN(==,1);
+  float threshold;
+  uint64_t TP, FP, TN, FN;
+  LUABIND_GET_PARAMETER(1, float, threshold);
+  obj->computeConfusion(threshold, TP, FP, TN, FN);
+  LUABIND_RETURN(double, static_cast<double>(TP));
+  LUABIND_RETURN(double, static_cast<double>(FP));
+  LUABIND_RETURN(double, static_cast<double>(TN));
+  LUABIND_RETURN(double, static_cast<double>(FN));
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator get_data
+{
+  MatrixFloat *scores, *targets;
+  obj->getData(scores, targets);
+  LUABIND_RETURN(MatrixFloat, scores);
+  LUABIND_RETURN(MatrixFloat, targets);
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator get_counts
+{
+  LUABIND_RETURN(MatrixDouble, obj->getCounts());
+}
+//BIND_END
+
+//BIND_METHOD ROCAccumulator add_counts
+{
+  LUABIND_CHECK_ARGN(==,1);
+  MatrixDouble *counts;
+  LUABIND_GET_PARAMETER(1, MatrixDouble, counts);
+  obj->addCounts(counts);
+  LUABIND_RETURN(ROCAccumulator, obj);
+}
+//BIND_END
@@ -0,0 +1,369 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+#include "error_print.h"
+#include "roc_accumulator.h"
+#include "unused_variable.h"
+
+using Basics::MatrixDouble;
+using Basics::MatrixFloat;
+using AprilUtils::vector;
+
+namespace Metrics {
+
+  namespace {
+    /// number of pairs stored by every chunk in exact mode
+    const size_t CHUNK_SIZE = 1u << 16;
+
+    /// head of a sorted chunk during the merge
+    struct Head {
+      float score;
+      unsigned int chunk;
+      Head(float score, unsigned int chunk) : score(score), chunk(chunk) { }
+      bool operator<(const Head &other) const { return score < other.score; }
+    };
+  }
+
+  ROCAccumulator::ROCAccumulator() :
+    Referenced(), bins(0), min(0.0f), max(0.0f), P(0), N(0) {
+  }
+
+  ROCAccumulator::ROCAccumulator(unsigned int bins, float min, float max) :
+    Referenced(), bins(bins), min(min), max(max),
+    pos_counts(bins, 0), neg_counts(bins, 0), P(0), N(0) {
+    if (bins == 0) ERROR_EXIT(128, "Needs at least one bin\n");
+    if (!(min < max)) ERROR_EXIT(128, "Needs min < max\n");
+  }
+
+  ROCAccumulator::~ROCAccumulator() {
+    reset();
+  }
+
+  void ROCAccumulator::reset() {
+    for (unsigned int i=0; i<chunks.size(); ++i) delete chunks[i];
+    chunks.clear();
+    for (unsigned int b=0; b<bins; ++b) pos_counts[b] = neg_counts[b] = 0;
+    P = N = 0;
+  }
+
+  unsigned int ROCAccumulator::getBin(float score) const {
+    if (score <= min) return 0;
+    if (score >= max) return bins - 1;
+    unsigned int b = static_cast<unsigned int>((score - min) / (max - min) *
+                                               bins);
+    return (b < bins) ? b : (bins - 1);
+  }
+
+  float ROCAccumulator::getBinEdge(unsigned int b) const {
+    return min + (max - min) * (static_cast<float>(b) / bins);
+  }
+
+  void ROCAccumulator::push(float score, bool positive) {
+    if (score != score) ERROR_EXIT(128, "Found a NaN score\n");
+    if (positive) ++P; else ++N;
+    if (isApproximate()) {
+      if (positive) ++pos_counts[getBin(score)];
+      else ++neg_counts[getBin(score)];
+    }
+    else {
+      if (chunks.empty() || chunks.back()->entries.size() == CHUNK_SIZE) {
+        chunks.push_back(new Chunk());
+        chunks.back()->entries.reserve(CHUNK_SIZE);
+      }
+      Chunk *chunk = chunks.back();
+      Entry e;
+      e.score    = score;
+      e.positive = positive ? 1u : 0u;
+      chunk->entries.push_back(e);
+      chunk->sorted = false;
+    }
+  }
+
+  void ROCAccumulator::add(const MatrixFloat *outputs,
+                           const MatrixFloat *targets) {
+    if (outputs->size() != targets->size()) {
+      ERROR_EXIT2(128, "Incompatible sizes, outputs=%d targets=%d\n",
+                  outputs->size(), targets->size());
+    }
+    MatrixFloat::const_iterator out_it(outputs->begin());
+    MatrixFloat::const_iterator tgt_it(targets->begin());
+    for (; out_it != outputs->end(); ++out_it, ++tgt_it) {
+      push(*out_it, *tgt_it > 0.5f);
+    }
+  }
+
+  void ROCAccumulator::merge(const ROCAccumulator *other) {
+    if (other == this) ERROR_EXIT(128, "Unable to merge with itself\n");
+    if (bins != other->bins || min != other->min || max != other->max) {
+      ERROR_EXIT(128, "Unable to merge accumulators with different "
+                 "histograms\n");
+    }
+    if (isApproximate()) {
+      for (unsigned int b=0; b<bins; ++b) {
+        pos_counts[b] += other->pos_counts[b];
+        neg_counts[b] += other->neg_counts[b];
+      }
+      P += other->P;
+      N += other->N;
+    }
+    else {
+      for (unsigned int i=0; i<other->chunks.size(); ++i) {
+        const vector<Entry> &entries = other->chunks[i]->entries;
+        for (unsigned int j=0; j<entries.size(); ++j) {
+          push(entries[j].score, entries[j].positive != 0u);
+        }
+      }
+    }
+  }
+
+  void ROCAccumulator::sortChunks() {
+    vector<Chunk*> unsorted;
+    for (unsigned int i=0; i<chunks.size(); ++i) {
+      if (!chunks[i]->sorted) unsorted.push_back(chunks[i]);
+    }
+    const int n = static_cast<int>(unsorted.size());
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic) if(n > 1)
+#endif
+    for (int i=0; i<n; ++i) {
+      vector<Entry> &entries = unsorted[i]->entries;
+      std::sort(entries.begin(), entries.end());
+      unsorted[i]->sorted = true;
+    }
+  }
+
+  void ROCAccumulator::traverse(GroupVisitor &visitor) {
+    if (isApproximate()) {
+      for (unsigned int b=bins; b>0; --b) {
+        if (pos_counts[b-1] + neg_counts[b-1] > 0) {
+          visitor(getBinEdge(b-1), pos_counts[b-1], neg_counts[b-1]);
+        }
+      }
+      return;
+    }
+    sortChunks();
+    // k-way merge of sorted chunks, samples with equal score are grouped
+    std::priority_queue<Head> heap;
+    vector<size_t> next(chunks.size(), 0);
+    for (unsigned int i=0; i<chunks.size(); ++i) {
+      if (!chunks[i]->entries.empty()) {
+        heap.push(Head(chunks[i]->entries[0].score, i));
+      }
+    }
+    bool empty = true;
+    float current = 0.0f;
+    uint64_t pos = 0, neg = 0;
+    while(!heap.empty()) {
+      const Head head = heap.top();
+      heap.pop();
+      const vector<Entry> &entries = chunks[head.chunk]->entries;
+      size_t &i = next[head.chunk];
+      if (!empty && head.score != current) {
+        visitor(current, pos, neg);
+        pos = neg = 0;
+      }
+      current = head.score;
+      empty = false;
+      for (; i < entries.size() && entries[i].score == current; ++i) {
+        if (entries[i].positive) ++pos; else ++neg;
+      }
+      if (i < entries.size()) heap.push(Head(entries[i].score, head.chunk));
+    }
+    if (!empty) visitor(current, pos, neg);
+  }
+
+  MatrixFloat *ROCAccumulator::computeCurve() {
+    class Visitor : public GroupVisitor {
+    public:
+      vector<float> rows;
+      double P, N, TP, FP;
+      Visitor(uint64_t P, uint64_t N) : P(P), N(N), TP(0), FP(0) { }
+      virtual void operator()(float score, uint64_t pos, uint64_t neg) {
+        rows.push_back(static_cast<float>(FP/N));
+        rows.push_back(static_cast<float>(TP/P));
+        rows.push_back(score);
+        rows.push_back(static_cast<float>(static_cast<double>(pos)/(pos+neg)));
+        TP += pos;
+        FP += neg;
+      }
+    } visitor(P, N);
+    traverse(visitor);
+    visitor.rows.push_back(1.0f);
+    visitor.rows.push_back(1.0f);
+    visitor.rows.push_back(-1.0f);
+    visitor.rows.push_back(-1.0f);
+    const int dims[2] = { static_cast<int>(visitor.rows.size()/4), 4 };
+    MatrixFloat *curve = new MatrixFloat(2, dims);
+    std::copy(visitor.rows.begin(), visitor.rows.end(),
+              curve->getRawDataAccess()->getPPALForWrite());
+    return curve;
+  }
+
+  MatrixFloat *ROCAccumulator::computePRCurve() {
+    class Visitor : public GroupVisitor {
+    public:
+      vector<float> rows;
+      double P, TP, FP;
+      Visitor(uint64_t P) : P(P), TP(0), FP(0) { }
+      virtual void operator()(float score, uint64_t pos, uint64_t neg) {
+        TP += pos;
+        FP += neg;
+        rows.push_back(static_cast<float>(TP/P));
+        rows.push_back(static_cast<float>(TP/(TP+FP)));
+        rows.push_back(score);
+      }
+    } visitor(P);
+    traverse(visitor);
+    const int dims[2] = { static_cast<int>(visitor.rows.size()/3), 3 };
+    MatrixFloat *curve = new MatrixFloat(2, dims);
+    std::copy(visitor.rows.begin(), visitor.rows.end(),
+              curve->getRawDataAccess()->getPPALForWrite());
+    return curve;
+  }
+
+  double ROCAccumulator::computeArea() {
+    class Visitor : public GroupVisitor {
+    public:
+      double TP, area;
+      Visitor() : TP(0), area(0) { }
+      virtual void operator()(float score, uint64_t pos, uint64_t neg) {
+        UNUSED_VARIABLE(score);
+        // trapezoid from (FP,TP) to (FP+neg,TP+pos)
+        area += neg * (2.0*TP + pos);
+        TP += pos;
+      }
+    } visitor;
+    traverse(visitor);
+    return visitor.area / (2.0 * static_cast<double>(P) * N);
+  }
+
+  double ROCAccumulator::computeAveragePrecision() {
+    class Visitor : public GroupVisitor {
+    public:
+      double TP, FP, ap;
+      Visitor() : TP(0), FP(0), ap(0) { }
+      virtual void operator()(float score, uint64_t pos, uint64_t neg) {
+        UNUSED_VARIABLE(score);
+        TP += pos;
+        FP += neg;
+        ap += pos * (TP/(TP+FP));
+      }
+    } visitor;
+    traverse(visitor);
+    return visitor.ap / P;
+  }
+
+  void ROCAccumulator::computeConfusion(float threshold,
+                                        uint64_t &TP, uint64_t &FP,
+                                        uint64_t &TN, uint64_t &FN) {
+    uint64_t tp = 0, fp = 0;
+    if (isApproximate()) {
+      float rb = roundf((threshold - min) / (max - min) * bins);
+      unsigned int first = (rb <= 0.0f) ? 0u :
+        ((rb >= bins) ? bins : static_cast<unsigned int>(rb));
+      for (unsigned int b=first; b<bins; ++b) {
+        tp += pos_counts[b];
+        fp += neg_counts[b];
+      }
+    }
+    else {
+      const int n = static_cast<int>(chunks.size());
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic) reduction(+:tp,fp) if(n > 1)
+#endif
+      for (int i=0; i<n; ++i) {
+        const vector<Entry> &entries = chunks[i]->entries;
+        for (size_t j=0; j<entries.size(); ++j) {
+          if (entries[j].score >= threshold) {
+            if (entries[j].positive) ++tp; else ++fp;
+          }
+        }
+      }
+    }
+    TP = tp;
+    FP = fp;
+    FN = P - tp;
+    TN = N - fp;
+  }
+
+  double ROCAccumulator::getAreaErrorBound() const {
+    if (!isApproximate()) return 0.0;
+    double ties = 0.0;
+    for (unsigned int b=0; b<bins; ++b) {
+      ties += static_cast<double>(pos_counts[b]) * neg_counts[b];
+    }
+    return ties / (2.0 * static_cast<double>(P) * N);
+  }
+
+  void ROCAccumulator::getData(MatrixFloat *&scores, MatrixFloat *&targets) {
+    if (isApproximate()) {
+      ERROR_EXIT(128, "Data is not available in approximate mode\n");
+    }
+    const int dims[2] = { static_cast<int>(P + N), 1 };
+    scores  = new MatrixFloat(2, dims);
+    targets = new MatrixFloat(2, dims);
+    float *s = scores->getRawDataAccess()->getPPALForWrite();
+    float *t = targets->getRawDataAccess()->getPPALForWrite();
+    for (unsigned int i=0; i<chunks.size(); ++i) {
+      const vector<Entry> &entries = chunks[i]->entries;
+      for (size_t j=0; j<entries.size(); ++j, ++s, ++t) {
+        *s = entries[j].score;
+        *t = static_cast<float>(entries[j].positive);
+      }
+    }
+  }
+
+  MatrixDouble *ROCAccumulator::getCounts() const {
+    if (!isApproximate()) {
+      ERROR_EXIT(128, "Counts are only available in approximate mode\n");
+    }
+    const int dims[2] = { 2, static_cast<int>(bins) };
+    MatrixDouble *counts = new MatrixDouble(2, dims);
+    double *c = counts->getRawDataAccess()->getPPALForWrite();
+    for (unsigned int b=0; b<bins; ++b) {
+      c[b]        = static_cast<double>(pos_counts[b]);
+      c[bins + b] = static_cast<double>(neg_counts[b]);
+    }
+    return counts;
+  }
+
+  void ROCAccumulator::addCounts(const MatrixDouble *counts) {
+    if (!isApproximate()) {
+      ERROR_EXIT(128, "Counts are only available in approximate mode\n");
+    }
+    if (counts->getNumDim() != 2 || counts->getDimSize(0) != 2 ||
+        counts->getDimSize(1) != static_cast<int>(bins)) {
+      ERROR_EXIT1(128, "Needs a 2x%u matrix\n", bins);
+    }
+    for (unsigned int b=0; b<bins; ++b) {
+      const uint64_t pos = static_cast<uint64_t>((*counts)(0, b));
+      const uint64_t neg = static_cast<uint64_t>((*counts)(1, b));
+      pos_counts[b] += pos;
+      neg_counts[b] += neg;
+      P += pos;
+      N += neg;
+    }
+  }
+
+} // namespace Metrics
@@ -0,0 +1,143 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef ROC_ACCUMULATOR_H
+#define ROC_ACCUMULATOR_H
+
+#include <stdint.h>
+
+#include "matrixDouble.h"
+#include "matrixFloat.h"
+#include "referenced.h"
+#include "vector.h"
+
+namespace Metrics {
+
+  /**
+   * @brief Streaming accumulator of (score,target) pairs for one-class
+   * classification metrics: ROC and PR curves, their areas, and confusion
+   * counts at any threshold.
+   *
+   * It works in two modes:
+   *
+   * - Exact mode: pairs are stored in fixed size chunks, so adding data never
+   *   copies previous data. Chunks are sorted in parallel when a curve is
+   *   needed (only the ones modified since last time) and merged on the fly
+   *   following descending scores, so no full copy of data is done.
+   *
+   * - Approximate mode: scores are counted into a fixed number of bins in
+   *   [min,max], using constant memory. Curves are computed over bin edges,
+   *   so the AUC error is bounded by the pairs of positive and negative
+   *   samples which share a bin, see getAreaErrorBound().
+   *
+   * Accumulators of the same mode (and bins) can be merged, allowing to
+   * evaluate data partitions in different threads or processes.
+   */
+  class ROCAccumulator : public Referenced {
+  public:
+    /// Builds an exact accumulator.
+    ROCAccumulator();
+    /// Builds an approximate accumulator with the given histogram.
+    ROCAccumulator(unsigned int bins, float min, float max);
+    virtual ~ROCAccumulator();
+
+    /// Adds a vector of scores and its vector of targets, a target is
+    /// positive when it is greater than 0.5.
+    void add(const Basics::MatrixFloat *outputs,
+             const Basics::MatrixFloat *targets);
+    /// Adds all the data of another accumulator of the same kind.
+    void merge(const ROCAccumulator *other);
+    void reset();
+
+    bool isApproximate() const { return bins > 0; }
+    unsigned int getNumBins() const { return bins; }
+    float getMin() const { return min; }
+    float getMax() const { return max; }
+    uint64_t getNumPositives() const { return P; }
+    uint64_t getNumNegatives() const { return N; }
+
+    /// ROC curve as a Mx4 matrix with FPR, TPR, threshold and the ratio of
+    /// positives at that threshold (the true value when it is unique). Every
+    /// point counts as positives the samples with score > threshold. The
+    /// last row is (1, 1, -1, -1).
+    Basics::MatrixFloat *computeCurve();
+    /// PR curve as a Mx3 matrix with recall, precision and threshold, every
+    /// point counts as positives the samples with score >= threshold.
+    Basics::MatrixFloat *computePRCurve();
+    /// Area under the ROC curve, without building the curve.
+    double computeArea();
+    /// Average precision, that is, the area under the PR step curve.
+    double computeAveragePrecision();
+    /// Confusion counts when samples with score >= threshold are classified
+    /// as positives. In approximate mode the threshold is rounded to the
+    /// closest bin edge.
+    void computeConfusion(float threshold, uint64_t &TP, uint64_t &FP,
+                          uint64_t &TN, uint64_t &FN);
+    /// Upper bound of |exact AUC - approximate AUC|, zero in exact mode.
+    double getAreaErrorBound() const;
+
+    /// Stored data in exact mode: two column vectors with scores and targets.
+    void getData(Basics::MatrixFloat *&scores, Basics::MatrixFloat *&targets);
+    /// Histogram in approximate mode: a 2xbins matrix with counts of
+    /// positives (first row) and negatives (second row).
+    Basics::MatrixDouble *getCounts() const;
+    /// Adds the counts of a 2xbins matrix as given by getCounts().
+    void addCounts(const Basics::MatrixDouble *counts);
+
+  private:
+    struct Entry {
+      float score;
+      uint32_t positive;
+      bool operator<(const Entry &other) const {
+        return score > other.score; // descending order
+      }
+    };
+    struct Chunk {
+      AprilUtils::vector<Entry> entries;
+      bool sorted;
+      Chunk() : sorted(true) { }
+    };
+
+    /// Receives every group of samples which share the same score, in
+    /// descending order of scores.
+    class GroupVisitor {
+    public:
+      virtual ~GroupVisitor() { }
+      virtual void operator()(float score, uint64_t pos, uint64_t neg) = 0;
+    };
+
+    // histogram (approximate mode)
+    unsigned int bins;
+    float min, max;
+    AprilUtils::vector<uint64_t> pos_counts, neg_counts;
+    // chunks (exact mode)
+    AprilUtils::vector<Chunk*> chunks;
+    uint64_t P, N;
+
+    void push(float score, bool positive);
+    unsigned int getBin(float score) const;
+    float getBinEdge(unsigned int b) const;
+    void sortChunks();
+    void traverse(GroupVisitor &visitor);
+  };
+
+} // namespace Metrics
+
+#endif // ROC_ACCUMULATOR_H
@@ -13,13 +13,22 @@ end
 
 --
 
-local roc,roc_methods = class("metrics.roc")
+-- native accumulator, see c_src/roc_accumulator.h
+local accumulator = metrics.roc.accumulator
+
+local roc,roc_methods = class("metrics.roc", nil, metrics.roc)
 metrics.roc = roc -- global environment
 
 april_set_doc(roc,
               {
                 class="class",
                 summary="ROC curve class, for one-class problems",
+                description={
+                  "Data is accumulated in constant time per sample. By",
+                  "default all data is stored and curves are exact, an",
+                  "approximate histogram with constant memory is used",
+                  "when the constructor receives a table with bins field.",
+                },
 })
 
 roc.constructor =
@@ -35,10 +44,33 @@ roc.constructor =
       { "A matrix with target class: 0 or 1", },
     },
   } ..
+  april_doc{
+    class = "method",
+    summary = "Constructor of an approximate ROC with constant memory",
+    params = {
+      bins = "Number of histogram bins",
+      min = "Minimum output value [optional], by default 0",
+      max = "Maximum output value [optional], by default 1",
+      counts = "A matrixDouble with initial counts [optional]",
+    },
+  } ..
   function(self,outputs,targets)
-    self.P = 0
-    self.N = 0
-    if outputs or targets then self:add(outputs,targets) end
+    if type(outputs) == "table" and not class.is_a(outputs,matrix) then
+      local params = get_table_fields(
+        {
+          bins = { mandatory=true, type_match="number" },
+          min = { mandatory=false, type_match="number", default=0 },
+          max = { mandatory=false, type_match="number", default=1 },
+          counts = { mandatory=false, isa_match=matrixDouble },
+        }, outputs)
+      self.acc = accumulator(params.bins, params.min, params.max)
+      if params.counts then self.acc:add_counts(params.counts) end
+    else
+      self.acc = accumulator()
+      if outputs or targets then self:add(outputs,targets) end
+    end
+    self.P = self.acc:num_positives()
+    self.N = self.acc:num_negatives()
   end
 
 roc_methods.add =
@@ -53,15 +85,33 @@ roc_methods.add =
   function(self,outputs,targets)
     local outputs = check_matrix(outputs)
     local targets = check_matrix(targets)
-    local data,P,N = self.data,0,0
-    if not data then
-      self.data = matrix.join(2, outputs, targets)
-    else
-      self.data = matrix.join(1, data, matrix.join(2, outputs, targets))
-    end
-    local ones = targets:gt(0.5):count_ones()
-    self.P = self.P + ones
-    self.N = self.N + targets:size() - ones
+    self.acc:add(outputs, targets)
+    self.P = self.acc:num_positives()
+    self.N = self.acc:num_negatives()
+  end
+
+roc_methods.merge =
+  april_doc{
+    class = "method",
+    summary = "Adds all data of another ROC object with the same histogram",
+    params = {
+      { "A metrics.roc instance", },
+    },
+  } ..
+  function(self,other)
+    assert(class.is_a(other,roc), "Needs a metrics.roc as argument")
+    self.acc:merge(other.acc)
+    self.P = self.acc:num_positives()
+    self.N = self.acc:num_negatives()
+  end
+
+roc_methods.is_approximate =
+  april_doc{
+    class = "method",
+    summary = "Returns true when data is accumulated into a histogram",
+  } ..
+  function(self)
+    return self.acc:is_approximate()
   end
 
 roc_methods.compute_curve =
@@ -70,38 +120,12 @@ roc_methods.compute_curve =
     summary = "Computes the ROC curve with all added data",
     outputs = {
       {"A matrix with N rows and 4 columns, the first column is FPR, second",
-       "is TPR, the third is the threshold, and the last is the true value"},
+       "is TPR, the third is the threshold, and the last is the true value",
+       "(ratio of positives when several samples share the threshold)"},
     },
   } ..
   function(self)
-    local data = self.data
-    local P = self.P
-    local N = self.N
-    local data = data:index(1,data:select(2,1):order())
-    local result = {}
-    local TP,FP = 0,0
-    local prev_th,j = -math.huge,0
-    for i,row in matrix.ext.iterate(data, 1, -1) do
-      if row[1] ~= prev_th then
-        local TPR,FPR = TP/P,FP/N
-	table.insert(result, FPR)    -- 1
-	table.insert(result, TPR)    -- 2
-	table.insert(result, row[1]) -- 3
-	table.insert(result, row[2]) -- 4
-        j=j+1
-        prev_th = row[1]
-      end
-      if row[2] > 0.5 then
-        TP = TP + 1
-      else
-        FP = FP + 1
-      end
-    end
-    table.insert(result, 1)
-    table.insert(result, 1)
-    table.insert(result, -1)
-    table.insert(result, -1)
-    return matrix(j+1,4,result)
+    return self.acc:compute_curve()
   end
 
 roc_methods.compute_area =
@@ -111,14 +135,63 @@ roc_methods.compute_area =
     outputs={ "The area" },
   } ..
   function(self)
-    local cv = self:compute_curve()
-    local area = 0
-    for i = 2,cv:dim(1) do
-      area = area +
-        (cv:get(i,1) - cv:get(i-1,1)) *
-        (cv:get(i,2) + cv:get(i-1,2))*0.5
-    end
-    return area
+    return self.acc:compute_area()
+  end
+
+roc_methods.area_error_bound =
+  april_doc{
+    class="method",
+    summary="Bound of the absolute AUC error, it is 0 when not approximate",
+  } ..
+  function(self)
+    return self.acc:area_error_bound()
+  end
+
+roc_methods.compute_pr_curve =
+  april_doc{
+    class = "method",
+    summary = "Computes the Precision-Recall curve with all added data",
+    outputs = {
+      {"A matrix with N rows and 3 columns, the first column is recall,",
+       "second is precision, and the third is the threshold"},
+    },
+  } ..
+  function(self)
+    return self.acc:compute_pr_curve()
+  end
+
+roc_methods.compute_average_precision =
+  april_doc{
+    class="method",
+    summary="Computes the Average Precision (area under PR curve)",
+    outputs={ "The average precision" },
+  } ..
+  function(self)
+    return self.acc:compute_average_precision()
+  end
+
+roc_methods.confusion =
+  april_doc{
+    class="method",
+    summary="Computes confusion counts and rates at a given threshold",
+    params={ "The threshold [optional], by default 0.5" },
+    outputs={
+      {"A table with TP, FP, TN, FN, precision, recall, FPR,",
+       "accuracy and F1 fields"},
+    },
+  } ..
+  function(self,threshold)
+    local TP,FP,TN,FN = self.acc:compute_confusion(threshold or 0.5)
+    local precision = TP/(TP+FP)
+    local recall = TP/(TP+FN)
+    return {
+      TP = TP, FP = FP, TN = TN, FN = FN,
+      precision = precision,
+      recall = recall,
+      FPR = FP/(FP+TN),
+      accuracy = (TP+TN)/(TP+FP+TN+FN),
+      F1 = 2*precision*recall/(precision+recall),
+    }
   end
 
 roc_methods.reset =
@@ -127,10 +200,26 @@ roc_methods.reset =
     summary="Resets all the intermediate data",
   } ..
   function(self)
-    self.data = nil
+    self.acc:reset()
     self.P    = 0
     self.N    = 0
-    collectgarbage("collect")
+  end
+
+roc_methods.to_lua_string =
+  function(self,format)
+    if self.acc:is_approximate() then
+      local bins,min,max = self.acc:histogram()
+      return string.format("metrics.roc{ bins=%d, min=%.9g, max=%.9g, counts=%s }",
+                           bins, min, max,
+                           util.to_lua_string(self.acc:get_counts(), format))
+    elseif self.P + self.N == 0 then
+      return "metrics.roc()"
+    else
+      local scores,targets = self.acc:get_data()
+      return string.format("metrics.roc(%s, %s)",
+                           util.to_lua_string(scores, format),
+                           util.to_lua_string(targets, format))
+    end
   end
 
 return roc
@@ -1,6 +1,6 @@
  package{ name = "metrics.roc",
    version = "1.0",
-   depends = { "util", },
+   depends = { "util", "matrix" },
    keywords = { "roc" },
    description = "alignment",
    -- targets como en ant
@@ -24,23 +24,23 @@
    target{
      name = "provide",
      depends = "init",
-     -- copy{ file= "c_src/*.h", dest_dir = "include" },
-     -- provide_bind{ file = "binding/bind_rates.lua.cc", dest_dir = "include" }
+     copy{ file= "c_src/*.h", dest_dir = "include" },
+     provide_bind{ file = "binding/bind_roc.lua.cc", dest_dir = "include" }
    },
    target{
      name = "build",
      depends = "provide",
      use_timestamp = true,
-     -- object{ 
-     --   file = "c_src/*.cc",
-     --   include_dirs = "${include_dirs}",
-     --   dest_dir = "build",
-     -- },
+     object{ 
+       file = "c_src/*.cc",
+       include_dirs = "${include_dirs}",
+       dest_dir = "build",
+     },
      luac{
        orig_dir = "lua_src",
        dest_dir = "build",
      },
-     -- build_bind{ file = "binding/bind_rates.lua.cc", dest_dir = "build" }
+     build_bind{ file = "binding/bind_roc.lua.cc", dest_dir = "build" }
    },
    target{
      name = "document",
@@ -21,3 +21,86 @@ T("ROCTest", function()
                                   matrix{0,0,0,1} ):compute_area(),
                      1.0 )
 end)
+
+-- reference implementation, sorting all data in Lua
+local function ref_area(outputs, targets)
+  local data = {}
+  for i=1,outputs:size() do
+    data[i] = { outputs:get(i), targets:get(i) > 0.5 and 1 or 0 }
+  end
+  table.sort(data, function(a,b) return a[1] > b[1] end)
+  local P,N,TP,FP,area,i = 0,0,0,0,0,1
+  for _,v in ipairs(data) do if v[2] == 1 then P=P+1 else N=N+1 end end
+  while i <= #data do
+    local pos,neg,th = 0,0,data[i][1]
+    while i <= #data and data[i][1] == th do
+      if data[i][2] == 1 then pos=pos+1 else neg=neg+1 end
+      i=i+1
+    end
+    area = area + neg*(2*TP + pos)
+    TP,FP = TP+pos,FP+neg
+  end
+  return area/(2*P*N)
+end
+
+T("ROCStreamingTest", function()
+    local rnd = random(1357)
+    local n = 200000
+    local target = matrix(n):uniform(0,1,rnd)
+    -- scores correlated with targets, rounded to force ties
+    local output = matrix(n):uniform(0,1000,rnd):axpy(500,target):scal(1/1500)
+    local exact = metrics.roc()
+    local parts = { metrics.roc(), metrics.roc() }
+    local approx = metrics.roc{ bins=4096 }
+    for i=1,n,10000 do
+      local slice = string.format("%d:%d", i, i+9999)
+      exact:add(output(slice), target(slice))
+      approx:add(output(slice), target(slice))
+      parts[(i-1)/10000%2+1]:add(output(slice), target(slice))
+    end
+    check.eq(exact.P + exact.N, n)
+    local area = exact:compute_area()
+    check.number_eq(area, ref_area(output, target), 1e-6)
+    -- area from the curve
+    local cv = exact:compute_curve()
+    local cv_area = 0
+    for i = 2,cv:dim(1) do
+      cv_area = cv_area + (cv:get(i,1) - cv:get(i-1,1)) *
+        (cv:get(i,2) + cv:get(i-1,2))*0.5
+    end
+    check.number_eq(cv_area, area, 1e-4)
+    local seen,distinct = {},0
+    for i=1,n do
+      local v = output:get(i)
+      if not seen[v] then seen[v],distinct = true,distinct+1 end
+    end
+    check.eq(cv:dim(1), distinct + 1) -- plus (1,1) point
+    -- merge
+    parts[1]:merge(parts[2])
+    check.number_eq(parts[1]:compute_area(), area, 1e-6)
+    -- approximate
+    check.TRUE(approx:is_approximate())
+    check.lt(math.abs(approx:compute_area() - area),
+             approx:area_error_bound() + 1e-6)
+    -- serialization
+    local approx2 = util.deserialize(util.serialize(approx))
+    check.number_eq(approx2:compute_area(), approx:compute_area(), 1e-6)
+    local exact2 = util.deserialize(util.serialize(exact))
+    check.number_eq(exact2:compute_area(), area, 1e-6)
+    -- confusion
+    local c = exact:confusion(0.5)
+    local TP = 0
+    for i=1,n do
+      if output:get(i) >= 0.5 and target:get(i) > 0.5 then TP = TP + 1 end
+    end
+    check.number_eq(c.TP, TP, 1e-6)
+    check.eq(c.TP + c.FP + c.TN + c.FN, n)
+    check.number_eq(c.recall, TP/exact.P, 1e-6)
+    -- PR curve and average precision
+    local pr = exact:compute_pr_curve()
+    check.eq(pr:dim(1), distinct)
+    check.number_eq(pr:get(pr:dim(1),1), 1.0, 1e-6)
+    local ap = exact:compute_average_precision()
+    check.gt(ap, 0.5)
+    check.le(ap, 1.0)
+end)
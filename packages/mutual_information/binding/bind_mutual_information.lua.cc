@@ -0,0 +1,118 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+//BIND_HEADER_C
+#include "bind_matrix.h"
+//BIND_END
+
+//BIND_HEADER_H
+#include "mutual_information.h"
+using namespace Stats;
+//BIND_END
+
+//BIND_LUACLASSNAME MIHistograms stats.MI.histograms
+//BIND_CPP_CLASS    MIHistograms
+
+//BIND_CONSTRUCTOR MIHistograms
+//DOC_BEGIN
+// histograms(num_rows, mins, maxs, levels=256)
+/// Discretized histograms of the columns of a data matrix with num_rows rows.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(>=, 3);
+  LUABIND_CHECK_ARGN(<=, 4);
+  int num_rows, levels;
+  MatrixFloat *mins, *maxs;
+  LUABIND_GET_PARAMETER(1, int, num_rows);
+  LUABIND_GET_PARAMETER(2, MatrixFloat, mins);
+  LUABIND_GET_PARAMETER(3, MatrixFloat, maxs);
+  LUABIND_GET_OPTIONAL_PARAMETER(4, int, levels, 256);
+  obj = new MIHistograms(num_rows, mins, maxs, levels);
+  LUABIND_RETURN(MIHistograms, obj);
+}
+//BIND_END
+
+//BIND_METHOD MIHistograms add
+//DOC_BEGIN
+// add(chunk)
+/// Adds the rows of a bi-dimensional matrix.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  MatrixFloat *chunk;
+  LUABIND_GET_PARAMETER(1, MatrixFloat, chunk);
+  obj->addRows(chunk);
+  LUABIND_RETURN(MIHistograms, obj);
+}
+//BIND_END
+
+//BIND_METHOD MIHistograms histograms
+{
+  LUABIND_RETURN(MatrixFloat, obj->getHistograms());
+}
+//BIND_END
+
+//BIND_METHOD MIHistograms entropy
+{
+  LUABIND_RETURN(MatrixFloat, obj->getEntropies());
+}
+//BIND_END
+
+//BIND_METHOD MIHistograms mutual_information
+//DOC_BEGIN
+// mutual_information(cols=nil)
+/// Returns the MI and NMI matrices between all columns and the given ones.
+//DOC_END
+{
+  LUABIND_CHECK_ARGN(<=, 1);
+  MatrixFloat *MI, *NMI;
+  if (lua_gettop(L) == 1 && !lua_isnil(L, 1)) {
+    LUABIND_CHECK_PARAMETER(1, table);
+    int num_sel;
+    LUABIND_TABLE_GETN(1, num_sel);
+    AprilUtils::UniquePtr<int []> cols( new int[num_sel] );
+    LUABIND_TABLE_TO_VECTOR_SUB1(1, int, cols.get(), num_sel);
+    obj->computeMutualInformation(cols.get(), num_sel, &MI, &NMI);
+  }
+  else {
+    obj->computeMutualInformation(0, 0, &MI, &NMI);
+  }
+  LUABIND_RETURN(MatrixFloat, MI);
+  LUABIND_RETURN(MatrixFloat, NMI);
+}
+//BIND_END
+
+//BIND_METHOD MIHistograms num_rows
+{
+  LUABIND_RETURN(int, obj->getNumRows());
+}
+//BIND_END
+
+//BIND_METHOD MIHistograms num_cols
+{
+  LUABIND_RETURN(int, obj->getNumCols());
+}
+//BIND_END
+
+//BIND_METHOD MIHistograms levels
+{
+  LUABIND_RETURN(int, obj->getLevels());
+}
+//BIND_END
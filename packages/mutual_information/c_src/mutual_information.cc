@@ -0,0 +1,245 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#include "error_print.h"
+#include "matrix_ext.h"
+#include "mutual_information.h"
+#include "omp_utils.h"
+#include "qsort.h"
+
+using AprilUtils::UniquePtr;
+using Basics::MatrixFloat;
+
+namespace Stats {
+
+  /// Maximum number of cells of the dense joint histogram of every thread,
+  /// larger joint histograms are computed sorting the joint codes
+  const int MAX_DENSE_JOINT_SIZE = 1<<20;
+  /// Minimum number of values to add rows in parallel
+  const int PARALLEL_THRESHOLD = 8192;
+
+  static double entropyFromCounts(const int32_t *counts, int levels, int n) {
+    double acc = 0.0;
+    for (int i=0; i<levels; ++i) {
+      if (counts[i] > 0) acc += counts[i] * log(static_cast<double>(counts[i]));
+    }
+    return (log(static_cast<double>(n)) - acc/n) / log(2.0);
+  }
+  
+  MIHistograms::MIHistograms(int num_rows, const MatrixFloat *mins,
+                             const MatrixFloat *maxs, int levels) :
+    Referenced(), num_rows(num_rows), num_cols(mins->size()),
+    levels(levels), filled(0) {
+    if (levels < 2 || levels > 65536) {
+      ERROR_EXIT(256, "The number of levels must be in range [2,65536]\n");
+    }
+    if (num_rows < 1) {
+      ERROR_EXIT(256, "At least one row is needed\n");
+    }
+    if (mins->getNumDim() != 1 || maxs->getNumDim() != 1 ||
+        mins->size() != maxs->size()) {
+      ERROR_EXIT(256, "Expected two vectors with the same size\n");
+    }
+    this->mins.resize(num_cols);
+    scales.resize(num_cols);
+    MatrixFloat::const_iterator min_it(mins->begin()), max_it(maxs->begin());
+    for (int c=0; c<num_cols; ++c, ++min_it, ++max_it) {
+      const float range = *max_it - *min_it;
+      this->mins[c] = *min_it;
+      scales[c] = (range > 0.0f) ? (levels / range) : 0.0f;
+    }
+    counts.resize(num_cols * levels);
+    for (unsigned int i=0; i<counts.size(); ++i) counts[i] = 0;
+    codes = new uint16_t[static_cast<size_t>(num_cols) * num_rows];
+  }
+
+  MIHistograms::~MIHistograms() {
+  }
+
+  void MIHistograms::addRows(const MatrixFloat *chunk) {
+    if (chunk->getNumDim() != 2 || chunk->getDimSize(1) != num_cols) {
+      ERROR_EXIT1(256, "Expected a bi-dimensional matrix with %d columns\n",
+                  num_cols);
+    }
+    const int rows = chunk->getDimSize(0);
+    if (filled + rows > num_rows) {
+      ERROR_EXIT1(256, "Adding more rows than the expected %d\n", num_rows);
+    }
+    const float *data = chunk->getRawDataAccess()->getPPALForRead() +
+      chunk->getOffset();
+    const int row_stride = chunk->getStrideSize(0);
+    const int col_stride = chunk->getStrideSize(1);
+    const int first = filled;
+#ifndef NO_OMP
+#pragma omp parallel for schedule(static) if(rows*num_cols > PARALLEL_THRESHOLD)
+#endif
+    for (int c=0; c<num_cols; ++c) {
+      const float *v = data + c*col_stride;
+      const float min = mins[c], scale = scales[c];
+      uint16_t *c_codes = codes.get() + static_cast<size_t>(c)*num_rows + first;
+      int32_t *c_counts = counts.begin() + c*levels;
+      for (int r=0; r<rows; ++r, v+=row_stride) {
+        // values out of [min,max] are clamped into the first or last bin
+        float x = (*v - min) * scale;
+        int code = (x > 0.0f) ? static_cast<int>(x) : 0;
+        if (code >= levels) code = levels - 1;
+        c_codes[r] = static_cast<uint16_t>(code);
+        ++c_counts[code];
+      }
+    }
+    filled += rows;
+  }
+
+  void MIHistograms::checkFilled() const {
+    if (filled != num_rows) {
+      ERROR_EXIT2(256, "Expected %d rows, found %d\n", num_rows, filled);
+    }
+  }
+
+  MatrixFloat *MIHistograms::getHistograms() const {
+    checkFilled();
+    const int dims[2] = { num_cols, levels };
+    MatrixFloat *result = new MatrixFloat(2, dims);
+    MatrixFloat::iterator it(result->begin());
+    for (unsigned int i=0; i<counts.size(); ++i, ++it) {
+      *it = static_cast<float>(counts[i]) / num_rows;
+    }
+    return result;
+  }
+
+  MatrixFloat *MIHistograms::getEntropies() const {
+    checkFilled();
+    MatrixFloat *result = new MatrixFloat(1, &num_cols);
+    MatrixFloat::iterator it(result->begin());
+    for (int c=0; c<num_cols; ++c, ++it) {
+      *it = entropyFromCounts(counts.begin() + c*levels, levels, num_rows);
+    }
+    return result;
+  }
+
+  double MIHistograms::jointEntropy(int a, int b, const double *nlogn,
+                                    int32_t *dense, uint32_t *keys) const {
+    // local copies, stores into the buffers could alias the members
+    const int n_rows = num_rows, L = levels;
+    const uint16_t *a_codes = codes.get() + static_cast<size_t>(a)*n_rows;
+    const uint16_t *b_codes = codes.get() + static_cast<size_t>(b)*n_rows;
+    double acc = 0.0;
+    if (dense != 0) {
+      for (int r=0; r<n_rows; ++r) {
+        ++dense[ a_codes[r]*L + b_codes[r] ];
+      }
+      if (L*L <= n_rows) {
+        for (int i=0; i<L*L; ++i) {
+          acc += nlogn[dense[i]];
+          dense[i] = 0;
+        }
+      }
+      else {
+        // every non-zero cell is accumulated once and reset to zero, so the
+        // buffer is cleaned with O(num_rows) cost instead of O(levels^2)
+        for (int r=0; r<n_rows; ++r) {
+          int32_t &n = dense[ a_codes[r]*L + b_codes[r] ];
+          acc += nlogn[n];
+          n = 0;
+        }
+      }
+    }
+    else {
+      for (int r=0; r<n_rows; ++r) {
+        keys[r] = a_codes[r]*static_cast<uint32_t>(L) + b_codes[r];
+      }
+      AprilUtils::Sort(keys, n_rows);
+      int n = 1;
+      for (int r=1; r<=n_rows; ++r) {
+        if (r < n_rows && keys[r] == keys[r-1]) ++n;
+        else {
+          acc += nlogn[n];
+          n = 1;
+        }
+      }
+    }
+    return (log(static_cast<double>(n_rows)) - acc/n_rows) / log(2.0);
+  }
+  
+  void MIHistograms::computeMutualInformation(const int *cols, int num_sel,
+                                              MatrixFloat **MI,
+                                              MatrixFloat **NMI) const {
+    checkFilled();
+    const bool symmetric = (cols == 0);
+    if (symmetric) num_sel = num_cols;
+    for (int j=0; j<num_sel && !symmetric; ++j) {
+      if (cols[j] < 0 || cols[j] >= num_cols) {
+        ERROR_EXIT1(256, "Column index %d out of range\n", cols[j]+1);
+      }
+    }
+    AprilUtils::SharedPtr<MatrixFloat> H( getEntropies() );
+    const float *h = H->getRawDataAccess()->getPPALForRead();
+    const int dims[2] = { num_cols, num_sel };
+    *MI  = new MatrixFloat(2, dims);
+    *NMI = new MatrixFloat(2, dims);
+    float *mi  = (*MI)->getRawDataAccess()->getPPALForWrite();
+    float *nmi = (*NMI)->getRawDataAccess()->getPPALForWrite();
+    const bool use_dense = (static_cast<double>(levels)*levels <=
+                            MAX_DENSE_JOINT_SIZE);
+    const int num_pairs = num_cols * num_sel;
+    // n*log(n) table for all possible counts, nlogn[0] = 0
+    UniquePtr<double []> nlogn( new double[num_rows + 1] );
+    nlogn[0] = 0.0;
+    for (int n=1; n<=num_rows; ++n) {
+      nlogn[n] = n * log(static_cast<double>(n));
+    }
+#ifndef NO_OMP
+#pragma omp parallel if(num_pairs > 1)
+#endif
+    {
+      // auxiliary buffers of every thread
+      UniquePtr<int32_t []> dense;
+      UniquePtr<uint32_t []> keys;
+      if (use_dense) {
+        dense = new int32_t[levels*levels];
+        for (int i=0; i<levels*levels; ++i) dense[i] = 0;
+      }
+      else {
+        keys = new uint32_t[num_rows];
+      }
+#ifndef NO_OMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int p=0; p<num_pairs; ++p) {
+        const int i = p / num_sel, k = p % num_sel;
+        const int j = symmetric ? k : cols[k];
+        // the symmetric matrix only computes its upper triangle
+        if (symmetric && j < i) continue;
+        const double hij = (i == j) ? h[i] :
+          jointEntropy(i, j, nlogn.get(), dense.get(), keys.get());
+        const double mi_ij = h[i] + h[j] - hij;
+        const double nmi_ij = (hij > 0.0) ? ((h[i] + h[j]) / hij) : 1.0;
+        mi[p]  = static_cast<float>(mi_ij);
+        nmi[p] = static_cast<float>(nmi_ij);
+        if (symmetric) {
+          mi[j*num_sel + i]  = mi[p];
+          nmi[j*num_sel + i] = nmi[p];
+        }
+      }
+    }
+  }
+  
+} // namespace Stats
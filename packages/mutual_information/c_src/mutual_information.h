@@ -0,0 +1,99 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef MUTUAL_INFORMATION_H
+#define MUTUAL_INFORMATION_H
+
+#include <stdint.h>
+#include "matrixFloat.h"
+#include "referenced.h"
+#include "smart_ptr.h"
+#include "vector.h"
+
+namespace Stats {
+
+  /**
+   * @brief Discretized histograms of the columns of a data matrix, with the
+   * entropy and mutual information derived from them.
+   *
+   * Rows are given by chunks with addRows(), and every column is discretized
+   * into levels bins of equal width between its min and max values. The bin
+   * codes are kept (two bytes by value) to compute joint histograms of pairs
+   * of columns later, but joint histograms are never stored: every thread
+   * counts one pair at a time into a dense levels x levels buffer, or sorts
+   * the joint codes of the pair when this buffer would be too large, so the
+   * memory is bounded by the codes plus one buffer per thread.
+   *
+   * Entropies are computed in base 2.
+   */
+  class MIHistograms : public Referenced {
+    int num_rows, num_cols, levels;
+    /// number of rows given by addRows()
+    int filled;
+    AprilUtils::vector<float> mins, scales;
+    /// num_cols x levels counts
+    AprilUtils::vector<int32_t> counts;
+    /// num_cols x num_rows codes, in column major
+    AprilUtils::UniquePtr<uint16_t []> codes;
+
+    double jointEntropy(int a, int b, const double *nlogn,
+                        int32_t *dense, uint32_t *keys) const;
+    void checkFilled() const;
+    
+  public:
+    /**
+     * @param num_rows - The number of rows of the data.
+     * @param mins - A vector with the min value of every column.
+     * @param maxs - A vector with the max value of every column.
+     * @param levels - The number of bins, between 2 and 65536.
+     */
+    MIHistograms(int num_rows, const Basics::MatrixFloat *mins,
+                 const Basics::MatrixFloat *maxs, int levels);
+    virtual ~MIHistograms();
+    /// Adds the rows of a bi-dimensional matrix, columns are processed in
+    /// parallel.
+    void addRows(const Basics::MatrixFloat *chunk);
+    /// Returns a num_cols x levels matrix with bin probabilities.
+    Basics::MatrixFloat *getHistograms() const;
+    /// Returns a vector with the entropy of every column.
+    Basics::MatrixFloat *getEntropies() const;
+    /**
+     * @brief Computes the mutual information between columns.
+     *
+     * Pairs are computed in parallel. MI(i,j) = H(i) + H(j) - H(i,j) and
+     * NMI(i,j) = (H(i) + H(j)) / H(i,j), being NMI=1 when H(i,j)=0.
+     *
+     * @param cols - Column indices (zero based) [optional]. If not given,
+     * the result is the symmetric matrix of all pairs of columns.
+     * @param num_sel - The number of column indices.
+     * @param MI - The num_cols x num_sel mutual information, by reference.
+     * @param NMI - The normalized mutual information, by reference.
+     */
+    void computeMutualInformation(const int *cols, int num_sel,
+                                  Basics::MatrixFloat **MI,
+                                  Basics::MatrixFloat **NMI) const;
+    int getNumRows() const { return num_rows; }
+    int getNumCols() const { return num_cols; }
+    int getLevels() const { return levels; }
+  };
+  
+} // namespace Stats
+
+#endif // MUTUAL_INFORMATION_H
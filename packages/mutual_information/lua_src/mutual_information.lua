@@ -1,22 +1,95 @@
 stats = stats or {}
 stats.MI = stats.MI or {}
 
-local LEVELS  = 256
-local EPSILON = 1e-03
+local LEVELS     = 256
+local CHUNK_SIZE = 1024
 
--- extracts the histogram from the matrix, using the image package
-local function get_histogram_from_matrix(m, levels)
-  assert(m, "A matrix is needed")
-  -- the matrix is adjusted to be between 0 and 1, and rewrap to fit a image of
-  -- only one row
-  local maux = m:clone():adjust_range(0.0, 1.0):rewrap(1, m:size())
-  local h = image.image_histogram.get_histogram(Image(maux), levels or LEVELS)
-  -- sanity check
-  assert(math.abs(h:sum() - 1) < EPSILON,
-	 "The image_histogram hasn't got bin probabilities")
+-- traverses the rows of X (a matrix or a dataset) in chunks, calling f(chunk)
+-- for every chunk
+local function foreach_chunk(X, chunk_size, f)
+  if class.is_a(X, matrix) then
+    local M,N = X:dim(1),X:dim(2)
+    for first=1,M,chunk_size do
+      local last = math.min(M, first + chunk_size - 1)
+      f(X:slice({first,1}, {last-first+1,N}))
+    end
+  else
+    local M  = X:numPatterns()
+    local ds = dataset.token.wrapper(X)
+    for first=1,M,chunk_size do
+      local last = math.min(M, first + chunk_size - 1)
+      f(ds:getPatternBunch(iterator(range(first,last)):table()))
+    end
+  end
+end
+
+-- builds the histograms of the columns of X, with the given range or with the
+-- range of every column
+local function build_histograms(X, levels, chunk_size, mins, maxs)
+  local M,N
+  if class.is_a(X, matrix) then
+    assert(#X:dim() == 2, "Expected a bi-dimensional matrix")
+    M,N = X:dim(1),X:dim(2)
+    if not mins then mins,maxs = X:min(1):rewrap(N),X:max(1):rewrap(N) end
+  else
+    M,N = X:numPatterns(),X:patternSize()
+    if not mins then
+      local tmin,tmax = X:min_max()
+      mins,maxs = matrix(tmin),matrix(tmax)
+    end
+  end
+  local h = stats.MI.histograms(M, mins, maxs, levels)
+  foreach_chunk(X, chunk_size, function(chunk) h:add(chunk) end)
   return h
 end
 
+-- extracts the histogram from the matrix, interpreting its data as a sequence
+-- of values of one variable
+local function histograms_from_matrix(m, levels)
+  assert(m, "A matrix is needed")
+  local x = m:contiguous():rewrap(m:size(), 1)
+  local mins,maxs = matrix{ (x:min()) },matrix{ (x:max()) }
+  return build_histograms(x, levels or LEVELS, m:size(), mins, maxs)
+end
+
+stats.MI.matrix =
+  april_doc{
+    class = "function",
+    summary = "Computes the entropy and Mutual Information between columns",
+    description = {
+      "Data is ordered by rows, variables by columns. Every column is",
+      "discretized into histogram bins of equal width between its min",
+      "and max values, in one pass over the data, and the mutual",
+      "information of every pair of columns is computed in parallel",
+      "from their joint histograms, which are never stored together.",
+    },
+    params = {
+      "A 2D matrix or a dataset",
+      {
+        "A table with options [optional]: levels=256 number of bins,",
+        "cols=nil a table with column indices to compute the MI of all",
+        "columns with them, chunk_size=1024 rows by chunk",
+      },
+    },
+    outputs = {
+      "The MI matrix, NxN or NxC if cols are given",
+      "The Normalized Mutual Information matrix, (Hi+Hj)/Hij",
+      "A vector with the entropy of every column",
+      "The stats.MI.histograms object",
+    },
+  } ..
+  function(X, params)
+    local params = get_table_fields(
+      {
+        levels = { type_match="number", mandatory=false, default=LEVELS },
+        cols = { type_match="table", mandatory=false, default=nil },
+        chunk_size = { type_match="number", mandatory=false,
+                       default=CHUNK_SIZE },
+      }, params or {})
+    local h = build_histograms(X, params.levels, params.chunk_size)
+    local MI,NMI = h:mutual_information(params.cols)
+    return MI,NMI,h:entropy(),h
+  end
 
 stats.MI.entropy =
   april_doc{
@@ -49,7 +122,9 @@ stats.MI.entropy =
       -- we don't know if the histogram has probabilities or raw counts
       local s = histogram:sum() if s~=1.0 then histogram:scal(1/s) end
     end
-    local histogram = histogram or get_histogram_from_matrix(m, levels)
+    if not histogram then
+      return histograms_from_matrix(m, levels):entropy():get(1)
+    end
     -- the entropy is computed as -sum_i[ p_i * log_2(p_i) ]
     return -histogram:clone():plogp():sum()/math.log(2)
   end
@@ -77,34 +152,16 @@ stats.MI.mutual_information =
   -- this function computes the mutual information between two matrices of the
   -- same size
   function(m1, m2, levels)
-    local levels = levels or LEVELS
     assert(m1:size() == m2:size(), "Two matrices must be of the same size")
-    -- the matrices are first adjusted to be between 0.0 and levels-1, and
-    -- re-wrapped to be a vector
-    local m1   = m1:clone():adjust_range(0.0, levels-1):rewrap(m1:size())
-    local m2   = m2:clone():adjust_range(0.0, levels-1):rewrap(m2:size())
-    -- the joint histogram is a 2-dimensional matrix
-    local h12  = matrix(levels,levels):zeros()
     local sz   = m1:size() -- the two matrices has the same size
-    -- auxiliary function which computes the bin of a given matrix value
-    function get_bin_idx(v) return math.floor(v)+1 end
-    for i=1,sz do
-      local i1  = get_bin_idx(m1:get(i)) -- bin row position
-      local i2  = get_bin_idx(m2:get(i)) -- bin col position
-      local c   = h12:get(i1, i2) -- the previous count
-      h12:set(i1, i2, c + 1)
-    end
-    h12:scal(1/sz)
-    -- marginalization for m1 and m2 histograms computation
-    local h1 = matrix(levels):zeros()
-    local h2 = matrix(levels):zeros()
-    for i=1,levels do
-      h1:axpy(1.0, h12:select(2, i)) -- by columns
-      h2:axpy(1.0, h12:select(1, i)) -- by rows
-    end
-    local entropy1  = stats.MI.entropy(nil, h1)
-    local entropy2  = stats.MI.entropy(nil, h2)
-    local entropy12 = stats.MI.entropy(nil, h12)
+    -- the matrices are re-wrapped as two columns, and every one keeps its
+    -- range
+    local x    = matrix.join(2, m1:contiguous():rewrap(sz, 1),
+                             m2:contiguous():rewrap(sz, 1))
+    local mins = matrix{ (m1:min()), (m2:min()) }
+    local maxs = matrix{ (m1:max()), (m2:max()) }
+    local h    = build_histograms(x, levels or LEVELS, sz, mins, maxs)
+    local MI,NMI = h:mutual_information{ 2 }
     -- returns the Mutual Information and Normalized Mutual Information
-    return entropy1+entropy2-entropy12 , (entropy1+entropy2)/entropy12
+    return MI:get(1,1),NMI:get(1,1)
   end
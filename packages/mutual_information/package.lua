@@ -1,6 +1,6 @@
  package{ name = "stats.MI",
    version = "1.0",
-   depends = { "util", "matrix", "image_cleaning" },
+   depends = { "util", "matrix" },
    keywords = { "mutual_information" },
    description = "Mutual information",
    -- targets como en ant
@@ -16,25 +16,34 @@
    target{
      name = "provide",
      depends = "init",
-     -- copy{ file= "c_src/*.h", dest_dir = "include" },
-     -- provide_bind{ file = "binding/bind_image.lua.cc", dest_dir = "include" },
+     copy{ file= "c_src/*.h", dest_dir = "include" },
+     provide_bind{ file = "binding/bind_mutual_information.lua.cc", dest_dir = "include" },
+   },
+   target{
+     name = "test",
+     lua_unit_test{
+       file={
+         "test/test_mutual_information.lua",
+       },
+     },
    },
    target{
      name = "build",
      depends = "provide",
      use_timestamp=true,
-     -- object{ 
-     --   file = "c_src/image.cc",
-     --   include_dirs = "${include_dirs}",
-     --   dest_dir = "build",
-     --   --debug = "yes",
-     -- },
+     object{ 
+       file = "c_src/*.cc",
+       include_dirs = "${include_dirs}",
+       dest_dir = "build",
+     },
      luac{
        orig_dir = "lua_src",
        dest_dir = "build",
      },
-     -- build_bind{ file = "binding/bind_image.lua.cc", dest_dir = "build" },
-     -- build_bind{ file = "binding/bind_image_RGB.lua.cc", dest_dir = "build" },
+     build_bind{
+       file = "binding/bind_mutual_information.lua.cc",
+       dest_dir = "build",
+     },
    },
    target{
      name = "document",
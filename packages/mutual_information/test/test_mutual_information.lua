@@ -0,0 +1,86 @@
+local check = utest.check
+local T = utest.test
+
+local function entropy(p)
+  return -p:clone():plogp():sum()/math.log(2)
+end
+
+-- reference joint histogram computed traversing the data in Lua
+local function joint_histogram(x, y, levels)
+  local h = matrix(levels, levels):zeros()
+  local function bin(v, m)
+    local min,max = m:min(),m:max()
+    return math.min(levels, math.floor((v - min)/(max - min)*levels) + 1)
+  end
+  for i=1,x:size() do
+    local a,b = bin(x:get(i), x),bin(y:get(i), y)
+    h:set(a, b, h:get(a, b) + 1)
+  end
+  return h:scal(1/x:size())
+end
+
+local rnd = random(1234)
+local X = matrix(2000, 6):uniformf(0, 1, rnd)
+-- dependent columns
+X:select(2,2):copy(X:select(2,1)):pow(2)
+X:select(2,3):copy(X:select(2,1)):axpy(0.5, X:select(2,4))
+X:select(2,6):fill(3)
+
+T("HistogramsTest", function()
+    local h = stats.MI.histograms(X:dim(1), X:min(1):rewrap(6), X:max(1):rewrap(6), 8)
+    check.errored(function() h:entropy() end)
+    h:add(X("1:500",":")):add(X("501:2000",":"))
+    local hist = h:histograms()
+    check.eq(hist:dim(1), 6) check.eq(hist:dim(2), 8)
+    check.eq(hist:sum(2), matrix(6,1):fill(1))
+    check.eq(hist(6,":"), matrix(1,8,{1,0,0,0,0,0,0,0}))
+    check.errored(function() h:add(X("1:10",":")) end)
+end)
+
+T("MutualInformationTest", function()
+    local levels = 16
+    local MI,NMI,H = stats.MI.matrix(X, { levels=levels, chunk_size=300 })
+    check.eq(MI:dim(1), 6) check.eq(MI:dim(2), 6)
+    check.eq(MI, MI:transpose())
+    for i=1,6 do
+      check.number_eq(MI:get(i,i), H:get(i))
+      local p = joint_histogram(X:select(2,i), X:select(2,i), levels)
+      if i < 6 then check.number_eq(H:get(i), entropy(p), 1e-04) end
+    end
+    check.number_eq(H:get(6), 0)
+    for _,pair in ipairs{ {1,2}, {1,3}, {3,4}, {4,5} } do
+      local i,j = table.unpack(pair)
+      local p12 = joint_histogram(X:select(2,i), X:select(2,j), levels)
+      local h1  = entropy(p12:sum(2))
+      local h2  = entropy(p12:sum(1))
+      local h12 = entropy(p12)
+      check.number_eq(MI:get(i,j), h1 + h2 - h12, 1e-04)
+      check.number_eq(NMI:get(i,j), (h1 + h2)/h12, 1e-04)
+    end
+    -- dependent columns have larger MI than independent ones
+    check.gt(MI:get(1,2), 2.0)
+    check.lt(MI:get(4,5), 0.1)
+    check.eq(MI(":",6), matrix(6,1):zeros())
+    check.eq(NMI:get(6,6), 1)
+    -- MI with a subset of columns
+    local MI2,NMI2 = stats.MI.matrix(X, { levels=levels, cols={ 3, 1 } })
+    check.eq(MI2:dim(2), 2)
+    check.eq(MI2:select(2,1), MI:select(2,3))
+    check.eq(NMI2:select(2,2), NMI:select(2,1))
+    -- datasets are traversed by chunks
+    local MI3 = stats.MI.matrix(dataset.matrix(X), { levels=levels,
+                                                     chunk_size=128 })
+    check.eq(MI3, MI)
+end)
+
+T("LargeLevelsTest", function()
+    -- a joint histogram larger than the dense buffer is computed by sorting
+    local x = X:select(2,1):clone()
+    local y = X:select(2,3):clone()
+    local mi,nmi = stats.MI.mutual_information(x, y, 2048)
+    local p12 = joint_histogram(x, y, 2048)
+    local h1,h2,h12 = entropy(p12:sum(2)),entropy(p12:sum(1)),entropy(p12)
+    check.number_eq(mi, h1 + h2 - h12, 1e-04)
+    check.number_eq(nmi, (h1 + h2)/h12, 1e-04)
+    check.number_eq(stats.MI.entropy(x, nil, 2048), h1, 1e-04)
+end)
@@ -1,17 +1,52 @@
 //BIND_HEADER_H
 #include "off_line_text_preprocessing.h"
+#include "batch_preprocessing.h"
 #include "utilImageFloat.h"
 #include "bind_image.h"
 #include "vector.h"
 #include <cmath>
 #include <cctype>
 #include "geometry.h"
+using OCR::OffLineTextPreprocessing::BatchPreprocessor;
 //BIND_END
 
 //BIND_HEADER_C
+#include "bind_affine_transform.h"
+#include "bind_matrix.h"
 using namespace AprilUtils;
 using namespace Basics;
 using namespace Imaging;
+
+/// Reads the images (and line matrices) tables of apply methods.
+static int readBatchImages(lua_State *L, BatchPreprocessor *obj,
+                           vector<ImageFloat*> &images,
+                           vector<MatrixFloat*> &line_mats) {
+  if (!lua_istable(L, 1)) luaL_error(L, "Needs a table of images");
+  int n = static_cast<int>(luaL_len(L, 1));
+  images.resize(n);
+  for (int i=1; i<=n; ++i) {
+    lua_rawgeti(L, 1, i);
+    images[i-1] = lua_toImageFloat(L, -1);
+    if (images[i-1] == 0) luaL_error(L, "Expected an image at position %d", i);
+    lua_pop(L, 1);
+  }
+  if (lua_istable(L, 2)) {
+    if (static_cast<int>(luaL_len(L, 2)) != n) {
+      luaL_error(L, "Needs one line matrix by image");
+    }
+    line_mats.resize(n);
+    for (int i=1; i<=n; ++i) {
+      lua_rawgeti(L, 2, i);
+      line_mats[i-1] = lua_toMatrixFloat(L, -1);
+      if (line_mats[i-1] == 0) luaL_error(L, "Expected a matrix at position %d", i);
+      lua_pop(L, 1);
+    }
+  }
+  else if (obj->needsLineMatrices()) {
+    luaL_error(L, "normalize_size step needs a table of line matrices");
+  }
+  return n;
+}
 //BIND_END
 
 //BIND_FUNCTION ocr.off_line_text_preprocessing.normalize_image
@@ -122,3 +157,136 @@ using namespace Imaging;
   LUABIND_RETURN(ImageFloat, result);
 }
 //BIND_END
+
+//BIND_LUACLASSNAME BatchPreprocessor ocr.off_line_text_preprocessing.batch_preprocessor
+//BIND_CPP_CLASS    BatchPreprocessor
+
+//BIND_CONSTRUCTOR BatchPreprocessor
+// receives a table of steps, every step is a table with the step name at
+// position 1 and its parameters as fields, the steps are applied in order
+{
+  LUABIND_CHECK_ARGN(==, 1);
+  LUABIND_CHECK_PARAMETER(1, table);
+  obj = new BatchPreprocessor();
+  int num_steps;
+  LUABIND_TABLE_GETN(1, num_steps);
+  for (int i=1; i<=num_steps; ++i) {
+    lua_rawgeti(L, 1, i);
+    if (!lua_istable(L, -1)) LUABIND_FERROR1("Expected a table at step %d\n", i);
+    int step = lua_gettop(L);
+    const char *name;
+    lua_rawgeti(L, step, 1);
+    if (!lua_isstring(L, -1)) LUABIND_FERROR1("Expected a name at step %d\n", i);
+    name = lua_tostring(L, -1);
+    lua_pop(L, 1);
+    constString csname(name);
+    if (csname == "binarize_sauvola") {
+      int radius;
+      float k, r;
+      LUABIND_GET_TABLE_PARAMETER(step, radius, int, radius);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, k, float, k, 0.5f);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, r, float, r, 128.0f);
+      obj->addBinarizeSauvola(radius, k, r);
+    }
+    else if (csname == "binarize_niblack") {
+      int radius;
+      float k, min, max;
+      LUABIND_GET_TABLE_PARAMETER(step, radius, int, radius);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, k, float, k, 0.2f);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, min, float, min, 0.0f);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, max, float, max, 1.0f);
+      obj->addBinarizeNiblack(radius, k, min, max);
+    }
+    else if (csname == "binarize_niblack_simple") {
+      int radius;
+      float k;
+      LUABIND_GET_TABLE_PARAMETER(step, radius, int, radius);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, k, float, k, 0.2f);
+      obj->addBinarizeNiblackSimple(radius, k);
+    }
+    else if (csname == "resize") {
+      int width, height;
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, width, int, width, 0);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, height, int, height, 0);
+      if (width <= 0 && height <= 0) {
+        LUABIND_ERROR("resize step needs width or height fields\n");
+      }
+      obj->addResize(width, height);
+    }
+    else if (csname == "shear_h") {
+      float angle, default_value;
+      LUABIND_GET_TABLE_PARAMETER(step, angle, float, angle);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, default, float, default_value,
+                                           CTEBLANCO);
+      obj->addShearH(angle, default_value);
+    }
+    else if (csname == "affine") {
+      AffineTransform2D *trans;
+      float default_value;
+      LUABIND_GET_TABLE_PARAMETER(step, transform, AffineTransform2D, trans);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, default, float, default_value,
+                                           CTEBLANCO);
+      obj->addAffine(trans, default_value);
+    }
+    else if (csname == "normalize_size") {
+      float ascender_ratio, descender_ratio;
+      int dst_height;
+      bool keep_aspect;
+      LUABIND_GET_TABLE_PARAMETER(step, ascender_ratio, float, ascender_ratio);
+      LUABIND_GET_TABLE_PARAMETER(step, descender_ratio, float, descender_ratio);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, dst_height, int, dst_height, -1);
+      LUABIND_GET_TABLE_OPTIONAL_PARAMETER(step, keep_aspect, bool, keep_aspect,
+                                           false);
+      obj->addNormalizeSize(ascender_ratio, descender_ratio, dst_height,
+                            keep_aspect);
+    }
+    else {
+      LUABIND_FERROR1("Unknown step name %s\n", name);
+    }
+    lua_pop(L, 1);
+  }
+  obj->compile();
+  LUABIND_RETURN(BatchPreprocessor, obj);
+}
+//BIND_END
+
+//BIND_METHOD BatchPreprocessor get_num_steps
+{
+  LUABIND_RETURN(int, obj->getNumSteps());
+}
+//BIND_END
+
+//BIND_METHOD BatchPreprocessor apply
+// receives a table of images and an optional table of line matrices, returns
+// a table with the processed images
+{
+  vector<ImageFloat*> images;
+  vector<MatrixFloat*> line_mats;
+  LUABIND_CHECK_ARGN(>=, 1);
+  LUABIND_CHECK_ARGN(<=, 2);
+  int n = readBatchImages(L, obj, images, line_mats);
+  vector<ImageFloat*> results(n);
+  obj->apply(n, images.begin(), line_mats.empty() ? 0 : line_mats.begin(),
+             results.begin());
+  lua_createtable(L, n, 0);
+  for (int i=0; i<n; ++i) {
+    lua_pushImageFloat(L, results[i]);
+    lua_rawseti(L, -2, i+1);
+  }
+  LUABIND_RETURN_FROM_STACK(-1);
+}
+//BIND_END
+
+//BIND_METHOD BatchPreprocessor apply_packed
+// the same as apply, but returns a matrix with one image by row
+{
+  vector<ImageFloat*> images;
+  vector<MatrixFloat*> line_mats;
+  LUABIND_CHECK_ARGN(>=, 1);
+  LUABIND_CHECK_ARGN(<=, 2);
+  int n = readBatchImages(L, obj, images, line_mats);
+  MatrixFloat *result = obj->applyPacked(n, images.begin(),
+                                         line_mats.empty() ? 0 : line_mats.begin());
+  LUABIND_RETURN(MatrixFloat, result);
+}
+//BIND_END
@@ -0,0 +1,556 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#include <cmath>
+#include "batch_preprocessing.h"
+#include "binarization.h"
+#include "error_print.h"
+#include "matrix_ext_lapack.h"
+#include "maxmin.h"
+#include "off_line_text_preprocessing.h"
+#include "omp_utils.h"
+#include "smart_ptr.h"
+
+using AprilUtils::vector;
+using Basics::MatrixFloat;
+using Imaging::ImageFloat;
+
+namespace OCR {
+  namespace OffLineTextPreprocessing {
+
+    namespace {
+
+      /// Row pointers access to the pixels of an image.
+      struct Pixels {
+        float *data;
+        int width, height, row_stride, col_stride;
+        Pixels(ImageFloat *img) : width(img->width()), height(img->height()) {
+          MatrixFloat *m = img->getMatrix();
+          data = m->getRawDataAccess()->getPPALForReadAndWrite() + m->getOffset();
+          row_stride = m->getStrideSize(0);
+          col_stride = m->getStrideSize(1);
+        }
+        float *row(int y) const { return data + y*row_stride; }
+        float &operator()(int x, int y) const {
+          return data[y*row_stride + x*col_stride];
+        }
+        // the same computation as Image<T>::getpixel_bilinear
+        float getpixel(int x, int y, float default_value) const {
+          if (x>=0 && y>=0 && x<width && y<height) return (*this)(x,y);
+          return default_value;
+        }
+        float bilinear(float x, float y, float default_value) const {
+          float fx = fabsf(x - static_cast<float>(trunc(x)));
+          float fy = fabsf(y - static_cast<float>(trunc(y)));
+          float dx = (x >= 0.0f ? 1.0f : -1.0f);
+          float dy = (y >= 0.0f ? 1.0f : -1.0f);
+          float h1 = (1-fx)*getpixel(int(x), int(y), default_value) + fx*getpixel(int(x+dx), int(y), default_value);
+          float h2 = (1-fx)*getpixel(int(x), int(y+dy), default_value) + fx*getpixel(int(x+dx), int(y+dy), default_value);
+          return (1-fy)*h1 + fy*h2;
+        }
+      };
+
+      /// Composition of affine transforms given by their first two rows,
+      /// result = a * b, that is, b is applied first.
+      void compose(const float *a, const float *b, float *result) {
+        float r[6];
+        r[0] = a[0]*b[0] + a[1]*b[3];
+        r[1] = a[0]*b[1] + a[1]*b[4];
+        r[2] = a[0]*b[2] + a[1]*b[5] + a[2];
+        r[3] = a[3]*b[0] + a[4]*b[3];
+        r[4] = a[3]*b[1] + a[4]*b[4];
+        r[5] = a[3]*b[2] + a[4]*b[5] + a[5];
+        for (int i=0; i<6; ++i) result[i] = r[i];
+      }
+
+      /**
+       * Sparse weights of a resize along one axis. Every destination index
+       * receives the sum of src[idx[j]]*w[j] for j in [first[d],first[d+1]).
+       *
+       * The weights reproduce the area sampling of Image<T>::resize: the
+       * destination index d covers the source interval [s0,s1], which is
+       * split into pixel fragments sampled by linear interpolation at their
+       * middle point, and normalized by the interval length.
+       */
+      struct AxisWeights {
+        vector<int> first, idx;
+        vector<float> w;
+        /// True when the destination interval lies inside one pixel.
+        vector<bool> single;
+        
+        AxisWeights(int src_size, int dst_size, bool integer_samples=false) {
+          first.reserve(dst_size + 1);
+          single.resize(dst_size);
+          for (int d=0; d<dst_size; ++d) {
+            first.push_back(static_cast<int>(idx.size()));
+            float s0 = (float(d)/float(dst_size)) * (src_size-1);
+            float s1 = (float(d+1)/float(dst_size)) * (src_size-1);
+            int i0 = int(s0), i1 = int(s1);
+            float len = s1 - s0;
+            single[d] = (i0 == i1);
+            if (i0 == i1) {
+              addSample(src_size, 0.5f*(s0+s1), len, len);
+            }
+            else {
+              // Image<T>::resize samples at integer rows when the
+              // horizontal interval lies inside one pixel
+              addSample(src_size, integer_samples ? float(i0) : 0.5f*(float(i0+1)+s0),
+                        float(i0+1)-s0, len);
+              addSample(src_size, integer_samples ? float(i1) : 0.5f*(s1+floorf(s1)),
+                        s1-floorf(s1), len);
+              for (int c=i0+1; c<i1; ++c) {
+                addSample(src_size, integer_samples ? float(c) : c+0.5f,
+                          1.0f, len);
+              }
+            }
+          }
+          first.push_back(static_cast<int>(idx.size()));
+        }
+        
+      private:
+        // linear interpolation at pos, pixels out of range are zero
+        void addSample(int src_size, float pos, float weight, float len) {
+          int i = int(pos);
+          float f = pos - float(i);
+          if (i < src_size) {
+            idx.push_back(i);
+            w.push_back(weight*(1.0f-f)/len);
+          }
+          if (f > 0.0f && i+1 < src_size) {
+            idx.push_back(i+1);
+            w.push_back(weight*f/len);
+          }
+        }
+      };
+
+      /// Vertical pass of the separable resize, one destination row.
+      void resizeRowPass(const Pixels &src, const AxisWeights &wy, int y,
+                         float *tmp) {
+        for (int x=0; x<src.width; ++x) tmp[x] = 0.0f;
+        for (int j=wy.first[y]; j<wy.first[y+1]; ++j) {
+          const float *src_row = src.row(wy.idx[j]);
+          const float weight = wy.w[j];
+          for (int x=0; x<src.width; ++x) {
+            tmp[x] += weight * src_row[x*src.col_stride];
+          }
+        }
+      }
+
+      void resizeKernel(const Pixels &src, const Pixels &dst) {
+        AxisWeights wx(src.width, dst.width);
+        AxisWeights wy(src.height, dst.height);
+        AxisWeights wy_int(src.height, dst.height, true);
+        bool any_single_column = false;
+        for (int x=0; x<dst.width; ++x) {
+          any_single_column = any_single_column || wx.single[x];
+        }
+        vector<float> tmp(src.width), tmp_int(src.width);
+        for (int y=0; y<dst.height; ++y) {
+          resizeRowPass(src, wy, y, tmp.begin());
+          bool use_int = any_single_column && !wy.single[y];
+          if (use_int) resizeRowPass(src, wy_int, y, tmp_int.begin());
+          float *dst_row = dst.row(y);
+          for (int x=0; x<dst.width; ++x) {
+            const float *t = (use_int && wx.single[x]) ? tmp_int.begin() : tmp.begin();
+            float sum = 0.0f;
+            for (int i=wx.first[x]; i<wx.first[x+1]; ++i) {
+              sum += wx.w[i] * t[wx.idx[i]];
+            }
+            dst_row[x*dst.col_stride] = sum;
+          }
+        }
+      }
+
+      // the same computation as Image<T>::shear_h
+      void shearKernel(const Pixels &src, const Pixels &dst, double angle,
+                       float default_value) {
+        const int w = src.width, h = src.height;
+        const bool positive = angle > 0;
+        if (!positive) angle = -angle;
+        for (int y=0; y<h; ++y) {
+          const int line = positive ? y : h-1-y;
+          const float *s = src.row(y);
+          float *d = dst.row(y);
+          const int sc = src.col_stride, dc = dst.col_stride;
+          float x = line*tan(angle);
+          float izq = x-int(x);
+          float der = 1.0-izq;
+          int x_int = int(x);
+          for (int i=0; i<x_int; ++i) d[i*dc] = default_value;
+          d[x_int*dc] = izq*default_value + der*s[0];
+          float prev = s[0];
+          for (int i=1; i<w; ++i) {
+            d[(x_int+i)*dc] = izq*prev + der*s[i*sc];
+            prev = s[i*sc];
+          }
+          d[(x_int+w)*dc] = izq*prev + der*default_value;
+          for (int i=x_int+w+1; i<dst.width; ++i) d[i*dc] = default_value;
+        }
+      }
+
+      // the same computation as Image<T>::affine_transform
+      void affineKernel(const Pixels &src, const Pixels &dst,
+                        const float *inverse, int xmin, int ymin,
+                        float default_value) {
+        for (int y=0; y<dst.height; ++y) {
+          float *d = dst.row(y);
+          const int sy = y + ymin;
+          for (int x=0; x<dst.width; ++x) {
+            const int sx = x + xmin;
+            float srcx = inverse[0]*sx+inverse[1]*sy+inverse[2];
+            float srcy = inverse[3]*sx+inverse[4]*sy+inverse[5];
+            d[x*dst.col_stride] = src.bilinear(srcx, srcy, default_value);
+          }
+        }
+      }
+
+    } // anonymous namespace
+
+    BatchPreprocessor::Step::Step(StepType type) :
+      type(type), radius(0), width(0), height(0), k(0.0f), r(0.0f),
+      min_threshold(0.0f), max_threshold(0.0f), default_value(0.0f),
+      ascender_ratio(0.0f), descender_ratio(0.0f), keep_aspect(false),
+      angle(0.0) {
+      for (int i=0; i<6; ++i) c[i] = inverse[i] = 0.0f;
+      c[0] = c[4] = inverse[0] = inverse[4] = 1.0f;
+    }
+
+    BatchPreprocessor::BatchPreprocessor() : Referenced(), compiled(true) {
+    }
+
+    BatchPreprocessor::~BatchPreprocessor() {
+    }
+
+    void BatchPreprocessor::addBinarizeSauvola(int radius, float k, float r) {
+      Step step(BINARIZE_SAUVOLA);
+      step.radius = radius;
+      step.k = k;
+      step.r = r;
+      steps.push_back(step);
+      compiled = false;
+    }
+
+    void BatchPreprocessor::addBinarizeNiblack(int radius, float k,
+                                               float min_threshold,
+                                               float max_threshold) {
+      Step step(BINARIZE_NIBLACK);
+      step.radius = radius;
+      step.k = k;
+      step.min_threshold = min_threshold;
+      step.max_threshold = max_threshold;
+      steps.push_back(step);
+      compiled = false;
+    }
+
+    void BatchPreprocessor::addBinarizeNiblackSimple(int radius, float k) {
+      Step step(BINARIZE_NIBLACK_SIMPLE);
+      step.radius = radius;
+      step.k = k;
+      steps.push_back(step);
+      compiled = false;
+    }
+
+    void BatchPreprocessor::addResize(int width, int height) {
+      if (width <= 0 && height <= 0) {
+        ERROR_EXIT(128, "Resize needs a positive width or height\n");
+      }
+      Step step(RESIZE);
+      step.width = width;
+      step.height = height;
+      steps.push_back(step);
+      compiled = false;
+    }
+
+    void BatchPreprocessor::addShearH(double angle, float default_value) {
+      Step step(SHEAR_H);
+      step.angle = angle;
+      step.default_value = default_value;
+      // the shear as an affine transform, the translation is irrelevant
+      // because outputs are cropped to the bounding box
+      step.c[1] = static_cast<float>(tan(angle));
+      step.inverse[1] = -step.c[1];
+      steps.push_back(step);
+      compiled = false;
+    }
+
+    void BatchPreprocessor::addAffine(Basics::AffineTransform2D *trans,
+                                      float default_value) {
+      Step step(AFFINE);
+      step.default_value = default_value;
+      AprilUtils::SharedPtr<MatrixFloat> direct_mat(trans);
+      if (!direct_mat->getIsContiguous()) direct_mat = direct_mat->clone();
+      AprilUtils::SharedPtr<MatrixFloat> inverse_mat =
+        AprilMath::MatrixExt::LAPACK::matInv(trans);
+      if (!inverse_mat->getIsContiguous()) inverse_mat = inverse_mat->clone();
+      const float *direct  = direct_mat->getRawDataAccess()->getPPALForRead();
+      const float *inverse = inverse_mat->getRawDataAccess()->getPPALForRead();
+      for (int i=0; i<6; ++i) {
+        step.c[i] = direct[i];
+        step.inverse[i] = inverse[i];
+      }
+      steps.push_back(step);
+      compiled = false;
+    }
+
+    void BatchPreprocessor::addNormalizeSize(float ascender_ratio,
+                                             float descender_ratio,
+                                             int dst_height,
+                                             bool keep_aspect) {
+      Step step(NORMALIZE_SIZE);
+      step.ascender_ratio = ascender_ratio;
+      step.descender_ratio = descender_ratio;
+      step.height = dst_height;
+      step.keep_aspect = keep_aspect;
+      steps.push_back(step);
+      compiled = false;
+    }
+
+    bool BatchPreprocessor::needsLineMatrices() const {
+      for (unsigned int i=0; i<steps.size(); ++i) {
+        if (steps[i].type == NORMALIZE_SIZE) return true;
+      }
+      return false;
+    }
+
+    void BatchPreprocessor::compile() {
+      if (compiled) return;
+      vector<Step> fused;
+      unsigned int i = 0;
+      while (i < steps.size()) {
+        const Step &step = steps[i];
+        // resizes are never fused, every area resampling changes the pixels
+        // seen by the next one
+        if (step.type == SHEAR_H || step.type == AFFINE) {
+          // pixels out of the image take the default value of the step, so
+          // only steps with the same default value are fused
+          unsigned int j = i + 1;
+          while (j < steps.size() &&
+                 (steps[j].type == SHEAR_H || steps[j].type == AFFINE) &&
+                 steps[j].default_value == step.default_value) ++j;
+          if (j - i == 1) {
+            fused.push_back(step);
+          }
+          else {
+            // a run of geometric steps is resampled only once, by bilinear
+            // interpolation with the composed transform
+            Step affine(AFFINE);
+            affine.default_value = step.default_value;
+            for (unsigned int p=i; p<j; ++p) {
+              compose(steps[p].c, affine.c, affine.c);
+              compose(affine.inverse, steps[p].inverse, affine.inverse);
+            }
+            fused.push_back(affine);
+          }
+          i = j;
+        }
+        else {
+          fused.push_back(step);
+          ++i;
+        }
+      }
+      steps.swap(fused);
+      compiled = true;
+    }
+
+    BatchPreprocessor::Shape
+    BatchPreprocessor::computeShape(const Step &step,
+                                    int width, int height) const {
+      using AprilUtils::max;
+      using AprilUtils::min;
+      Shape shape;
+      shape.width  = width;
+      shape.height = height;
+      shape.xmin = shape.ymin = 0;
+      switch(step.type) {
+      case RESIZE:
+        shape.width  = step.width;
+        shape.height = step.height;
+        if (shape.width <= 0) {
+          shape.width = max(1, int(roundf(float(width)*step.height/height)));
+        }
+        if (shape.height <= 0) {
+          shape.height = max(1, int(roundf(float(height)*step.width/width)));
+        }
+        break;
+      case SHEAR_H:
+        if (step.angle > 0) shape.width = width+int(height*tan(step.angle))+1;
+        else shape.width = width+int(height*tan(-step.angle))+1;
+        break;
+      case AFFINE:
+        {
+          const float *c = step.c;
+          int x0 = int(roundf(c[2]));
+          int y0 = int(roundf(c[5]));
+          int x1 = int(roundf((width-1) *c[0] + c[2]));
+          int y1 = int(roundf((width-1) *c[3] + c[5]));
+          int x2 = int(roundf((height-1)*c[1] + c[2]));
+          int y2 = int(roundf((height-1)*c[4] + c[5]));
+          int x3 = int(roundf((width-1) *c[0] + (height-1)*c[1] + c[2]));
+          int y3 = int(roundf((width-1) *c[3] + (height-1)*c[4] + c[5]));
+          int xmax = max(x0, max(x1, max(x2, x3)));
+          int ymax = max(y0, max(y1, max(y2, y3)));
+          shape.xmin = min(x0, min(x1, min(x2, x3)));
+          shape.ymin = min(y0, min(y1, min(y2, y3)));
+          shape.width  = xmax - shape.xmin + 1;
+          shape.height = ymax - shape.ymin + 1;
+        }
+        break;
+      case NORMALIZE_SIZE:
+        if (step.height >= 0) shape.height = step.height;
+        break;
+      default:
+        ;
+      }
+      return shape;
+    }
+
+    void BatchPreprocessor::checkLineMatrix(MatrixFloat *line_mat,
+                                            int width) const {
+      if (line_mat == 0) {
+        ERROR_EXIT(128, "normalize_size step needs line matrices\n");
+      }
+      if (line_mat->getNumDim() != 2 || line_mat->getDimSize(0) != width ||
+          line_mat->getDimSize(1) != 4) {
+        ERROR_EXIT1(128, "Incorrect line matrix size, expected %d x 4\n",
+                    width);
+      }
+    }
+
+    void BatchPreprocessor::runStep(const Step &step, const Shape &shape,
+                                    ImageFloat *src, MatrixFloat *line_mat,
+                                    ImageFloat *dst) const {
+      switch(step.type) {
+      case BINARIZE_SAUVOLA:
+        Imaging::binarize_sauvola_into(src, dst, step.radius, step.k, step.r);
+        break;
+      case BINARIZE_NIBLACK:
+        Imaging::binarize_niblack_into(src, dst, step.radius, step.k,
+                                       step.min_threshold, step.max_threshold);
+        break;
+      case BINARIZE_NIBLACK_SIMPLE:
+        Imaging::binarize_niblack_simple_into(src, dst, step.radius, step.k);
+        break;
+      case RESIZE:
+        resizeKernel(Pixels(src), Pixels(dst));
+        break;
+      case SHEAR_H:
+        shearKernel(Pixels(src), Pixels(dst), step.angle, step.default_value);
+        break;
+      case AFFINE:
+        affineKernel(Pixels(src), Pixels(dst), step.inverse,
+                     shape.xmin, shape.ymin, step.default_value);
+        break;
+      case NORMALIZE_SIZE:
+        {
+          Pixels pixels(dst);
+          for (int y=0; y<pixels.height; ++y) {
+            float *row = pixels.row(y);
+            for (int x=0; x<pixels.width; ++x) row[x*pixels.col_stride] = 0.0f;
+          }
+          normalize_size_into(src, line_mat, dst, step.ascender_ratio,
+                              step.descender_ratio, step.keep_aspect);
+        }
+        break;
+      default:
+        ERROR_EXIT(256, "Unknown step type\n");
+      }
+    }
+
+    void BatchPreprocessor::apply(int n, ImageFloat **images,
+                                  MatrixFloat **line_mats,
+                                  ImageFloat **results) {
+      compile();
+      const int num_steps = getNumSteps();
+      const int chunk_size = CHUNK_FACTOR * OMPUtils::get_num_threads();
+      // buffers[i*(num_steps+1) + s] is the input of step s for image i
+      vector<ImageFloat*> buffers(chunk_size * (num_steps + 1));
+      vector<Shape> shapes(chunk_size * num_steps);
+      for (int base = 0; base < n; base += chunk_size) {
+        const int m = AprilUtils::min(chunk_size, n - base);
+        // allocation of all the chunk images, the memory pool of matrices
+        // is not thread-safe, so it is done before the parallel section
+        for (int i=0; i<m; ++i) {
+          ImageFloat **img_buffers = buffers.begin() + i*(num_steps + 1);
+          img_buffers[0] = images[base + i];
+          int width  = images[base + i]->width();
+          int height = images[base + i]->height();
+          for (int s=0; s<num_steps; ++s) {
+            if (steps[s].type == NORMALIZE_SIZE) {
+              checkLineMatrix(line_mats ? line_mats[base + i] : 0, width);
+            }
+            Shape &shape = shapes[i*num_steps + s];
+            shape = computeShape(steps[s], width, height);
+            width  = shape.width;
+            height = shape.height;
+            int dims[2] = { height, width };
+            img_buffers[s+1] = new ImageFloat(new MatrixFloat(2, dims));
+          }
+          if (num_steps == 0) img_buffers[0] = images[base + i]->clone();
+        }
+#ifndef NO_OMP
+#pragma omp parallel for schedule(dynamic, 1) if(m > 1)
+#endif
+        for (int i=0; i<m; ++i) {
+          ImageFloat **img_buffers = buffers.begin() + i*(num_steps + 1);
+          MatrixFloat *line_mat = line_mats ? line_mats[base + i] : 0;
+          for (int s=0; s<num_steps; ++s) {
+            runStep(steps[s], shapes[i*num_steps + s], img_buffers[s],
+                    line_mat, img_buffers[s+1]);
+          }
+        }
+        // intermediate images are released in the same serial way
+        for (int i=0; i<m; ++i) {
+          ImageFloat **img_buffers = buffers.begin() + i*(num_steps + 1);
+          for (int s=1; s<num_steps; ++s) delete img_buffers[s];
+          results[base + i] = img_buffers[num_steps];
+        }
+      }
+    }
+
+    MatrixFloat *BatchPreprocessor::applyPacked(int n, ImageFloat **images,
+                                                MatrixFloat **line_mats) {
+      if (n <= 0) ERROR_EXIT(128, "Needs at least one image\n");
+      vector<ImageFloat*> results(n);
+      apply(n, images, line_mats, results.begin());
+      const int width = results[0]->width(), height = results[0]->height();
+      bool ok = true;
+      for (int i=1; i<n && ok; ++i) {
+        ok = results[i]->width() == width && results[i]->height() == height;
+      }
+      MatrixFloat *packed = 0;
+      if (ok) {
+        int dims[2] = { n, width*height };
+        packed = new MatrixFloat(2, dims);
+        float *dst = packed->getRawDataAccess()->getPPALForWrite();
+        for (int i=0; i<n; ++i) {
+          Pixels pixels(results[i]);
+          for (int y=0; y<height; ++y) {
+            const float *row = pixels.row(y);
+            for (int x=0; x<width; ++x) *dst++ = row[x*pixels.col_stride];
+          }
+        }
+      }
+      for (int i=0; i<n; ++i) delete results[i];
+      if (!ok) ERROR_EXIT(128, "All the images must have the same size to be packed\n");
+      return packed;
+    }
+
+  } // namespace OffLineTextPreprocessing
+} // namespace OCR
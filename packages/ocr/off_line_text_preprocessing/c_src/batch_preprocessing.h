@@ -0,0 +1,135 @@
+/*
+ * This file is part of APRIL-ANN toolkit (A
+ * Pattern Recognizer In Lua with Artificial Neural Networks).
+ *
+ * Copyright 2015, Francisco Zamora-Martinez
+ *
+ * The APRIL-ANN toolkit is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3 as
+ * published by the Free Software Foundation
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this library; if not, write to the Free Software Foundation,
+ * Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ *
+ */
+#ifndef BATCH_PREPROCESSING_H
+#define BATCH_PREPROCESSING_H
+
+#include "affine_transform.h"
+#include "referenced.h"
+#include "utilImageFloat.h"
+#include "vector.h"
+
+namespace OCR {
+  namespace OffLineTextPreprocessing {
+
+    /**
+     * @brief Applies a chain of preprocessing steps to a batch of images.
+     *
+     * The chain is declared step by step (binarizations, resize, shear,
+     * affine transforms and size normalization) and compiled before its
+     * first use. Compilation fuses runs of two or more geometric steps
+     * (shear_h and affine) with the same default value into a single affine
+     * transform, so pixels are resampled only once. This is intended: the
+     * result is the one of Image::affine_transform with the composed
+     * transform, which differs from the chain of per-image calls by their
+     * intermediate interpolation and cropping. Other steps are not fused.
+     *
+     * Images are processed in chunks. For every chunk all the output and
+     * intermediate images are allocated in advance, and the steps are
+     * executed in parallel over the images of the chunk using OMP. Kernels
+     * work with row pointers over the image matrices instead of per-pixel
+     * iterators.
+     */
+    class BatchPreprocessor : public Referenced {
+    public:
+      enum StepType {
+        BINARIZE_SAUVOLA,        ///< Imaging::binarize_sauvola
+        BINARIZE_NIBLACK,        ///< Imaging::binarize_niblack
+        BINARIZE_NIBLACK_SIMPLE, ///< Imaging::binarize_niblack_simple
+        RESIZE,                  ///< Separable area resampling, as Image::resize
+        SHEAR_H,                 ///< Image::shear_h
+        AFFINE,                  ///< Image::affine_transform
+        NORMALIZE_SIZE           ///< normalize_size with a line matrix
+      };
+
+      BatchPreprocessor();
+      virtual ~BatchPreprocessor();
+
+      void addBinarizeSauvola(int radius, float k, float r);
+      void addBinarizeNiblack(int radius, float k,
+                              float min_threshold, float max_threshold);
+      void addBinarizeNiblackSimple(int radius, float k);
+      /// A non positive width or height is computed keeping the aspect ratio.
+      void addResize(int width, int height);
+      void addShearH(double angle, float default_value);
+      /// The transform maps source coordinates into destination coordinates.
+      void addAffine(Basics::AffineTransform2D *trans, float default_value);
+      /// Needs a line matrix (width x 4) for every image in apply methods.
+      void addNormalizeSize(float ascender_ratio, float descender_ratio,
+                            int dst_height, bool keep_aspect);
+
+      /// Fuses compatible steps, it is called by apply methods when needed.
+      void compile();
+
+      int getNumSteps() const { return static_cast<int>(steps.size()); }
+      bool needsLineMatrices() const;
+
+      /**
+       * @brief Processes n images writing the new images into results.
+       *
+       * @param line_mats - An array with n line matrices, it can be NULL
+       * when the chain has no NORMALIZE_SIZE step.
+       */
+      void apply(int n, Imaging::ImageFloat **images,
+                 Basics::MatrixFloat **line_mats,
+                 Imaging::ImageFloat **results);
+
+      /**
+       * @brief Processes n images and packs them into a matrix with one
+       * image by row. All the resulting images must have the same size.
+       */
+      Basics::MatrixFloat *applyPacked(int n, Imaging::ImageFloat **images,
+                                       Basics::MatrixFloat **line_mats);
+
+    private:
+      struct Step {
+        StepType type;
+        int radius, width, height;
+        float k, r, min_threshold, max_threshold, default_value;
+        float ascender_ratio, descender_ratio;
+        bool keep_aspect;
+        double angle;
+        /// Direct and inverse affine transforms, first two rows.
+        float c[6], inverse[6];
+        Step(StepType type = RESIZE);
+      };
+
+      /// Size of a step output, and offset of affine transform outputs.
+      struct Shape {
+        int width, height, xmin, ymin;
+      };
+
+      /// Number of images processed together, in number of threads.
+      static const int CHUNK_FACTOR = 4;
+
+      AprilUtils::vector<Step> steps;
+      bool compiled;
+
+      Shape computeShape(const Step &step, int width, int height) const;
+      void runStep(const Step &step, const Shape &shape,
+                   Imaging::ImageFloat *src, Basics::MatrixFloat *line_mat,
+                   Imaging::ImageFloat *dst) const;
+      void checkLineMatrix(Basics::MatrixFloat *line_mat, int width) const;
+    };
+
+  } // namespace OffLineTextPreprocessing
+} // namespace OCR
+
+#endif // BATCH_PREPROCESSING_H
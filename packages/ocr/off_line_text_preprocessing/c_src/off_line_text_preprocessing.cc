@@ -10,6 +10,7 @@
 #include <cstdio>
 #include "interest_points.h"
 
+using AprilMath::MatrixExt::Initializers::matFill;
 using namespace AprilUtils;
 using namespace Basics;
 using namespace Imaging;
@@ -418,24 +419,24 @@ namespace OCR {
     }
 
 
-    ImageFloat *normalize_size (ImageFloat     *source,
+    void normalize_size_into (ImageFloat     *source,
             MatrixFloat *line_mat,
+            ImageFloat     *result,
             float           ascender_ratio,
             float           descender_ratio,
-            int dst_height,
             bool keep_aspect
             )
     {
         // Precondition: upper_baseline and lower_baseline must contain, at least, one point each
         int width = source->width();
         int height = source->height();
+        int dst_height = result->height();
 
         MatrixFloat::random_access_iterator line_it(line_mat);
 
         assert(line_mat->getDimSize(0) == width && "The number of columns does not fit");
         assert(line_mat->getDimSize(1) == 4 && "There are no 3 areas on the image");
-        if (dst_height < 0)
-            dst_height = source->height();
+        assert(result->width() == width && "The result width does not fit");
 
         int ascender_size  = int(roundf(ascender_ratio*dst_height));
         int descender_size = int(roundf(descender_ratio*dst_height));
@@ -457,9 +458,6 @@ namespace OCR {
         int dst_upper = ascender_size;
         int dst_lower = ascender_size + body_size;
 
-        int dims[2] = {dst_height, width};
-        MatrixFloat *result_mat = new MatrixFloat(2, dims);
-        ImageFloat  *result = new ImageFloat(result_mat);
         for (int column = 0; column < width; column++) {
 
             float cur_upper = line_it(column, 1);
@@ -509,8 +507,25 @@ namespace OCR {
                 resize_index(source, result, column, cur_lower, bottom_cut, dst_lower, dst_desc);
 
         }
+    }
 
-
+    ImageFloat *normalize_size (ImageFloat     *source,
+            MatrixFloat *line_mat,
+            float           ascender_ratio,
+            float           descender_ratio,
+            int dst_height,
+            bool keep_aspect
+            )
+    {
+        if (dst_height < 0)
+            dst_height = source->height();
+        // resize_index accumulates partial rows, so the result starts at zero
+        int dims[2] = {dst_height, source->width()};
+        MatrixFloat *result_mat = new MatrixFloat(2, dims);
+        matFill(result_mat, 0.0f);
+        ImageFloat  *result = new ImageFloat(result_mat);
+        normalize_size_into(source, line_mat, result,
+                            ascender_ratio, descender_ratio, keep_aspect);
         return result;
     }
 
@@ -49,6 +49,16 @@ namespace OCR {
               float           descender_ratio,
               int dst_height,
               bool keep_aspect);
+
+      /// Same as normalize_size, but the result is written into a
+      /// preallocated zero-filled image of the same width as source, its
+      /// height is the destination height.
+      void normalize_size_into (Imaging::ImageFloat     *source,
+              Basics::MatrixFloat *line_mat,
+              Imaging::ImageFloat *result,
+              float           ascender_ratio,
+              float           descender_ratio,
+              bool keep_aspect);
       AprilUtils::vector<AprilUtils::Point2D>* extract_points_from_image(Imaging::ImageFloat *pimg);
 
   }
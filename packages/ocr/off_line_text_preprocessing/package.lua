@@ -1,6 +1,6 @@
  package{ name = "ocr.off_line_text_preprocessing",
    version = "1.0",
-   depends = { "util", "Image", "matrix", "interest_points" },
+   depends = { "util", "Image", "matrix", "interest_points", "binarization_filter" },
    keywords = { "off_line_text_preprocessing" },
    description = "Handwritten text preprocessing utilities",
    -- targets como en ant
@@ -19,6 +19,14 @@
      copy{ file= "c_src/*.h", dest_dir = "include" },
      provide_bind{ file = "binding/bind_off_line_text_preprocessing.lua.cc", dest_dir = "include" }
    },
+   target{
+     name = "test",
+     lua_unit_test{
+       file={
+         "test/test_batch_preprocessing.lua",
+       },
+     },
+   },
    target{
      name = "build",
      depends = "provide",
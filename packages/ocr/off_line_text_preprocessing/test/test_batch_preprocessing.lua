@@ -0,0 +1,113 @@
+local check = utest.check
+local T = utest.test
+--
+local preprocessor = ocr.off_line_text_preprocessing.batch_preprocessor
+
+local function random_images(n, rnd)
+  local images = {}
+  for i=1,n do
+    local h,w = 20 + 3*i, 35 + 5*i
+    images[i] = Image(matrix(h,w):uniformf(0, 1, rnd))
+  end
+  return images
+end
+
+-- compares the batch engine with the given per-image function
+local function check_chain(steps, images, per_image, line_mats)
+  local pre = preprocessor(steps)
+  local results = pre:apply(images, line_mats)
+  check.eq(#results, #images)
+  for i,img in ipairs(images) do
+    local expected = per_image(img, line_mats and line_mats[i])
+    check.eq(results[i]:matrix(), expected:matrix())
+  end
+  return pre
+end
+
+T("BinarizationTest", function()
+    local images = random_images(9, random(1234))
+    check_chain({ { "binarize_sauvola", radius=3, k=0.3, r=0.5 } }, images,
+      function(img) return img:binarize_sauvola(3, 0.3, 0.5) end)
+    check_chain({ { "binarize_niblack", radius=4, k=0.2, min=0.1, max=0.9 } },
+      images,
+      function(img) return img:binarize_niblack(4, 0.2, 0.1, 0.9) end)
+    check_chain({ { "binarize_niblack_simple", radius=2, k=0.1 } }, images,
+      function(img) return img:binarize_niblack_simple(2, 0.1) end)
+end)
+
+T("ResizeTest", function()
+    local images = random_images(9, random(4567))
+    -- every resize is applied, they are not fused
+    local pre = check_chain({ { "resize", width=50, height=12 },
+                              { "resize", width=17, height=30 } }, images,
+      function(img) return img:resize(50, 12):resize(17, 30) end)
+    check.eq(pre:get_num_steps(), 2)
+    -- the height keeps the aspect ratio
+    check_chain({ { "resize", width=24 } }, images,
+      function(img)
+        local w,h = img:geometry()
+        return img:resize(24, math.max(1, math.floor(h*24/w + 0.5)))
+    end)
+end)
+
+T("GeometricTest", function()
+    local images = random_images(9, random(8910))
+    local angle = 0.3
+    local trans = AffineTransform2D():rotate(0.2):scale(1.2, 0.9)
+    check_chain({ { "shear_h", angle=angle, default=0.25 } }, images,
+      function(img) return img:shear_h(angle, "rad", 0.25) end)
+    check_chain({ { "shear_h", angle=-angle, default=0.25 } }, images,
+      function(img) return img:shear_h(-angle, "rad", 0.25) end)
+    check_chain({ { "affine", transform=trans, default=0.5 } }, images,
+      function(img) return (img:affine_transform(trans, 0.5)) end)
+    -- a run with the same default value is one affine transform
+    local composed = AffineTransform2D():shear(angle, 0):rotate(0.2):scale(1.2, 0.9)
+    local pre = check_chain({ { "shear_h", angle=angle, default=1 },
+                              { "affine", transform=trans, default=1 } },
+      images,
+      function(img) return (img:affine_transform(composed, 1)) end)
+    check.eq(pre:get_num_steps(), 1)
+    -- different default values are not fused
+    local pre = check_chain({ { "shear_h", angle=angle, default=1 },
+                              { "affine", transform=trans, default=0 } },
+      images,
+      function(img)
+        return (img:shear_h(angle, "rad", 1):affine_transform(trans, 0))
+    end)
+    check.eq(pre:get_num_steps(), 2)
+end)
+
+T("NormalizeSizeTest", function()
+    local images = random_images(5, random(1112))
+    local line_mats = {}
+    for i,img in ipairs(images) do
+      local w,h = img:geometry()
+      line_mats[i] = matrix(w, 4)
+      line_mats[i]:select(2,1):fill(1)
+      line_mats[i]:select(2,2):fill(math.floor(h/3))
+      line_mats[i]:select(2,3):fill(math.floor(2*h/3))
+      line_mats[i]:select(2,4):fill(h-2)
+    end
+    check_chain({ { "normalize_size", ascender_ratio=0.25,
+                    descender_ratio=0.2, dst_height=32 } }, images,
+      function(img, line_mat)
+        return ocr.off_line_text_preprocessing.
+          normalize_from_matrix(img, 0.25, 0.2, line_mat, 32)
+      end,
+      line_mats)
+end)
+
+T("PackedTest", function()
+    local images = random_images(11, random(1314))
+    local pre = preprocessor{ { "binarize_niblack_simple", radius=2 },
+                              { "resize", width=16, height=8 } }
+    local packed = pre:apply_packed(images)
+    local results = pre:apply(images)
+    check.eq(packed:dim(1), #images)
+    check.eq(packed:dim(2), 16*8)
+    for i,img in ipairs(images) do
+      local expected = img:binarize_niblack_simple(2):resize(16, 8)
+      check.eq(results[i]:matrix(), expected:matrix())
+      check.eq(packed[i], expected:matrix():clone():rewrap(16*8))
+    end
+end)
@@ -0,0 +1,184 @@
+trainable = trainable or {} -- global environment
+trainable.checkpoint = trainable.checkpoint or {} -- global environment
+local checkpoint = trainable.checkpoint
+
+-------------------------------------------------------------------------------
+
+--[[
+  Binary checkpoint container. The file is written with util.mmap.writer and
+  contains:
+
+  - A header string and the format version.
+  - A Lua chunk which returns the object, where matrices are references as
+    T[i]. It is produced by util.to_lua_string with a tensor sink installed
+    at matrix.__generic__.__tensor_sink__.
+  - The number of tensors, and every tensor as its class name followed by its
+    raw mmap data, aligned to 64 bytes.
+
+  Loading maps the file with a private (copy on write) mapping, so tensors are
+  paged in lazily and modifying them doesn't change the file. Files are
+  written to a temporary path and renamed, so a checkpoint which is being
+  used by a loaded object is never truncated.
+]]
+
+local HEADER  = "APRIL-ANN checkpoint"
+local VERSION = 1
+
+-- pending asynchronous saves indexed by path
+local pending = {}
+
+local tensor_classes = {
+  ["matrix"] = matrix,
+  ["matrix.sparse"] = matrix.sparse,
+}
+
+-- returns a Lua expression string of obj and the list of stored tensors
+local function serialize(obj, format)
+  local generic = matrix.__generic__
+  assert(not generic.__tensor_sink__, "Nested checkpoints are not allowed")
+  local tensors,ids = {},{}
+  generic.__tensor_sink__ = function(m)
+    if not tensor_classes[class.of(m).meta_instance.id] then return nil end
+    local id = ids[m]
+    if not id then
+      -- views of a larger memory block, as flat weights, are written compact
+      if class.of(m).meta_instance.id == "matrix" and
+      (m:offset() ~= 0 or m:data():size() ~= m:size()) then
+        table.insert(tensors, m:clone())
+      else
+        table.insert(tensors, m)
+      end
+      id = #tensors
+      ids[m] = id
+    end
+    return string.format("T[%d]", id)
+  end
+  local ok,result = pcall(util.to_lua_string, obj, format)
+  generic.__tensor_sink__ = nil
+  if not ok then error(result) end
+  return result,tensors
+end
+
+local function write(obj, path, format)
+  local chunk,tensors = serialize(obj, format)
+  local tmp = path .. ".tmp"
+  local w = util.mmap.writer(tmp)
+  w:put_string(HEADER)
+  w:put_uint(VERSION)
+  w:put_string("return " .. chunk)
+  w:put_uint(#tensors)
+  for _,m in ipairs(tensors) do
+    w:put_string(class.of(m).meta_instance.id)
+    m:toMMap(w)
+  end
+  w:close()
+  assert(os.rename(tmp, path))
+end
+
+local function wait(handle)
+  if handle.status == nil then
+    local _,status = util.waitpid(handle.pid)
+    handle.status = status
+    if pending[handle.path] == handle then pending[handle.path] = nil end
+  end
+  april_assert(handle.status == 0, "Unable to save checkpoint %s",
+               handle.path)
+  return true
+end
+
+-------------------------------------------------------------------------------
+
+checkpoint.save =
+  april_doc{
+    class = "function",
+    summary = "Saves an object into a binary checkpoint file",
+    description = {
+      "The object is serialized as with util.serialize, but float",
+      "matrices are written raw out of the Lua chunk. In async mode,",
+      "the process is forked and the child writes the file, so the",
+      "checkpoint is a copy on write snapshot of the object and the",
+      "caller can continue modifying it. Saves to the same path are",
+      "serialized, a pending one is waited before starting another.",
+    },
+    params = {
+      "Any object which can be serialized by util.serialize",
+      "A filename",
+      {
+        "A table with options [optional]: async=false, and",
+        "format='binary' for matrices which are not written raw",
+      },
+    },
+    outputs = {
+      "In async mode, a handle with a wait() method which returns",
+      "true or raises an error when the child process fails",
+    },
+  } ..
+  function(obj, path, params)
+    local params = get_table_fields(
+      {
+        async = { type_match="boolean", mandatory=false, default=false },
+        format = { type_match="string", mandatory=false, default="binary" },
+      }, params or {})
+    if pending[path] then wait(pending[path]) end
+    if not params.async then
+      write(obj, path, params.format)
+      return
+    end
+    -- avoid duplicated output when the child flushes its buffers
+    io.stdout:flush()
+    io.stderr:flush()
+    local id,pid = util.split_process(2)
+    if id == 2 then
+      -- the OpenMP thread pool of the parent doesn't exist in the child
+      util.omp_set_num_threads(1)
+      local ok,msg = pcall(write, obj, path, params.format)
+      if not ok then
+        io.stderr:write(tostring(msg), "\n")
+        io.stderr:flush()
+        os.exit(1)
+      end
+      os.exit(0)
+    end
+    local handle = { pid = pid, path = path, wait = wait }
+    pending[path] = handle
+    return handle
+  end
+
+checkpoint.wait_all =
+  april_doc{
+    class = "function",
+    summary = "Waits all pending asynchronous saves",
+  } ..
+  function()
+    for _,handle in pairs(pending) do wait(handle) end
+  end
+
+checkpoint.load =
+  april_doc{
+    class = "function",
+    summary = "Loads an object from a binary checkpoint file",
+    description = {
+      "Matrices are mapped from the file in copy on write mode, so",
+      "their data is read lazily and the file is never modified.",
+    },
+    params = { "A filename" },
+    outputs = { "The loaded object" },
+  } ..
+  function(path)
+    if pending[path] then wait(pending[path]) end
+    local r = util.mmap.reader(path, true, false)
+    april_assert(r:get_string() == HEADER, "%s is not a checkpoint", path)
+    local version = r:get_uint()
+    april_assert(version == VERSION,
+                 "Unsupported checkpoint version %d at %s", version, path)
+    local chunk = r:get_string()
+    local T = {}
+    for i=1,r:get_uint() do
+      local cls = april_assert(tensor_classes[r:get_string()],
+                               "Unknown tensor class at %s", path)
+      T[i] = cls.fromMMap(r)
+    end
+    local env = setmetatable({ T = T }, { __index = _G })
+    local f = assert(load(chunk, "@" .. path, "t", env))
+    return f()
+  end
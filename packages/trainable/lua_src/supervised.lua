@@ -104,7 +104,7 @@ trainable_supervised_trainer.constructor =
       --     weights:insert(name,m:clone())
       --   end
       -- end
-      self:build{ weights = weights }
+      self:build{ weights = weights, flat = t.flat }
     else
       -- Constructor of a new object
       local ann_component,loss_function,bunch_size,optimizer,smooth_gradients,max_gradients_norm = ...
@@ -387,6 +387,9 @@ function trainable_supervised_trainer_methods:to_lua_string(format)
     table.insert(t, tostring(self.max_gradients_norm))
     table.insert(t, ",\n")
   end
+  if self.flat then
+    table.insert(t, "flat=true,\n")
+  end
   table.insert(t, "}")
   return table.concat(t, "")
 end
@@ -605,6 +608,42 @@ trainable_supervised_trainer_methods.get_weights_table =
 
 ------------------------------------------------------------------------
 
+trainable_supervised_trainer_methods.get_flat_weights =
+  april_doc{
+    class = "method",
+    summary = "Returns the flat matrix which contains all weights",
+    description = {
+      "It is only available when the trainer is built with flat=true,",
+      "and every weights matrix is a view of this flat matrix.",
+    },
+    outputs = { "A one dimensional matrix or nil" },
+  } ..
+  function(self)
+    if not self.is_built then
+      error("Needs execution of build method")
+    end
+    return self.flat_weights
+  end
+
+trainable_supervised_trainer_methods.get_flat_gradients =
+  april_doc{
+    class = "method",
+    summary = "Returns the flat matrix which contains all gradients",
+    description = {
+      "It is only available when the trainer is built with flat=true,",
+      "it has the same layout as get_flat_weights() matrix.",
+    },
+    outputs = { "A one dimensional matrix or nil" },
+  } ..
+  function(self)
+    if not self.is_built then
+      error("Needs execution of build method")
+    end
+    return self.flat_grads
+  end
+
+------------------------------------------------------------------------
+
 trainable_supervised_trainer_methods.randomize_weights =
   april_doc{
     class = "method",
@@ -686,6 +725,7 @@ trainable_supervised_trainer_methods.build =
       ["weights"] = "A table weights_name=>matrix [optional]",
       ["input"]   = "The input size of the component [optional]",
       ["output"]  = "The output size of the component [optional]",
+      ["flat"]    = "A boolean, if true weights and gradients are views of one flat matrix [optional]",
     },
     outputs = {
       "The caller object",
@@ -699,17 +739,36 @@ trainable_supervised_trainer_methods.build =
         weights = { mandatory = false, default=nil, type_match="table" },
         input   = { type_match="number", mandatory = false, default=nil },
         output  = { type_match="number", mandatory = false, default=nil },
+        flat    = { type_match="boolean", mandatory = false,
+                    default=self.flat or false },
       }, t or {})
     self.weight_grads  = {}
     self.weights_table = params.weights or {}
+    self.flat          = params.flat or nil
+    self.flat_weights  = nil
+    self.flat_grads    = nil
     -- BUILD CALL
     _,
     self.weights_table,
     self.components_table = self.ann_component:build{
       input   = params.input,
       output  = params.output,
-      weights = self.weights_table, }
+      weights = self.weights_table,
+      flat    = self.flat, }
     --
+    if self.flat and next(self.weights_table) then
+      -- components which don't support flat weights are flattened here, and
+      -- the gradients are allocated as views of another flat matrix
+      if not ann.connections.get_flat(self.weights_table) then
+        ann.connections.flatten(self.weights_table)
+        self.ann_component:build{ input   = params.input,
+                                  output  = params.output,
+                                  weights = self.weights_table }
+      end
+      self.flat_weights = ann.connections.get_flat(self.weights_table)
+      self.weight_grads,self.flat_grads =
+        ann.connections.flat_like(self.weights_table)
+    end
     self.weights_order = iterator(table.keys(self.weights_table)):table()
     table.sort(self.weights_order)
     self.components_order = {}
@@ -822,7 +881,8 @@ trainable_supervised_trainer_methods.train_step =
           if needs_gradient then
             local gradient=model:backprop(loss:gradient(output,target))
             --
-            md.zeros(grads)
+            local flat_grads = self.flat_grads
+            if flat_grads then flat_grads:zeros() else md.zeros(grads) end
             --
             local grads = model:compute_gradients(grads)
             self.weight_grads = grads
@@ -836,10 +896,15 @@ trainable_supervised_trainer_methods.train_step =
             end
             -- gradient explode control
             if max_gradients_norm then
-              local gradients_norm = matrix.dict.norm2(grads)
+              local gradients_norm = flat_grads and flat_grads:norm2() or
+                matrix.dict.norm2(grads)
               if gradients_norm > max_gradients_norm then
                 local ratio = max_gradients_norm / gradients_norm
-                matrix.dict.scal(grads, ratio)
+                if flat_grads then
+                  flat_grads:scal(ratio)
+                else
+                  matrix.dict.scal(grads, ratio)
+                end
               end
             end
             -- the loss, the gradients, and the loss matrix
@@ -1421,6 +1486,8 @@ trainable_supervised_trainer_methods.validate_dataset =
     params.loss               = nil
     params.mask_dataset       = nil
     params.bunch_size         = params.bunch_size or self.bunch_size
+    -- every bunch is consumed by validate_step before the next one
+    params.reuse_buffers      = true
     local bunch_mb_size = params.bunch_size * self:size() * 4
     -- set to ZERO the accumulated of loss
     loss:reset()
@@ -1512,6 +1579,7 @@ trainable_supervised_trainer_methods.use_dataset =
     params.bunch_size           = params.bunch_size or self.bunch_size 
     params.datasets             = { params.input_dataset }
     params.assert_pattern_sizes = { self:get_input_size() }
+    params.reuse_buffers        = true
     params.input_dataset, params.output_dataset = nil, nil
     local bunch_mb_size = params.bunch_size * self:size() * 4
     local ann_component = self.ann_component
@@ -1566,7 +1634,7 @@ trainable_supervised_trainer_methods.clone =
       obj:set_optimizer(self.optimizer:clone())
     end
     if #self.weights_order > 0 then
-      obj:build{ weights = md.clone(self.weights_table) }
+      obj:build{ weights = md.clone(self.weights_table), flat = self.flat }
     end
     -- add possible user functions
     for i,v in pairs(self) do
@@ -63,6 +63,7 @@ trainable.dataset_pair_iterator =
         replacement    = { type_match = "number", mandatory = false, default=nil },
         assert_input_size = { type_match = "number", mandatory = false, default=0 },
         assert_output_size = { type_match = "number", mandatory = false, default=0 },
+        reuse_buffers  = { type_match = "boolean", mandatory = false, default=false },
       }, t)
     -- ERROR CHECKING
     assert(params.input_dataset ~= not params.output_dataset,
@@ -105,6 +106,11 @@ trainable.dataset_multiple_iterator =
       "returning a token with bunch_size patterns.",
       "It admits the following traversals: sequential, shuffled,",
       "shuffled with replacement, shuffled with distribution.",
+      "When reuse_buffers=true, the bunches of dataset.token.wrapper",
+      "datasets are written into the same matrix at every iteration,",
+      "so a bunch is only valid until the next iteration. In any case,",
+      "bunches of contiguous patterns could share memory with the",
+      "dataset, so they must be taken as read-only.",
     },
   } ..
   function(t)
@@ -131,6 +137,7 @@ trainable.dataset_multiple_iterator =
         replacement    = { type_match = "number", mandatory = false, default=nil },
         assert_pattern_sizes = { type_match = "table", mandatory = false,
                                  default={ } },
+        reuse_buffers  = { type_match = "boolean", mandatory = false, default=false },
       }, t)
     -- ERROR CHECKING
     assert(not params.datasets or not params.distribution,
@@ -241,6 +248,19 @@ trainable.dataset_multiple_iterator =
 		       "Incorrect patternSize at dataset %d, found %d, expected %d",
 		       k, ds_psize, psize)
       end)
+    -- BUNCH BUFFERS, only for datasets which fill them in place; sparse
+    -- datasets recycle the previous bunch
+    local buffers = {}
+    local recycle = {}
+    if params.reuse_buffers then
+      for i,ds in ipairs(params.datasets) do
+        if is_a(ds, dataset.token.wrapper) then
+          buffers[i] = matrix(bunch_size, ds:patternSize())
+        elseif is_a(ds, dataset.token.sparse_matrix) then
+          recycle[i] = true
+        end
+      end
+    end
     --
     -- ITERATOR USING ds_idx_func
     local k=0
@@ -262,7 +282,10 @@ trainable.dataset_multiple_iterator =
         -- end condition, return nil
         if #bunch_indexes == 0 then cgarbage("collect") return end
         local data = {}
-        for i,v in ipairs(params.datasets) do data[i] = v:getPatternBunch(bunch_indexes) end
+        for i,v in ipairs(params.datasets) do
+          data[i] = v:getPatternBunch(bunch_indexes, buffers[i])
+          if recycle[i] then buffers[i] = data[i] end
+        end
         insert(data, bunch_indexes)
         k=k+bunch_mb_size
         if k >= MAX_SIZE_WO_COLLECT_GARBAGE then cgarbage("collect") k=0 end
@@ -285,8 +308,10 @@ trainable.dataset_multiple_iterator =
         until not idx or #bunch_indexes==bunch_size
         -- end condition, return nil
         if #bunch_indexes == 0 then cgarbage("collect") return end
-        local bunch1 = ds1:getPatternBunch(bunch_indexes)
-        local bunch2 = ds2:getPatternBunch(bunch_indexes)
+        local bunch1 = ds1:getPatternBunch(bunch_indexes, buffers[1])
+        local bunch2 = ds2:getPatternBunch(bunch_indexes, buffers[2])
+        if recycle[1] then buffers[1] = bunch1 end
+        if recycle[2] then buffers[2] = bunch2 end
         k=k+bunch_mb_size
         if k >= MAX_SIZE_WO_COLLECT_GARBAGE then cgarbage("collect") k=0 end
         return bunch1,bunch2,bunch_indexes
@@ -308,7 +333,8 @@ trainable.dataset_multiple_iterator =
         until not idx or #bunch_indexes==bunch_size
         -- end condition, return nil
         if #bunch_indexes == 0 then cgarbage("collect") return end
-        local bunch1 = ds1:getPatternBunch(bunch_indexes)
+        local bunch1 = ds1:getPatternBunch(bunch_indexes, buffers[1])
+        if recycle[1] then buffers[1] = bunch1 end
         k=k+bunch_mb_size
         if k >= MAX_SIZE_WO_COLLECT_GARBAGE then cgarbage("collect") k=0 end
         return bunch1,bunch_indexes
@@ -396,6 +422,71 @@ function train_holdout:constructor(t,saved_state)
   }
 end
 
+-- updates the best model using the validation error of state.last
+local function update_best(params, state, clone)
+  if ( state.validation_error < state.best_val_error or
+       state.current_epoch <= params.epochs_wo_validation ) then
+    local abs_error = math.abs(state.best_val_error - state.validation_error)
+    local rel_error = abs_error / math.abs(state.best_val_error)
+    if state.best_val_error == math.huge or rel_error > params.tolerance then
+      state.best_epoch     = state.current_epoch
+      state.best_val_error = state.validation_error
+      state.best           = clone( state.last )
+    end
+  end
+end
+
+-- trains one epoch and keeps a clone of the model, which could be trained
+-- again before its validation finishes
+local function train_one_epoch(train_function, ...)
+  local model, train_error = train_function(...)
+  assert(model and train_error,
+         "Needs a train function which returns two values: a model and training error")
+  return { model = util.clone(model), train_error = train_error }
+end
+
+-- forks a child process which writes validate_function(model) into a
+-- temporary file, numbers are written with full precision
+local function fork_validation(validate_function, model)
+  local filename = os.tmpname()
+  -- avoid duplicated output when the child flushes its buffers
+  io.stdout:flush()
+  io.stderr:flush()
+  local id,pid = util.split_process(2)
+  if id == 2 then
+    -- the OpenMP thread pool of the parent doesn't exist in the child, which
+    -- would block in the first parallel region using more than one thread
+    util.omp_set_num_threads(1)
+    local ok,result = pcall(function()
+        local result = validate_function(model)
+        return assert(tonumber(result),
+                      "Needs a validation function which returns a number")
+    end)
+    local f = io.open(filename, "w")
+    if not ok then
+      f:write(string.format("return false,%q\n", tostring(result)))
+    elseif result ~= result then f:write("return true,0/0\n")
+    elseif result == math.huge then f:write("return true,math.huge\n")
+    elseif result == -math.huge then f:write("return true,-math.huge\n")
+    else f:write(string.format("return true,%.17g\n", result))
+    end
+    f:close()
+    os.exit(0)
+  end
+  return { pid = pid, filename = filename }
+end
+
+-- waits the child process and returns its validation error
+local function join_validation(job)
+  local _,status = util.waitpid(job.pid)
+  local chunk = loadfile(job.filename)
+  os.remove(job.filename)
+  assert(status == 0 and chunk, "Validation process failed")
+  local ok,result = chunk()
+  if not ok then error(result) end
+  return result
+end
+
 train_holdout_methods.execute =
   april_doc{
     class = "method", summary = "Runs one training epoch",
@@ -431,17 +522,80 @@ train_holdout_methods.execute =
     state.last, state.train_error, state.validation_error = epoch_function(...)
     assert(state.last and state.train_error and state.validation_error,
            "Needs a function which returns three values: a model, training error and validation error")
-    -- update with the best model
-    if ( state.validation_error < state.best_val_error or
-         state.current_epoch <= params.epochs_wo_validation ) then
-      local abs_error = math.abs(state.best_val_error - state.validation_error)
-      local rel_error = abs_error / math.abs(state.best_val_error)
-      if state.best_val_error == math.huge or rel_error > params.tolerance then
-        state.best_epoch     = state.current_epoch
-        state.best_val_error = state.validation_error
-        state.best           = util.clone( state.last )
+    update_best(params, state, util.clone)
+    return true
+  end
+
+train_holdout_methods.execute_async =
+  april_doc{
+    class = "method",
+    summary = "Runs one training epoch, validating while the next one trains",
+    description ={
+      "This method is equivalent to execute, but training and",
+      "validation are given as two functions. The validation of",
+      "epoch N is computed by a forked process, which works over a",
+      "copy of the model, while the next epoch is trained, so the",
+      "wall time of one epoch is max(train,validation) instead of",
+      "the sum. The child process uses only one OpenMP thread.",
+      "Results are given to the stopping criterion in order,",
+      "and after every call the state is the same as with execute.",
+      "The next epoch is trained by calling the train function",
+      "again, so the model trained by this function (the caller's",
+      "live trainer) is always one epoch ahead of state.current_epoch,",
+      "and when the training stops it has been trained one extra",
+      "epoch. The trained model is cloned after every epoch, so",
+      "state.last and state.best never see the speculative epoch,",
+      "use them instead of the live trainer after the training. The",
+      "speculative epoch is not saved by save() or to_lua_string().",
+      "The variadic arguments of call N are used to train epoch N+1,",
+      "so they should be the same in every call.",
+    },
+    params = {
+      {
+        "A function which trains one epoch and returns the trained",
+        "model and the training loss",
+      },
+      {
+        "A function which receives the trained model and returns the",
+        "validation loss. It is executed in a child process, so its",
+        "side effects are not seen by the caller.",
+      },
+      "Variadic list of arguments for the train function, used also",
+      "for the speculative epoch [optional]",
+    },
+    outputs = { "True or false, indicating if the training continues or not" },
+  } ..
+  function(self, train_function, validate_function, ...)
+    local params = self.params
+    local state  = self.state
+    if ( state.current_epoch >= params.max_epochs or
+           ( state.current_epoch > params.min_epochs and
+               params.stopping_criterion(state) ) ) then
+      self.next_epoch = nil
+      return false
+    end
+    -- the epoch trained by the previous call, or a new one at the beginning
+    local epoch = self.next_epoch or train_one_epoch(train_function, ...)
+    self.next_epoch = nil
+    local job = fork_validation(validate_function, epoch.model)
+    -- speculative epoch, it advances the live model of the caller, which is
+    -- not rolled back when the training stops
+    if state.current_epoch + 1 < params.max_epochs then
+      local ok,next_epoch = pcall(train_one_epoch, train_function, ...)
+      if not ok then
+        -- the child is waited before raising, so it isn't left as a zombie
+        util.waitpid(job.pid)
+        os.remove(job.filename)
+        error(next_epoch, 0)
       end
+      self.next_epoch = next_epoch
     end
+    state.current_epoch    = state.current_epoch + 1
+    state.last             = epoch.model
+    state.train_error      = epoch.train_error
+    state.validation_error = join_validation(job)
+    -- state.last is a clone which is not modified anymore
+    update_best(params, state, function(model) return model end)
     return true
   end
 
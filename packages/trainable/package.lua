@@ -18,6 +18,9 @@
      lua_unit_test{
        file={
 	 "test/test.lua",
+	 "test/test_async_validation.lua",
+	 "test/test_checkpoint.lua",
+	 "test/test_flat_weights.lua",
        },
      },
    },
@@ -0,0 +1,102 @@
+local check = utest.check
+local T = utest.test
+
+-- a fake model whose validation error has its minimum at epoch 6
+local function make_train()
+  local model = { epoch = 0 }
+  return model, function()
+    model.epoch = model.epoch + 1
+    return model, 1/model.epoch
+  end
+end
+
+local function validate(model)
+  return (model.epoch - 6)^2 + 0.125
+end
+
+local function make_holdout()
+  return trainable.train_holdout_validation{
+    min_epochs = 4,
+    max_epochs = 20,
+    stopping_criterion = trainable.stopping_criteria.make_max_epochs_wo_imp_absolute(3),
+  }
+end
+
+T("AsyncHoldoutValidation",
+  function()
+    local sync_states, async_states = {}, {}
+    local _,train = make_train()
+    local sync = make_holdout()
+    while sync:execute(function()
+        local model,tr = train()
+        return model,tr,validate(model)
+    end) do
+      table.insert(sync_states, sync:get_state_string())
+    end
+    local live,train = make_train()
+    local async = make_holdout()
+    while async:execute_async(train, validate) do
+      table.insert(async_states, async:get_state_string())
+    end
+    check.eq( #async_states, #sync_states )
+    for i=1,#sync_states do check.eq( async_states[i], sync_states[i] ) end
+    local sync_t, async_t = sync:get_state_table(), async:get_state_table()
+    check.eq( async_t.best_epoch, 6 )
+    check.eq( async_t.best.epoch, 6 )
+    check.eq( async_t.last.epoch, sync_t.last.epoch )
+    -- the live model was trained one speculative epoch more
+    check.eq( live.epoch, async_t.current_epoch + 1 )
+    -- errors in the child process are raised at the caller
+    local _,train = make_train()
+    local holdout = make_holdout()
+    check.errored(function()
+        holdout:execute_async(train, function() error("FAIL") end)
+    end)
+    -- errors in the speculative epoch are raised after waiting the child,
+    -- so no child process is left to be waited
+    local model,train = make_train()
+    local holdout = make_holdout()
+    local ok,msg = pcall(function()
+        holdout:execute_async(function()
+            if model.epoch == 1 then error("SPECULATIVE FAIL") end
+            return train()
+        end, validate)
+    end)
+    check.TRUE( not ok and msg:find("SPECULATIVE FAIL") )
+    check.errored(function() return util.waitpid(-1) end)
+end)
+
+T("AsyncHoldoutValidationTrainer",
+  function()
+    local rnd = random(1234)
+    local x = matrix(64, 4):uniformf(-1, 1, rnd)
+    local y = x:sum(2)
+    local function make_trainer()
+      local net = ann.mlp.all_all.generate("4 inputs 1 linear")
+      local trainer = trainable.supervised_trainer(net, ann.loss.mse(), 16,
+                                                   ann.optimizer.sgd())
+      trainer:build()
+      trainer:randomize_weights{ random = random(52324), inf = -0.1, sup = 0.1 }
+      trainer:set_option("learning_rate", 0.05)
+      return trainer
+    end
+    local data = { input_dataset = dataset.matrix(x),
+                   output_dataset = dataset.matrix(y) }
+    local function make_functions(trainer)
+      return function() return trainer, trainer:train_dataset(data) end,
+      function(model) return model:validate_dataset(data) end
+    end
+    local sync_trainer  = make_trainer()
+    local async_trainer = make_trainer()
+    local sync, async = make_holdout(), make_holdout()
+    local train, validate = make_functions(sync_trainer)
+    while sync:execute(function()
+        local model,tr = train()
+        return model,tr,validate(model)
+    end) do end
+    local train, validate = make_functions(async_trainer)
+    while async:execute_async(train, validate) do end
+    check.eq( async:get_state_string(), sync:get_state_string() )
+    check.number_eq( async:get_state_table().best:validate_dataset(data),
+                     sync:get_state_table().best:validate_dataset(data) )
+end)
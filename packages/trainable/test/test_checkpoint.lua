@@ -0,0 +1,76 @@
+local check = utest.check
+local T = utest.test
+
+local function make_trainer(rnd)
+  local net = ann.mlp.all_all.generate("4 inputs 256 tanh 1 linear")
+  local trainer = trainable.supervised_trainer(net, ann.loss.mse(), 16,
+                                               ann.optimizer.sgd())
+  trainer:build()
+  trainer:randomize_weights{ random = rnd, inf = -0.1, sup = 0.1 }
+  trainer:set_option("learning_rate", 0.05)
+  trainer:set_option("momentum", 0.9)
+  return trainer
+end
+
+local function check_weights(a, b)
+  for name,w in a:iterate_weights() do
+    check.eq(w, b:weights(name))
+  end
+end
+
+T("CheckpointTest",
+  function()
+    local rnd = random(1234)
+    local x = matrix(64, 4):uniformf(-1, 1, rnd)
+    local data = { input_dataset = dataset.matrix(x),
+                   output_dataset = dataset.matrix(x:sum(2)) }
+    local trainer = make_trainer(random(5678))
+    trainer:train_dataset(data)
+    local path = os.tmpname()
+    trainable.checkpoint.save(trainer, path)
+    -- raw binary data is smaller than base-85 text
+    local f = io.open(path) local cp_size = f:seek("end") f:close()
+    check.lt(cp_size, #util.serialize(trainer))
+    local loaded = trainable.checkpoint.load(path)
+    check.TRUE(class.is_a(loaded, trainable.supervised_trainer))
+    check_weights(trainer, loaded)
+    check.number_eq(loaded:validate_dataset(data),
+                    trainer:validate_dataset(data), 1e-6)
+    -- optimizer state (momentum) is restored, training continues equal
+    check.number_eq(loaded:train_dataset(data),
+                    trainer:train_dataset(data), 1e-6)
+    check_weights(trainer, loaded)
+    -- asynchronous save is a snapshot at call time, and loaded matrices
+    -- are copy on write, so overwriting the file doesn't change them
+    local snapshot = trainer:clone()
+    local handle = trainable.checkpoint.save(trainer, path, { async=true })
+    trainer:train_dataset(data)
+    check.TRUE(handle:wait())
+    local loaded2 = trainable.checkpoint.load(path)
+    check_weights(snapshot, loaded2)
+    check_weights(snapshot, loaded)
+    -- nested tables, non float matrices and shared references
+    local w = matrix(3,3):linear()
+    trainable.checkpoint.save({ a = w, b = { w, matrixInt32{1,2} },
+                                c = "hello" }, path, { async=true })
+    local t = trainable.checkpoint.load(path)
+    check.eq(t.a, w)
+    check.eq(t.b[2], matrixInt32{1,2})
+    check.eq(t.c, "hello")
+    t.a:set(1,1,100)
+    check.eq(t.b[1]:get(1,1), 100)
+    -- views are written without the rest of their memory block
+    local big = matrix(100,100):linear()
+    trainable.checkpoint.save({ a = big:select(2,3),
+                                b = big:slice({3,2},{4,5}) }, path)
+    local f = io.open(path) local cp_size = f:seek("end") f:close()
+    check.lt(cp_size, big:size()*4)
+    local t = trainable.checkpoint.load(path)
+    check.eq(t.a, big:select(2,3))
+    check.eq(t.b, big:slice({3,2},{4,5}))
+    os.remove(path)
+    -- errors in the child process are raised by wait()
+    local handle = trainable.checkpoint.save(trainer, "/nonexistent/dir/cp",
+                                             { async=true })
+    check.errored(function() handle:wait() end)
+end)
@@ -0,0 +1,73 @@
+local check = utest.check
+local T = utest.test
+
+local function make_trainer(net, flat)
+  local trainer = trainable.supervised_trainer(net, ann.loss.mse(), 16,
+                                               ann.optimizer.sgd(),
+                                               true, 0.5)
+  trainer:build{ flat = flat }
+  trainer:randomize_weights{ random = random(5678), inf = -0.1, sup = 0.1 }
+  trainer:set_option("learning_rate", 0.05)
+  trainer:set_option("momentum", 0.9)
+  return trainer
+end
+
+local function check_weights(a, b)
+  for name,w in a:iterate_weights() do
+    check.eq(w, b:weights(name))
+  end
+end
+
+T("FlatWeightsTrainerTest",
+  function()
+    local rnd = random(1234)
+    local x = matrix(64, 4):uniformf(-1, 1, rnd)
+    local data = { input_dataset = dataset.matrix(x),
+                   output_dataset = dataset.matrix(x:sum(2)) }
+    local net = ann.mlp.all_all.generate("4 inputs 32 tanh 1 linear")
+    local trainer = make_trainer(net:clone())
+    local flat_trainer = make_trainer(net:clone(), true)
+    check.FALSE(trainer:get_flat_weights())
+    local flat = flat_trainer:get_flat_weights()
+    check.eq(flat:size(), flat_trainer:size())
+    check.eq(flat_trainer:get_flat_gradients():size(), flat:size())
+    check_weights(trainer, flat_trainer)
+    for i=1,4 do
+      check.number_eq(flat_trainer:train_dataset(data),
+                      trainer:train_dataset(data), 1e-5)
+    end
+    check_weights(trainer, flat_trainer)
+    -- the optimizer updates the views in place
+    check.TRUE(flat_trainer:get_flat_weights() == flat)
+    -- flat option is kept by clone and serialization
+    check.TRUE(flat_trainer:clone():get_flat_weights())
+    local loaded = util.deserialize(util.serialize(flat_trainer))
+    check.TRUE(loaded:get_flat_weights())
+    check_weights(trainer, loaded)
+    -- checkpoints store compact views
+    local path = os.tmpname()
+    trainable.checkpoint.save(flat_trainer, path)
+    local f = io.open(path) local flat_size = f:seek("end") f:close()
+    trainable.checkpoint.save(trainer, path)
+    local f = io.open(path) local size = f:seek("end") f:close()
+    check.lt(flat_size, size + 1024)
+    os.remove(path)
+end)
+
+T("FlatWeightsGraphTest",
+  function()
+    local g = ann.graph()
+    local l1 = ann.components.hyperplane{ input=4, output=8, name="l1",
+                                          dot_product_weights="w1",
+                                          bias_weights="b1" }
+    local l2 = ann.components.hyperplane{ input=8, output=2, name="l2",
+                                          dot_product_weights="w2",
+                                          bias_weights="b2" }
+    g:connect("input", l1, l2, "output")
+    local _,weights = g:build{ flat = true }
+    local flat = ann.connections.get_flat(weights)
+    check.TRUE(flat)
+    check.eq(flat:size(), 4*8 + 8 + 8*2 + 2)
+    flat:fill(1.0)
+    check.eq(g:forward(matrix(1,4):fill(1)), matrix(1,2):fill(41))
+end)
@@ -1,3 +1,6 @@
+-- Appends to a FEATURES_TXT file one column per given file, every file with
+-- one value per hypothesis, as the "scores" output of
+-- language_models.nbest_rescorer. No LM is queried here.
 featuresfilename     = arg[1]
 
 f = {} for i=2,#arg do f[i-1] = io.open(arg[i], "r") end
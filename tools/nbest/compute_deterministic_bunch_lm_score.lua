@@ -30,95 +30,28 @@ local lm = ngram.lira.bunch_hashed_model{
   lira_model   = lm1,
   bunch_size   = 4,
 }
-
-local lmi = lm:get_interface()
 collectgarbage("collect")
---use_cache = lm:has_cache()
-
-------------------------------------- GO!
-
-time=util.stopwatch()
-time:go()
-local scores = {}
-local j=1
-local prevn = nil
---lm:restart()
---cachef = nil
---if cache_extra_set then
---  cachef = io.open(cache_extra_set, "r")
---end
---local last_best_line = nil
 
 assert(lm:is_deterministic(),
        "Error: Expected a deterministic LM")
-nbestf = io.open(nbestfile, "r")
 
-while true do
-  local line = nbestf:read("*l")
-  local n
-  if line then n = tonumber(string.match(line, "(.*)|||.*|||.*|||")) + 1 end
-  if not prevn then prevn = n last_best_line = line end
-  if not line or n ~= prevn then
-    --[[
-    if cachef then
-      local line  = cachef:read("*l")
-      local words = string.tokenize(line)
-      for i=1,#words do
-        if words[i] == stop_word then lm:clearCache()
-        elseif words[i] ~= null_word then
-	        local w = dictionary:getWordId(words[i]) or dictionary:getWordId(unk_word)
-          ngram_model:cacheWord(w)
-        end
-      end
-    end
-    --]]
+------------------------------------- GO!
 
-    result = lmi:get_queries()
-    for i=1,#result do
-      k,p,b = result:get(i)
-      scores[b]= scores[b] + p
-    end
-    lmi:clear_queries()
+time=util.stopwatch()
+time:go()
 
-    print(table.concat(scores, "\n"))
-    scores    = {}
-    prevn     = n
-    --[[
-    if use_cache or n and math.mod(n, 100) == 99 then lm:restart() end
-    if use_cache and last_best_line then
-      local words = string.tokenize(string.match(last_best_line, "|||(.*)|||.*|||"))
-      local wids  = vocab:searchWordIdSequence(words, vocab:getWordId(unk_word))
-      for i=1,#wids do lm:cacheWord(wids[i]) end
-    end
-    --]]
-    last_best_line = line
-  end
-  if not line then break end
-  
-  line = string.match(line, "|||(.*)|||.*|||")
-  local words = string.tokenize(line)
-  local wids  = vocab:searchWordIdSequence(words, vocab:getWordId(unk_word))
-  table.insert(scores, 0)
-  local key
-  if use_bcc then
-    key = lmi:get_initial_key()
-  else
-    key = lmi:get_zero_key()
-  end
-  for wpos=1,#wids do
-    local w = wids[wpos]
-    lmi:insert_query(key, w, { id_key = #scores})
-    result = lmi:next_keys(key, w)
-    assert(#result == 1)
-    key = result:get(1)
-  end
-  if use_ecc then
-    local w = vocab:getWordId(end_word)
-    lmi:insert_query(key, w, { id_key = #scores })
-  end
-  j=j+1
-  if math.modf(j, 250) == 0 then collectgarbage("collect") end
-end
+-- the native rescorer shares prefixes of the hypotheses of each sentence and
+-- queries the LM in bunches of many sentences
+local rescorer = language_models.nbest_rescorer{
+  model      = lm,
+  vocabulary = words,
+  unk_word   = unk_word,
+  end_word   = end_word,
+  use_bcc    = use_bcc,
+  use_ecc    = use_ecc,
+}
+local nbestf = io.open(nbestfile, "r")
+rescorer:rescore(nbestf, io.stdout, "scores")
 nbestf:close()
 time:stop()
 a,b=time:read()
@@ -1,3 +1,6 @@
+-- Reranks an n-best list with a linear combination of its features. No LM is
+-- queried here, LM scores are added to the n-best beforehand by
+-- language_models.nbest_rescorer (see compute_deterministic_bunch_lm_score.lua)
 weightsfilename = arg[1]
 nbestfilename   = arg[2]
 features        = arg[3]